@@ -4,6 +4,10 @@
  *
  * Wreath-Sheaf Architecture - Algebraic Operating System
  * Built with proper EDK2 toolchain for correct PE/COFF format
+ *
+ * Loads bonsai_kernel.elf: every PT_LOAD segment is read from the file
+ * straight to its physical link address, .bss is zeroed, and the kernel
+ * is entered at e_entry with a BootInfo (../Kernel/boot_info.h) in x0.
  */
 
 #include <Uefi.h>
@@ -11,30 +15,98 @@
 #include <Library/UefiApplicationEntryPoint.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CacheMaintenanceLib.h>
 #include <Protocol/LoadedImage.h>
 #include <Protocol/SimpleFileSystem.h>
-#include <Guid/FileInfo.h>
+#include <Guid/Acpi.h>
+
+#include "../Kernel/boot_info.h"
 
 #define KERNEL_STACK_SIZE (16 * 1024) // 16KB stack
 
+// Flattened device tree configuration table (UEFI spec, EFI_DTB_TABLE_GUID)
+STATIC EFI_GUID  mDtbTableGuid = {
+  0xb1b621d5, 0xf19c, 0x41a5, { 0x83, 0x0b, 0xd9, 0x15, 0x2c, 0x69, 0xaa, 0xe0 }
+};
+
+// The parts of the ELF64 format the loader reads
+#define ELF_CLASS_64      2
+#define ELF_DATA_LSB      1
+#define ELF_TYPE_EXEC     2
+#define ELF_MACHINE_ARM64 183
+#define ELF_PT_LOAD       1
+#define ELF_MAX_PHDRS     16
+
+typedef struct {
+  UINT8   Ident[16];
+  UINT16  Type;
+  UINT16  Machine;
+  UINT32  Version;
+  UINT64  Entry;
+  UINT64  PhOff;
+  UINT64  ShOff;
+  UINT32  Flags;
+  UINT16  EhSize;
+  UINT16  PhEntSize;
+  UINT16  PhNum;
+  UINT16  ShEntSize;
+  UINT16  ShNum;
+  UINT16  ShStrNdx;
+} ELF64_EHDR;
+
+typedef struct {
+  UINT32  Type;
+  UINT32  Flags;
+  UINT64  Offset;
+  UINT64  VAddr;
+  UINT64  PAddr;
+  UINT64  FileSz;
+  UINT64  MemSz;
+  UINT64  Align;
+} ELF64_PHDR;
+
+/**
+ * Generic timer count, for the boot timestamps
+ */
+STATIC
+UINT64
+ReadCounter (
+  VOID
+  )
+{
+  UINT64  Value;
+
+  __asm__ volatile ("isb\n mrs %0, cntvct_el0" : "=r"(Value));
+  return Value;
+}
+
+STATIC
+UINT64
+ReadCounterFrequency (
+  VOID
+  )
+{
+  UINT64  Value;
+
+  __asm__ volatile ("mrs %0, cntfrq_el0" : "=r"(Value));
+  return Value;
+}
+
 /**
- * Load a file from the ESP
+ * Open a file on the volume this image was loaded from
  */
 EFI_STATUS
-LoadKernelFile (
-  IN  EFI_HANDLE   ImageHandle,
-  IN  CHAR16       *FileName,
-  OUT VOID         **Buffer,
-  OUT UINTN        *Size
+OpenKernelFile (
+  IN  EFI_HANDLE         ImageHandle,
+  IN  CHAR16             *FileName,
+  OUT EFI_FILE_PROTOCOL  **Root,
+  OUT EFI_FILE_PROTOCOL  **File
   )
 {
   EFI_STATUS                       Status;
   EFI_LOADED_IMAGE_PROTOCOL        *LoadedImage;
   EFI_SIMPLE_FILE_SYSTEM_PROTOCOL  *FileSystem;
-  EFI_FILE_PROTOCOL                *Root;
-  EFI_FILE_PROTOCOL                *File;
-  EFI_FILE_INFO                    *FileInfo;
-  UINTN                            FileInfoSize;
 
   Status = gBS->HandleProtocol(ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
   if (EFI_ERROR(Status)) return Status;
@@ -42,76 +114,153 @@ LoadKernelFile (
   Status = gBS->HandleProtocol(LoadedImage->DeviceHandle, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&FileSystem);
   if (EFI_ERROR(Status)) return Status;
 
-  Status = FileSystem->OpenVolume(FileSystem, &Root);
+  Status = FileSystem->OpenVolume(FileSystem, Root);
   if (EFI_ERROR(Status)) return Status;
 
-  Status = Root->Open(Root, &File, FileName, EFI_FILE_MODE_READ, 0);
+  Status = (*Root)->Open(*Root, File, FileName, EFI_FILE_MODE_READ, 0);
   if (EFI_ERROR(Status)) {
-    Root->Close(Root);
-    return Status;
+    (*Root)->Close(*Root);
   }
+  return Status;
+}
 
-  FileInfoSize = 0;
-  Status = File->GetInfo(File, &gEfiFileInfoGuid, &FileInfoSize, NULL);
-  if (Status != EFI_BUFFER_TOO_SMALL) {
-    File->Close(File);
-    Root->Close(Root);
-    return Status;
-  }
+/**
+ * Read exactly Size bytes at Offset
+ */
+EFI_STATUS
+ReadAt (
+  IN  EFI_FILE_PROTOCOL  *File,
+  IN  UINT64             Offset,
+  IN  UINTN              Size,
+  OUT VOID               *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Read;
 
-  FileInfo = AllocatePool(FileInfoSize);
-  if (!FileInfo) {
-    File->Close(File);
-    Root->Close(Root);
-    return EFI_OUT_OF_RESOURCES;
-  }
+  Status = File->SetPosition(File, Offset);
+  if (EFI_ERROR(Status)) return Status;
 
-  Status = File->GetInfo(File, &gEfiFileInfoGuid, &FileInfoSize, FileInfo);
-  if (EFI_ERROR(Status)) {
-    FreePool(FileInfo);
-    File->Close(File);
-    Root->Close(Root);
-    return Status;
+  Read = Size;
+  Status = File->Read(File, &Read, Buffer);
+  if (EFI_ERROR(Status)) return Status;
+
+  return Read == Size ? EFI_SUCCESS : EFI_END_OF_FILE;
+}
+
+/**
+ * Load the kernel ELF at its link addresses
+ *
+ * All PT_LOAD segments are covered by one EfiLoaderCode allocation at
+ * AllocateAddress, so segments sharing a page need no special casing.
+ * The span is zeroed, file bytes are read in place (no staging copy) and
+ * the instruction cache is made coherent with what was written.
+ */
+EFI_STATUS
+LoadKernelElf (
+  IN  EFI_HANDLE  ImageHandle,
+  IN  CHAR16      *FileName,
+  OUT UINT64      *Entry,
+  OUT UINT64      *ImageBase,
+  OUT UINTN       *ImagePages
+  )
+{
+  EFI_STATUS            Status;
+  EFI_FILE_PROTOCOL     *Root;
+  EFI_FILE_PROTOCOL     *File;
+  ELF64_EHDR            Header;
+  ELF64_PHDR            Segments[ELF_MAX_PHDRS];
+  UINT64                Low;
+  UINT64                High;
+  EFI_PHYSICAL_ADDRESS  Base;
+  UINTN                 Pages;
+  UINTN                 Index;
+
+  Status = OpenKernelFile(ImageHandle, FileName, &Root, &File);
+  if (EFI_ERROR(Status)) return Status;
+
+  Status = ReadAt(File, 0, sizeof(Header), &Header);
+  if (EFI_ERROR(Status)) goto Close;
+
+  if (Header.Ident[0] != 0x7f || Header.Ident[1] != 'E' || Header.Ident[2] != 'L' || Header.Ident[3] != 'F'
+      || Header.Ident[4] != ELF_CLASS_64 || Header.Ident[5] != ELF_DATA_LSB
+      || Header.Type != ELF_TYPE_EXEC || Header.Machine != ELF_MACHINE_ARM64
+      || Header.PhEntSize != sizeof(ELF64_PHDR) || Header.PhNum == 0 || Header.PhNum > ELF_MAX_PHDRS) {
+    Print(L"  [ERR] Not an AArch64 ELF executable\n");
+    Status = EFI_LOAD_ERROR;
+    goto Close;
   }
 
-  *Size = (UINTN)FileInfo->FileSize;
-  FreePool(FileInfo);
+  Status = ReadAt(File, Header.PhOff, Header.PhNum * sizeof(ELF64_PHDR), Segments);
+  if (EFI_ERROR(Status)) goto Close;
 
-  *Buffer = AllocatePool(*Size);
-  if (!*Buffer) {
-    File->Close(File);
-    Root->Close(Root);
-    return EFI_OUT_OF_RESOURCES;
+  // Physical span of the loadable segments
+  Low = MAX_UINT64;
+  High = 0;
+  for (Index = 0; Index < Header.PhNum; Index++) {
+    if (Segments[Index].Type != ELF_PT_LOAD || Segments[Index].MemSz == 0) continue;
+    if (Segments[Index].FileSz > Segments[Index].MemSz) {
+      Status = EFI_LOAD_ERROR;
+      goto Close;
+    }
+    Low = MIN(Low, Segments[Index].PAddr);
+    High = MAX(High, Segments[Index].PAddr + Segments[Index].MemSz);
+  }
+  if (High == 0 || Header.Entry < Low || Header.Entry >= High) {
+    Print(L"  [ERR] No loadable segment holds the entry point\n");
+    Status = EFI_LOAD_ERROR;
+    goto Close;
   }
 
-  Status = File->Read(File, Size, *Buffer);
+  Base = Low & ~(UINT64)EFI_PAGE_MASK;
+  Pages = EFI_SIZE_TO_PAGES(High - Base);
+  Status = gBS->AllocatePages(AllocateAddress, EfiLoaderCode, Pages, &Base);
   if (EFI_ERROR(Status)) {
-    FreePool(*Buffer);
-    *Buffer = NULL;
+    Print(L"  [ERR] 0x%lx - 0x%lx is not free: %r\n", Base, Base + EFI_PAGES_TO_SIZE(Pages), Status);
+    goto Close;
+  }
+  ZeroMem((VOID *)(UINTN)Base, EFI_PAGES_TO_SIZE(Pages));
+
+  for (Index = 0; Index < Header.PhNum; Index++) {
+    if (Segments[Index].Type != ELF_PT_LOAD || Segments[Index].FileSz == 0) continue;
+    Status = ReadAt(File, Segments[Index].Offset, (UINTN)Segments[Index].FileSz,
+                    (VOID *)(UINTN)Segments[Index].PAddr);
+    if (EFI_ERROR(Status)) {
+      gBS->FreePages(Base, Pages);
+      goto Close;
+    }
   }
 
+  // Clean D-cache to PoU and invalidate I-cache over the new code
+  InvalidateInstructionCacheRange((VOID *)(UINTN)Base, EFI_PAGES_TO_SIZE(Pages));
+
+  *Entry = Header.Entry;
+  *ImageBase = Base;
+  *ImagePages = Pages;
+
+Close:
   File->Close(File);
   Root->Close(Root);
-
   return Status;
 }
 
 /**
- * Jump to kernel (AArch64 assembly)
+ * Jump to kernel (AArch64 assembly), BootInfo in x0
  */
 VOID
 JumpToKernel (
-  IN VOID  *KernelEntry,
-  IN VOID  *StackTop
+  IN VOID      *KernelEntry,
+  IN VOID      *StackTop,
+  IN BootInfo  *Boot
   )
 {
-  // Simple approach: kernel takes no arguments for now
-  // Stack is already set up
+  register UINT64  Arg __asm__("x0") = (UINT64)(UINTN)Boot;
+
   __asm__ volatile (
     "mov sp, %0\n"
     "br %1\n"
     :
-    : "r"(StackTop), "r"(KernelEntry)
+    : "r"(StackTop), "r"(KernelEntry), "r"(Arg)
     : "memory"
   );
 }
@@ -127,15 +276,24 @@ UefiMain (
   )
 {
   EFI_STATUS  Status;
-  VOID        *KernelBuffer = NULL;
-  UINTN       KernelSize = 0;
-  VOID        *KernelStack = NULL;
+  UINT64      LoaderEntryTime;
+  UINT64      KernelEntry;
+  UINT64      KernelBase;
+  UINTN       KernelPages;
+  EFI_PHYSICAL_ADDRESS  KernelStack;
   VOID        *KernelStackTop;
   UINTN       MapKey;
   UINTN       MapSize = 0;
+  UINTN       MapCapacity;
   UINTN       DescriptorSize;
   UINT32      DescriptorVersion;
+  UINTN       Attempt;
+  UINTN       Index;
   EFI_MEMORY_DESCRIPTOR  *MemoryMap = NULL;
+  EFI_CONFIGURATION_TABLE  *Table;
+  BootInfo    *Boot = NULL;
+
+  LoaderEntryTime = ReadCounter();
 
   // Clear screen
   SystemTable->ConOut->ClearScreen(SystemTable->ConOut);
@@ -152,45 +310,70 @@ UefiMain (
   Print(L"\n");
 
   // Load kernel
-  Print(L"  [ ] Loading bonsai_kernel.bin...\n");
-  Status = LoadKernelFile(ImageHandle, L"bonsai_kernel.bin", &KernelBuffer, &KernelSize);
+  Print(L"  [ ] Loading bonsai_kernel.elf...\n");
+  Status = LoadKernelElf(ImageHandle, L"bonsai_kernel.elf", &KernelEntry, &KernelBase, &KernelPages);
   if (EFI_ERROR(Status)) {
-    Print(L"  [ERR] Kernel not found: %r\n", Status);
+    Print(L"  [ERR] Kernel not loaded: %r\n", Status);
     Print(L"\nBootloader halted. Press any key...\n");
     SystemTable->BootServices->WaitForEvent(1, &SystemTable->ConIn->WaitForKey, NULL);
     return Status;
   }
-  Print(L"  [OK] Kernel loaded: %u bytes at 0x%lx\n", KernelSize, KernelBuffer);
+  Print(L"  [OK] Kernel loaded: 0x%lx - 0x%lx, entry 0x%lx\n",
+        KernelBase, KernelBase + EFI_PAGES_TO_SIZE(KernelPages), KernelEntry);
 
-  // Allocate kernel stack
-  KernelStack = AllocatePool(KERNEL_STACK_SIZE);
-  if (!KernelStack) {
+  // Allocate kernel stack (pages: sp must be 16-byte aligned)
+  Status = gBS->AllocatePages(AllocateAnyPages, EfiLoaderData, EFI_SIZE_TO_PAGES(KERNEL_STACK_SIZE), &KernelStack);
+  if (EFI_ERROR(Status)) {
     Print(L"  [ERR] Failed to allocate kernel stack\n");
-    FreePool(KernelBuffer);
+    gBS->FreePages(KernelBase, KernelPages);
     return EFI_OUT_OF_RESOURCES;
   }
-  KernelStackTop = (VOID *)((UINT8 *)KernelStack + KERNEL_STACK_SIZE);
+  KernelStackTop = (VOID *)(UINTN)(KernelStack + KERNEL_STACK_SIZE);
   Print(L"  [OK] Stack allocated: 0x%lx - 0x%lx\n", KernelStack, KernelStackTop);
 
-  // Get memory map
-  Status = gBS->GetMemoryMap(&MapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
-  if (Status == EFI_BUFFER_TOO_SMALL) {
-    MapSize += 2 * DescriptorSize;
-    MemoryMap = AllocatePool(MapSize);
-    if (!MemoryMap) {
-      FreePool(KernelStack);
-      FreePool(KernelBuffer);
-      return EFI_OUT_OF_RESOURCES;
+  // Boot info and the memory map buffer, both loader data
+  Status = gBS->AllocatePool(EfiLoaderData, sizeof(BootInfo), (VOID **)&Boot);
+  if (EFI_ERROR(Status)) {
+    gBS->FreePages(KernelStack, EFI_SIZE_TO_PAGES(KERNEL_STACK_SIZE));
+    gBS->FreePages(KernelBase, KernelPages);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  ZeroMem(Boot, sizeof(BootInfo));
+  Boot->timer_frequency = ReadCounterFrequency();
+  Boot->t_loader_entry = LoaderEntryTime;
+  Boot->t_kernel_loaded = ReadCounter();
+
+  // Firmware tables the kernel may want; ACPI 2.0 wins over 1.0
+  for (Index = 0; Index < SystemTable->NumberOfTableEntries; Index++) {
+    Table = &SystemTable->ConfigurationTable[Index];
+    if (CompareGuid(&Table->VendorGuid, &gEfiAcpi20TableGuid)) {
+      Boot->acpi_rsdp = (UINT64)(UINTN)Table->VendorTable;
+    } else if (CompareGuid(&Table->VendorGuid, &gEfiAcpi10TableGuid) && Boot->acpi_rsdp == 0) {
+      Boot->acpi_rsdp = (UINT64)(UINTN)Table->VendorTable;
+    } else if (CompareGuid(&Table->VendorGuid, &mDtbTableGuid)) {
+      Boot->dtb = (UINT64)(UINTN)Table->VendorTable;
     }
-    Status = gBS->GetMemoryMap(&MapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
   }
-  if (EFI_ERROR(Status)) {
+  Print(L"  [OK] ACPI RSDP: 0x%lx, DTB: 0x%lx\n", Boot->acpi_rsdp, Boot->dtb);
+
+  Status = gBS->GetMemoryMap(&MapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
+  if (Status != EFI_BUFFER_TOO_SMALL) {
     Print(L"  [ERR] Failed to get memory map: %r\n", Status);
-    FreePool(MemoryMap);
-    FreePool(KernelStack);
-    FreePool(KernelBuffer);
-    return Status;
+    FreePool(Boot);
+    gBS->FreePages(KernelStack, EFI_SIZE_TO_PAGES(KERNEL_STACK_SIZE));
+    gBS->FreePages(KernelBase, KernelPages);
+    return EFI_ERROR(Status) ? Status : EFI_DEVICE_ERROR;
+  }
+  // Room for the descriptors this allocation and the prints below add
+  MapCapacity = MapSize + 8 * DescriptorSize;
+  Status = gBS->AllocatePool(EfiLoaderData, MapCapacity, (VOID **)&MemoryMap);
+  if (EFI_ERROR(Status)) {
+    FreePool(Boot);
+    gBS->FreePages(KernelStack, EFI_SIZE_TO_PAGES(KERNEL_STACK_SIZE));
+    gBS->FreePages(KernelBase, KernelPages);
+    return EFI_OUT_OF_RESOURCES;
   }
+  Print(L"  [OK] Boot info at 0x%lx, memory map: %u bytes\n", Boot, MapCapacity);
 
   Print(L"\n  Booting in 2 seconds...\n");
   Print(L"  (Connect serial console at 115200 baud for interaction)\n\n");
@@ -198,8 +381,20 @@ UefiMain (
   // Brief delay so user can see message
   gBS->Stall(2000000);  // 2 seconds in microseconds
 
-  // Exit boot services
-  Status = gBS->ExitBootServices(ImageHandle, MapKey);
+  // The map handed to the kernel must be the one ExitBootServices()
+  // accepts. If the key went stale, fetch the map again (allocating is no
+  // longer allowed after a failed exit) and retry once.
+  for (Attempt = 0; Attempt < 2; Attempt++) {
+    MapSize = MapCapacity;
+    Status = gBS->GetMemoryMap(&MapSize, MemoryMap, &MapKey, &DescriptorSize, &DescriptorVersion);
+    if (EFI_ERROR(Status)) {
+      break;
+    }
+    Status = gBS->ExitBootServices(ImageHandle, MapKey);
+    if (!EFI_ERROR(Status)) {
+      break;
+    }
+  }
   if (EFI_ERROR(Status)) {
     // Can't print anymore, just hang
     while (1) {
@@ -207,8 +402,21 @@ UefiMain (
     }
   }
 
+  Boot->t_exit_boot_services = ReadCounter();
+  Boot->magic = BOOT_INFO_MAGIC;
+  Boot->version = BOOT_INFO_VERSION;
+  Boot->descriptor_version = DescriptorVersion;
+  Boot->memory_map = (UINT64)(UINTN)MemoryMap;
+  Boot->memory_map_size = MapSize;
+  Boot->descriptor_size = DescriptorSize;
+  Boot->kernel_base = KernelBase;
+  Boot->kernel_size = EFI_PAGES_TO_SIZE(KernelPages);
+  Boot->kernel_entry = KernelEntry;
+  Boot->stack_base = KernelStack;
+  Boot->stack_size = KERNEL_STACK_SIZE;
+
   // Jump to kernel
-  JumpToKernel(KernelBuffer, KernelStackTop);
+  JumpToKernel((VOID *)(UINTN)KernelEntry, KernelStackTop, Boot);
 
   // Should never return
   while (1) {
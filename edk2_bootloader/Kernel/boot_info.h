@@ -0,0 +1,86 @@
+/**
+ * @file boot_info.h
+ * @brief Handoff from BonsaiBootloader to the kernel
+ *
+ * Shared by the EDK2 bootloader and the freestanding kernel, so it uses
+ * plain C types only. The bootloader passes a pointer to BootInfo in x0
+ * when it jumps to the ELF entry; the image is EfiLoaderCode and
+ * everything else it points at lives in EfiLoaderData pages, neither of
+ * which the kernel hands out.
+ */
+
+#pragma once
+
+#define BOOT_INFO_MAGIC   0x42534e4f42494e46ULL   // "BSNOBINF"
+#define BOOT_INFO_VERSION 2            // Bump on any layout change
+
+// UEFI memory types the kernel cares about (UEFI spec, EFI_MEMORY_TYPE)
+#define BOOT_MEMORY_LOADER_CODE         1
+#define BOOT_MEMORY_LOADER_DATA         2
+#define BOOT_MEMORY_BOOT_SERVICES_CODE  3
+#define BOOT_MEMORY_BOOT_SERVICES_DATA  4
+#define BOOT_MEMORY_RUNTIME_CODE        5
+#define BOOT_MEMORY_RUNTIME_DATA        6
+#define BOOT_MEMORY_CONVENTIONAL        7
+#define BOOT_MEMORY_ACPI_RECLAIM        9
+#define BOOT_MEMORY_ACPI_NVS            10
+#define BOOT_MEMORY_MMIO                11
+#define BOOT_MEMORY_MMIO_PORT           12
+#define BOOT_MEMORY_PERSISTENT          14
+
+#define BOOT_MEMORY_ATTR_WB             0x8ULL   // EFI_MEMORY_WB: cacheable RAM
+
+/**
+ * Layout of EFI_MEMORY_DESCRIPTOR. Walk the map with descriptor_size as
+ * the stride: firmware may append fields.
+ */
+typedef struct {
+    unsigned int type;
+    unsigned int pad;
+    unsigned long long physical_start;
+    unsigned long long virtual_start;
+    unsigned long long n_pages;          // 4 KiB UEFI pages
+    unsigned long long attribute;
+} BootMemoryDescriptor;
+
+/**
+ * What the kernel gets at entry
+ */
+typedef struct {
+    unsigned long long magic;            // BOOT_INFO_MAGIC
+    unsigned int version;                // BOOT_INFO_VERSION
+    unsigned int descriptor_version;
+
+    // Final memory map, the one ExitBootServices() accepted
+    unsigned long long memory_map;       // Physical address of the first descriptor
+    unsigned long long memory_map_size;  // Bytes
+    unsigned long long descriptor_size;
+
+    // Loaded ELF span (EfiLoaderCode) and stack (EfiLoaderData)
+    unsigned long long kernel_base;
+    unsigned long long kernel_size;
+    unsigned long long kernel_entry;
+    unsigned long long stack_base;
+    unsigned long long stack_size;
+
+    // Firmware configuration tables, 0 when the firmware has none
+    unsigned long long acpi_rsdp;
+    unsigned long long dtb;
+
+    // CNTVCT_EL0 at boot milestones, in ticks of timer_frequency Hz
+    unsigned long long timer_frequency;
+    unsigned long long t_loader_entry;
+    unsigned long long t_kernel_loaded;
+    unsigned long long t_exit_boot_services;
+} BootInfo;
+
+/**
+ * i-th descriptor of the map
+ */
+static inline const BootMemoryDescriptor *boot_memory_descriptor(const BootInfo *boot, unsigned long i) {
+    return (const BootMemoryDescriptor *)(unsigned long)(boot->memory_map + i * boot->descriptor_size);
+}
+
+static inline unsigned long boot_memory_descriptor_count(const BootInfo *boot) {
+    return boot->descriptor_size ? (unsigned long)(boot->memory_map_size / boot->descriptor_size) : 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file cpu.h
+ * @brief Per-CPU identity and spinlocks for BonsaiOS kernel
+ *
+ * Each core keeps its index (0 .. MAX_CPUS - 1) in TPIDR_EL1, so per-CPU
+ * data is an array lookup with no atomics. Host builds used for testing
+ * always run as CPU 0.
+ */
+
+#pragma once
+
+#define MAX_CPUS 12                 // Orin AGX: three clusters of four
+
+static inline void cpu_relax(void) {
+#if defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+static inline unsigned int cpu_id(void) {
+#if defined(__aarch64__)
+    unsigned long cpu;
+    __asm__ volatile("mrs %0, tpidr_el1" : "=r"(cpu));
+    return cpu < MAX_CPUS ? (unsigned int)cpu : 0;
+#else
+    return 0;
+#endif
+}
+
+static inline void cpu_set_id(unsigned int cpu) {
+#if defined(__aarch64__)
+    __asm__ volatile("msr tpidr_el1, %0" : : "r"((unsigned long)cpu));
+#else
+    (void)cpu;
+#endif
+}
+
+static inline void spin_lock(int *lock) {
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED)) cpu_relax();
+    }
+}
+
+static inline void spin_unlock(int *lock) {
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
@@ -2,11 +2,16 @@
  * @file kmain.c
  * @brief BonsaiOS Interactive Kernel with Sheaf Solver
  *
- * This kernel runs standalone after ExitBootServices.
+ * This kernel runs standalone after ExitBootServices, loaded at its link
+ * address with the final UEFI memory map, firmware table pointers and
+ * boot timestamps handed over in BootInfo.
  * Demonstrates wreath-sheaf algebraic OS design.
  */
 
 #include "sheaf.h"
+#include "page_alloc.h"
+#include "slab.h"
+#include "mmu.h"
 
 // Tegra Orin UART base address (from NVIDIA L4T docs)
 // UART A is at physical address 0x03100000
@@ -72,6 +77,126 @@ static void uart_puts(const char *s) {
     }
 }
 
+/**
+ * Write an unsigned value as 0x-prefixed hex to UART
+ */
+static void uart_puthex(unsigned long v) {
+    uart_puts("0x");
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        const unsigned int digit = (v >> shift) & 0xf;
+        uart_putc(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    }
+}
+
+/**
+ * Write an unsigned decimal to UART
+ */
+static void uart_putu(unsigned long v) {
+    char buf[20];
+    int idx = 0;
+    do {
+        buf[idx++] = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0);
+    while (idx > 0) uart_putc(buf[--idx]);
+}
+
+// Solver problems come from their own cache rather than the kernel stack
+static SlabCache *problem_cache;
+
+extern char exception_vectors[];
+
+// Handoff from the bootloader, kept for the 'boot' command
+static const BootInfo *boot_info;
+static unsigned long kernel_entry_time;
+
+static unsigned long read_counter(void) {
+    unsigned long v;
+    __asm__ volatile("isb\n mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+}
+
+/**
+ * Counter ticks from one boot milestone to the next, in microseconds
+ */
+static void uart_put_interval(const char *label, unsigned long from, unsigned long to) {
+    uart_puts(label);
+    if (from == 0 || to < from) {
+        uart_puts("n/a\n");
+        return;
+    }
+    uart_putu((to - from) * 1000000UL / boot_info->timer_frequency);
+    uart_puts(" us\n");
+}
+
+static unsigned long current_el(void) {
+    unsigned long el;
+    __asm__ volatile("mrs %0, CurrentEL" : "=r"(el));
+    return (el >> 2) & 3;
+}
+
+/**
+ * Point VBAR at the vectors in start.S (they need 2 KiB alignment, which
+ * holds as long as the image runs at its link address)
+ */
+static int install_vectors(void) {
+    const unsigned long vbar = (unsigned long)exception_vectors;
+    if (vbar & 0x7ff) return -1;
+    if (current_el() == 2) __asm__ volatile("msr vbar_el2, %0\n isb" : : "r"(vbar));
+    else __asm__ volatile("msr vbar_el1, %0\n isb" : : "r"(vbar));
+    return 0;
+}
+
+/**
+ * Every exception lands here (from start.S) and halts: report what hit
+ */
+void kernel_fault(unsigned long vector) {
+    unsigned long esr, far, elr;
+    if (current_el() == 2) {
+        __asm__ volatile("mrs %0, esr_el2" : "=r"(esr));
+        __asm__ volatile("mrs %0, far_el2" : "=r"(far));
+        __asm__ volatile("mrs %0, elr_el2" : "=r"(elr));
+    } else {
+        __asm__ volatile("mrs %0, esr_el1" : "=r"(esr));
+        __asm__ volatile("mrs %0, far_el1" : "=r"(far));
+        __asm__ volatile("mrs %0, elr_el1" : "=r"(elr));
+    }
+    uart_puts("\n[FAULT] vector ");
+    uart_putu(vector);
+    uart_puts(" ESR ");
+    uart_puthex(esr);
+    uart_puts(" FAR ");
+    uart_puthex(far);
+    uart_puts(" ELR ");
+    uart_puthex(elr);
+    uart_puts("\n  System halted.\n");
+}
+
+typedef struct {
+    SheafProblem *problem;
+    int result;
+} SolveCall;
+
+static void solve_call(void *arg) {
+    SolveCall *call = arg;
+    call->result = sheaf_solve(call->problem);
+}
+
+/**
+ * sheaf_solve() on a guarded stack when the MMU is up, else on this one
+ */
+static int solve_guarded(SheafProblem *problem) {
+    SolveCall call = { problem, -1 };
+    const unsigned long top = mmu_stack_alloc();
+    if (top == 0) {
+        solve_call(&call);
+        return call.result;
+    }
+    call_on_stack(solve_call, &call, top);
+    mmu_stack_free(top);
+    return call.result;
+}
+
 /**
  * Simple string compare
  */
@@ -101,7 +226,11 @@ static void process_command(const char *cmd) {
         uart_puts("  help   - Show this help\n");
         uart_puts("  echo   - Echo back input\n");
         uart_puts("  sheaf  - Run sheaf solver demo\n");
+        uart_puts("  mem    - Show page allocator state\n");
+        uart_puts("  heap   - Show slab cache statistics\n");
+        uart_puts("  mmu    - Show translation table state\n");
         uart_puts("  status - Show system status\n");
+        uart_puts("  boot   - Show boot handoff and timeline\n");
     }
     else if (str_cmp(cmd, "echo") == 0) {
         uart_puts("Echo: ");
@@ -111,46 +240,39 @@ static void process_command(const char *cmd) {
     else if (str_cmp(cmd, "sheaf") == 0) {
         uart_puts("\n=== Sheaf Solver Demo: Register Allocation ===\n\n");
 
-        SheafProblem problem;
-        sheaf_demo_register_allocation(&problem);
+        SheafProblem *problem = slab_alloc(problem_cache);
+        if (!problem) {
+            uart_puts("  [ERR] Out of memory\n");
+            return;
+        }
+        sheaf_demo_register_allocation(problem);
 
         uart_puts("Problem: Allocate registers across 2 basic blocks\n");
-        uart_puts("  Patch 1 (block_a): 3 variables (x,y,z)\n");
-        uart_puts("  Patch 2 (block_b): 2 variables (y,w)\n");
+        uart_puts("  Patch 1 (block_a): 3 variables (x,y,z), 4 samples\n");
+        uart_puts("  Patch 2 (block_b): 2 variables (y,w), 3 samples\n");
         uart_puts("  Gluing: Variable 'y' shared between blocks\n\n");
 
-        uart_puts("Running algebraic solver...\n");
-        int result = sheaf_solve(&problem);
+        uart_puts("Running least-squares solver...\n");
+        int result = solve_guarded(problem);
 
         if (result == 0) {
-            uart_puts("  [OK] Solver converged\n");
-            uart_puts("  Residual (obstruction): ");
+            uart_puts("  [OK] Solved ");
+            uart_putu((unsigned long)problem->n_weights);
+            uart_puts(" weights in ");
+            uart_putu(problem->work);
+            uart_puts(" multiply-adds\n");
 
-            // Print residual as integer (simplified)
-            int residual_int = (int)(problem.residual * 1000);
-            if (residual_int == 0) {
-                uart_puts("0.000");
-            } else {
-                // Simple integer print
-                char buf[16];
-                int idx = 0;
-                int temp = residual_int;
-                if (temp == 0) {
-                    buf[idx++] = '0';
-                } else {
-                    while (temp > 0) {
-                        buf[idx++] = '0' + (temp % 10);
-                        temp /= 10;
-                    }
-                }
-                // Reverse
-                for (int i = idx - 1; i >= 0; i--) {
-                    uart_putc(buf[i]);
-                }
-            }
+            // Fixed-point with three decimals
+            unsigned long residual_milli = (unsigned long)(problem->residual * 1000.0 + 0.5);
+            uart_puts("  Residual (obstruction): ");
+            uart_putu(residual_milli / 1000);
+            uart_putc('.');
+            uart_putc('0' + (residual_milli / 100) % 10);
+            uart_putc('0' + (residual_milli / 10) % 10);
+            uart_putc('0' + residual_milli % 10);
             uart_puts("\n");
 
-            if (problem.converged) {
+            if (problem->converged) {
                 uart_puts("  [OK] Optimal allocation found!\n");
             } else {
                 uart_puts("  [WARN] Non-optimal (constraints conflict)\n");
@@ -159,9 +281,113 @@ static void process_command(const char *cmd) {
             uart_puts("  [ERR] Solver failed\n");
         }
 
+        slab_free(problem_cache, problem);
+
         uart_puts("\nThis demonstrates wreath-sheaf algebraic OS design.\n");
         uart_puts("Future: GPU-accelerated scheduling & compilation.\n");
     }
+    else if (str_cmp(cmd, "mem") == 0) {
+        PageStats stats;
+        page_alloc_stats(&stats);
+        uart_puts("Physical memory (4 KiB pages):\n");
+        uart_puts("  Managed: ");
+        uart_putu(stats.total_pages);
+        uart_puts(" (");
+        uart_putu(stats.total_pages >> 8);
+        uart_puts(" MiB)\n  Free:    ");
+        uart_putu(stats.free_pages);
+        uart_puts("\n  Cached:  ");
+        uart_putu(stats.cached_pages);
+        uart_puts("\n  Frame table: ");
+        uart_putu(stats.frame_table_pages);
+        uart_puts("\n  Free blocks by order:");
+        for (int o = 0; o < PAGE_ORDERS; o++) {
+            uart_putc(' ');
+            uart_putu(stats.free_blocks[o]);
+        }
+        uart_puts("\n");
+    }
+    else if (str_cmp(cmd, "heap") == 0) {
+        SlabStats stats[SLAB_MAX_CACHES + 1];
+        const int n = slab_stats(stats, SLAB_MAX_CACHES + 1);
+        uart_puts("cache           size  slabs  in use  allocs\n");
+        for (int i = 0; i < n; i++) {
+            uart_puts("  ");
+            uart_puts(stats[i].name);
+            for (int pad = str_len(stats[i].name); pad < 14; pad++) uart_putc(' ');
+            uart_putu(stats[i].object_size);
+            uart_puts("  ");
+            uart_putu(stats[i].slabs);
+            uart_puts("  ");
+            uart_putu(stats[i].in_use);
+            uart_puts("  ");
+            uart_putu(stats[i].allocs);
+            uart_puts("\n");
+        }
+        unsigned long used, size;
+        slab_pool_usage(&used, &size);
+        uart_puts("Bootstrap pool: ");
+        uart_putu(used >> 10);
+        uart_puts(" / ");
+        uart_putu(size >> 10);
+        uart_puts(" KiB\n");
+    }
+    else if (str_cmp(cmd, "mmu") == 0) {
+        MmuStats stats;
+        mmu_stats(&stats);
+        if (stats.el == 0) {
+            uart_puts("Running on firmware translation tables\n");
+            return;
+        }
+        uart_puts("Kernel tables at EL");
+        uart_putu(stats.el);
+        uart_puts(":\n  1 GiB blocks: ");
+        uart_putu(stats.blocks_1g);
+        uart_puts("\n  2 MiB blocks: ");
+        uart_putu(stats.blocks_2m);
+        uart_puts("\n  4 KiB pages:  ");
+        uart_putu(stats.pages_4k);
+        uart_puts("\n  Table pages:  ");
+        uart_putu(stats.table_pages);
+        uart_puts("\n  Guarded stacks in use: ");
+        uart_putu(stats.stacks_in_use);
+        uart_puts(" of ");
+        uart_putu(MMU_STACK_SLOTS);
+        uart_puts("\n");
+    }
+    else if (str_cmp(cmd, "boot") == 0) {
+        if (!boot_info || boot_info->magic != BOOT_INFO_MAGIC || boot_info->version != BOOT_INFO_VERSION) {
+            uart_puts("No boot info from the bootloader\n");
+            return;
+        }
+        uart_puts("Boot Handoff (v");
+        uart_putu(boot_info->version);
+        uart_puts("):\n  Kernel: ");
+        uart_puthex(boot_info->kernel_base);
+        uart_puts(" (");
+        uart_putu(boot_info->kernel_size >> 10);
+        uart_puts(" KiB), entry ");
+        uart_puthex(boot_info->kernel_entry);
+        uart_puts("\n  Stack:  ");
+        uart_puthex(boot_info->stack_base);
+        uart_puts(" (");
+        uart_putu(boot_info->stack_size >> 10);
+        uart_puts(" KiB)\n  ACPI RSDP: ");
+        if (boot_info->acpi_rsdp) uart_puthex(boot_info->acpi_rsdp);
+        else uart_puts("none");
+        uart_puts("\n  DTB:       ");
+        if (boot_info->dtb) uart_puthex(boot_info->dtb);
+        else uart_puts("none");
+        uart_puts("\n");
+        if (boot_info->timer_frequency == 0) {
+            uart_puts("  Timeline: counter frequency unknown\n");
+            return;
+        }
+        uart_put_interval("  Load kernel ELF:       ", boot_info->t_loader_entry, boot_info->t_kernel_loaded);
+        uart_put_interval("  Exit boot services:    ", boot_info->t_kernel_loaded, boot_info->t_exit_boot_services);
+        uart_put_interval("  Jump to kmain:         ", boot_info->t_exit_boot_services, kernel_entry_time);
+        uart_put_interval("  Total to kmain:        ", boot_info->t_loader_entry, kernel_entry_time);
+    }
     else if (str_cmp(cmd, "status") == 0) {
         uart_puts("System Status:\n");
         uart_puts("  Kernel: Running\n");
@@ -179,12 +405,23 @@ static void process_command(const char *cmd) {
 /**
  * Kernel entry point
  */
-void kmain(void) {
+void kmain(const BootInfo *boot) {
+    const unsigned long entry_time = read_counter();
     char cmd_buffer[64];
     int cmd_idx = 0;
 
+    boot_info = boot;
+    kernel_entry_time = entry_time;
+
     // Initialize UART
     uart_init();
+    const int have_vectors = install_vectors() == 0;
+    const int have_memory = page_alloc_init(boot) == 0;
+    const int have_mmu = have_memory && mmu_init(boot) == 0;
+    // Firmware tables are gone now, so boot-services memory is free
+    const unsigned long reclaimed = have_mmu ? page_alloc_add_boot_services(boot) : 0;
+    slab_init();
+    problem_cache = slab_cache_create("sheaf_problem", sizeof(SheafProblem));
 
     // Print banner
     uart_puts("\n\n");
@@ -198,6 +435,25 @@ void kmain(void) {
     uart_puts("\n");
     uart_puts("  [OK] Kernel running\n");
     uart_puts("  [OK] UART initialized\n");
+    if (have_memory) {
+        PageStats stats;
+        page_alloc_stats(&stats);
+        uart_puts("  [OK] Page allocator: ");
+        uart_putu(stats.free_pages >> 8);
+        uart_puts(" MiB free\n");
+    } else {
+        uart_puts("  [WARN] No usable memory map, page allocator off\n");
+    }
+    if (have_mmu) {
+        uart_puts("  [OK] Kernel page tables, caches on (");
+        uart_putu(reclaimed >> 8);
+        uart_puts(" MiB reclaimed from boot services)\n");
+    } else {
+        uart_puts("  [WARN] Running on firmware page tables\n");
+    }
+    if (!have_vectors) {
+        uart_puts("  [WARN] Exception vectors misaligned, faults not reported\n");
+    }
     uart_puts("  [OK] Console ready\n");
     uart_puts("\nType 'help' for commands.\n");
 
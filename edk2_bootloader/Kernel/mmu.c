@@ -0,0 +1,362 @@
+/**
+ * @file mmu.c
+ * @brief Identity-mapped translation tables and the guarded stack arena
+ *
+ * Tables are built while the firmware's translation is still live, then
+ * swapped in by one register-only sequence that turns the MMU off, loads
+ * MAIR/TCR/TTBR0, invalidates the TLB and turns the MMU back on with the
+ * caches enabled. Nothing in that window touches memory, so the old and
+ * new tables never need to agree on anything but the code being run.
+ *
+ * Host builds (for testing) skip every system register access and run
+ * as EL1 with a 40-bit physical address size.
+ */
+
+#include "mmu.h"
+#include "page_alloc.h"
+#include "cpu.h"
+
+#define ENTRIES 512
+#define DESC_VALID (1UL << 0)
+#define DESC_TABLE (1UL << 1)           // With VALID: table at levels 1-2, page at 3
+#define DESC_ATTR(i) ((unsigned long)(i) << 2)
+#define DESC_AP1 (1UL << 6)             // EL0 access, RES1 in the non-VHE EL2 regime
+#define DESC_SH_INNER (3UL << 8)
+#define DESC_AF (1UL << 10)
+#define DESC_PXN (1UL << 53)
+#define DESC_UXN (1UL << 54)            // XN in the non-VHE EL2 regime
+#define DESC_ADDR_MASK 0x0000fffffffff000UL
+
+#define ATTR_NORMAL 0                   // MAIR index
+#define ATTR_DEVICE 1
+#define MAIR_VALUE (0xffUL | (0x04UL << 8))     // Normal WB RW-allocate, Device-nGnRE
+
+#define TCR_T0SZ (64UL - MMU_VA_BITS)
+#define TCR_WALK ((1UL << 8) | (1UL << 10) | (3UL << 12))   // WB walks, inner shareable
+#define TCR_EPD1 (1UL << 23)
+#define TCR_TG1_4K (2UL << 30)          // 0b00 is reserved even with EPD1 set
+#define TCR_EL2_RES1 ((1UL << 31) | (1UL << 23))
+
+#define SCTLR_M (1UL << 0)
+#define SCTLR_C (1UL << 2)
+#define SCTLR_I (1UL << 12)
+#define SCTLR_WXN (1UL << 19)
+
+static struct {
+    unsigned long *l1;
+    unsigned long normal;           // Leaf attributes for this regime
+    unsigned long device;
+    unsigned int el;
+    int nvhe_el2;                   // EL2 with HCR_EL2.E2H clear: EL2 descriptor format
+    unsigned long leaves[4];        // By level: 1 GiB, 2 MiB, 4 KiB
+    unsigned long table_pages;
+    unsigned long arena;
+    unsigned int stacks_used;       // Bit per slot
+    int lock;
+} mmu;
+
+static int level_shift(int level) {
+    return 12 + 9 * (3 - level);
+}
+
+static unsigned long *table_new(void) {
+    const unsigned long page = page_alloc(0);
+    if (page == 0) return 0;
+    unsigned long *t = (unsigned long *)page;
+    for (int i = 0; i < ENTRIES; i++) t[i] = 0;
+    mmu.table_pages++;
+    return t;
+}
+
+static void table_free(unsigned long *t, int level) {
+    if (level < 3) {
+        for (int i = 0; i < ENTRIES; i++) {
+            if ((t[i] & (DESC_VALID | DESC_TABLE)) == (DESC_VALID | DESC_TABLE)) {
+                table_free((unsigned long *)(t[i] & DESC_ADDR_MASK), level + 1);
+            }
+        }
+    }
+    page_free((unsigned long)t, 0);
+}
+
+/**
+ * Table below entry e of `level`: the existing one, a new empty one, or
+ * a block split into ENTRIES leaves with the same attributes
+ */
+static unsigned long *next_table(unsigned long *e, int level) {
+    if ((*e & (DESC_VALID | DESC_TABLE)) == (DESC_VALID | DESC_TABLE)) {
+        return (unsigned long *)(*e & DESC_ADDR_MASK);
+    }
+    unsigned long *t = table_new();
+    if (!t) return 0;
+    if (*e & DESC_VALID) {
+        const unsigned long base = *e & DESC_ADDR_MASK;
+        const unsigned long attrs = *e & ~DESC_ADDR_MASK & ~(DESC_VALID | DESC_TABLE);
+        const unsigned long type = level + 1 == 3 ? DESC_VALID | DESC_TABLE : DESC_VALID;
+        const unsigned long step = 1UL << level_shift(level + 1);
+        for (int i = 0; i < ENTRIES; i++) t[i] = (base + i * step) | attrs | type;
+        mmu.leaves[level]--;
+        mmu.leaves[level + 1] += ENTRIES;
+    }
+    *e = (unsigned long)t | DESC_VALID | DESC_TABLE;
+    return t;
+}
+
+/**
+ * Map [pa, end) (page aligned) with attrs, each step in the largest block
+ * that is aligned, fits, and does not sit on a finer table already there
+ */
+static int map_range(unsigned long pa, unsigned long end, unsigned long attrs) {
+    while (pa < end) {
+        int level = 1;
+        unsigned long *e = &mmu.l1[pa >> level_shift(1)];
+        for (;;) {
+            const unsigned long size = 1UL << level_shift(level);
+            const int is_table = level < 3 && (*e & (DESC_VALID | DESC_TABLE)) == (DESC_VALID | DESC_TABLE);
+            if (!is_table && (pa & (size - 1)) == 0 && end - pa >= size) {
+                if (!(*e & DESC_VALID)) mmu.leaves[level]++;
+                *e = pa | attrs | (level == 3 ? DESC_VALID | DESC_TABLE : DESC_VALID);
+                pa += size;
+                break;
+            }
+            unsigned long *t = next_table(e, level);
+            if (!t) return -1;
+            level++;
+            e = &t[(pa >> level_shift(level)) & (ENTRIES - 1)];
+        }
+    }
+    return 0;
+}
+
+static int unmap_page(unsigned long pa) {
+    unsigned long *e = &mmu.l1[pa >> level_shift(1)];
+    for (int level = 1; level < 3; level++) {
+        unsigned long *t = next_table(e, level);
+        if (!t) return -1;
+        e = &t[(pa >> level_shift(level + 1)) & (ENTRIES - 1)];
+    }
+    if (*e & DESC_VALID) mmu.leaves[3]--;
+    *e = 0;
+    return 0;
+}
+
+/**
+ * Attributes for a memory map entry, or 0 to leave it unmapped
+ */
+static unsigned long classify(const BootMemoryDescriptor *d) {
+    switch (d->type) {
+    case BOOT_MEMORY_MMIO:
+    case BOOT_MEMORY_MMIO_PORT:
+        return mmu.device;
+    case BOOT_MEMORY_LOADER_CODE:
+    case BOOT_MEMORY_LOADER_DATA:
+    case BOOT_MEMORY_BOOT_SERVICES_CODE:
+    case BOOT_MEMORY_BOOT_SERVICES_DATA:
+    case BOOT_MEMORY_RUNTIME_CODE:
+    case BOOT_MEMORY_RUNTIME_DATA:
+    case BOOT_MEMORY_CONVENTIONAL:
+    case BOOT_MEMORY_ACPI_RECLAIM:
+    case BOOT_MEMORY_ACPI_NVS:
+    case BOOT_MEMORY_PERSISTENT:
+        return (d->attribute & BOOT_MEMORY_ATTR_WB) ? mmu.normal : mmu.device;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Clean every table to the point of coherency, for walkers that miss in
+ * the data cache while the MMU is off
+ */
+static void clean_table(const unsigned long *t, int level) {
+#if defined(__aarch64__)
+    unsigned long ctr;
+    __asm__ volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    const unsigned long line = 4UL << ((ctr >> 16) & 0xf);
+    for (unsigned long a = (unsigned long)t; a < (unsigned long)t + PAGE_SIZE; a += line) {
+        __asm__ volatile("dc cvac, %0" : : "r"(a) : "memory");
+    }
+#endif
+    if (level == 3) return;
+    for (int i = 0; i < ENTRIES; i++) {
+        if ((t[i] & (DESC_VALID | DESC_TABLE)) == (DESC_VALID | DESC_TABLE)) {
+            clean_table((const unsigned long *)(t[i] & DESC_ADDR_MASK), level + 1);
+        }
+    }
+}
+
+#if defined(__aarch64__)
+#define SWITCH_TABLES(el, tlbi)                                                \
+    __asm__ volatile(                                                          \
+        "dsb ish\n"                                                            \
+        "mrs x9, sctlr_" el "\n"                                               \
+        "bic x10, x9, #1\n"                                                    \
+        "msr sctlr_" el ", x10\n"                                              \
+        "isb\n"                                                                \
+        "msr mair_" el ", %0\n"                                                \
+        "msr tcr_" el ", %1\n"                                                 \
+        "msr ttbr0_" el ", %2\n"                                               \
+        "isb\n"                                                                \
+        "tlbi " tlbi "\n"                                                      \
+        "dsb ish\n"                                                            \
+        "isb\n"                                                                \
+        "bic x9, x9, %3\n"                                                     \
+        "orr x9, x9, %4\n"                                                     \
+        "msr sctlr_" el ", x9\n"                                               \
+        "isb\n"                                                                \
+        :                                                                      \
+        : "r"(MAIR_VALUE), "r"(tcr), "r"(ttbr), "r"(SCTLR_WXN),                \
+          "r"(SCTLR_M | SCTLR_C | SCTLR_I)                                     \
+        : "x9", "x10", "memory")
+#endif
+
+/**
+ * Undo a failed mmu_init(): return the tables and the arena (if taken)
+ * and leave the state as if it never ran. Returns -1.
+ */
+static int init_failed(unsigned long arena, int arena_order) {
+    if (arena) page_free(arena, arena_order);
+    if (mmu.l1) table_free(mmu.l1, 1);
+    mmu.l1 = 0;
+    for (int level = 0; level < 4; level++) mmu.leaves[level] = 0;
+    mmu.table_pages = 0;
+    return -1;
+}
+
+static void switch_tables(unsigned long tcr, unsigned long ttbr) {
+#if defined(__aarch64__)
+    if (mmu.el == 2) {
+        SWITCH_TABLES("el2", "alle2");
+    } else {
+        SWITCH_TABLES("el1", "vmalle1");
+    }
+#else
+    (void)tcr;
+    (void)ttbr;
+#endif
+}
+
+int mmu_init(const BootInfo *boot) {
+    if (!boot || boot->magic != BOOT_INFO_MAGIC || boot->version != BOOT_INFO_VERSION || mmu.l1) {
+        return -1;
+    }
+
+    unsigned long parange = 2;      // 40 bits
+    mmu.el = 1;
+    mmu.nvhe_el2 = 0;
+#if defined(__aarch64__)
+    unsigned long mmfr0, current_el;
+    __asm__ volatile("mrs %0, id_aa64mmfr0_el1" : "=r"(mmfr0));
+    __asm__ volatile("mrs %0, CurrentEL" : "=r"(current_el));
+    if (((mmfr0 >> 28) & 0xf) == 0xf) return -1;   // No 4 KiB granule
+    parange = mmfr0 & 0xf;
+    mmu.el = (unsigned int)((current_el >> 2) & 3);
+    if (mmu.el == 2) {
+        unsigned long hcr;
+        __asm__ volatile("mrs %0, hcr_el2" : "=r"(hcr));
+        mmu.nvhe_el2 = !(hcr & (1UL << 34));
+    }
+    if (mmu.el != 1 && mmu.el != 2) return -1;
+#endif
+    if (parange > 5) parange = 5;   // 52-bit output needs a different descriptor format
+
+    const unsigned long ap = mmu.nvhe_el2 ? DESC_AP1 : 0;
+    mmu.normal = DESC_ATTR(ATTR_NORMAL) | DESC_SH_INNER | DESC_AF | ap;
+    mmu.device = DESC_ATTR(ATTR_DEVICE) | DESC_AF | ap | (mmu.nvhe_el2 ? DESC_UXN : DESC_UXN | DESC_PXN);
+
+    mmu.l1 = table_new();
+    if (!mmu.l1) return -1;
+    if (map_range(0, MMU_DEVICE_LIMIT, mmu.device) != 0) return init_failed(0, 0);
+
+    // Contiguous entries of one kind map as a single range so blocks can
+    // span descriptor boundaries
+    const unsigned long limit = 1UL << MMU_VA_BITS;
+    unsigned long run_start = 0, run_end = 0, run_attrs = 0;
+    const unsigned long n_desc = boot_memory_descriptor_count(boot);
+    for (unsigned long i = 0; i <= n_desc; i++) {
+        unsigned long start = 0, end = 0, attrs = 0;
+        if (i < n_desc) {
+            const BootMemoryDescriptor *d = boot_memory_descriptor(boot, i);
+            start = (unsigned long)d->physical_start & ~(PAGE_SIZE - 1);
+            end = start + ((unsigned long)d->n_pages << PAGE_SHIFT);
+            if (end > limit) end = limit;
+            attrs = start < end ? classify(d) : 0;
+            if (attrs && attrs == run_attrs && start == run_end) {
+                run_end = end;
+                continue;
+            }
+        }
+        if (run_attrs && map_range(run_start, run_end, run_attrs) != 0) return init_failed(0, 0);
+        run_start = start;
+        run_end = end;
+        run_attrs = attrs;
+    }
+
+    // Stack arena: 4 KiB pages, lowest page of every slot left invalid
+    const int arena_order = page_order_for(MMU_STACK_SLOTS * MMU_STACK_SLOT_SIZE);
+    const unsigned long arena = page_alloc(arena_order);
+    if (arena == 0) return init_failed(0, 0);
+    for (int s = 0; s < MMU_STACK_SLOTS; s++) {
+        if (unmap_page(arena + s * MMU_STACK_SLOT_SIZE) != 0) return init_failed(arena, arena_order);
+    }
+
+    clean_table(mmu.l1, 1);
+
+    const unsigned long tcr = mmu.nvhe_el2
+        ? TCR_T0SZ | TCR_WALK | (parange << 16) | TCR_EL2_RES1
+        : TCR_T0SZ | TCR_WALK | TCR_EPD1 | TCR_TG1_4K | (parange << 32);
+    switch_tables(tcr, (unsigned long)mmu.l1);
+
+    mmu.arena = arena;
+    mmu.stacks_used = 0;
+    mmu.lock = 0;
+    return 0;
+}
+
+unsigned long mmu_stack_alloc(void) {
+    if (mmu.arena == 0) return 0;
+    unsigned long top = 0;
+    spin_lock(&mmu.lock);
+    for (int s = 0; s < MMU_STACK_SLOTS; s++) {
+        if (!(mmu.stacks_used & (1U << s))) {
+            mmu.stacks_used |= 1U << s;
+            top = mmu.arena + (s + 1) * MMU_STACK_SLOT_SIZE;
+            break;
+        }
+    }
+    spin_unlock(&mmu.lock);
+    return top;
+}
+
+int mmu_stack_free(unsigned long top) {
+    if (mmu.arena == 0 || top <= mmu.arena || (top - mmu.arena) % MMU_STACK_SLOT_SIZE != 0) return -1;
+    const unsigned long s = (top - mmu.arena) / MMU_STACK_SLOT_SIZE - 1;
+    if (s >= MMU_STACK_SLOTS) return -1;
+    int result = -1;
+    spin_lock(&mmu.lock);
+    if (mmu.stacks_used & (1U << s)) {
+        mmu.stacks_used &= ~(1U << s);
+        result = 0;
+    }
+    spin_unlock(&mmu.lock);
+    return result;
+}
+
+unsigned long mmu_lookup(unsigned long addr) {
+    if (!mmu.l1 || addr >> MMU_VA_BITS) return 0;
+    unsigned long e = mmu.l1[addr >> level_shift(1)];
+    for (int level = 1; level < 3; level++) {
+        if ((e & (DESC_VALID | DESC_TABLE)) != (DESC_VALID | DESC_TABLE)) break;
+        e = ((const unsigned long *)(e & DESC_ADDR_MASK))[(addr >> level_shift(level + 1)) & (ENTRIES - 1)];
+    }
+    return (e & DESC_VALID) ? e : 0;
+}
+
+void mmu_stats(MmuStats *stats) {
+    stats->el = mmu.arena ? mmu.el : 0;
+    stats->blocks_1g = mmu.leaves[1];
+    stats->blocks_2m = mmu.leaves[2];
+    stats->pages_4k = mmu.leaves[3];
+    stats->table_pages = mmu.table_pages;
+    stats->stacks_in_use = (unsigned long)__builtin_popcount(mmu.stacks_used);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file mmu.h
+ * @brief Kernel translation tables for BonsaiOS kernel
+ *
+ * Identity map with a 4 KiB granule and 39-bit addresses (walks start at
+ * level 1), built at whichever of EL1 or EL2 the firmware left us in:
+ *
+ *   RAM in the memory map     Normal write-back, inner shareable, in the
+ *                             largest 1 GiB / 2 MiB / 4 KiB blocks that fit
+ *   Below MMU_DEVICE_LIMIT    Device-nGnRE, execute-never (UART, Tegra MMIO)
+ *   EfiMemoryMappedIO ranges  Device-nGnRE, execute-never
+ *
+ * Reserved and unusable ranges stay unmapped. Stacks for solver work come
+ * from an arena mapped with 4 KiB pages in which the lowest page of every
+ * slot is left invalid, so running off the bottom of a stack faults
+ * instead of overwriting the neighbour.
+ */
+
+#pragma once
+
+#include "boot_info.h"
+
+#define MMU_VA_BITS 39
+#define MMU_DEVICE_LIMIT 0x80000000UL   // Orin: MMIO below, DRAM from 2 GiB
+#define MMU_STACK_SLOTS 32
+#define MMU_STACK_SLOT_SIZE (64UL * 1024)               // Including the guard page
+#define MMU_STACK_SIZE (MMU_STACK_SLOT_SIZE - 4096UL)   // Usable bytes per stack
+
+typedef struct {
+    unsigned int el;                // Exception level the tables run at, 0 if not live
+    unsigned long blocks_1g;
+    unsigned long blocks_2m;
+    unsigned long pages_4k;
+    unsigned long table_pages;
+    unsigned long stacks_in_use;
+} MmuStats;
+
+/**
+ * Build the tables from the boot memory map and switch to them with the
+ * data and instruction caches on. Needs page_alloc_init() for table
+ * pages and the stack arena.
+ *
+ * Returns 0 on success, -1 (firmware tables still live) when the boot
+ * info is missing, memory runs out or the CPU cannot use a 4 KiB granule
+ */
+int mmu_init(const BootInfo *boot);
+
+/**
+ * Top of a free MMU_STACK_SIZE stack with a guard page below it, or 0
+ * when all slots are taken or mmu_init() did not run
+ */
+unsigned long mmu_stack_alloc(void);
+
+/**
+ * Return a stack from mmu_stack_alloc()
+ *
+ * Returns 0 on success, -1 if top is not the top of a stack in use
+ */
+int mmu_stack_free(unsigned long top);
+
+/**
+ * Run fn(arg) with sp at top; returns once fn does (start.S)
+ */
+void call_on_stack(void (*fn)(void *), void *arg, unsigned long top);
+
+/**
+ * Leaf descriptor (block or page) that maps addr, or 0 if it is unmapped
+ */
+unsigned long mmu_lookup(unsigned long addr);
+
+void mmu_stats(MmuStats *stats);
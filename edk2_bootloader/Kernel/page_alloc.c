@@ -0,0 +1,308 @@
+/**
+ * @file page_alloc.c
+ * @brief Buddy page allocator with per-CPU single-page caches
+ *
+ * One PageFrame per 4 KiB frame between the lowest and highest usable
+ * address, carved out of the first usable range large enough to hold the
+ * table. Holes and reserved ranges stay PAGE_RESERVED and never merge.
+ * A block's buddy at order o is frame pfn ^ 2^o, with pfn the absolute
+ * physical frame number, so every block is aligned to its size.
+ */
+
+#include "page_alloc.h"
+
+#define PAGE_NONE 0xffffffffU
+
+enum {
+    PAGE_RESERVED = 0,
+    PAGE_FREE,      // First frame of a block on free list `order`
+    PAGE_USED,      // First frame of an allocated block
+    PAGE_CACHED,    // Single page parked in a per-CPU cache
+    PAGE_TAIL       // Inside a block; only the first frame is kept current
+};
+
+typedef struct {
+    unsigned int next;      // Free-list links, frame indices
+    unsigned int prev;
+    unsigned char order;
+    unsigned char state;
+} PageFrame;
+
+typedef struct {
+    unsigned long count;
+    unsigned long pfns[PAGE_CACHE_HIGH];
+} __attribute__((aligned(64))) PageCache;
+
+static struct {
+    PageFrame *frames;
+    unsigned long base_pfn;       // pfn of frames[0]
+    unsigned long n_frames;
+    unsigned int free_head[PAGE_ORDERS];
+    unsigned long free_blocks[PAGE_ORDERS];
+    unsigned long total_pages;
+    unsigned long free_pages;
+    unsigned long frame_table_pages;
+    int lock;
+} zone;
+
+static PageCache caches[MAX_CPUS];
+
+void page_alloc_cpu_online(unsigned int cpu) {
+    cpu_set_id(cpu);
+}
+
+static void list_push(unsigned int idx, int order) {
+    PageFrame *f = &zone.frames[idx];
+    f->state = PAGE_FREE;
+    f->order = (unsigned char)order;
+    f->prev = PAGE_NONE;
+    f->next = zone.free_head[order];
+    if (f->next != PAGE_NONE) zone.frames[f->next].prev = idx;
+    zone.free_head[order] = idx;
+    zone.free_blocks[order]++;
+    zone.free_pages += 1UL << order;
+}
+
+static void list_remove(unsigned int idx) {
+    PageFrame *f = &zone.frames[idx];
+    const int order = f->order;
+    if (f->prev != PAGE_NONE) zone.frames[f->prev].next = f->next;
+    else zone.free_head[order] = f->next;
+    if (f->next != PAGE_NONE) zone.frames[f->next].prev = f->prev;
+    zone.free_blocks[order]--;
+    zone.free_pages -= 1UL << order;
+}
+
+/**
+ * Take a 2^order block, splitting a larger one if needed (lock held)
+ */
+static unsigned long block_alloc(int order) {
+    int o = order;
+    while (o < PAGE_ORDERS && zone.free_head[o] == PAGE_NONE) o++;
+    if (o == PAGE_ORDERS) return 0;
+
+    const unsigned int idx = zone.free_head[o];
+    list_remove(idx);
+    // Hand the upper halves back down until the block is the right size
+    while (o > order) {
+        o--;
+        list_push(idx + (1U << o), o);
+    }
+    zone.frames[idx].state = PAGE_USED;
+    zone.frames[idx].order = (unsigned char)order;
+    return zone.base_pfn + idx;
+}
+
+/**
+ * Return a block and merge it with free buddies (lock held)
+ */
+static void block_free(unsigned long pfn, int order) {
+    // Both heads of a merged pair become tails; list_push() marks the survivor
+    zone.frames[pfn - zone.base_pfn].state = PAGE_TAIL;
+    while (order < PAGE_ORDERS - 1) {
+        const unsigned long buddy = pfn ^ (1UL << order);
+        if (buddy < zone.base_pfn || buddy - zone.base_pfn >= zone.n_frames) break;
+        const PageFrame *b = &zone.frames[buddy - zone.base_pfn];
+        if (b->state != PAGE_FREE || b->order != order) break;
+        list_remove((unsigned int)(buddy - zone.base_pfn));
+        zone.frames[buddy - zone.base_pfn].state = PAGE_TAIL;
+        pfn &= ~(1UL << order);
+        order++;
+    }
+    list_push((unsigned int)(pfn - zone.base_pfn), order);
+}
+
+/**
+ * Ranges of `type` in whole pages, page 0 excluded so 0 can mean failure
+ */
+static int range_of(const BootMemoryDescriptor *d, unsigned int type, unsigned long *first, unsigned long *end) {
+    if (d->type != type || d->n_pages == 0) return 0;
+    unsigned long lo = (unsigned long)(d->physical_start >> PAGE_SHIFT);
+    unsigned long hi = lo + (unsigned long)d->n_pages;
+    if (lo == 0) lo = 1;
+    if (hi <= lo) return 0;
+    *first = lo;
+    *end = hi;
+    return 1;
+}
+
+static int usable(const BootMemoryDescriptor *d, unsigned long *first, unsigned long *end) {
+    return range_of(d, BOOT_MEMORY_CONVENTIONAL, first, end);
+}
+
+// Usable now or once page_alloc_add_boot_services() runs
+static int reclaimable(const BootMemoryDescriptor *d, unsigned long *first, unsigned long *end) {
+    return usable(d, first, end) || range_of(d, BOOT_MEMORY_BOOT_SERVICES_CODE, first, end)
+        || range_of(d, BOOT_MEMORY_BOOT_SERVICES_DATA, first, end);
+}
+
+/**
+ * Free [pfn, end) in the largest aligned blocks that fit; block_free()
+ * joins blocks across adjacent ranges (lock held)
+ */
+static void free_range(unsigned long pfn, unsigned long end) {
+    while (pfn < end) {
+        int order = 0;
+        while (order < PAGE_ORDERS - 1 && (pfn & (1UL << order)) == 0
+               && pfn + (2UL << order) <= end) {
+            order++;
+        }
+        block_free(pfn, order);
+        pfn += 1UL << order;
+    }
+}
+
+int page_alloc_init(const BootInfo *boot) {
+    if (!boot || boot->magic != BOOT_INFO_MAGIC || boot->version != BOOT_INFO_VERSION
+        || boot->descriptor_size < sizeof(BootMemoryDescriptor)) {
+        return -1;
+    }
+    const unsigned long n_desc = boot_memory_descriptor_count(boot);
+
+    // Span of usable frames, boot-services ranges included so the table
+    // already covers them when they are handed over
+    unsigned long lo = ~0UL, hi = 0;
+    for (unsigned long i = 0; i < n_desc; i++) {
+        unsigned long first, end;
+        if (!reclaimable(boot_memory_descriptor(boot, i), &first, &end)) continue;
+        if (first < lo) lo = first;
+        if (end > hi) hi = end;
+    }
+    if (hi == 0 || hi - lo >= PAGE_NONE) return -1;
+
+    // Frame table from the first range that holds it
+    const unsigned long n_frames = hi - lo;
+    const unsigned long table_pages = (n_frames * sizeof(PageFrame) + PAGE_SIZE - 1) >> PAGE_SHIFT;
+    unsigned long table_pfn = 0;
+    for (unsigned long i = 0; i < n_desc && table_pfn == 0; i++) {
+        unsigned long first, end;
+        if (usable(boot_memory_descriptor(boot, i), &first, &end) && end - first > table_pages) {
+            table_pfn = first;
+        }
+    }
+    if (table_pfn == 0) return -1;
+
+    zone.frames = (PageFrame *)(table_pfn << PAGE_SHIFT);
+    zone.base_pfn = lo;
+    zone.n_frames = n_frames;
+    zone.frame_table_pages = table_pages;
+    zone.total_pages = 0;
+    zone.free_pages = 0;
+    zone.lock = 0;
+    for (int o = 0; o < PAGE_ORDERS; o++) {
+        zone.free_head[o] = PAGE_NONE;
+        zone.free_blocks[o] = 0;
+    }
+    for (unsigned long i = 0; i < n_frames; i++) {
+        zone.frames[i].state = PAGE_RESERVED;
+        zone.frames[i].order = 0;
+    }
+
+    for (unsigned long i = 0; i < n_desc; i++) {
+        unsigned long pfn, end;
+        if (!usable(boot_memory_descriptor(boot, i), &pfn, &end)) continue;
+        if (pfn == table_pfn) pfn += table_pages;
+        zone.total_pages += end - pfn;
+        free_range(pfn, end);
+    }
+
+    for (int c = 0; c < MAX_CPUS; c++) caches[c].count = 0;
+    page_alloc_cpu_online(0);
+    return 0;
+}
+
+unsigned long page_alloc_add_boot_services(const BootInfo *boot) {
+    if (!zone.frames) return 0;
+    static const unsigned int types[2] = { BOOT_MEMORY_BOOT_SERVICES_CODE, BOOT_MEMORY_BOOT_SERVICES_DATA };
+    const unsigned long n_desc = boot_memory_descriptor_count(boot);
+    const unsigned long span_end = zone.base_pfn + zone.n_frames;
+    unsigned long added = 0;
+    spin_lock(&zone.lock);
+    for (unsigned long i = 0; i < n_desc; i++) {
+        for (int t = 0; t < 2; t++) {
+            unsigned long pfn, end;
+            if (!range_of(boot_memory_descriptor(boot, i), types[t], &pfn, &end)) continue;
+            // The table spans every such range; clamp in case the map changed
+            if (pfn < zone.base_pfn) pfn = zone.base_pfn;
+            if (end > span_end) end = span_end;
+            if (pfn >= end) continue;
+            zone.total_pages += end - pfn;
+            added += end - pfn;
+            free_range(pfn, end);
+        }
+    }
+    spin_unlock(&zone.lock);
+    return added;
+}
+
+unsigned long page_alloc(int order) {
+    if (order < 0 || order >= PAGE_ORDERS || !zone.frames) return 0;
+
+    if (order == 0) {
+        PageCache *cache = &caches[cpu_id()];
+        if (cache->count == 0) {
+            spin_lock(&zone.lock);
+            while (cache->count < PAGE_CACHE_BATCH) {
+                const unsigned long pfn = block_alloc(0);
+                if (pfn == 0) break;
+                zone.frames[pfn - zone.base_pfn].state = PAGE_CACHED;
+                cache->pfns[cache->count++] = pfn;
+            }
+            spin_unlock(&zone.lock);
+            if (cache->count == 0) return 0;
+        }
+        const unsigned long pfn = cache->pfns[--cache->count];
+        zone.frames[pfn - zone.base_pfn].state = PAGE_USED;
+        return pfn << PAGE_SHIFT;
+    }
+
+    spin_lock(&zone.lock);
+    const unsigned long pfn = block_alloc(order);
+    spin_unlock(&zone.lock);
+    return pfn << PAGE_SHIFT;
+}
+
+int page_free(unsigned long addr, int order) {
+    if (order < 0 || order >= PAGE_ORDERS || (addr & ((PAGE_SIZE << order) - 1)) != 0) return -1;
+    const unsigned long pfn = addr >> PAGE_SHIFT;
+    if (pfn < zone.base_pfn || pfn - zone.base_pfn >= zone.n_frames) return -1;
+    // The caller owns the block, so its frame is stable without the lock
+    PageFrame *f = &zone.frames[pfn - zone.base_pfn];
+    if (f->state != PAGE_USED || f->order != order) return -1;
+
+    if (order == 0) {
+        PageCache *cache = &caches[cpu_id()];
+        if (cache->count == PAGE_CACHE_HIGH) {
+            spin_lock(&zone.lock);
+            for (int i = 0; i < PAGE_CACHE_BATCH; i++) block_free(cache->pfns[--cache->count], 0);
+            spin_unlock(&zone.lock);
+        }
+        f->state = PAGE_CACHED;
+        cache->pfns[cache->count++] = pfn;
+        return 0;
+    }
+
+    spin_lock(&zone.lock);
+    block_free(pfn, order);
+    spin_unlock(&zone.lock);
+    return 0;
+}
+
+int page_order_for(unsigned long bytes) {
+    int order = 0;
+    while (order < PAGE_ORDERS && (PAGE_SIZE << order) < bytes) order++;
+    return order < PAGE_ORDERS ? order : -1;
+}
+
+void page_alloc_stats(PageStats *stats) {
+    spin_lock(&zone.lock);
+    stats->total_pages = zone.total_pages;
+    stats->free_pages = zone.free_pages;
+    stats->frame_table_pages = zone.frame_table_pages;
+    for (int o = 0; o < PAGE_ORDERS; o++) stats->free_blocks[o] = zone.free_blocks[o];
+    spin_unlock(&zone.lock);
+    stats->cached_pages = 0;
+    for (int c = 0; c < MAX_CPUS; c++) {
+        stats->cached_pages += __atomic_load_n(&caches[c].count, __ATOMIC_RELAXED);
+    }
+}
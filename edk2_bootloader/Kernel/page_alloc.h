@@ -0,0 +1,85 @@
+/**
+ * @file page_alloc.h
+ * @brief Physical page-frame allocator for BonsaiOS kernel
+ *
+ * Binary buddy allocator over the free memory in the UEFI memory map:
+ * blocks of 2^order pages, one free list per order, split on alloc and
+ * merged with the buddy on free, so both are O(PAGE_ORDERS). Single
+ * pages go through a per-CPU cache first and only touch the shared lock
+ * once per PAGE_CACHE_BATCH pages.
+ *
+ * Addresses are physical; the kernel runs identity mapped.
+ */
+
+#pragma once
+
+#include "boot_info.h"
+#include "cpu.h"
+
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1UL << PAGE_SHIFT)
+#define PAGE_ORDERS 11              // Orders 0..10: 4 KiB .. 4 MiB blocks
+#define PAGE_CACHE_HIGH 64          // Per-CPU cache capacity (pages)
+#define PAGE_CACHE_BATCH 16         // Pages moved per refill or drain
+
+/**
+ * Allocator counters
+ */
+typedef struct {
+    unsigned long total_pages;      // Managed by the allocator
+    unsigned long free_pages;       // On the buddy free lists
+    unsigned long cached_pages;     // Sitting in per-CPU caches
+    unsigned long free_blocks[PAGE_ORDERS];
+    unsigned long frame_table_pages; // Spent on the allocator's own metadata
+} PageStats;
+
+/**
+ * Build the allocator from the boot memory map
+ *
+ * Takes EfiConventionalMemory only. Boot-services ranges are free after
+ * ExitBootServices() too, but they hold the firmware's translation tables
+ * the kernel still runs on; see page_alloc_add_boot_services(). Must run
+ * on the boot CPU before any other page_* call.
+ *
+ * Returns 0 on success, -1 if the boot info is invalid or holds no
+ * usable memory
+ */
+int page_alloc_init(const BootInfo *boot);
+
+/**
+ * Hand EfiBootServicesCode/Data to the allocator once the kernel runs on
+ * its own translation tables (mmu_init()). Call once.
+ *
+ * Returns the number of pages added
+ */
+unsigned long page_alloc_add_boot_services(const BootInfo *boot);
+
+/**
+ * Tell the allocator which CPU this is (0 .. MAX_CPUS - 1); selects the
+ * page cache used by this core. page_alloc_init() does it for the boot CPU.
+ */
+void page_alloc_cpu_online(unsigned int cpu);
+
+/**
+ * Allocate 2^order physically contiguous pages aligned to their size
+ *
+ * Not reentrant from interrupt handlers on the same CPU.
+ *
+ * Returns the physical address, or 0 when no block is large enough
+ */
+unsigned long page_alloc(int order);
+
+/**
+ * Return a block from page_alloc() with the same order
+ *
+ * Returns 0 on success, -1 if addr is not the start of an allocated
+ * block of that order
+ */
+int page_free(unsigned long addr, int order);
+
+/**
+ * Smallest order whose block holds bytes, or -1 above the largest order
+ */
+int page_order_for(unsigned long bytes);
+
+void page_alloc_stats(PageStats *stats);
@@ -1,117 +1,387 @@
 /**
  * @file sheaf.c
  * @brief Minimal sheaf solver implementation
+ *
+ * Features are the real form of the cyclic characters: for a sample V of
+ * length n, feature (p, j) is
+ *
+ *   f[p][j] = (1/n) Σ_q b_j((p - q) mod n) V[q]
+ *
+ * with b_j(d) = cos(2π j d / n) for j <= n/2 and sin(2π (n - j) d / n)
+ * above, so characters j and n - j - the complex conjugate pair of the
+ * C++ solver - become the cosine and sine halves of one real frequency.
+ *
+ * Rows never leave the stack: each sample's features are rank-1 added to
+ * the normal equations (upper triangle) and dropped, the system is
+ * Cholesky factored in place, and the residual pass recomputes them.
  */
 
 #include "sheaf.h"
 
-/**
- * Simple absolute value
- */
-static real_t abs_val(real_t x) {
-    return x < 0 ? -x : x;
-}
+#define PI 3.14159265358979323846
 
 /**
- * Simple sqrt (Newton-Raphson)
+ * Square root: the AArch64 instruction, or Newton from a bit-level guess
+ * (four steps reach double precision) on hosts used for testing
  */
 static real_t sqrt_approx(real_t x) {
     if (x <= 0.0) return 0.0;
-
-    real_t guess = x / 2.0;
-    for (int i = 0; i < 10; i++) {
+#if defined(__aarch64__)
+    real_t r;
+    __asm__("fsqrt %d0, %d1" : "=w"(r) : "w"(x));
+    return r;
+#else
+    union { real_t d; unsigned long long u; } bits = { x };
+    bits.u = 0x1ff7a3bea91d9b1bULL + (bits.u >> 1);
+    real_t guess = bits.d;
+    for (int i = 0; i < 4; i++) {
         guess = (guess + x / guess) / 2.0;
     }
     return guess;
+#endif
+}
+
+/**
+ * cos and sin of x in [-π, π] by 16 Taylor terms (error below 1e-16)
+ */
+static void cos_sin(real_t x, real_t *c, real_t *s) {
+    // 1 / ((2k - 1) 2k) and 1 / (2k (2k + 1)): no divides in the loop
+    static const real_t inv_c[16] = {
+        1.0 / 2, 1.0 / 12, 1.0 / 30, 1.0 / 56, 1.0 / 90, 1.0 / 132, 1.0 / 182, 1.0 / 240,
+        1.0 / 306, 1.0 / 380, 1.0 / 462, 1.0 / 552, 1.0 / 650, 1.0 / 756, 1.0 / 870, 1.0 / 992
+    };
+    static const real_t inv_s[16] = {
+        1.0 / 6, 1.0 / 20, 1.0 / 42, 1.0 / 72, 1.0 / 110, 1.0 / 156, 1.0 / 210, 1.0 / 272,
+        1.0 / 342, 1.0 / 420, 1.0 / 506, 1.0 / 600, 1.0 / 702, 1.0 / 812, 1.0 / 930, 1.0 / 1056
+    };
+    real_t term_c = 1.0, term_s = x;
+    real_t sum_c = 1.0, sum_s = x;
+    const real_t x2 = x * x;
+    for (int k = 0; k < 16; k++) {
+        term_c *= -x2 * inv_c[k];
+        term_s *= -x2 * inv_s[k];
+        sum_c += term_c;
+        sum_s += term_s;
+    }
+    *c = sum_c;
+    *s = sum_s;
+}
+
+/**
+ * b_j(d) for every character j and shift d of one patch
+ */
+typedef struct {
+    real_t basis[MAX_POSITIONS][MAX_POSITIONS];   // [j][d]
+    real_t inv_n;
+} CharacterTable;
+
+static void build_table(const PatchConfig *config, CharacterTable *table, unsigned long *work) {
+    const int n = config->n_positions;
+    real_t c[MAX_POSITIONS], s[MAX_POSITIONS];
+    for (int d = 0; d < n; d++) {
+        real_t angle = 2.0 * PI * d / n;
+        if (angle > PI) angle -= 2.0 * PI;
+        cos_sin(angle, &c[d], &s[d]);
+    }
+    *work += (unsigned long)n * 32;
+    table->inv_n = 1.0 / n;
+    for (int j = 0; j < config->n_chars; j++) {
+        for (int d = 0; d < n; d++) {
+            // j · d mod n keeps the angle on the precomputed grid
+            table->basis[j][d] = 2 * j <= n ? c[(j * d) % n] : s[((n - j) * d) % n];
+        }
+    }
+}
+
+/**
+ * Features of one sample into f[pos · n_chars + j]
+ */
+static void features(const PatchConfig *config, const CharacterTable *table,
+                     const real_t *sample, real_t *f, unsigned long *work) {
+    const int n = config->n_positions;
+    const int k = config->n_chars;
+    for (int p = 0; p < n; p++) {
+        for (int j = 0; j < k; j++) {
+            real_t acc = 0.0;
+            for (int q = 0; q < n; q++) {
+                int d = p - q;
+                if (d < 0) d += n;
+                acc += table->basis[j][d] * sample[q];
+            }
+            f[p * k + j] = acc * table->inv_n;
+        }
+    }
+    *work += (unsigned long)n * n * k;
 }
 
 /**
- * Solve 2x2 linear system: Ax = b
- * Using Cramer's rule
+ * G += scale · r r^T (upper triangle) and m += scale · target · r over the
+ * columns [cols[0], cols[0] + len[0]) and [cols[1], cols[1] + len[1])
+ * (disjoint; part i of r starts at r + i · MAX_WEIGHTS)
  */
-static int solve_2x2(const Matrix2x2 *A, const real_t *b, real_t *x) {
-    real_t det = A->data[0][0] * A->data[1][1] - A->data[0][1] * A->data[1][0];
+static void add_row(real_t G[MAX_WEIGHTS][MAX_WEIGHTS], real_t *m, const real_t *r,
+                    const int *cols, const int *len, int n_parts, real_t scale, real_t target,
+                    unsigned long *work) {
+    int idx[MAX_WEIGHTS];
+    real_t val[MAX_WEIGHTS];
+    int n = 0;
+    // Lower columns first, so idx ascends and b >= a is the upper triangle
+    const int first = n_parts == 2 && cols[1] < cols[0];
+    for (int i = 0; i < n_parts; i++) {
+        const int part = first ? 1 - i : i;
+        for (int c = 0; c < len[part]; c++) {
+            idx[n] = cols[part] + c;
+            val[n] = r[part * MAX_WEIGHTS + c];
+            n++;
+        }
+    }
+    for (int a = 0; a < n; a++) {
+        const real_t sa = scale * val[a];
+        for (int b = a; b < n; b++) G[idx[a]][idx[b]] += sa * val[b];
+        m[idx[a]] += sa * target;
+    }
+    *work += (unsigned long)n * (n + 1) / 2;
+}
+
+/**
+ * In-place Cholesky of the upper triangle: G = U^T U, U stored upward
+ */
+static int cholesky(real_t G[MAX_WEIGHTS][MAX_WEIGHTS], int W, unsigned long *work) {
+    for (int j = 0; j < W; j++) {
+        real_t d = G[j][j];
+        for (int k = 0; k < j; k++) d -= G[k][j] * G[k][j];
+        if (!(d > 0.0)) return -1;
+        const real_t root = sqrt_approx(d);
+        const real_t inv = 1.0 / root;
+        G[j][j] = root;
+        for (int i = j + 1; i < W; i++) {
+            real_t s = G[j][i];
+            for (int k = 0; k < j; k++) s -= G[k][j] * G[k][i];
+            G[j][i] = s * inv;
+        }
+    }
+    *work += (unsigned long)W * W * W / 6;
+    return 0;
+}
 
-    if (abs_val(det) < 1e-10) {
-        return -1;  // Singular matrix
+/**
+ * U^T U x = b in place
+ */
+static void cholesky_solve(real_t G[MAX_WEIGHTS][MAX_WEIGHTS], int W, real_t *x, unsigned long *work) {
+    for (int i = 0; i < W; i++) {
+        real_t s = x[i];
+        for (int k = 0; k < i; k++) s -= G[k][i] * x[k];
+        x[i] = s / G[i][i];
+    }
+    for (int i = W - 1; i >= 0; i--) {
+        real_t s = x[i];
+        for (int k = i + 1; k < W; k++) s -= G[i][k] * x[k];
+        x[i] = s / G[i][i];
     }
+    *work += (unsigned long)W * W;
+}
 
-    x[0] = (b[0] * A->data[1][1] - b[1] * A->data[0][1]) / det;
-    x[1] = (A->data[0][0] * b[1] - A->data[1][0] * b[0]) / det;
+static real_t dot(const real_t *a, const real_t *b, int n) {
+    real_t s = 0.0;
+    for (int i = 0; i < n; i++) s += a[i] * b[i];
+    return s;
+}
 
+static int validate(SheafProblem *problem) {
+    if (problem->n_patches < 1 || problem->n_patches > MAX_PATCHES
+        || problem->n_constraints < 0 || problem->n_constraints > MAX_CONSTRAINTS) {
+        return -1;
+    }
+    int W = 0;
+    for (int p = 0; p < problem->n_patches; p++) {
+        const Patch *patch = &problem->patches[p];
+        const int n = patch->config.n_positions;
+        const int k = patch->config.n_chars;
+        if (n < 1 || n > MAX_POSITIONS || k < 1 || k > n
+            || patch->n_samples < 0 || patch->n_samples > MAX_SAMPLES_PER_PATCH) {
+            return -1;
+        }
+        problem->offsets[p] = W;
+        W += n * k;
+        if (W > MAX_WEIGHTS) return -1;
+    }
+    for (int g = 0; g < problem->n_constraints; g++) {
+        const GluingConstraint *c = &problem->constraints[g];
+        if (c->patch_1 < 0 || c->patch_1 >= problem->n_patches
+            || c->patch_2 < 0 || c->patch_2 >= problem->n_patches
+            || !(c->weight >= 0.0 && c->weight < 1e300)) {
+            return -1;
+        }
+    }
+    problem->n_weights = W;
     return 0;
 }
 
 /**
  * Solve a minimal sheaf problem
  *
- * This is a ultra-simplified version demonstrating the concept:
- * - Build local systems (per-patch least squares)
- * - Compute global residual (measures inconsistency)
- * - Return residual as "cohomological obstruction"
+ * Local accuracy and gluing agreement in one least-squares system:
+ * - Build local systems (one feature row per sample)
+ * - Add gluing rows (patch_1's features minus patch_2's, target 0)
+ * - Solve the normal equations, then report the remaining error as the
+ *   "cohomological obstruction"
  */
 int sheaf_solve(SheafProblem *problem) {
-    real_t total_error = 0.0;
+    problem->work = 0;
+    problem->converged = 0;
+    if (validate(problem) != 0) {
+        return -1;
+    }
+    const int W = problem->n_weights;
+    unsigned long work = 0;
 
-    // For each patch, solve local problem
+    CharacterTable tables[MAX_PATCHES];
     for (int p = 0; p < problem->n_patches; p++) {
-        Patch *patch = &problem->patches[p];
+        build_table(&problem->patches[p].config, &tables[p], &work);
+    }
+
+    real_t G[MAX_WEIGHTS][MAX_WEIGHTS];
+    real_t *m = problem->weights;
+    for (int i = 0; i < W; i++) {
+        for (int j = 0; j < W; j++) G[i][j] = 0.0;
+        m[i] = 0.0;
+    }
 
-        // Simplified: just compute mean squared error
-        real_t mean_target = 0.0;
-        for (int i = 0; i < patch->n_samples; i++) {
-            mean_target += patch->targets[i];
+    // r holds up to two parts of MAX_WEIGHTS each: a sample row uses the
+    // first, a gluing row both
+    real_t r[2 * MAX_WEIGHTS];
+
+    for (int p = 0; p < problem->n_patches; p++) {
+        const Patch *patch = &problem->patches[p];
+        const int cols[1] = { problem->offsets[p] };
+        const int len[1] = { patch->config.n_positions * patch->config.n_chars };
+        for (int s = 0; s < patch->n_samples; s++) {
+            features(&patch->config, &tables[p], patch->samples[s], r, &work);
+            add_row(G, m, r, cols, len, 1, 1.0, patch->targets[s], &work);
         }
-        mean_target /= patch->n_samples;
+    }
 
-        // Compute residual
-        real_t patch_error = 0.0;
-        for (int i = 0; i < patch->n_samples; i++) {
-            real_t diff = patch->targets[i] - mean_target;
-            patch_error += diff * diff;
+    for (int g = 0; g < problem->n_constraints; g++) {
+        const GluingConstraint *c = &problem->constraints[g];
+        const PatchConfig *c1 = &problem->patches[c->patch_1].config;
+        const PatchConfig *c2 = &problem->patches[c->patch_2].config;
+        const int cols[2] = { problem->offsets[c->patch_1], problem->offsets[c->patch_2] };
+        const int len[2] = { c1->n_positions * c1->n_chars, c2->n_positions * c2->n_chars };
+        features(c1, &tables[c->patch_1], c->data_1, r, &work);
+        features(c2, &tables[c->patch_2], c->data_2, r + MAX_WEIGHTS, &work);
+        if (c->patch_1 == c->patch_2) {
+            // Both sides on one patch: a single part f_1 - f_2
+            for (int i = 0; i < len[0]; i++) r[i] -= r[MAX_WEIGHTS + i];
+            add_row(G, m, r, cols, len, 1, c->weight, 0.0, &work);
+        } else {
+            for (int i = 0; i < len[1]; i++) r[MAX_WEIGHTS + i] = -r[MAX_WEIGHTS + i];
+            add_row(G, m, r, cols, len, 2, c->weight, 0.0, &work);
         }
+    }
 
-        total_error += patch_error;
+    for (int i = 0; i < W; i++) G[i][i] += SHEAF_RIDGE;
+    if (cholesky(G, W, &work) != 0) {
+        problem->work = work;
+        return -1;
+    }
+    cholesky_solve(G, W, problem->weights, &work);
+
+    // Residual of every row against the solution
+    const real_t *w = problem->weights;
+    real_t total_error = 0.0;
+    for (int p = 0; p < problem->n_patches; p++) {
+        const Patch *patch = &problem->patches[p];
+        const int len = patch->config.n_positions * patch->config.n_chars;
+        for (int s = 0; s < patch->n_samples; s++) {
+            features(&patch->config, &tables[p], patch->samples[s], r, &work);
+            const real_t e = dot(r, w + problem->offsets[p], len) - patch->targets[s];
+            total_error += e * e;
+            work += len;
+        }
+    }
+    for (int g = 0; g < problem->n_constraints; g++) {
+        const GluingConstraint *c = &problem->constraints[g];
+        const PatchConfig *c1 = &problem->patches[c->patch_1].config;
+        const PatchConfig *c2 = &problem->patches[c->patch_2].config;
+        const int len1 = c1->n_positions * c1->n_chars;
+        const int len2 = c2->n_positions * c2->n_chars;
+        features(c1, &tables[c->patch_1], c->data_1, r, &work);
+        features(c2, &tables[c->patch_2], c->data_2, r + MAX_WEIGHTS, &work);
+        const real_t e = dot(r, w + problem->offsets[c->patch_1], len1)
+                       - dot(r + MAX_WEIGHTS, w + problem->offsets[c->patch_2], len2);
+        total_error += c->weight * e * e;
+        work += len1 + len2;
     }
 
     problem->residual = sqrt_approx(total_error);
     problem->converged = (problem->residual < 1e-6);
+    problem->work = work;
 
     return 0;
 }
 
+real_t sheaf_predict(const SheafProblem *problem, int patch, const real_t *sample) {
+    const PatchConfig *config = &problem->patches[patch].config;
+    CharacterTable table;
+    real_t f[MAX_WEIGHTS];
+    unsigned long work = 0;
+    build_table(config, &table, &work);
+    features(config, &table, sample, f, &work);
+    return dot(f, problem->weights + problem->offsets[patch], config->n_positions * config->n_chars);
+}
+
 /**
  * Demo: 2-patch register allocation problem
  *
  * Simulates compiler register allocation across two code regions:
- * - Patch 1: Basic block A (needs 3 registers)
- * - Patch 2: Basic block B (needs 2 registers)
+ * - Patch 1: Basic block A (live ranges of x, y, z -> register pressure)
+ * - Patch 2: Basic block B (live ranges of y, w)
  * - Gluing: Variables shared between blocks must use same register
  *
- * The sheaf solver finds optimal allocation minimizing spills.
+ * Each sample is a block's live-range vector, its target the register
+ * the allocator wants; the gluing asks both blocks to agree on y.
  */
 void sheaf_demo_register_allocation(SheafProblem *problem) {
+    static const real_t block_a[4][3] = {
+        {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}, {1.0, 1.0, 0.0}
+    };
+    static const real_t block_a_regs[4] = {1.0, 2.0, 3.0, 3.0};
+    static const real_t block_b[3][2] = { {1.0, 0.0}, {0.0, 1.0}, {1.0, 1.0} };
+    static const real_t block_b_regs[3] = {2.0, 1.0, 3.0};
+
     problem->n_patches = 2;
 
     // Patch 1: Basic Block A
     problem->patches[0].name = "block_a";
-    problem->patches[0].n_samples = 3;
-    problem->patches[0].samples[0] = 1.0;  // Variable x
-    problem->patches[0].samples[1] = 2.0;  // Variable y
-    problem->patches[0].samples[2] = 3.0;  // Variable z
-    problem->patches[0].targets[0] = 1.0;  // Prefer register 1
-    problem->patches[0].targets[1] = 2.0;  // Prefer register 2
-    problem->patches[0].targets[2] = 3.0;  // Prefer register 3
+    problem->patches[0].n_samples = 4;
+    for (int s = 0; s < 4; s++) {
+        for (int q = 0; q < 3; q++) problem->patches[0].samples[s][q] = block_a[s][q];
+        problem->patches[0].targets[s] = block_a_regs[s];
+    }
     problem->patches[0].config.n_positions = 3;
     problem->patches[0].config.n_chars = 2;
 
     // Patch 2: Basic Block B
     problem->patches[1].name = "block_b";
-    problem->patches[1].n_samples = 2;
-    problem->patches[1].samples[0] = 2.0;  // Variable y (shared)
-    problem->patches[1].samples[1] = 4.0;  // Variable w
-    problem->patches[1].targets[0] = 2.0;  // Must match patch 1's y
-    problem->patches[1].targets[1] = 1.0;  // Prefer register 1
+    problem->patches[1].n_samples = 3;
+    for (int s = 0; s < 3; s++) {
+        for (int q = 0; q < 2; q++) problem->patches[1].samples[s][q] = block_b[s][q];
+        problem->patches[1].targets[s] = block_b_regs[s];
+    }
     problem->patches[1].config.n_positions = 2;
     problem->patches[1].config.n_chars = 2;
+
+    // Gluing: y (position 1 of block A, position 0 of block B) shares a register
+    problem->n_constraints = 1;
+    GluingConstraint *y = &problem->constraints[0];
+    y->patch_1 = 0;
+    y->patch_2 = 1;
+    for (int q = 0; q < MAX_POSITIONS; q++) {
+        y->data_1[q] = 0.0;
+        y->data_2[q] = 0.0;
+    }
+    y->data_1[1] = 1.0;
+    y->data_2[0] = 1.0;
+    y->weight = 1.0;
 }
+
@@ -4,6 +4,11 @@
  *
  * No std library, no dynamic allocation, fixed-size arrays only.
  * Demonstrates wreath-sheaf algebraic framework for OS decisions.
+ *
+ * Real-valued counterpart of UnifiedSheafLearner::fit() for cyclic
+ * patches: each patch learns weights w[p][j] over its character features,
+ * gluings ask two patches to agree on a pair of inputs, and everything is
+ * solved in one regularized least-squares step.
  */
 
 #pragma once
@@ -11,25 +16,47 @@
 // Fixed-size configuration
 #define MAX_PATCHES 4
 #define MAX_SAMPLES_PER_PATCH 8
-#define MAX_WEIGHTS 16
+#define MAX_POSITIONS 8          // Sample length (cyclic group order)
+#define MAX_WEIGHTS 16           // Σ n_positions · n_chars over all patches
 #define MAX_CONSTRAINTS 8
 
-// Simple types
-typedef double real_t;
+#define SHEAF_RIDGE 1e-8         // Added to the normal equations, as in fit()
 
-/**
- * A minimal 2x2 matrix (for demo purposes)
+/*
+ * Worst-case multiply-adds of one sheaf_solve() at these limits (n =
+ * MAX_POSITIONS, W = MAX_WEIGHTS, P patches of S samples, C gluings):
+ *
+ *   features   n · n_positions · n_chars <= n · W per sample
+ *              and gluing side, built twice (solve, residual)   2 (P·S + 2C) · n · W
+ *   Gram       one rank-1 update per row, upper triangle        (P·S + C) · W(W+1)/2
+ *   Cholesky   W^3/6, triangular solves W^2                     W^3/6 + W^2
+ *   residual   one dot product per row (per gluing side)        (P·S + 2C) · W
+ *   tables     16 Taylor steps for each sin/cos pair            P · n · 32
+ *
+ * plus W square roots and 3W divides. sheaf_solve() reports the count it
+ * actually spent in SheafProblem::work, which never exceeds the bound.
+ * At a conservative 4 cycles per dependent multiply-add (Cortex-A78AE
+ * FMA latency) and 20 per divide or square root, the limits above give
+ * 4 · 20 458 + 20 · 64 < 84 000 cycles, about 38 us at 2.2 GHz.
  */
-typedef struct {
-    real_t data[2][2];
-} Matrix2x2;
+#define SHEAF_ROWS_MAX (MAX_PATCHES * MAX_SAMPLES_PER_PATCH + MAX_CONSTRAINTS)
+#define SHEAF_FEATURE_ROWS_MAX (MAX_PATCHES * MAX_SAMPLES_PER_PATCH + 2 * MAX_CONSTRAINTS)
+#define SHEAF_SOLVE_MAX_MACS                                                   \
+    (2 * SHEAF_FEATURE_ROWS_MAX * MAX_POSITIONS * MAX_WEIGHTS                  \
+     + SHEAF_ROWS_MAX * MAX_WEIGHTS * (MAX_WEIGHTS + 1) / 2                    \
+     + MAX_WEIGHTS * MAX_WEIGHTS * MAX_WEIGHTS / 6 + MAX_WEIGHTS * MAX_WEIGHTS \
+     + SHEAF_FEATURE_ROWS_MAX * MAX_WEIGHTS                                    \
+     + MAX_PATCHES * MAX_POSITIONS * 32)
+
+// Simple types
+typedef double real_t;
 
 /**
  * Patch configuration
  */
 typedef struct {
-    int n_positions;
-    int n_chars;
+    int n_positions;    // 1..MAX_POSITIONS
+    int n_chars;        // 1..n_positions
 } PatchConfig;
 
 /**
@@ -37,28 +64,59 @@ typedef struct {
  */
 typedef struct {
     const char *name;
-    real_t samples[MAX_SAMPLES_PER_PATCH];  // Flattened data
+    real_t samples[MAX_SAMPLES_PER_PATCH][MAX_POSITIONS];  // First n_positions used
     real_t targets[MAX_SAMPLES_PER_PATCH];
     int n_samples;
     PatchConfig config;
 } Patch;
 
+/**
+ * Gluing: patch_1 on data_1 should predict what patch_2 predicts on data_2
+ */
+typedef struct {
+    int patch_1;
+    int patch_2;
+    real_t data_1[MAX_POSITIONS];
+    real_t data_2[MAX_POSITIONS];
+    real_t weight;      // Row weight relative to data rows (>= 0)
+} GluingConstraint;
+
 /**
  * Sheaf problem
  */
 typedef struct {
     Patch patches[MAX_PATCHES];
     int n_patches;
-    real_t residual;  // Output: cohomological obstruction
+    GluingConstraint constraints[MAX_CONSTRAINTS];
+    int n_constraints;
+
+    // Outputs
+    real_t weights[MAX_WEIGHTS];   // Patch p's w[pos][j] at offsets[p] + pos · n_chars + j
+    int offsets[MAX_PATCHES];
+    int n_weights;
+    real_t residual;  // Output: cohomological obstruction (root of the objective)
     int converged;
+    unsigned long work;            // Multiply-adds spent (<= SHEAF_SOLVE_MAX_MACS)
 } SheafProblem;
 
 /**
  * Solve a minimal sheaf problem
- * Returns 0 on success, -1 on error
+ *
+ * Minimizes Σ (f_p(x) · w_p - t)^2 + Σ weight · (f_1(d_1) · w_1 - f_2(d_2) · w_2)^2
+ * + SHEAF_RIDGE · |w|^2 by Cholesky on the normal equations, in place on
+ * the stack (about 5 KB).
+ *
+ * Returns 0 on success, -1 on error (a size outside the limits, a bad
+ * patch index or weight, or a system that is not numerically positive
+ * definite)
  */
 int sheaf_solve(SheafProblem *problem);
 
+/**
+ * Prediction of a solved patch for one sample of its n_positions values
+ */
+real_t sheaf_predict(const SheafProblem *problem, int patch, const real_t *sample);
+
 /**
  * Demo: 2-patch register allocation problem
  */
@@ -0,0 +1,309 @@
+/**
+ * @file slab.c
+ * @brief Slab caches with per-CPU magazines
+ *
+ * A slab is a 2^order-page block aligned to its size, so the SlabPage
+ * header of any object is its address rounded down to the slab size.
+ * Free objects inside a slab are chained through their first word; slabs
+ * with at least one free object sit on the cache's partial list, full
+ * slabs on no list. An empty slab goes back to where it came from unless
+ * it is the only partial one left.
+ */
+
+#include "slab.h"
+#include "page_alloc.h"
+
+#define SLAB_MAGIC 0x51ab51abU
+#define LARGE_MAGIC 0x1a26e0b1U     // Page-sized kmalloc() block
+#define SLAB_HEADER 64              // Header bytes at the start of a slab
+#define SLAB_MAX_ORDER 3
+#define SIZE_CLASSES 7              // 16 << 0 .. 16 << 6 == KMALLOC_MAX
+
+typedef struct SlabPage {
+    unsigned int magic;
+    unsigned int order;
+    SlabCache *cache;
+    struct SlabPage *next;          // Partial list
+    struct SlabPage *prev;
+    void *free;
+    unsigned int in_use;
+    unsigned int capacity;
+} SlabPage;
+
+_Static_assert(sizeof(SlabPage) <= SLAB_HEADER, "slab header too large");
+
+typedef struct {
+    unsigned long count;
+    void *objects[SLAB_MAGAZINE_SIZE];
+    unsigned long allocs;
+    unsigned long frees;
+} __attribute__((aligned(64))) Magazine;
+
+struct SlabCache {
+    const char *name;
+    unsigned long object_size;
+    unsigned int order;
+    unsigned int per_slab;
+    int lock;
+    SlabPage *partial;
+    unsigned long slabs;
+    Magazine magazines[MAX_CPUS];
+};
+
+extern char __heap_pool_start[], __heap_pool_end[];
+
+static SlabCache caches[SLAB_MAX_CACHES];
+static int n_caches;
+static int caches_lock;
+static SlabCache *size_classes[SIZE_CLASSES];
+
+static const char *const class_names[SIZE_CLASSES] = {
+    "kmalloc-16", "kmalloc-32", "kmalloc-64", "kmalloc-128",
+    "kmalloc-256", "kmalloc-512", "kmalloc-1024"
+};
+
+// Linker pool: bump pointer plus a free list per slab order
+static struct {
+    unsigned long next;
+    void *free[SLAB_MAX_ORDER + 1];
+    int lock;
+} pool;
+
+static struct {
+    unsigned long allocs;
+    unsigned long frees;
+} large;
+
+static int in_pool(unsigned long addr) {
+    return addr >= (unsigned long)__heap_pool_start && addr < (unsigned long)__heap_pool_end;
+}
+
+/**
+ * 2^order pages aligned to their size: the linker pool first, then RAM
+ */
+static unsigned long pages_get(int order) {
+    const unsigned long bytes = PAGE_SIZE << order;
+    void *block = 0;
+    if (order <= SLAB_MAX_ORDER) {
+        spin_lock(&pool.lock);
+        block = pool.free[order];
+        if (block) {
+            pool.free[order] = *(void **)block;
+        } else {
+            const unsigned long start = (pool.next + bytes - 1) & ~(bytes - 1);
+            if (start + bytes <= (unsigned long)__heap_pool_end) {
+                block = (void *)start;
+                pool.next = start + bytes;
+            }
+        }
+        spin_unlock(&pool.lock);
+    }
+    return block ? (unsigned long)block : page_alloc(order);
+}
+
+static void pages_put(unsigned long addr, int order) {
+    if (in_pool(addr)) {
+        spin_lock(&pool.lock);
+        *(void **)addr = pool.free[order];
+        pool.free[order] = (void *)addr;
+        spin_unlock(&pool.lock);
+    } else {
+        page_free(addr, order);
+    }
+}
+
+static void partial_push(SlabCache *cache, SlabPage *s) {
+    s->prev = 0;
+    s->next = cache->partial;
+    if (s->next) s->next->prev = s;
+    cache->partial = s;
+}
+
+static void partial_remove(SlabCache *cache, SlabPage *s) {
+    if (s->prev) s->prev->next = s->next;
+    else cache->partial = s->next;
+    if (s->next) s->next->prev = s->prev;
+}
+
+/**
+ * Fresh slab with every object on its free list (cache lock held)
+ */
+static SlabPage *slab_grow(SlabCache *cache) {
+    const unsigned long base = pages_get((int)cache->order);
+    if (base == 0) return 0;
+    SlabPage *s = (SlabPage *)base;
+    s->magic = SLAB_MAGIC;
+    s->order = cache->order;
+    s->cache = cache;
+    s->in_use = 0;
+    s->capacity = cache->per_slab;
+    s->free = 0;
+    char *objects = (char *)base + SLAB_HEADER;
+    for (unsigned int i = cache->per_slab; i-- > 0;) {
+        void *obj = objects + i * cache->object_size;
+        *(void **)obj = s->free;
+        s->free = obj;
+    }
+    partial_push(cache, s);
+    cache->slabs++;
+    return s;
+}
+
+/**
+ * Object back into its slab (cache lock held)
+ */
+static void slab_put(SlabCache *cache, void *obj) {
+    SlabPage *s = (SlabPage *)((unsigned long)obj & ~((PAGE_SIZE << cache->order) - 1));
+    *(void **)obj = s->free;
+    s->free = obj;
+    if (s->in_use-- == s->capacity) partial_push(cache, s);
+    if (s->in_use == 0 && (cache->partial != s || s->next)) {
+        partial_remove(cache, s);
+        s->magic = 0;
+        cache->slabs--;
+        pages_put((unsigned long)s, (int)s->order);
+    }
+}
+
+static SlabCache *cache_setup(const char *name, unsigned long size, unsigned int max_order) {
+    size = size < 16 ? 16 : (size + 15) & ~15UL;
+    unsigned int order = 0;
+    while (order < max_order && ((PAGE_SIZE << order) - SLAB_HEADER) / size < SLAB_MIN_OBJECTS) order++;
+    const unsigned long per_slab = ((PAGE_SIZE << order) - SLAB_HEADER) / size;
+    if (per_slab == 0) return 0;
+
+    spin_lock(&caches_lock);
+    if (n_caches == SLAB_MAX_CACHES) {
+        spin_unlock(&caches_lock);
+        return 0;
+    }
+    SlabCache *cache = &caches[n_caches];
+    cache->name = name;
+    cache->object_size = size;
+    cache->order = order;
+    cache->per_slab = (unsigned int)per_slab;
+    cache->lock = 0;
+    cache->partial = 0;
+    cache->slabs = 0;
+    for (int c = 0; c < MAX_CPUS; c++) {
+        cache->magazines[c].count = 0;
+        cache->magazines[c].allocs = 0;
+        cache->magazines[c].frees = 0;
+    }
+    n_caches++;
+    spin_unlock(&caches_lock);
+    return cache;
+}
+
+void slab_init(void) {
+    pool.next = ((unsigned long)__heap_pool_start + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    for (int o = 0; o <= SLAB_MAX_ORDER; o++) pool.free[o] = 0;
+    pool.lock = 0;
+    n_caches = 0;
+    large.allocs = 0;
+    large.frees = 0;
+    // Size-class slabs stay one page so kfree() finds the header by masking
+    for (int c = 0; c < SIZE_CLASSES; c++) size_classes[c] = cache_setup(class_names[c], 16UL << c, 0);
+}
+
+SlabCache *slab_cache_create(const char *name, unsigned long size) {
+    return cache_setup(name, size, SLAB_MAX_ORDER);
+}
+
+void *slab_alloc(SlabCache *cache) {
+    Magazine *mag = &cache->magazines[cpu_id()];
+    if (mag->count == 0) {
+        spin_lock(&cache->lock);
+        while (mag->count < SLAB_MAGAZINE_BATCH) {
+            SlabPage *s = cache->partial ? cache->partial : slab_grow(cache);
+            if (!s) break;
+            void *obj = s->free;
+            s->free = *(void **)obj;
+            if (++s->in_use == s->capacity) partial_remove(cache, s);
+            mag->objects[mag->count++] = obj;
+        }
+        spin_unlock(&cache->lock);
+        if (mag->count == 0) return 0;
+    }
+    mag->allocs++;
+    return mag->objects[--mag->count];
+}
+
+void slab_free(SlabCache *cache, void *obj) {
+    if (!obj) return;
+    Magazine *mag = &cache->magazines[cpu_id()];
+    if (mag->count == SLAB_MAGAZINE_SIZE) {
+        spin_lock(&cache->lock);
+        for (int i = 0; i < SLAB_MAGAZINE_BATCH; i++) slab_put(cache, mag->objects[--mag->count]);
+        spin_unlock(&cache->lock);
+    }
+    mag->frees++;
+    mag->objects[mag->count++] = obj;
+}
+
+void *kmalloc(unsigned long size) {
+    if (size <= KMALLOC_MAX) {
+        int c = 0;
+        while ((16UL << c) < size) c++;
+        return size_classes[c] ? slab_alloc(size_classes[c]) : 0;
+    }
+    const int order = page_order_for(size + SLAB_HEADER);
+    if (order < 0) return 0;
+    const unsigned long base = pages_get(order);
+    if (base == 0) return 0;
+    SlabPage *s = (SlabPage *)base;
+    s->magic = LARGE_MAGIC;
+    s->order = (unsigned int)order;
+    s->cache = 0;
+    __atomic_add_fetch(&large.allocs, 1, __ATOMIC_RELAXED);
+    return (char *)base + SLAB_HEADER;
+}
+
+void kfree(void *ptr) {
+    if (!ptr) return;
+    SlabPage *s = (SlabPage *)((unsigned long)ptr & ~(PAGE_SIZE - 1));
+    if (s->magic == LARGE_MAGIC && (char *)ptr == (char *)s + SLAB_HEADER) {
+        s->magic = 0;
+        __atomic_add_fetch(&large.frees, 1, __ATOMIC_RELAXED);
+        pages_put((unsigned long)s, (int)s->order);
+    } else if (s->magic == SLAB_MAGIC) {
+        slab_free(s->cache, ptr);
+    }
+}
+
+int slab_stats(SlabStats *stats, int max) {
+    int n = 0;
+    const int count = __atomic_load_n(&n_caches, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count && n < max; i++, n++) {
+        const SlabCache *cache = &caches[i];
+        SlabStats *st = &stats[n];
+        st->name = cache->name;
+        st->object_size = cache->object_size;
+        st->slab_bytes = PAGE_SIZE << cache->order;
+        st->slabs = cache->slabs;
+        st->allocs = 0;
+        st->frees = 0;
+        for (int c = 0; c < MAX_CPUS; c++) {
+            st->allocs += cache->magazines[c].allocs;
+            st->frees += cache->magazines[c].frees;
+        }
+        st->in_use = st->allocs - st->frees;
+    }
+    if (n < max) {
+        SlabStats *st = &stats[n++];
+        st->name = "kmalloc-large";
+        st->object_size = 0;
+        st->slab_bytes = 0;
+        st->allocs = __atomic_load_n(&large.allocs, __ATOMIC_RELAXED);
+        st->frees = __atomic_load_n(&large.frees, __ATOMIC_RELAXED);
+        st->in_use = st->allocs - st->frees;
+        st->slabs = st->in_use;
+    }
+    return n;
+}
+
+void slab_pool_usage(unsigned long *used, unsigned long *size) {
+    const unsigned long start = (unsigned long)__heap_pool_start;
+    *size = (unsigned long)__heap_pool_end - start;
+    *used = pool.next > start ? pool.next - start : 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file slab.h
+ * @brief Slab kernel heap for BonsaiOS kernel
+ *
+ * Object caches hand out fixed-size objects from slabs of 2^order pages;
+ * kmalloc() picks a power-of-two size class (16 B .. 1 KiB) and sends
+ * anything larger straight to whole pages. Slabs come from a pool the
+ * linker reserves (__heap_pool_start .. __heap_pool_end), so the heap
+ * works before and without a memory map, and from page_alloc() once the
+ * pool runs out.
+ *
+ * Every cache keeps a magazine of free objects per CPU: alloc and free
+ * pop and push it with no lock or atomic, and only a magazine that runs
+ * empty or full takes the cache lock to move SLAB_MAGAZINE_BATCH objects.
+ * Like page_alloc(), not reentrant from interrupt handlers on one CPU.
+ * Caches have no constructors: objects come back with whatever the last
+ * user left in them.
+ */
+
+#pragma once
+
+#include "cpu.h"
+
+#define SLAB_MAX_CACHES 16          // Size classes plus named caches
+#define SLAB_MAGAZINE_SIZE 16       // Objects per per-CPU magazine
+#define SLAB_MAGAZINE_BATCH 8       // Objects moved per refill or flush
+#define SLAB_MIN_OBJECTS 4          // Slabs grow up to 8 pages to hold this many
+#define KMALLOC_MAX 1024            // Largest size class; above this, pages
+
+typedef struct SlabCache SlabCache;
+
+/**
+ * Counters of one cache, or of page-sized kmalloc() blocks when name is
+ * "kmalloc-large"
+ */
+typedef struct {
+    const char *name;
+    unsigned long object_size;
+    unsigned long slab_bytes;
+    unsigned long slabs;
+    unsigned long allocs;
+    unsigned long frees;
+    unsigned long in_use;           // allocs - frees
+} SlabStats;
+
+/**
+ * Set up the size classes. Runs once on the boot CPU before any other
+ * slab_* or kmalloc() call, after page_alloc_init() when there is one.
+ */
+void slab_init(void);
+
+/**
+ * New cache of size-byte objects, 16-byte aligned; name must outlive it
+ *
+ * Returns NULL once SLAB_MAX_CACHES exist or the object is larger than
+ * an 8-page slab can hold
+ */
+SlabCache *slab_cache_create(const char *name, unsigned long size);
+
+void *slab_alloc(SlabCache *cache);
+void slab_free(SlabCache *cache, void *obj);
+
+/**
+ * General-purpose heap; kfree(NULL) is a no-op
+ */
+void *kmalloc(unsigned long size);
+void kfree(void *ptr);
+
+/**
+ * Fill up to max entries (caches in creation order, then kmalloc-large)
+ * and return how many were written
+ */
+int slab_stats(SlabStats *stats, int max);
+
+/**
+ * Bootstrap pool size and how much of it slabs have taken
+ */
+void slab_pool_usage(unsigned long *used, unsigned long *size);
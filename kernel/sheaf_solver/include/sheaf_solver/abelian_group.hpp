@@ -0,0 +1,112 @@
+/**
+ * @file abelian_group.hpp
+ * @brief Characters of finite abelian groups C_{n_0} × C_{n_1} × ...
+ *
+ * Resource problems are often grids - (core × time slot), (node × core ×
+ * time) - with an independent cyclic symmetry along each axis. The product
+ * group G = C_{n_0} × ... × C_{n_{r-1}} has order N = Π n_a and exactly N
+ * one-dimensional characters, indexed like the elements by a multi-index:
+ *
+ *   χ_j(k) = Π_a ω_a^{j_a k_a},   ω_a = e^{2πi/n_a}
+ *
+ * Samples are [N, d_model] with the grid flattened row-major (the last
+ * axis varies fastest), and character j uses the same flattening.
+ *
+ * Because χ_j factors over the axes, the transform X_j = Σ_k χ_j(k) V_k is
+ * separable: a 1-D FFT along each axis in turn, O(N log N) in total. Axes
+ * other than the last are strided in memory, so each is brought to unit
+ * stride by a cache-blocked transpose before its FFTs and moved back after.
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "fft.hpp"
+#include "symmetry_group.hpp"
+
+#include <vector>
+
+namespace sheaf {
+
+class AbelianGroupCharacters : public SymmetryGroup {
+public:
+    /**
+     * @brief Construct the product of cyclic groups with the given orders
+     *
+     * @param shape Axis lengths n_0, ..., n_{r-1} (all positive, r >= 1)
+     */
+    explicit AbelianGroupCharacters(std::vector<size_t> shape);
+
+    const std::vector<size_t>& shape() const { return shape_; }
+    size_t rank() const { return shape_.size(); }
+    size_t order() const override { return order_; }
+
+    /**
+     * @brief Flat (row-major) index of a multi-index
+     */
+    size_t flat_index(const std::vector<size_t>& multi) const;
+
+    /**
+     * @brief Multi-index of a flat index
+     */
+    std::vector<size_t> multi_index(size_t flat) const;
+
+    /**
+     * @brief χ_j(k) = Π_a ω_a^{j_a k_a} for flat indices j, k
+     */
+    complex_t character(size_t j, size_t k) const override;
+
+    /**
+     * @brief Separable transform X_j = Σ_k χ_j(k) V_k, per column
+     *
+     * @param V [N, d_model]
+     * @throws std::invalid_argument if V does not have N rows
+     */
+    Matrix transform(const Matrix& V) const;
+
+    /**
+     * @brief Inverse of transform(): V_k = (1/N) Σ_j χ̄_j(k) X_j
+     */
+    Matrix inverse_transform(const Matrix& X) const;
+
+    /**
+     * @brief Proj_{χ_j}(V)[i] = (1/N) χ̄_j(i) X_j
+     */
+    Matrix project_onto_character(const Matrix& V, size_t j) const;
+
+    /**
+     * @brief All N projections from one transform per column
+     */
+    std::vector<Matrix> decompose_into_characters(const Matrix& V) const override;
+
+    Vector selected_projection_features(
+        const Matrix& V, std::span<const size_t> characters) const override;
+
+    /**
+     * @brief Σ_j coefficients[j] · projections[j]
+     */
+    Matrix reconstruct_from_characters(
+        const Vector& coefficients,
+        const std::vector<Matrix>& projections
+    ) const;
+
+private:
+    std::vector<size_t> shape_;
+    std::vector<size_t> strides_;            // Row-major: stride of the last axis is 1
+    size_t order_;
+    std::vector<FourierPlan> plans_;         // One per axis
+    std::vector<std::vector<complex_t>> roots_;  // roots_[a][t] = ω_a^t
+    size_t workspace_size_ = 0;              // Largest per-axis FFT workspace
+
+    void check_rows(const Matrix& V) const;
+
+    /**
+     * @brief Transform one contiguous column of N values in place
+     *
+     * @param scratch N values (transpose target)
+     * @param work workspace_size_ values
+     */
+    void transform_column(complex_t* x, bool inverse, complex_t* scratch, complex_t* work) const;
+};
+
+} // namespace sheaf
@@ -0,0 +1,71 @@
+/**
+ * @file batched_cholesky.hpp
+ * @brief Lockstep Cholesky solves of many small Hermitian systems
+ *
+ * A 32 x 32 complex Cholesky is too short for the vector units: every
+ * column is a few dozen multiply-adds between a square root and a
+ * division. BatchedCholesky holds kBatchLanes systems of the same size
+ * interleaved - entry (i, j) of all lanes is contiguous, real and
+ * imaginary parts in separate arrays - so each scalar step of the
+ * factorization and of both triangular solves becomes a fixed-length loop
+ * over lanes that the compiler maps onto SIMD registers. Matrices are
+ * stored as packed lower triangles.
+ */
+
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <vector>
+
+namespace sheaf {
+
+constexpr size_t kBatchLanes = 8;
+
+class BatchedCholesky {
+public:
+    explicit BatchedCholesky(size_t n);
+
+    size_t size() const { return n_; }
+
+    /**
+     * @brief Set lane's system A x = b (only the lower triangle of A is read)
+     */
+    void load(size_t lane, const Matrix& A, const Vector& b);
+
+    /**
+     * @brief Fill an unused lane with I x = 0
+     */
+    void load_identity(size_t lane);
+
+    /**
+     * @brief Factor A = L L^H and solve, every lane at once
+     *
+     * @return Per lane, false if its matrix was not numerically positive
+     *         definite (that lane's solution is then meaningless)
+     */
+    std::array<bool, kBatchLanes> solve();
+
+    /**
+     * @brief x of one lane after solve()
+     */
+    Vector solution(size_t lane) const;
+
+    /**
+     * @brief Bytes held by the interleaved matrix and right-hand-side buffers
+     */
+    size_t buffer_bytes() const;
+
+private:
+    size_t n_;
+    std::vector<real_t> re_;         // Packed row-major lower triangle, lanes innermost
+    std::vector<real_t> im_;
+    std::vector<real_t> rhs_re_;     // [i * kBatchLanes + lane]
+    std::vector<real_t> rhs_im_;
+    std::vector<real_t> inv_diag_;   // 1 / L(i, i)
+
+    size_t at(size_t i, size_t j) const { return (i * (i + 1) / 2 + j) * kBatchLanes; }
+};
+
+} // namespace sheaf
@@ -0,0 +1,107 @@
+/**
+ * @file character_theory.hpp
+ * @brief Character-theory attention layer (wreath product attention)
+ *
+ * C++ port of the attention in sheaf_compiler/character_theory_attention.py:
+ *
+ *   Attention(V) = Σ_{j=0}^{n-1} c_j · Proj_{χ_j}(V)
+ *
+ * Since Proj_{χ_j}(V)[i] = (1/n) ω^{-ij} X_j with X the character transform
+ * of V, the layer is a transform, a per-character scale and an inverse
+ * transform along the sequence axis. All three run fused on one column at a
+ * time in a single scratch buffer: O(seq log seq) per column, with no
+ * projection tensors materialized (the Python version builds all n of them,
+ * O(seq^2) each).
+ *
+ * Tensors are [seq_len, d_model] matrices; a batch is a span of them.
+ * d_model is split into n_heads contiguous column groups, and each head has
+ * its own coefficient vector c (one entry per character).
+ *
+ * Coefficients can be learned in closed form: the projections onto
+ * distinct characters are orthogonal, so the least-squares problem of
+ * CyclicGroupCharacters::learn_character_weights decouples into one ratio
+ * per character, c_j = Σ conj(X_j) Y_j / Σ |X_j|^2.
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "fft.hpp"
+
+#include <span>
+#include <vector>
+
+namespace sheaf {
+
+class CharacterAttention {
+public:
+    /**
+     * @brief Construct a layer with all coefficients zero
+     *
+     * @param seq_len Sequence length n (group C_n acts by rotation)
+     * @param d_model Embedding dimension
+     * @param n_heads Number of heads; must divide d_model
+     */
+    CharacterAttention(size_t seq_len, size_t d_model, size_t n_heads = 1);
+
+    size_t seq_len() const { return seq_len_; }
+    size_t d_model() const { return d_model_; }
+    size_t n_heads() const { return n_heads_; }
+    size_t head_dim() const { return d_model_ / n_heads_; }
+
+    /**
+     * @brief Set the character coefficients of one head
+     *
+     * Entries past c.size() are zero, so the first k characters can be
+     * given on their own.
+     */
+    void set_head_coefficients(size_t head, const Vector& c);
+
+    /**
+     * @brief Character coefficients, [seq_len, n_heads]
+     */
+    const Matrix& coefficients() const { return coefficients_; }
+
+    /**
+     * @brief Learn every head's coefficients from examples (closed form)
+     *
+     * @param V_samples Inputs [seq_len, d_model]
+     * @param targets Desired outputs [seq_len, d_model]
+     * @param ridge Added to each character's energy (0 = plain least squares;
+     *              characters absent from the data get coefficient 0)
+     * @param n_threads Worker threads (0 = hardware concurrency)
+     */
+    void fit(
+        std::span<const Matrix> V_samples,
+        std::span<const Matrix> targets,
+        real_t ridge = 0.0,
+        size_t n_threads = 0
+    );
+
+    /**
+     * @brief Apply the layer to one tensor [seq_len, d_model]
+     */
+    Matrix forward(const Matrix& V) const;
+
+    /**
+     * @brief Apply the layer to a batch, split across threads
+     */
+    std::vector<Matrix> forward_batch(std::span<const Matrix> batch, size_t n_threads = 0) const;
+
+private:
+    size_t seq_len_;
+    size_t d_model_;
+    size_t n_heads_;
+    FourierPlan plan_;
+    Matrix coefficients_;   // c[j, head]
+    Matrix scale_;          // c[j, head] / n, applied between the transforms
+
+    void check_shape(const Matrix& V, const char* what) const;
+
+    /**
+     * @brief Fused transform -> scale -> inverse transform, in place on out
+     */
+    void apply(Matrix& out, complex_t* work) const;
+};
+
+} // namespace sheaf
@@ -0,0 +1,99 @@
+/**
+ * @file consensus_solver.hpp
+ * @brief Domain decomposition of fit() across worker processes (ADMM)
+ *
+ * Each worker owns a subset of the patches and only ever featurizes those.
+ * A gluing whose two patches live on different workers - or any hard
+ * gluing - is a boundary gluing: every owning side keeps its prediction
+ * u = f · w_p at the gluing point and a local copy v of it, and the
+ * centralized objective
+ *
+ *   Σ_workers f_r(w_r) + Σ_boundary d_i |v_i1 - v_i2|^2,   u = v
+ *
+ * is solved by scaled ADMM:
+ *
+ *   w_r ← argmin f_r(w) + ρ/2 Σ_sides |f w - v + y|^2     (one Cholesky, reused)
+ *   v   ← prox of d|v_1 - v_2|^2 at s = u + y              (per gluing, closed form)
+ *   y   ← y + u - v
+ *
+ * f_r is the worker's own fit() objective (data rows, its internal soft
+ * gluings, ridge). The v update needs s from both sides, so one
+ * iteration moves one complex value per boundary gluing side to the
+ * neighbouring worker and a five-number residual sum through rank 0.
+ * For hard gluings the prox is the mean, so consensus enforces them
+ * exactly. The fixed point is the solution of the centralized fit().
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "transport.hpp"
+#include "unified_sheaf_learner.hpp"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sheaf {
+
+enum class TransportKind {
+    SharedMemory,
+    Socket
+};
+
+struct ConsensusOptions {
+    size_t n_workers = 2;
+    std::vector<size_t> assignment;  // Worker per patch; empty = contiguous blocks
+    TransportKind transport = TransportKind::SharedMemory;
+    real_t ridge = 1e-8;             // As UnifiedSheafLearner::set_ridge()
+    real_t rho = 0.0;                // Initial penalty; 0 = mean Gram diagonal / mean |f|^2
+    bool adaptive_rho = true;        // Balance primal and dual residuals (refactors)
+    real_t tolerance = 1e-9;         // On both relative residuals
+    size_t max_iterations = 20000;
+    size_t ring_bytes = 1 << 20;     // Per ordered pair of workers (shared memory)
+    std::chrono::milliseconds timeout = std::chrono::seconds(60);
+};
+
+struct ConsensusResult {
+    SheafSolution solution;          // residual_error is the global objective
+    size_t iterations = 0;
+    real_t primal_residual = 0.0;    // ||u - v|| / (sqrt(m) + max(||u||, ||v||))
+    real_t dual_residual = 0.0;      // ρ||Δv|| / (sqrt(m) + ρ||y||)
+    bool converged = false;          // Both below tolerance
+    real_t rho = 0.0;                // Final penalty
+    size_t refactorizations = 0;
+    size_t boundary_values = 0;      // Gluing sides exchanged per iteration, all workers
+    uint64_t bytes_sent = 0;         // By this worker (fit_consensus(): by all workers)
+};
+
+/**
+ * @brief One worker's side of the consensus fit (call on every rank)
+ *
+ * @param problem This worker's patches (others may be absent) and the full
+ *                gluing list, identical on every rank
+ * @param owner Rank of every patch named by a gluing or owned here
+ * @param learner Supplies the ridge and row compression; ends fitted on
+ *                this worker's patches
+ * @return This worker's weights, with the global residual and iteration data
+ */
+ConsensusResult consensus_worker(
+    const SheafProblemView& problem,
+    const std::unordered_map<std::string, size_t>& owner,
+    Transport& transport,
+    UnifiedSheafLearner& learner,
+    const ConsensusOptions& options = {}
+);
+
+/**
+ * @brief Fork options.n_workers - 1 worker processes, run the consensus
+ * fit over the chosen transport and gather every patch's weights here
+ *
+ * The calling process is rank 0. Children exit when done.
+ *
+ * @throws std::invalid_argument for a bad assignment
+ * @throws std::runtime_error if a worker fails or times out
+ */
+ConsensusResult fit_consensus(const SheafProblem& problem, const ConsensusOptions& options = {});
+
+} // namespace sheaf
@@ -16,10 +16,12 @@
 #pragma once
 
 #include "types.hpp"
+#include "fft.hpp"
+#include "symmetry_group.hpp"
 
 namespace sheaf {
 
-class CyclicGroupCharacters {
+class CyclicGroupCharacters : public SymmetryGroup {
 public:
     /**
      * @brief Construct character table for C_n
@@ -30,7 +32,7 @@ public:
     /**
      * @brief Get group order
      */
-    size_t order() const { return n_; }
+    size_t order() const override { return n_; }
 
     /**
      * @brief Evaluate character χ_j on group element g^k
@@ -38,7 +40,7 @@ public:
      * @param k Group element power (0 to n-1)
      * @return χ_j(g^k) = ω^(jk)
      */
-    complex_t character(size_t j, size_t k) const;
+    complex_t character(size_t j, size_t k) const override;
 
     /**
      * @brief Project representation V onto character χ_j subspace
@@ -48,6 +50,9 @@ public:
      *
      * where g^k(V) means "rotate V by k positions"
      *
+     * When seq_len == n this is (1/n) ω^{-ij} X_j with X = transform(V), and
+     * only row j of the transform is evaluated: O(n·d_model).
+     *
      * @param V Value tensor [seq_len, d_model]
      * @param j Character index
      * @return Projected tensor [seq_len, d_model]
@@ -59,10 +64,41 @@ public:
      *
      * By Maschke's theorem: V = Σ_{j=0}^{n-1} Proj_{χ_j}(V)
      *
+     * When seq_len == n one FFT per column replaces the n rotate-and-sum
+     * projections (O(n^2 d) to fill the output instead of O(n^3 d)).
+     *
      * @param V Value tensor [seq_len, d_model]
      * @return Vector of n projected tensors (one per character)
      */
-    std::vector<Matrix> decompose_into_characters(const Matrix& V) const;
+    std::vector<Matrix> decompose_into_characters(const Matrix& V) const override;
+
+    /**
+     * @brief Features from one FFT: (1/n) χ̄_c(g^p) X_c for each selected c
+     */
+    Vector selected_projection_features(
+        const Matrix& V, std::span<const size_t> characters) const override;
+
+    /**
+     * @brief Character transform along the sequence axis: X_j = Σ_m χ_j(g^m) V_m
+     *
+     * Row j of the result is the (unnormalized) coefficient of χ_j, computed
+     * per column in O(n log n).
+     *
+     * @param V Value tensor [n, d_model]
+     * @return Transform [n, d_model]
+     * @throws std::invalid_argument if V does not have n rows
+     */
+    Matrix transform(const Matrix& V) const;
+
+    /**
+     * @brief Inverse of transform(): V_m = (1/n) Σ_j χ̄_j(g^m) X_j
+     */
+    Matrix inverse_transform(const Matrix& X) const;
+
+    /**
+     * @brief FFT plan for this group order (shareable across threads)
+     */
+    const FourierPlan& plan() const { return plan_; }
 
     /**
      * @brief Reconstruct V from character decomposition
@@ -105,6 +141,7 @@ private:
     size_t n_;              // Group order
     complex_t omega_;       // Primitive n-th root of unity: e^(2πi/n)
     Matrix characters_;     // Character table (DFT matrix)
+    FourierPlan plan_;      // O(n log n) evaluation of the character sums
 
     /**
      * @brief Compute the character table
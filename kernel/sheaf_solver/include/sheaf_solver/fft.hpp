@@ -0,0 +1,79 @@
+/**
+ * @file fft.hpp
+ * @brief O(n log n) character transform of C_n (FFT)
+ *
+ * FourierPlan evaluates the character sums of the cyclic group:
+ *
+ *   forward:  X_j = Σ_m ω^{+jm} x_m      (ω = e^{2πi/n}, the character table)
+ *   inverse:  x_m = Σ_j ω^{-jm} X_j      (unnormalized; divide by n)
+ *
+ * Note the sign: this follows the character-table convention of
+ * CyclicGroupCharacters, i.e. NumPy's n·ifft, not np.fft.fft.
+ *
+ * Power-of-two orders use an in-place iterative radix-2 transform with
+ * precomputed twiddles and bit-reversal table. Every other order uses
+ * Bluestein's chirp-z algorithm on top of a power-of-two plan, so all sizes
+ * are O(n log n). Plans are immutable after construction and may be shared
+ * between threads; each thread passes its own workspace.
+ */
+
+#pragma once
+
+#include "types.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace sheaf {
+
+class FourierPlan {
+public:
+    /**
+     * @brief Precompute twiddles (and the Bluestein chirp) for order n
+     */
+    explicit FourierPlan(size_t n);
+
+    size_t size() const { return n_; }
+
+    /**
+     * @brief Scratch elements execute() needs (0 for power-of-two orders)
+     */
+    size_t workspace_size() const { return chirp_fft_.size(); }
+
+    /**
+     * @brief In-place forward transform X_j = Σ_m ω^{jm} x_m
+     *
+     * @param x n contiguous values, overwritten with the transform
+     * @param work workspace_size() scratch values (may be null if 0)
+     */
+    void forward(complex_t* x, complex_t* work) const;
+
+    /**
+     * @brief In-place inverse transform x_m = Σ_j ω^{-jm} X_j (no 1/n)
+     */
+    void inverse(complex_t* x, complex_t* work) const;
+
+    /**
+     * @brief Convenience overloads that allocate their own workspace
+     */
+    void forward(complex_t* x) const;
+    void inverse(complex_t* x) const;
+
+private:
+    size_t n_;
+    bool pow2_;
+
+    // Radix-2 path
+    std::vector<complex_t> twiddles_;   // ω^k, k < n/2
+    std::vector<uint32_t> bitrev_;      // Bit-reversal permutation
+
+    // Bluestein path
+    std::vector<complex_t> chirp_;      // e^{iπ k²/n}, k < n
+    std::vector<complex_t> chirp_fft_;  // Padded conj(chirp) kernel, transformed
+    std::shared_ptr<const FourierPlan> inner_;  // Power-of-two plan of size M >= 2n-1
+
+    void radix2(complex_t* x) const;
+    void bluestein(complex_t* x, complex_t* work) const;
+};
+
+} // namespace sheaf
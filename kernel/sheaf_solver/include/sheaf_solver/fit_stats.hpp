@@ -0,0 +1,123 @@
+/**
+ * @file fit_stats.hpp
+ * @brief Per-phase timings and counters for fit() and predict()
+ *
+ * Timings use the monotonic clock and are recorded only when the library is
+ * built with SHEAF_SOLVER_STATS defined (CMake option of the same name).
+ * Otherwise PhaseTimer and stats_add() are empty inline functions, the
+ * optimizer removes them entirely, and every FitStats field stays zero.
+ * In a SHEAF_SOLVER_TRACE build each lap is also emitted as a trace span.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "trace.hpp"
+
+#if defined(SHEAF_SOLVER_STATS) || defined(SHEAF_SOLVER_TRACE)
+#include <chrono>
+#endif
+
+namespace sheaf {
+
+/**
+ * @brief Phases of the one-step solve (plus the two halves of predict)
+ */
+enum class FitPhase : std::size_t {
+    LocalBuild = 0,     // Featurize samples into per-patch A_patch / b_patch
+    GluingBuild,        // Featurize gluing data into A_gluing
+    Assembly,           // Stack A_sheaf = [A_local; A_gluing]
+    Gram,               // A^H A and A^H b
+    Factorization,      // Cholesky of the Gram matrix
+    Solve,              // Triangular solves
+    Residual,           // ||A w - b||^2
+    Unpack,             // Flat solution -> per-patch weight matrices
+    PredictFeaturize,   // predict(): feature row of the query sample
+    PredictEvaluate,    // predict(): dot product with the learned weights
+    Count
+};
+
+constexpr std::size_t kNumFitPhases = static_cast<std::size_t>(FitPhase::Count);
+
+/**
+ * @brief Human-readable phase name ("local_build", "gram", ...)
+ */
+const char* phase_name(FitPhase phase);
+
+/**
+ * @brief Timings and counters for one fit() (or accumulated predict() calls)
+ */
+struct FitStats {
+    uint64_t phase_ns[kNumFitPhases] = {};  // Wall time per phase
+    uint64_t flops = 0;                     // Nominal flop estimate (complex MAC = 8)
+    uint64_t bytes_allocated = 0;           // Bytes of matrix/vector storage created
+    uint64_t character_transforms = 0;      // decompose_into_characters() calls
+    uint64_t cache_hits = 0;                // Character-table cache hits
+    uint64_t cache_misses = 0;              // Character tables built from scratch
+    uint64_t predictions = 0;               // predict() calls folded into these stats
+
+    uint64_t& operator[](FitPhase phase) { return phase_ns[static_cast<std::size_t>(phase)]; }
+    uint64_t operator[](FitPhase phase) const { return phase_ns[static_cast<std::size_t>(phase)]; }
+
+    /**
+     * @brief Sum of all phase timings
+     */
+    uint64_t total_ns() const {
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < kNumFitPhases; ++i) total += phase_ns[i];
+        return total;
+    }
+};
+
+#if defined(SHEAF_SOLVER_STATS) || defined(SHEAF_SOLVER_TRACE)
+
+/**
+ * @brief Lap timer: lap(p) charges the time since the previous lap to phase p
+ */
+class PhaseTimer {
+public:
+    explicit PhaseTimer(FitStats& stats) : stats_(stats), last_(now()) {}
+
+    void lap(FitPhase phase) {
+        const uint64_t t = now();
+#ifdef SHEAF_SOLVER_STATS
+        stats_[phase] += t - last_;
+#endif
+#ifdef SHEAF_SOLVER_TRACE
+        if (trace::enabled()) {
+            trace::record(phase_name(phase), "phase", last_, t);
+        }
+#endif
+        last_ = t;
+    }
+
+private:
+    [[maybe_unused]] FitStats& stats_;
+    uint64_t last_;
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+#else
+
+class PhaseTimer {
+public:
+    explicit PhaseTimer(FitStats&) {}
+    void lap(FitPhase) {}
+};
+
+#endif // SHEAF_SOLVER_STATS || SHEAF_SOLVER_TRACE
+
+#ifdef SHEAF_SOLVER_STATS
+inline void stats_add(uint64_t& counter, uint64_t n) { counter += n; }
+#else
+inline void stats_add(uint64_t&, uint64_t) {}
+#endif
+
+} // namespace sheaf
@@ -0,0 +1,134 @@
+/**
+ * @file generalized_sheaf_learner.hpp
+ * @brief Generalized Sheaf Learner - automatic patch discovery
+ *
+ * This is the C++ port of sheaf_compiler/generalized_sheaf_learner.py.
+ * Instead of receiving hand-built patches, it takes a flat stream of
+ * samples and a conditioning function, partitions the samples into patches
+ * by the key the function returns, and hands the result to the
+ * UnifiedSheafLearner.
+ *
+ * Built for ingesting large volumes of unlabeled telemetry:
+ * - Keys are computed and hash-partitioned in parallel (see parallel.hpp).
+ * - Patches reference the caller's samples (PatchView); nothing is copied.
+ * - predict_batch() routes each sample to its patch and predicts in parallel.
+ *
+ * Difference from the Python version: the conditioning function sees only
+ * the sample V, not its target, so the same function can route samples at
+ * prediction time when no target exists.
+ */
+
+#pragma once
+
+#include "unified_sheaf_learner.hpp"
+
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sheaf {
+
+/**
+ * @brief Maps a sample to the name of the patch it belongs to
+ *
+ * Called concurrently from several threads; must be thread-safe.
+ */
+using ConditioningFunction = std::function<std::string(const Matrix& V)>;
+
+/**
+ * @brief Settings shared by every discovered patch
+ *
+ * n_positions is taken from the patch's first sample, as in Python.
+ */
+struct GeneralizedConfig {
+    size_t n_characters = 1;
+    size_t d_model = 1;
+    std::vector<GluingConstraint> gluings;  // Between discovered patch names
+};
+
+/**
+ * @brief Samples assigned to one patch, as indices into the input stream
+ */
+struct SamplePartition {
+    std::string key;
+    std::vector<size_t> indices;  // Ascending
+};
+
+/**
+ * @brief Generalized Sheaf Learner
+ */
+class GeneralizedSheafLearner {
+public:
+    /**
+     * @brief Construct learner
+     *
+     * @param verbose Print partition summary and solver progress
+     * @param n_threads Worker threads for partitioning and batched predict
+     *                  (0 = hardware concurrency)
+     */
+    explicit GeneralizedSheafLearner(bool verbose = false, size_t n_threads = 0);
+
+    /**
+     * @brief Partition samples by conditioning key, then solve
+     *
+     * Patches appear in order of their first sample, matching the insertion
+     * order of the Python dictionary. The samples are only referenced
+     * during the call.
+     *
+     * @param V_samples Input samples, each [n_positions, d_model]
+     * @param targets Targets, one per sample
+     * @param config Character count, d_model and gluings
+     * @param conditioning Sample -> patch name
+     * @return Solution of the unified solver
+     */
+    SheafSolution fit(
+        std::span<const Matrix> V_samples,
+        std::span<const Matrix> targets,
+        const GeneralizedConfig& config,
+        ConditioningFunction conditioning
+    );
+
+    /**
+     * @brief Predict one sample, routed by the conditioning function
+     *
+     * @throws std::out_of_range if the sample's key matches no fitted patch
+     */
+    Matrix predict(const Matrix& V) const;
+
+    /**
+     * @brief Predict many samples in parallel, each routed to its patch
+     */
+    std::vector<Matrix> predict_batch(std::span<const Matrix> V_samples) const;
+
+    /**
+     * @brief Partition computed by the last fit()
+     */
+    const std::vector<SamplePartition>& partitions() const { return partitions_; }
+
+    /**
+     * @brief Underlying unified solver (weights, statistics)
+     */
+    const UnifiedSheafLearner& unified_learner() const { return unified_; }
+
+    bool is_fitted() const { return unified_.is_fitted(); }
+
+private:
+    bool verbose_;
+    size_t n_threads_;
+    UnifiedSheafLearner unified_;
+    ConditioningFunction conditioning_;
+    std::vector<SamplePartition> partitions_;
+
+    /**
+     * @brief Parallel hash partition of the sample stream by conditioning key
+     *
+     * Pass 1 computes every key and its hash in parallel chunks. In pass 2
+     * each worker owns the keys whose hash maps to it, so it can group its
+     * samples without locks; the owned groups are then merged and ordered
+     * by first occurrence.
+     */
+    std::vector<SamplePartition> partition(std::span<const Matrix> V_samples) const;
+};
+
+} // namespace sheaf
@@ -0,0 +1,210 @@
+/**
+ * @file ntt.hpp
+ * @brief Exact cyclic-group characters over Z_q (number-theoretic transform)
+ *
+ * In the FHE and integer settings the characters of C_n take values in
+ * Z_q, not ℂ: for a prime q with n | q-1 there is an element ω of order
+ * exactly n, and χ_j(g^k) = ω^{jk} mod q satisfies the same orthogonality
+ * relations as the complex table. Everything CyclicGroupCharacters does
+ * with complex_t - decomposition, reconstruction, convolution - then holds
+ * bit-exactly in modular arithmetic, with no FPU.
+ *
+ * Arithmetic uses 32-bit Montgomery multiplication (q odd, q < 2^31).
+ * Power-of-two orders run an iterative radix-2 NTT whose twiddles are
+ * stored contiguously per stage, so each butterfly pass is a branch-free
+ * unit-stride loop the compiler vectorizes. Other orders go through
+ * Bluestein's chirp-z convolution on a power-of-two NTT of length
+ * M >= 2n-1, exactly as FourierPlan does over ℂ; that needs an element of
+ * order 2n and M | q-1. Orders where Z_q has neither (for the default q:
+ * n = odd · 2^23) fall back to the exact O(n^2) character sum.
+ *
+ * This is a standalone transform: the learner fits complex least squares,
+ * so it is not a SymmetryGroup and UnifiedSheafLearner cannot select it.
+ *
+ * Sign conventions match CyclicGroupCharacters / FourierPlan:
+ *   transform:  X_j = Σ_m ω^{jm} x_m
+ *   inverse:    x_m = n^{-1} Σ_j ω^{-jm} X_j     (normalized)
+ *
+ * Values are canonical residues in [0, q).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace sheaf {
+
+/**
+ * @brief Prime field Z_q with Montgomery multiplication (R = 2^32)
+ */
+class MontgomeryField {
+public:
+    /**
+     * @throws std::invalid_argument unless q is an odd prime below 2^31
+     */
+    explicit MontgomeryField(uint32_t q);
+
+    uint32_t modulus() const { return q_; }
+
+    uint32_t add(uint32_t a, uint32_t b) const {
+        const uint32_t s = a + b;
+        return s >= q_ ? s - q_ : s;
+    }
+
+    uint32_t sub(uint32_t a, uint32_t b) const {
+        return a >= b ? a - b : a + q_ - b;
+    }
+
+    /**
+     * @brief REDC: t · 2^{-32} mod q, for t < q · 2^32
+     */
+    uint32_t reduce(uint64_t t) const {
+        const uint32_t m = static_cast<uint32_t>(t) * q_inv_neg_;
+        const uint32_t r = static_cast<uint32_t>((t + static_cast<uint64_t>(m) * q_) >> 32);
+        return r >= q_ ? r - q_ : r;
+    }
+
+    /**
+     * @brief a · b mod q where b is in Montgomery form (result is plain)
+     */
+    uint32_t mul_mont(uint32_t a, uint32_t b_mont) const {
+        return reduce(static_cast<uint64_t>(a) * b_mont);
+    }
+
+    uint32_t to_mont(uint32_t a) const { return reduce(static_cast<uint64_t>(a) * r2_); }
+
+    uint32_t mul(uint32_t a, uint32_t b) const { return mul_mont(a, to_mont(b)); }
+
+    uint32_t pow(uint32_t a, uint64_t e) const;
+
+    /**
+     * @brief Multiplicative inverse (a != 0)
+     */
+    uint32_t inv(uint32_t a) const { return pow(a, q_ - 2); }
+
+    /**
+     * @brief Reduce a signed integer into [0, q)
+     */
+    uint32_t from_int(int64_t v) const;
+
+    /**
+     * @brief Centered representative in (-q/2, q/2]
+     */
+    int64_t to_int(uint32_t a) const {
+        return a > q_ / 2 ? static_cast<int64_t>(a) - q_ : static_cast<int64_t>(a);
+    }
+
+    /**
+     * @brief Generator of Z_q^* (found by factoring q - 1)
+     */
+    uint32_t primitive_root() const;
+
+private:
+    uint32_t q_;
+    uint32_t q_inv_neg_;   // -q^{-1} mod 2^32
+    uint32_t r2_;          // 2^64 mod q
+};
+
+/**
+ * @brief Characters of C_n with values in Z_q
+ */
+class NttCyclicGroupCharacters {
+public:
+    /// 119 · 2^23 + 1: supports power-of-two orders up to 2^23 (and 7, 17, ... | q-1)
+    static constexpr uint32_t kDefaultModulus = 998244353;
+
+    /**
+     * @brief Construct the character table of C_n over Z_q
+     *
+     * @param n Group order; must divide q - 1
+     * @param q NTT-friendly prime
+     * @throws std::invalid_argument if q is unsuitable or n does not divide q - 1
+     */
+    explicit NttCyclicGroupCharacters(size_t n, uint32_t q = kDefaultModulus);
+
+    size_t order() const { return n_; }
+    const MontgomeryField& field() const { return field_; }
+
+    /**
+     * @brief ω, an element of order exactly n
+     */
+    uint32_t root() const { return root_; }
+
+    /**
+     * @brief χ_j(g^k) = ω^{jk} mod q
+     */
+    uint32_t character(size_t j, size_t k) const;
+
+    /**
+     * @brief In-place transform of n contiguous residues
+     *
+     * Allocation-free for power-of-two orders; O(n log n) whenever Bluestein
+     * applies, O(n^2) otherwise.
+     */
+    void forward(uint32_t* x) const;
+
+    /**
+     * @brief In-place normalized inverse transform
+     */
+    void inverse(uint32_t* x) const;
+
+    /**
+     * @brief Transform each column of V ([n, d_model], column-major)
+     */
+    std::vector<uint32_t> transform(std::span<const uint32_t> V, size_t d_model = 1) const;
+
+    /**
+     * @brief Inverse of transform()
+     */
+    std::vector<uint32_t> inverse_transform(std::span<const uint32_t> X, size_t d_model = 1) const;
+
+    /**
+     * @brief Exact projections Proj_{χ_j}(V)[i] = n^{-1} ω^{-ij} X_j
+     *
+     * @param V [n, d_model] residues, column-major
+     * @return n projections, each [n, d_model]; they sum to V exactly
+     */
+    std::vector<std::vector<uint32_t>> decompose_into_characters(
+        std::span<const uint32_t> V, size_t d_model = 1) const;
+
+    /**
+     * @brief Σ_j coefficients[j] · projections[j] mod q
+     */
+    std::vector<uint32_t> reconstruct_from_characters(
+        std::span<const uint32_t> coefficients,
+        const std::vector<std::vector<uint32_t>>& projections) const;
+
+    /**
+     * @brief Exact cyclic convolution (a * b)[k] = Σ_m a[m] b[k - m mod n]
+     */
+    std::vector<uint32_t> convolve(std::span<const uint32_t> a, std::span<const uint32_t> b) const;
+
+private:
+    size_t n_;
+    MontgomeryField field_;
+    uint32_t root_;
+    uint32_t n_inv_mont_;                 // n^{-1}, Montgomery form
+    bool pow2_;
+
+    std::vector<uint32_t> powers_mont_;   // ω^k, Montgomery form, k < n
+    std::vector<uint32_t> stage_tw_;      // ω twiddles, stage after stage, Montgomery form
+    std::vector<uint32_t> stage_tw_inv_;  // Same for ω^{-1}
+    std::vector<uint32_t> bitrev_;
+
+    // Bluestein path (null inner_: direct character sum)
+    std::vector<uint32_t> chirp_mont_;       // ψ^{k²}, ψ² = ω, k < n, Montgomery form
+    std::vector<uint32_t> chirp_inv_mont_;   // ψ^{-k²}
+    std::vector<uint32_t> kernel_mont_;      // Padded ψ^{-k²} kernel, transformed, scaled by M^{-1}
+    std::vector<uint32_t> kernel_inv_mont_;  // Same for ψ^{k²}
+    std::shared_ptr<const NttCyclicGroupCharacters> inner_;  // Power-of-two order M >= 2n-1
+
+    void radix2(uint32_t* x, const uint32_t* twiddles) const;
+    void bluestein(uint32_t* x, bool inverse_sign) const;
+    void direct(uint32_t* x, bool inverse_sign) const;
+};
+
+} // namespace sheaf
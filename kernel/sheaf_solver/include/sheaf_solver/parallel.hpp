@@ -0,0 +1,86 @@
+/**
+ * @file parallel.hpp
+ * @brief Minimal fork-join helper over std::thread
+ *
+ * parallel_for() splits an index range into one contiguous chunk per worker,
+ * runs the first chunk on the calling thread and the rest on short-lived
+ * std::threads, and joins before returning. There is no pool: the callers
+ * (partitioning millions of samples, batched predict) do enough work per
+ * call that thread start-up is noise. Each chunk is traced as a "task" span.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace sheaf {
+
+/**
+ * @brief Number of workers to use for n_items (requested == 0 means "all cores")
+ */
+inline std::size_t resolve_thread_count(std::size_t requested, std::size_t n_items) {
+    std::size_t n = requested;
+    if (n == 0) {
+        n = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<std::size_t>(1, std::min(n, n_items));
+}
+
+/**
+ * @brief Run fn(begin, end, worker) over [0, n) in contiguous chunks
+ *
+ * Worker w always receives chunk w, so per-worker output slots can be
+ * indexed by the worker id without synchronization. If any worker throws,
+ * the first exception is rethrown on the calling thread after all joined.
+ *
+ * @param n Number of items
+ * @param n_threads Requested workers (0 = hardware concurrency)
+ * @param fn Callable as fn(size_t begin, size_t end, size_t worker)
+ */
+template<typename Fn>
+void parallel_for(std::size_t n, std::size_t n_threads, Fn&& fn) {
+    if (n == 0) {
+        return;
+    }
+    const std::size_t n_workers = resolve_thread_count(n_threads, n);
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto run_chunk = [&](std::size_t worker) {
+        const std::size_t begin = n * worker / n_workers;
+        const std::size_t end = n * (worker + 1) / n_workers;
+        try {
+            SHEAF_TRACE_SCOPE("task", "parallel");
+            fn(begin, end, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_workers - 1);
+    for (std::size_t w = 1; w < n_workers; ++w) {
+        threads.emplace_back(run_chunk, w);
+    }
+    run_chunk(0);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace sheaf
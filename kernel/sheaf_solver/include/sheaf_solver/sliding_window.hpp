@@ -0,0 +1,105 @@
+/**
+ * @file sliding_window.hpp
+ * @brief Sliding character transform for streaming sequences
+ *
+ * Keeps the character spectrum X_j = Σ_m ω^{jm} W[m] of the last n samples
+ * W[0..n-1] (oldest first) up to date as new samples arrive. Dropping W[0]
+ * and appending x shifts every position down by one, which multiplies each
+ * character coefficient by ω^{-j}:
+ *
+ *   X'_j = ω^{-j} (X_j - W[0] + x)
+ *
+ * so a new sample costs O(n·d_model) instead of a fresh decomposition.
+ * Rounding errors accumulate slowly through the twiddle products; every
+ * resync_interval samples the spectrum is recomputed exactly from the
+ * stored window with an FFT, which bounds the drift.
+ *
+ * Before n samples have arrived the missing (oldest) positions are zero,
+ * exactly as the scheduler pads short histories.
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "fft.hpp"
+
+#include <vector>
+
+namespace sheaf {
+
+class SlidingCharacterWindow {
+public:
+    /**
+     * @brief Empty (all-zero) window
+     *
+     * @param n Window length / group order
+     * @param d_model Values per sample
+     * @param resync_interval Samples between exact recomputations (0 = never)
+     */
+    explicit SlidingCharacterWindow(size_t n, size_t d_model = 1, size_t resync_interval = 1024);
+
+    size_t order() const { return n_; }
+    size_t d_model() const { return d_model_; }
+
+    /**
+     * @brief Samples pushed since construction or the last reset()
+     */
+    size_t count() const { return count_; }
+
+    /**
+     * @brief True once n samples have arrived (no zero padding left)
+     */
+    bool full() const { return count_ >= n_; }
+
+    /**
+     * @brief Replace the window ([n, d_model], oldest first) and transform it exactly
+     */
+    void reset(const Matrix& window);
+
+    /**
+     * @brief Append one sample (d_model values) and update the spectrum in O(n·d)
+     */
+    void push(const complex_t* sample);
+
+    /**
+     * @brief Append one scalar sample (d_model == 1)
+     */
+    void push(complex_t sample);
+
+    /**
+     * @brief Recompute the spectrum exactly from the stored window
+     */
+    void resync();
+
+    /**
+     * @brief Current spectrum [n, d_model]: row j is X_j
+     */
+    const Matrix& spectrum() const { return spectrum_; }
+
+    /**
+     * @brief Current window [n, d_model], oldest first
+     */
+    Matrix window() const;
+
+    /**
+     * @brief Proj_{χ_j}(window) without materializing the other characters
+     *
+     * Same result as CyclicGroupCharacters::project_onto_character(window(), j).
+     */
+    Matrix projection(size_t j) const;
+
+private:
+    size_t n_;
+    size_t d_model_;
+    size_t resync_interval_;
+    size_t count_ = 0;
+    size_t since_resync_ = 0;
+    size_t oldest_ = 0;                 // Ring index of W[0]
+
+    FourierPlan plan_;
+    std::vector<complex_t> shift_;      // ω^{-j}
+    Matrix ring_;                       // Samples, ring-ordered [n, d_model]
+    Matrix spectrum_;                   // X [n, d_model]
+};
+
+} // namespace sheaf
@@ -0,0 +1,90 @@
+/**
+ * @file symmetry_group.hpp
+ * @brief Common interface for the symmetry group a patch is learned under
+ *
+ * The learner only needs a few things from a group: its order, the
+ * projections of a sample onto the isotypic components of its irreducible
+ * representations, and - for abelian groups - the character values (to
+ * fold the weights into spectral form for predict_spectrum()).
+ *
+ * Which group a patch uses is part of its PatchConfig:
+ *   - SymmetryKind::Abelian, group_shape empty (or one axis): C_{n_positions}
+ *   - SymmetryKind::Abelian, several axes: C_{n_0} × C_{n_1} × ... acting on
+ *     a row-major flattened grid
+ *   - SymmetryKind::Wreath, group_shape {m, n}: C_m ≀ C_n
+ */
+
+#pragma once
+
+#include "types.hpp"
+
+#include <memory>
+#include <span>
+
+namespace sheaf {
+
+class SymmetryGroup {
+public:
+    virtual ~SymmetryGroup() = default;
+
+    /**
+     * @brief Number of group elements
+     */
+    virtual size_t order() const = 0;
+
+    /**
+     * @brief Number of irreducible representations (= order() when abelian)
+     */
+    virtual size_t n_irreps() const { return order(); }
+
+    /**
+     * @brief True when every irreducible representation is one-dimensional
+     */
+    virtual bool is_abelian() const { return true; }
+
+    /**
+     * @brief Character of irrep j evaluated on group element k (flat indices)
+     */
+    virtual complex_t character(size_t j, size_t k) const = 0;
+
+    /**
+     * @brief Projections of V onto every isotypic component; they sum to V
+     */
+    virtual std::vector<Matrix> decompose_into_characters(const Matrix& V) const = 0;
+
+    /**
+     * @brief Projections onto selected irreps from a single transform
+     *
+     * Entry p * characters.size() + i is Proj_{ρ_c}(V)(p, 0) with
+     * c = characters[i]. Only the listed projections are evaluated.
+     *
+     * @param V Sample with order() rows (column 0 is used)
+     * @throws std::invalid_argument if V does not have order() rows
+     * @throws std::out_of_range for a character index >= n_irreps()
+     */
+    virtual Vector selected_projection_features(
+        const Matrix& V, std::span<const size_t> characters) const = 0;
+
+    /**
+     * @brief Learner features of one sample
+     *
+     * Entry p * n_characters + j is Proj_{ρ_j}(V)(p, 0), for j below
+     * min(n_characters, n_irreps()); the rest are zero.
+     */
+    Vector projection_features(const Matrix& V, size_t n_characters) const;
+};
+
+/**
+ * @brief Build the group described by a patch configuration
+ *
+ * @throws std::invalid_argument if the group order does not match
+ *         n_positions
+ */
+std::unique_ptr<SymmetryGroup> make_symmetry_group(const PatchConfig& config);
+
+/**
+ * @brief Validated group_shape of a configuration ({n_positions} when cyclic)
+ */
+std::vector<size_t> symmetry_group_shape(const PatchConfig& config);
+
+} // namespace sheaf
@@ -0,0 +1,164 @@
+/**
+ * @file trace.hpp
+ * @brief Scoped execution tracing with Chrome Trace Event / Perfetto export
+ *
+ * Spans are recorded per phase (via PhaseTimer), per patch and per executor
+ * task into per-thread buffers. Each buffer has a single writer (its owning
+ * thread) and is published with a release store, so recording never takes
+ * a lock; the only lock is taken once per thread, when its buffer is
+ * registered. Full buffers drop new spans and count the drops instead of
+ * wrapping, so a concurrent dump always reads complete events.
+ *
+ * Tracing exists only when the library is built with SHEAF_SOLVER_TRACE
+ * (CMake option of the same name). Otherwise the SHEAF_TRACE_* macros expand
+ * to nothing. In a tracing build, recording is further gated at runtime by
+ * trace::set_enabled() and is off until a caller turns it on.
+ *
+ * Usage:
+ *   sheaf::trace::set_enabled(true);
+ *   learner.fit(problem);
+ *   sheaf::trace::write_chrome_trace("fit.json");   // open in ui.perfetto.dev
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#ifdef SHEAF_SOLVER_TRACE
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#endif
+
+namespace sheaf {
+namespace trace {
+
+#ifdef SHEAF_SOLVER_TRACE
+
+constexpr std::size_t kMaxArgLength = 31;         // Bytes of span argument kept
+constexpr std::size_t kEventsPerThread = 1 << 16; // Spans buffered per thread
+
+/**
+ * @brief One completed span
+ */
+struct Event {
+    const char* name;        // Must be a string literal (stored by pointer)
+    const char* category;    // Must be a string literal (stored by pointer)
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    char arg[kMaxArgLength + 1];  // Optional argument, e.g. the patch name
+};
+
+/**
+ * @brief Monotonic clock shared by spans and PhaseTimer
+ */
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+}
+
+/**
+ * @brief Turn recording on or off at runtime
+ */
+void set_enabled(bool enabled);
+
+/**
+ * @brief Whether spans are currently being recorded
+ */
+inline bool enabled() {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Name the calling thread in the exported trace (e.g. "worker 3")
+ */
+void set_thread_name(const std::string& name);
+
+/**
+ * @brief Record a completed span on the calling thread's buffer
+ */
+void record(const char* name, const char* category,
+            uint64_t begin_ns, uint64_t end_ns, const char* arg = nullptr);
+
+/**
+ * @brief Drop all recorded spans (buffers stay registered)
+ *
+ * Must not race with recording threads.
+ */
+void clear();
+
+/**
+ * @brief Spans dropped because a thread's buffer was full
+ */
+uint64_t dropped();
+
+/**
+ * @brief Write all recorded spans as Chrome Trace Event JSON
+ */
+void write_chrome_trace(std::ostream& out);
+
+/**
+ * @brief Write the trace to a file
+ * @return false if the file could not be opened
+ */
+bool write_chrome_trace(const std::string& path);
+
+/**
+ * @brief RAII span: records [construction, destruction) when tracing is on
+ */
+class Scope {
+public:
+    Scope(const char* name, const char* category, const char* arg = nullptr)
+        : name_(name)
+        , category_(category)
+        , arg_(arg)
+        , begin_(enabled() ? now_ns() : 0)
+    {}
+
+    Scope(const char* name, const char* category, const std::string& arg)
+        : Scope(name, category, arg.c_str())
+    {}
+
+    ~Scope() {
+        if (begin_ != 0) {
+            record(name_, category_, begin_, now_ns(), arg_);
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    const char* arg_;   // Copied into the event at destruction; must outlive the scope
+    uint64_t begin_;
+};
+
+#define SHEAF_TRACE_CONCAT_INNER(a, b) a##b
+#define SHEAF_TRACE_CONCAT(a, b) SHEAF_TRACE_CONCAT_INNER(a, b)
+
+/// Trace the enclosing scope as a span
+#define SHEAF_TRACE_SCOPE(name, category) \
+    ::sheaf::trace::Scope SHEAF_TRACE_CONCAT(sheaf_trace_scope_, __LINE__)((name), (category))
+
+/// Trace the enclosing scope with a string argument (e.g. patch name)
+#define SHEAF_TRACE_SCOPE_ARG(name, category, arg) \
+    ::sheaf::trace::Scope SHEAF_TRACE_CONCAT(sheaf_trace_scope_, __LINE__)((name), (category), (arg))
+
+#else
+
+#define SHEAF_TRACE_SCOPE(name, category) ((void)0)
+#define SHEAF_TRACE_SCOPE_ARG(name, category, arg) ((void)0)
+
+#endif // SHEAF_SOLVER_TRACE
+
+} // namespace trace
+} // namespace sheaf
@@ -0,0 +1,193 @@
+/**
+ * @file transport.hpp
+ * @brief Point-to-point messages between solver processes
+ *
+ * A Transport connects `size()` ranks (processes, possibly on different
+ * boards). Messages are vectors of complex_t, delivered in order per
+ * (sender, receiver) pair. send() may block until the receiver drains
+ * enough of the message, so callers must not have two ranks sending to
+ * each other at once - exchange() orders the pairs so that never happens.
+ *
+ * Two implementations:
+ *   - ShmRingTransport: one single-producer/single-consumer byte ring per
+ *     ordered pair in a shared anonymous mapping. The segment has to be
+ *     created before the worker processes are forked.
+ *   - SocketTransport: a full mesh of TCP connections (loopback for tests,
+ *     IPv4 addresses between boards of the same byte order).
+ */
+
+#pragma once
+
+#include "types.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sheaf {
+
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual size_t rank() const = 0;
+    virtual size_t size() const = 0;
+
+    /**
+     * @brief Send one message to `peer` (blocks while the channel is full)
+     */
+    virtual void send(size_t peer, std::span<const complex_t> message) = 0;
+
+    /**
+     * @brief Next message from `peer` (blocks until it has fully arrived)
+     *
+     * @throws std::runtime_error after the transport's timeout
+     */
+    virtual std::vector<complex_t> receive(size_t peer) = 0;
+
+    /**
+     * @brief Swap one message with each peer
+     *
+     * Every rank walks its peers in ascending order; with each peer the
+     * lower rank sends first. All ranks thus handle the pairs in the same
+     * global order, which is deadlock free even when send() only returns
+     * after the peer has read the whole message.
+     *
+     * @param peers Distinct ranks other than this one, ascending; every
+     *              listed peer must list this rank in its own call
+     * @param outgoing One message per peer
+     * @return One message per peer, in the order of `peers`
+     */
+    std::vector<std::vector<complex_t>> exchange(
+        std::span<const size_t> peers,
+        const std::vector<std::vector<complex_t>>& outgoing
+    );
+
+    /**
+     * @brief Element-wise sum over all ranks, identical on every rank
+     *
+     * Rank 0 adds the contributions in rank order and sends the total back,
+     * so every rank sees bit-identical values.
+     */
+    void allreduce_sum(std::span<complex_t> values);
+
+    /**
+     * @brief Payload bytes this rank has sent
+     */
+    uint64_t bytes_sent() const { return bytes_sent_; }
+
+protected:
+    uint64_t bytes_sent_ = 0;
+
+    void check_peer(size_t peer) const;
+};
+
+/**
+ * @brief Byte rings in memory shared by forked processes
+ */
+class ShmRingTransport : public Transport {
+public:
+    /**
+     * @brief size² rings of ring_bytes each in a MAP_SHARED | MAP_ANONYMOUS
+     * mapping; create before fork(), then one transport per process
+     */
+    class Segment {
+    public:
+        Segment(size_t n_ranks, size_t ring_bytes);
+        ~Segment();
+        Segment(const Segment&) = delete;
+        Segment& operator=(const Segment&) = delete;
+
+        size_t n_ranks() const { return n_ranks_; }
+        size_t ring_bytes() const { return ring_bytes_; }
+
+    private:
+        friend class ShmRingTransport;
+        struct Ring;
+
+        void* base_ = nullptr;
+        size_t mapped_bytes_ = 0;
+        size_t n_ranks_;
+        size_t ring_bytes_;
+        size_t stride_;              // Bytes per ring, header included
+
+        Ring& ring(size_t from, size_t to) const;
+    };
+
+    ShmRingTransport(
+        std::shared_ptr<Segment> segment,
+        size_t rank,
+        std::chrono::milliseconds timeout = std::chrono::seconds(60)
+    );
+
+    size_t rank() const override { return rank_; }
+    size_t size() const override { return segment_->n_ranks(); }
+    void send(size_t peer, std::span<const complex_t> message) override;
+    std::vector<complex_t> receive(size_t peer) override;
+
+private:
+    std::shared_ptr<Segment> segment_;
+    size_t rank_;
+    std::chrono::milliseconds timeout_;
+
+    void write(Segment::Ring& ring, const std::byte* data, size_t n);
+    void read(Segment::Ring& ring, std::byte* data, size_t n);
+};
+
+/**
+ * @brief IPv4 endpoint of one rank
+ */
+struct SocketAddress {
+    std::string host = "127.0.0.1";
+    uint16_t port = 0;
+};
+
+/**
+ * @brief Full mesh of TCP connections, one per pair of ranks
+ */
+class SocketTransport : public Transport {
+public:
+    /**
+     * @brief Bind and listen on `address`; port 0 picks a free port and
+     * writes it back
+     *
+     * @return The listening descriptor, for the constructor
+     */
+    static int listen(SocketAddress& address);
+
+    /**
+     * @brief Connect to every lower rank and accept every higher one
+     *
+     * @param addresses One per rank
+     * @param listen_fd This rank's socket from listen() (adopted), or -1 to
+     *                  listen on addresses[rank] here
+     */
+    SocketTransport(
+        size_t rank,
+        std::vector<SocketAddress> addresses,
+        int listen_fd = -1,
+        std::chrono::milliseconds timeout = std::chrono::seconds(60)
+    );
+    ~SocketTransport() override;
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    size_t rank() const override { return rank_; }
+    size_t size() const override { return fds_.size(); }
+    void send(size_t peer, std::span<const complex_t> message) override;
+    std::vector<complex_t> receive(size_t peer) override;
+
+private:
+    size_t rank_;
+    std::vector<int> fds_;           // Connected socket per peer, -1 for self
+    std::chrono::milliseconds timeout_;
+
+    void write_all(int fd, const void* data, size_t n);
+    void read_all(int fd, void* data, size_t n);
+};
+
+} // namespace sheaf
@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <complex>
+#include <limits>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -20,6 +21,8 @@
 #include <Eigen/Dense>
 #endif
 
+#include "fit_stats.hpp"
+
 namespace sheaf {
 
 // Fundamental types
@@ -65,11 +68,20 @@ using RealMatrix = BasicMatrix<real_t>;
 using RealVector = BasicVector<real_t>;
 #endif
 
+// Symmetry group family of a patch (see symmetry_group.hpp)
+enum class SymmetryKind {
+    Abelian,   // C_{n_0} × C_{n_1} × ... (a single axis is the cyclic group)
+    Wreath     // C_m ≀ C_n with group_shape = {m, n}
+};
+
 // Problem configuration
 struct PatchConfig {
     size_t n_positions;    // Sequence length
     size_t n_characters;   // Number of character projections to use
     size_t d_model;        // Embedding dimension (typically 1 for simple problems)
+    std::vector<size_t> group_shape = {};  // Abelian: C_{n_0} × C_{n_1} × ... over a row-major
+                                           // grid of n_positions cells; empty = C_{n_positions}
+    SymmetryKind group_kind = SymmetryKind::Abelian;
 };
 
 // Patch data for sheaf learning
@@ -80,12 +92,22 @@ struct Patch {
     PatchConfig config;
 };
 
+// Non-owning view of a patch: samples are referenced, not copied.
+// The referenced matrices must outlive the fit() call that uses the view.
+struct PatchView {
+    std::string name;
+    std::vector<const Matrix*> V_samples;
+    std::vector<const Matrix*> targets;
+    PatchConfig config;
+};
+
 // Gluing constraint between two patches
 struct GluingConstraint {
     std::string patch_1;
     std::string patch_2;
     Matrix constraint_data_1;  // Data point from patch 1
     Matrix constraint_data_2;  // Data point from patch 2
+    real_t weight = 1.0;       // Row weight relative to data rows; HARD_GLUING = exact
 };
 
 // Solution structure
@@ -93,10 +115,12 @@ struct SheafSolution {
     std::unordered_map<std::string, Matrix> weights;  // Learned weights per patch
     real_t residual_error;                            // Cohomological obstruction
     bool converged;
+    FitStats stats;                                   // Phase timings and counters
 };
 
 // Constants
 constexpr real_t PI = 3.14159265358979323846;
 constexpr real_t EPSILON = 1e-12;
+constexpr real_t HARD_GLUING = std::numeric_limits<real_t>::infinity();
 
 } // namespace sheaf
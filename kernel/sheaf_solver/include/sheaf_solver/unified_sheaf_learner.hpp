@@ -24,7 +24,13 @@
 
 #include "types.hpp"
 #include "cyclic_group.hpp"
+#include "symmetry_group.hpp"
+#include "block_graph_solver.hpp"
+#include <atomic>
+#include <map>
 #include <memory>
+#include <span>
+#include <utility>
 
 namespace sheaf {
 
@@ -36,6 +42,168 @@ struct SheafProblem {
     std::vector<GluingConstraint> gluings;
 };
 
+/**
+ * @brief Problem definition over patch views (samples owned elsewhere)
+ */
+struct SheafProblemView {
+    std::vector<PatchView> patches;
+    std::vector<GluingConstraint> gluings;
+};
+
+/**
+ * @brief Row compression applied while building the local systems
+ *
+ * Samples whose feature rows coincide are merged into one row weighted by
+ * the group size, carrying the mean target. With quantum = 0 only exact
+ * duplicates merge and the fit is unchanged. With quantum > 0 rows whose
+ * features (real and imaginary parts) fall in the same quantum-wide cell
+ * merge into their mean, moving each feature by less than quantum · sqrt(2)
+ * and so each prediction by less than quantum · sqrt(2) · ||w||_1.
+ */
+struct RowCompression {
+    bool enabled = false;
+    real_t quantum = 0.0;
+};
+
+/**
+ * @brief What row compression did in the last fit
+ */
+struct RowCompressionReport {
+    size_t rows_in = 0;                  // Samples over all patches
+    size_t rows_out = 0;                 // Rows handed to the solver
+    real_t max_feature_deviation = 0.0;  // Largest |a_i - group mean| seen (quantized only)
+    real_t within_group_residual = 0.0;  // Σ |t_i - t̄|^2, included in every residual
+};
+
+/**
+ * @brief Options for UnifiedSheafLearner::fit_iterative()
+ */
+struct IterativeOptions {
+    real_t tolerance = 1e-10;        // ||c - N w|| / ||c|| on the normal equations
+    size_t max_iterations = 1000;
+    bool multigrid = true;           // false = block Jacobi (one patch per block)
+    size_t multigrid_min_patches = 24;  // Below this, block Jacobi: setup costs more than it saves
+    MultigridOptions multigrid_options;
+};
+
+/**
+ * @brief Result of UnifiedSheafLearner::fit_iterative()
+ */
+struct IterativeFit {
+    SheafSolution solution;
+    size_t iterations = 0;
+    real_t relative_residual = 0.0;
+    bool converged = false;
+    std::vector<size_t> level_sizes;     // Multigrid unknowns per level, finest first
+};
+
+/**
+ * @brief Options for UnifiedSheafLearner::fit_many()
+ */
+struct BatchFitOptions {
+    size_t n_threads = 0;            // 0 = all cores
+    bool batched = true;             // false = one fit() per problem (reference path)
+};
+
+/**
+ * @brief Result of UnifiedSheafLearner::fit_many()
+ */
+struct BatchFit {
+    std::vector<SheafSolution> solutions;   // One per problem, in order (stats left empty)
+    size_t batched = 0;              // Solved through the lockstep Cholesky
+    size_t fallback = 0;             // Solved one at a time by fit()
+    FitStats stats;                  // The whole call
+};
+
+/**
+ * @brief Featurized normal equations of a problem, left for another solver
+ */
+struct NormalEquations {
+    std::vector<std::pair<std::string, size_t>> layout;   // (patch, column offset)
+    Matrix gram;                     // A^H A + Σ weight · k^H k + ridge · I
+    Vector moment;                   // A^H b
+};
+
+/**
+ * @brief Grid for UnifiedSheafLearner::select_ridge()
+ */
+struct RidgeSelectionOptions {
+    std::vector<real_t> lambdas;     // Explicit grid; empty = geometric default below
+    size_t grid_points = 25;         // Default grid: from min_ratio · σ_max^2 ...
+    real_t min_ratio = 1e-10;
+    real_t max_ratio = 1.0;          // ... to max_ratio · σ_max^2
+};
+
+/**
+ * @brief Diagnostics of one ridge value
+ */
+struct RidgePoint {
+    real_t lambda;
+    real_t residual;                 // ||A w - b||^2, data and gluing rows
+    real_t gluing_obstruction;       // Gluing rows only
+    real_t loo_error;                // Mean squared leave-one-out error over data rows
+    real_t effective_dof;            // Σ σ_k^2 / (σ_k^2 + λ)
+};
+
+/**
+ * @brief Result of UnifiedSheafLearner::select_ridge()
+ */
+struct RidgeSelection {
+    std::vector<RidgePoint> path;    // In grid order
+    size_t best = 0;                 // Index of the smallest leave-one-out error
+    real_t best_lambda = 0.0;
+    SheafSolution solution;          // Fit at best_lambda
+};
+
+/**
+ * @brief Options for UnifiedSheafLearner::prune()
+ *
+ * The group-LASSO penalty λ Σ_g ||w_g|| groups the weights of one character
+ * of one patch (all positions). λ is given relative to λ_max, the smallest
+ * penalty at which every group is zero.
+ */
+struct PruningOptions {
+    real_t lambda = 0.0;         // Fraction of λ_max; 0 = search a path for `tolerance`
+    real_t tolerance = 1e-3;     // Allowed residual increase, relative to ||b||^2
+    size_t path_points = 20;     // Geometric path from λ_max down to 1e-4 λ_max
+    real_t convergence = 1e-8;   // Stop when no group moves by more than this (relative)
+    size_t max_sweeps = 500;     // Coordinate-descent sweeps per λ
+    bool refit = true;           // Re-solve least squares on the active characters
+};
+
+/**
+ * @brief One λ of the pruning path
+ */
+struct PruningPoint {
+    real_t lambda;               // Absolute penalty
+    size_t active_characters;    // Surviving (patch, character) groups
+    size_t active_weights;
+    real_t residual;             // ||A w - b||^2 of the (refitted) sparse weights
+    real_t relative_loss;        // (residual - dense residual) / ||b||^2
+    size_t sweeps;
+};
+
+/**
+ * @brief Speed/accuracy trade-off of a prune() call
+ */
+struct PruningReport {
+    std::vector<PruningPoint> path;  // In order of decreasing λ
+    size_t chosen = 0;               // Index into path of the applied model
+    size_t total_characters = 0;
+    size_t total_weights = 0;
+    real_t dense_residual = 0.0;
+    uint64_t dense_predict_flops = 0;    // Summed over patches, one sample each
+    uint64_t sparse_predict_flops = 0;
+};
+
+/**
+ * @brief Compact patch model: only the active characters are kept
+ */
+struct SparsePatchModel {
+    std::vector<size_t> characters;  // Active character indices, ascending
+    Matrix weights;                  // [n_positions, characters.size()]
+};
+
 /**
  * @brief Unified Sheaf Learner
  *
@@ -62,11 +230,149 @@ public:
      * The residual IS the cohomological obstruction.
      * Zero residual = perfect learnability.
      *
+     * Gluing rows enter with GluingConstraint::weight (rows scaled by
+     * sqrt(weight)). If any gluing is HARD_GLUING, the solve is instead
+     *
+     *   min ||A_local w - b_local||^2 + Σ_soft weight · |k_i w|^2
+     *   subject to k_j w = 0 for every hard gluing j
+     *
+     * through per-patch Cholesky factors and the Schur complement of the
+     * gluing rows (see reweight_gluings()).
+     *
      * @param problem Sheaf problem definition
      * @return Solution with learned weights and residual error
      */
     SheafSolution fit(const SheafProblem& problem);
 
+    /**
+     * @brief Fit a problem whose patches reference samples held elsewhere
+     *
+     * Same solve as fit(const SheafProblem&) without copying any sample.
+     */
+    SheafSolution fit(const SheafProblemView& problem);
+
+    /**
+     * @brief Fit by preconditioned CG on the patch graph instead of one
+     * dense factorization
+     *
+     * The normal equations N w = A^H b are kept block sparse - a block per
+     * patch and per glued pair - and never assembled densely. With
+     * options.multigrid the preconditioner is a BlockGraphMultigrid V-cycle
+     * over aggregates of neighbouring patches, which keeps the iteration
+     * count nearly flat as gluing chains grow; otherwise, and for graphs of
+     * fewer than options.multigrid_min_patches patches, block Jacobi.
+     * The learner ends up fitted as by fit().
+     *
+     * @throws std::invalid_argument if a gluing is HARD_GLUING
+     */
+    IterativeFit fit_iterative(const SheafProblem& problem, const IterativeOptions& options = {});
+    IterativeFit fit_iterative(const SheafProblemView& problem, const IterativeOptions& options = {});
+
+    /**
+     * @brief Fit many small independent problems in one call
+     *
+     * Per-call overhead dominates fit() on tiny problems, so the batch is
+     * solved stage by stage instead of problem by problem:
+     *
+     * 1. Samples of all problems are pooled per symmetry group and
+     *    featurized by one product with the group's character table
+     *    (abelian groups of order <= 64, where that beats an FFT per sample)
+     * 2. Each problem's Gram A^H A + Σ weight · k^H k + ridge · I is formed
+     * 3. Problems are grouped by system size and solved kBatchLanes at a
+     *    time by BatchedCholesky
+     *
+     * Stages 1 and 2 and the batches of stage 3 run on worker threads.
+     * Problems the batched path does not cover (hard gluings, row
+     * compression, larger or non-abelian groups, anything fit() would
+     * reject, a failed lane) go through fit() on their own learner with
+     * this learner's settings. Solutions match fit() up to rounding.
+     * The learner's own model is left untouched.
+     */
+    BatchFit fit_many(std::span<const SheafProblem> problems, const BatchFitOptions& options = {});
+
+    /**
+     * @brief Featurize a problem and return its normal equations unsolved
+     *
+     * For solvers that own the outer iteration (consensus_worker()): they
+     * add their own terms, solve, and hand the weights to install_weights().
+     *
+     * @throws std::invalid_argument if a gluing is HARD_GLUING
+     */
+    NormalEquations normal_equations(const SheafProblemView& problem);
+
+    /**
+     * @brief Feature row of V for a patch of the last normal_equations() or fit()
+     *
+     * @throws std::out_of_range for an unknown patch
+     */
+    Vector feature_row(const std::string& patch_name, const Matrix& V);
+
+    /**
+     * @brief Make w (in the layout of normal_equations()) the fitted solution
+     *
+     * The residual is that of the retained system: data rows plus weighted
+     * soft gluings.
+     */
+    SheafSolution install_weights(const Vector& w);
+
+    /**
+     * @brief Re-solve the last fit with new gluing weights
+     *
+     * A_sheaf is block diagonal apart from the gluing rows K, so with
+     * H = blockdiag(A_p^H A_p + ρI) the solution is w = H^{-1}(c - K^H μ),
+     * where μ solves a system the size of the number of gluings:
+     *
+     *   (K H^{-1} K^H + E) μ = K H^{-1} c,   E = diag(1 / weight)
+     *
+     * (0 on hard rows; weight-0 rows drop out). The per-patch factorizations
+     * and K H^{-1} K^H are computed once per fit and reused, so a reweight
+     * costs O(gluings^3 + weights · gluings) with no data row touched.
+     *
+     * @param weights One weight per gluing of the last fit (>= 0, or HARD_GLUING)
+     * @return The new solution (also installed as get_solution())
+     * @throws std::runtime_error if the model has not been fitted
+     * @throws std::invalid_argument on a size mismatch or a negative weight
+     */
+    SheafSolution reweight_gluings(const std::vector<real_t>& weights);
+
+    /**
+     * @brief Choose the ridge by leave-one-out error over a grid of λ
+     *
+     * Builds and assembles the system once and eigendecomposes its Gram
+     * A^H A = V diag(σ_k^2) V^H. With P = A V every λ reuses it:
+     *
+     *   w(λ) = V diag(1 / (σ_k^2 + λ)) P^H b
+     *   h_ii = Σ_k |P_ik|^2 / (σ_k^2 + λ)
+     *   LOO_i = (A w - b)_i / (1 - h_ii)
+     *
+     * so a grid point costs O(rows · weights) instead of a refit. The learner is
+     * left fitted at the best λ (as if by fit()) and keeps it as its ridge.
+     * With row compression on, a merged row is left out as a whole.
+     *
+     * @throws std::invalid_argument if a gluing is HARD_GLUING
+     */
+    RidgeSelection select_ridge(const SheafProblem& problem, const RidgeSelectionOptions& options = {});
+    RidgeSelection select_ridge(const SheafProblemView& problem, const RidgeSelectionOptions& options = {});
+
+    /**
+     * @brief Merge duplicate (or quantized) samples before solving
+     *
+     * @throws std::invalid_argument for a negative quantum
+     */
+    void set_row_compression(const RowCompression& compression);
+    const RowCompression& get_row_compression() const { return compression_; }
+
+    /**
+     * @brief Row counts of the last fit() or select_ridge()
+     */
+    const RowCompressionReport& get_compression_report() const { return compression_report_; }
+
+    /**
+     * @brief Ridge λ added to the normal equations by fit() (default 1e-8)
+     */
+    void set_ridge(real_t lambda);
+    real_t get_ridge() const { return lambda_ridge_; }
+
     /**
      * @brief Predict using learned solution
      *
@@ -76,6 +382,53 @@ public:
      */
     Matrix predict(const std::string& patch_name, const Matrix& V) const;
 
+    /**
+     * @brief Predict from a precomputed character spectrum in O(n_characters)
+     *
+     * The prediction is linear in the spectrum X of the sample:
+     * Σ_{p,j} w[p,j] (1/n) ω^{-pj} X_j = Σ_j g_j X_j, and fit() precomputes
+     * g per patch. Pair with SlidingCharacterWindow to predict on a stream
+     * without re-decomposing the window on every step. Only patches with an
+     * abelian symmetry group have this form.
+     *
+     * @param patch_name Name of patch to use
+     * @param spectrum Character transform of the sample [n_positions, >= 1]
+     *                 (e.g. SlidingCharacterWindow::spectrum(), or
+     *                 AbelianGroupCharacters::transform() for a product-group
+     *                 patch); column 0 is used
+     * @return Predicted output (same as predict() on the window)
+     * @throws std::invalid_argument for a patch with a non-abelian group
+     */
+    Matrix predict_spectrum(const std::string& patch_name, const Matrix& spectrum) const;
+
+    /**
+     * @brief Drop characters that barely contribute to the last fit
+     *
+     * Solves the group-LASSO
+     *
+     *   min_w ||A w - b||^2 + ρ||w||^2 + λ Σ_g ||w_g||
+     *
+     * over the system of the last fit() (ρ is the fit's ridge), one group per
+     * (patch, character), by block coordinate descent warm-started from the
+     * ridge solution. Each λ warm-starts the next along the path. The chosen
+     * model becomes the learner's solution: get_solution().weights keeps its
+     * dense shape with the pruned columns zero, and predict() only
+     * evaluates the active characters (see get_sparse_model()).
+     *
+     * With options.lambda = 0 the largest λ on the path whose residual
+     * increase stays within options.tolerance is chosen (or the smallest λ
+     * if none is).
+     *
+     * @throws std::runtime_error if the model has not been fitted or has
+     *         hard gluings
+     */
+    PruningReport prune(const PruningOptions& options = {});
+
+    /**
+     * @brief Compact model of a pruned patch, nullptr when the patch is dense
+     */
+    const SparsePatchModel* get_sparse_model(const std::string& patch_name) const;
+
     /**
      * @brief Get the last solution
      */
@@ -86,12 +439,101 @@ public:
      */
     bool is_fitted() const { return fitted_; }
 
+    /**
+     * @brief Phase timings and counters accumulated over predict() calls
+     *
+     * Fit statistics are returned in SheafSolution::stats instead.
+     */
+    FitStats get_predict_stats() const;
+
+    /**
+     * @brief Clear the accumulated predict() statistics
+     */
+    void reset_predict_stats();
+
 private:
     bool verbose_;
     bool fitted_;
+    real_t lambda_ridge_ = 1e-8;
+    RowCompression compression_;
+    RowCompressionReport compression_report_;
     SheafSolution solution_;
     std::unordered_map<std::string, PatchConfig> patch_configs_;
 
+    // Per-patch g_j = (1/n) Σ_p w[p,j] ω^{-pj}, for predict_spectrum()
+    std::unordered_map<std::string, Vector> spectral_weights_;
+
+    // Retained from the last fit() for prune() and reweight_gluings(): the
+    // normal equations by parts, ||b||^2 and the dense solution
+    std::vector<std::pair<std::string, size_t>> layout_;   // (patch, column offset), fit order
+    std::vector<Matrix> patch_grams_;                      // A_p^H A_p, no ridge
+    Matrix gluing_rows_;                                   // K, unweighted
+    std::vector<std::pair<size_t, size_t>> gluing_patches_; // layout_ indices per gluing
+    std::vector<real_t> gluing_weights_;
+    Vector moment_;                                        // A^H b
+    real_t target_norm2_ = 0.0;
+    real_t ridge_ = 0.0;
+    Vector dense_weights_;
+    Matrix gram_;                                          // A^H A + ρI; empty until needed
+
+    // Weight-independent part of the gluing solve (see reweight_gluings()).
+    // Immutable once built, so copies of the learner share it
+    struct GluingSchur {
+        Vector h_c;     // H^{-1} c
+        Matrix h_k;     // H^{-1} K^H
+        Matrix S;       // K H^{-1} K^H
+        Vector z;       // K H^{-1} c
+    };
+    std::shared_ptr<const GluingSchur> gluing_schur_;
+
+    // Patches pruned by prune(); absent = dense
+    std::unordered_map<std::string, SparsePatchModel> sparse_models_;
+
+    // Groups by kind and shape ({n} for C_n), reused across patches, gluings
+    // and fits. Groups are immutable, so copies of the learner share them
+    using GroupKey = std::pair<SymmetryKind, std::vector<size_t>>;
+    std::map<GroupKey, std::shared_ptr<const SymmetryGroup>> group_cache_;
+
+    // FitStats as relaxed atomics, so concurrent predict() calls never wait
+    // on each other to record a few microseconds of timing. Copying takes a
+    // snapshot, which keeps the learner copyable and movable
+    struct PredictCounters {
+        std::atomic<uint64_t> phase_ns[kNumFitPhases];
+        std::atomic<uint64_t> flops;
+        std::atomic<uint64_t> bytes_allocated;
+        std::atomic<uint64_t> character_transforms;
+        std::atomic<uint64_t> cache_hits;
+        std::atomic<uint64_t> cache_misses;
+        std::atomic<uint64_t> predictions;
+
+        PredictCounters() = default;
+        PredictCounters(const PredictCounters& other) { store(other.load()); }
+        PredictCounters& operator=(const PredictCounters& other) {
+            store(other.load());
+            return *this;
+        }
+
+        void add(const FitStats& stats);
+        FitStats load() const;
+        void store(const FitStats& stats);
+    };
+    mutable PredictCounters predict_stats_;
+
+    /**
+     * @brief Look up (or build and cache) the symmetry group of a patch
+     */
+    const SymmetryGroup& cached_group(const PatchConfig& config, FitStats& stats);
+
+    /**
+     * @brief Recompute spectral_weights_ from solution_.weights
+     */
+    void update_spectral_weights(FitStats& stats);
+
+    /**
+     * @brief Fold one predict call's statistics into predict_stats_
+     */
+    void record_predict_stats(const FitStats& stats) const;
+
     /**
      * @brief Build local accuracy systems for each patch
      */
@@ -100,38 +542,95 @@ private:
         std::vector<Vector> targets;
         std::unordered_map<std::string, size_t> patch_offsets;
         std::unordered_map<std::string, size_t> patch_n_weights;
+        real_t residual_offset = 0.0;   // Target spread left behind by merged rows
     };
-    LocalSystemsResult build_local_systems(const SheafProblem& problem);
+    LocalSystemsResult build_local_systems(const SheafProblemView& problem, FitStats& stats);
 
     /**
      * @brief Build global consistency constraints
      */
     struct GluingSystemResult {
-        Matrix A_gluing;
+        Matrix A_gluing;              // Unweighted rows
         Vector b_gluing;
+        std::vector<real_t> weights;  // GluingConstraint::weight per row
     };
     GluingSystemResult build_gluing_system(
-        const SheafProblem& problem,
-        const LocalSystemsResult& local_info
+        const SheafProblemView& problem,
+        const LocalSystemsResult& local_info,
+        FitStats& stats
+    );
+
+    /**
+     * @brief Stacked system [A_local; A_gluing] w = [b_local; b_gluing]
+     */
+    struct GlobalSystem {
+        Matrix A;
+        Vector b;
+        size_t local_rows = 0;
+    };
+    GlobalSystem assemble_system(
+        const SheafProblemView& problem,
+        const LocalSystemsResult& local_result,
+        const GluingSystemResult& gluing_result,
+        FitStats& stats
+    );
+
+    /**
+     * @brief Fill layout_, patch_grams_, moment_ and the gluing rows from the
+     * built systems; drops gram_ and the gluing Schur complement
+     */
+    void build_normal_equations(
+        const SheafProblemView& problem,
+        const LocalSystemsResult& local_result,
+        const GluingSystemResult& gluing_result,
+        FitStats& stats
     );
 
+    bool has_hard_gluings() const;
+
+    /**
+     * @brief The regularized normal equations as a block graph over patches
+     */
+    BlockGraphMatrix patch_graph(FitStats& stats) const;
+
+    /**
+     * @brief blockdiag(A_p^H A_p) + Σ_soft weight · k_i^H k_i + ridge · I
+     */
+    Matrix regularized_gram(real_t ridge, FitStats& stats) const;
+
+    /**
+     * @brief Per-patch factorizations and gluing Schur complement (cached)
+     */
+    const GluingSchur& gluing_schur(FitStats& stats);
+
+    /**
+     * @brief Solution for the current gluing_weights_ (hard rows exact)
+     */
+    Vector solve_gluings(FitStats& stats);
+
+    /**
+     * @brief Data residual plus weighted soft gluing residual of w
+     */
+    real_t gluing_objective(const Vector& w, FitStats& stats) const;
+
+    /**
+     * @brief Make w_solution the learner's solution (weights, spectra)
+     */
+    void install_solution(const Vector& w_solution, real_t residual_error, FitStats& stats);
+
     /**
      * @brief Get feature row for a sample (character projections at all positions)
      */
     Vector get_feature_row(
         const Matrix& V,
         const PatchConfig& config,
-        const CyclicGroupCharacters& group
+        const SymmetryGroup& group
     ) const;
 
     /**
      * @brief Unpack flat solution vector into structured form
      */
-    SheafSolution unpack_solution(
-        const Vector& w_solution,
-        const LocalSystemsResult& local_info,
-        real_t residual_error
-    );
+    SheafSolution unpack_solution(const Vector& w_solution, real_t residual_error);
 };
 
 } // namespace sheaf
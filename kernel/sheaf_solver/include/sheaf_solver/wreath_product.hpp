@@ -0,0 +1,161 @@
+/**
+ * @file wreath_product.hpp
+ * @brief Irreducible representations and Fourier transform of C_m ≀ C_n
+ *
+ * The wreath product G = C_m ≀ C_n = (C_m)^n ⋊ C_n has elements (a, s),
+ * a ∈ Z_m^n, s ∈ Z_n, with
+ *
+ *   (a, s)(b, t) = (a + σ^s b, s + t),   (σ^s b)_i = b_{i-s}
+ *
+ * so |G| = m^n · n. Element (a, s) has flat index s · m^n + flat(a), with
+ * flat(a) row-major as in AbelianGroupCharacters: a sample [|G|, d] is n
+ * consecutive blocks of m^n base positions.
+ *
+ * Irreps (Clifford theory / Mackey's little-group method). The base
+ * N = Z_m^n is abelian with characters ψ_x(a) = ω_m^{x·a}; C_n permutes
+ * them by cyclic shift. For an orbit {x, σx, ..., σ^{p-1}x} of period p
+ * (p | n) the stabilizer is H = ⟨p⟩ ≅ C_{n/p}, and each character λ_r of
+ * H (r < n/p) gives the p-dimensional irrep
+ *
+ *   ρ_{x,r} = Ind_{N⋊H}^{G} (ψ_x ⊗ λ_r)
+ *
+ * In the basis of cosets t = 0..p-1 it is monomial:
+ *
+ *   ρ(a, s) e_t = ψ_{σ^{t'}x}(a) · ω_{n/p}^{r q} e_{t'},
+ *   w = (s + t) mod n,  t' = w mod p,  q = (w - t') / p
+ *
+ * Every irrep appears once: Σ_orbits (n/p) · p² = n · m^n = |G|.
+ * Irreps are numbered orbit by orbit (orbits in order of their smallest
+ * member, which is the representative x), then by r. Irreps 0..n-1 come
+ * from the trivial orbit x = 0 and are the characters of the top group C_n.
+ *
+ * Fourier transform  \hat f(ρ) = Σ_g f(g) ρ(g):
+ *   1. F_s(y) = Σ_a f(a, s) ψ_y(a): one base transform (separable FFT) per
+ *      top element s, O(|G| n log m)
+ *   2. \hat f(ρ_{x,r})_{t',t} = Σ_q ω_{n/p}^{rq} F_{(t' + pq - t) mod n}(σ^{t'}x):
+ *      for each orbit and (t', t), one length-n/p DFT yields every r at
+ *      once, O(p n log(n/p)) per orbit
+ * and the inverse runs the same two steps backwards. The naive transform
+ * costs Σ_ρ d_ρ² |G| = |G|²; this one is O(|G| log |G|).
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "fft.hpp"
+#include "abelian_group.hpp"
+#include "symmetry_group.hpp"
+
+#include <map>
+#include <vector>
+
+namespace sheaf {
+
+class WreathProductCharacters : public SymmetryGroup {
+public:
+    /**
+     * @brief Irrep ρ_{x,r} of C_m ≀ C_n
+     */
+    struct Irrep {
+        size_t representative;   // Flat index of x (smallest in its orbit)
+        size_t period;           // p = orbit size = dimension
+        size_t r;                // Stabilizer character, r < n / p
+        size_t orbit;            // Index into the orbit list
+    };
+
+    /**
+     * @brief Construct C_m ≀ C_n
+     *
+     * @param m Base cyclic order
+     * @param n Top cyclic order (number of base copies)
+     * @throws std::invalid_argument if m or n is zero or m^n · n overflows
+     */
+    WreathProductCharacters(size_t m, size_t n);
+
+    size_t base_order() const { return m_; }
+    size_t top_order() const { return n_; }
+    size_t order() const override { return order_; }
+    size_t n_irreps() const override { return irreps_.size(); }
+    bool is_abelian() const override { return m_ == 1 || n_ == 1; }
+
+    const Irrep& irrep(size_t i) const { return irreps_.at(i); }
+    size_t irrep_dimension(size_t i) const { return irreps_.at(i).period; }
+
+    /**
+     * @brief Flat index of (a, s)
+     */
+    size_t element(size_t a, size_t s) const;
+
+    /**
+     * @brief Group product g · h of flat indices
+     */
+    size_t multiply(size_t g, size_t h) const;
+
+    /**
+     * @brief ρ_i(g) as a dense [d, d] matrix
+     */
+    Matrix representation(size_t i, size_t g) const;
+
+    /**
+     * @brief χ_i(g) = tr ρ_i(g)
+     */
+    complex_t character(size_t i, size_t g) const override;
+
+    /**
+     * @brief \hat f(ρ_i) = Σ_g f(g) ρ_i(g) for every irrep
+     *
+     * @param f Function on G [|G|]
+     * @return One [d_i, d_i] matrix per irrep
+     */
+    std::vector<Matrix> fourier_transform(const Vector& f) const;
+
+    /**
+     * @brief f(g) = (1/|G|) Σ_i d_i tr(ρ_i(g)^H \hat f(ρ_i))
+     */
+    Vector inverse_fourier_transform(const std::vector<Matrix>& coefficients) const;
+
+    /**
+     * @brief Projection onto the isotypic component of irrep i (per column)
+     */
+    Matrix project_onto_irrep(const Matrix& V, size_t i) const;
+
+    /**
+     * @brief Isotypic projections for every irrep (one transform per column)
+     */
+    std::vector<Matrix> decompose_into_characters(const Matrix& V) const override;
+
+    Vector selected_projection_features(
+        const Matrix& V, std::span<const size_t> characters) const override;
+
+private:
+    size_t m_;
+    size_t n_;
+    size_t base_size_;                 // m^n
+    size_t order_;                     // m^n · n
+    AbelianGroupCharacters base_;      // (C_m)^n
+    std::vector<complex_t> roots_m_;   // ω_m^k
+
+    struct Orbit {
+        size_t period;
+        size_t first_member;           // Offset into members_ (σ^t x for t < p)
+        size_t first_irrep;
+    };
+    std::vector<Orbit> orbits_;
+    std::vector<size_t> members_;
+    std::vector<Irrep> irreps_;
+    std::map<size_t, FourierPlan> top_plans_;   // Length n / p
+
+    void check_rows(const Matrix& V) const;
+
+    /**
+     * @brief ψ_y(a) as an exponent of ω_m (flat y and a)
+     */
+    size_t base_phase(size_t y, size_t a) const;
+
+    /**
+     * @brief out[g] += (d/|G|) tr(ρ_i(g)^H coef), for all g
+     */
+    void accumulate_projection(size_t i, const Matrix& coef, complex_t* out) const;
+};
+
+} // namespace sheaf
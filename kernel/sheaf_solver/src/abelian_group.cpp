@@ -0,0 +1,256 @@
+/**
+ * @file abelian_group.cpp
+ * @brief Separable transforms for products of cyclic groups
+ */
+
+#include "sheaf_solver/abelian_group.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace sheaf {
+
+namespace {
+
+// 16 x 16 complex doubles = 4 KiB per tile: source and destination tiles
+// both stay in L1 while the tile is transposed
+constexpr size_t kTransposeTile = 16;
+
+/**
+ * @brief dst[c * rows + r] = src[r * cols + c], tile by tile
+ */
+void transpose_blocked(const complex_t* src, complex_t* dst, size_t rows, size_t cols) {
+    for (size_t r0 = 0; r0 < rows; r0 += kTransposeTile) {
+        const size_t r1 = std::min(r0 + kTransposeTile, rows);
+        for (size_t c0 = 0; c0 < cols; c0 += kTransposeTile) {
+            const size_t c1 = std::min(c0 + kTransposeTile, cols);
+            for (size_t r = r0; r < r1; ++r) {
+                for (size_t c = c0; c < c1; ++c) {
+                    dst[c * rows + r] = src[r * cols + c];
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+AbelianGroupCharacters::AbelianGroupCharacters(std::vector<size_t> shape)
+    : shape_(std::move(shape))
+    , strides_(shape_.size())
+    , order_(1)
+{
+    if (shape_.empty()) {
+        throw std::invalid_argument("Group shape needs at least one axis");
+    }
+    for (size_t a = shape_.size(); a-- > 0;) {
+        if (shape_[a] == 0) {
+            throw std::invalid_argument("Axis orders must be positive");
+        }
+        strides_[a] = order_;
+        order_ *= shape_[a];
+    }
+
+    plans_.reserve(shape_.size());
+    roots_.resize(shape_.size());
+    for (size_t a = 0; a < shape_.size(); ++a) {
+        const size_t n = shape_[a];
+        plans_.emplace_back(n);
+        workspace_size_ = std::max(workspace_size_, plans_.back().workspace_size());
+        roots_[a].resize(n);
+        for (size_t t = 0; t < n; ++t) {
+            roots_[a][t] = std::polar(1.0, 2.0 * PI * static_cast<double>(t) / static_cast<double>(n));
+        }
+    }
+}
+
+size_t AbelianGroupCharacters::flat_index(const std::vector<size_t>& multi) const {
+    if (multi.size() != shape_.size()) {
+        throw std::invalid_argument("Multi-index rank does not match the group");
+    }
+    size_t flat = 0;
+    for (size_t a = 0; a < shape_.size(); ++a) {
+        if (multi[a] >= shape_[a]) {
+            throw std::out_of_range("Multi-index out of range");
+        }
+        flat += multi[a] * strides_[a];
+    }
+    return flat;
+}
+
+std::vector<size_t> AbelianGroupCharacters::multi_index(size_t flat) const {
+    if (flat >= order_) {
+        throw std::out_of_range("Flat index out of range");
+    }
+    std::vector<size_t> multi(shape_.size());
+    for (size_t a = 0; a < shape_.size(); ++a) {
+        multi[a] = (flat / strides_[a]) % shape_[a];
+    }
+    return multi;
+}
+
+complex_t AbelianGroupCharacters::character(size_t j, size_t k) const {
+    if (j >= order_ || k >= order_) {
+        throw std::out_of_range("Character index out of range");
+    }
+    complex_t value(1.0, 0.0);
+    for (size_t a = 0; a < shape_.size(); ++a) {
+        const size_t n = shape_[a];
+        const size_t ja = (j / strides_[a]) % n;
+        const size_t ka = (k / strides_[a]) % n;
+        value *= roots_[a][(ja * ka) % n];
+    }
+    return value;
+}
+
+void AbelianGroupCharacters::check_rows(const Matrix& V) const {
+    if (static_cast<size_t>(V.rows()) != order_) {
+        throw std::invalid_argument("Abelian group transform needs exactly N rows");
+    }
+}
+
+void AbelianGroupCharacters::transform_column(
+    complex_t* x, bool inverse, complex_t* scratch, complex_t* work) const
+{
+    for (size_t a = 0; a < shape_.size(); ++a) {
+        const size_t len = shape_[a];
+        if (len == 1) continue;
+
+        const FourierPlan& plan = plans_[a];
+        const size_t inner = strides_[a];
+        const size_t block = len * inner;
+
+        for (size_t base = 0; base < order_; base += block) {
+            complex_t* slab = x + base;
+            if (inner == 1) {
+                inverse ? plan.inverse(slab, work) : plan.forward(slab, work);
+                continue;
+            }
+
+            // slab is [len, inner] row-major: make axis a contiguous
+            transpose_blocked(slab, scratch, len, inner);
+            for (size_t t = 0; t < inner; ++t) {
+                complex_t* line = scratch + t * len;
+                inverse ? plan.inverse(line, work) : plan.forward(line, work);
+            }
+            transpose_blocked(scratch, slab, inner, len);
+        }
+    }
+}
+
+Matrix AbelianGroupCharacters::transform(const Matrix& V) const {
+    check_rows(V);
+    Matrix X = V;
+#ifdef USE_EIGEN3
+    std::vector<complex_t> scratch(order_), work(workspace_size_);
+    for (Eigen::Index c = 0; c < X.cols(); ++c) {
+        transform_column(X.col(c).data(), false, scratch.data(), work.data());
+    }
+#endif
+    return X;
+}
+
+Matrix AbelianGroupCharacters::inverse_transform(const Matrix& X) const {
+    check_rows(X);
+    Matrix V = X;
+#ifdef USE_EIGEN3
+    std::vector<complex_t> scratch(order_), work(workspace_size_);
+    for (Eigen::Index c = 0; c < V.cols(); ++c) {
+        transform_column(V.col(c).data(), true, scratch.data(), work.data());
+    }
+    V /= static_cast<double>(order_);
+#endif
+    return V;
+}
+
+Matrix AbelianGroupCharacters::project_onto_character(const Matrix& V, size_t j) const {
+    if (j >= order_) {
+        throw std::out_of_range("Character index out of range");
+    }
+    check_rows(V);
+
+    Matrix proj(order_, V.cols());
+#ifdef USE_EIGEN3
+    // Only row j of the transform is needed: X_j = Σ_k χ_j(k) V_k
+    Eigen::RowVectorXcd X_j = Eigen::RowVectorXcd::Zero(V.cols());
+    for (size_t k = 0; k < order_; ++k) {
+        X_j += character(j, k) * V.row(k);
+    }
+    X_j /= static_cast<double>(order_);
+    for (size_t i = 0; i < order_; ++i) {
+        proj.row(i) = std::conj(character(j, i)) * X_j;
+    }
+#endif
+    return proj;
+}
+
+std::vector<Matrix> AbelianGroupCharacters::decompose_into_characters(const Matrix& V) const {
+    std::vector<Matrix> projections;
+#ifdef USE_EIGEN3
+    Matrix X = transform(V);
+    X /= static_cast<double>(order_);
+
+    projections.reserve(order_);
+    for (size_t j = 0; j < order_; ++j) {
+        Matrix proj(order_, V.cols());
+        for (size_t i = 0; i < order_; ++i) {
+            proj.row(i) = std::conj(character(j, i)) * X.row(j);
+        }
+        projections.push_back(std::move(proj));
+    }
+#else
+    (void)V;
+#endif
+    return projections;
+}
+
+Vector AbelianGroupCharacters::selected_projection_features(
+    const Matrix& V, std::span<const size_t> characters) const
+{
+    check_rows(V);
+    for (size_t c : characters) {
+        if (c >= order_) {
+            throw std::out_of_range("Character index out of range");
+        }
+    }
+
+#ifdef USE_EIGEN3
+    const size_t k = characters.size();
+    Vector features(order_ * k);
+    const Matrix X = transform(V.col(0));
+    const double inv_n = 1.0 / static_cast<double>(order_);
+
+    for (size_t p = 0; p < order_; ++p) {
+        for (size_t i = 0; i < k; ++i) {
+            const size_t c = characters[i];
+            features(p * k + i) = std::conj(character(c, p)) * X(c, 0) * inv_n;
+        }
+    }
+    return features;
+#else
+    return Vector(1);
+#endif
+}
+
+Matrix AbelianGroupCharacters::reconstruct_from_characters(
+    const Vector& coefficients,
+    const std::vector<Matrix>& projections
+) const {
+    if (projections.empty()) {
+        throw std::invalid_argument("Empty projections");
+    }
+
+#ifdef USE_EIGEN3
+    Matrix result = Matrix::Zero(projections[0].rows(), projections[0].cols());
+    for (size_t j = 0; j < projections.size() && j < static_cast<size_t>(coefficients.size()); ++j) {
+        result += coefficients(j) * projections[j];
+    }
+    return result;
+#else
+    (void)coefficients;
+    return Matrix(projections[0].rows(), projections[0].cols());
+#endif
+}
+
+} // namespace sheaf
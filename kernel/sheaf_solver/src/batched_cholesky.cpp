@@ -0,0 +1,178 @@
+/**
+ * @file batched_cholesky.cpp
+ * @brief Interleaved complex Cholesky factorization and triangular solves
+ */
+
+#include "sheaf_solver/batched_cholesky.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace sheaf {
+
+BatchedCholesky::BatchedCholesky(size_t n)
+    : n_(n),
+      re_(n * (n + 1) / 2 * kBatchLanes, 0.0),
+      im_(n * (n + 1) / 2 * kBatchLanes, 0.0),
+      rhs_re_(n * kBatchLanes, 0.0),
+      rhs_im_(n * kBatchLanes, 0.0),
+      inv_diag_(n * kBatchLanes, 0.0) {}
+
+void BatchedCholesky::load(size_t lane, const Matrix& A, const Vector& b) {
+    if (lane >= kBatchLanes) {
+        throw std::out_of_range("Lane out of range");
+    }
+#ifdef USE_EIGEN3
+    if (static_cast<size_t>(A.rows()) != n_ || static_cast<size_t>(A.cols()) != n_
+        || static_cast<size_t>(b.size()) != n_) {
+        throw std::invalid_argument("System does not match the batch size");
+    }
+    for (size_t i = 0; i < n_; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            re_[at(i, j) + lane] = A(i, j).real();
+            im_[at(i, j) + lane] = A(i, j).imag();
+        }
+        rhs_re_[i * kBatchLanes + lane] = b(i).real();
+        rhs_im_[i * kBatchLanes + lane] = b(i).imag();
+    }
+#else
+    (void)A;
+    (void)b;
+#endif
+}
+
+void BatchedCholesky::load_identity(size_t lane) {
+    if (lane >= kBatchLanes) {
+        throw std::out_of_range("Lane out of range");
+    }
+    for (size_t i = 0; i < n_; ++i) {
+        for (size_t j = 0; j <= i; ++j) {
+            re_[at(i, j) + lane] = i == j ? 1.0 : 0.0;
+            im_[at(i, j) + lane] = 0.0;
+        }
+        rhs_re_[i * kBatchLanes + lane] = 0.0;
+        rhs_im_[i * kBatchLanes + lane] = 0.0;
+    }
+}
+
+std::array<bool, kBatchLanes> BatchedCholesky::solve() {
+    std::array<bool, kBatchLanes> ok;
+    ok.fill(true);
+    constexpr size_t B = kBatchLanes;
+
+    // Crout order: column j of L from the rows above it
+    //   L(j,j) = sqrt(A(j,j) - Σ_{k<j} |L(j,k)|^2)
+    //   L(i,j) = (A(i,j) - Σ_{k<j} L(i,k) conj(L(j,k))) / L(j,j)
+    for (size_t j = 0; j < n_; ++j) {
+        real_t d[B];
+        const real_t* lj_re = &re_[at(j, 0)];
+        const real_t* lj_im = &im_[at(j, 0)];
+        for (size_t l = 0; l < B; ++l) d[l] = lj_re[j * B + l];
+        for (size_t k = 0; k < j; ++k) {
+            for (size_t l = 0; l < B; ++l) {
+                d[l] -= lj_re[k * B + l] * lj_re[k * B + l] + lj_im[k * B + l] * lj_im[k * B + l];
+            }
+        }
+        real_t* inv = &inv_diag_[j * B];
+        for (size_t l = 0; l < B; ++l) {
+            // A failed lane keeps running on a unit pivot; its result is discarded
+            if (!(d[l] > 0.0)) {
+                ok[l] = false;
+                d[l] = 1.0;
+            }
+            const real_t root = std::sqrt(d[l]);
+            re_[at(j, j) + l] = root;
+            im_[at(j, j) + l] = 0.0;
+            inv[l] = 1.0 / root;
+        }
+
+        for (size_t i = j + 1; i < n_; ++i) {
+            real_t* li_re = &re_[at(i, 0)];
+            real_t* li_im = &im_[at(i, 0)];
+            real_t s_re[B], s_im[B];
+            for (size_t l = 0; l < B; ++l) {
+                s_re[l] = li_re[j * B + l];
+                s_im[l] = li_im[j * B + l];
+            }
+            for (size_t k = 0; k < j; ++k) {
+                for (size_t l = 0; l < B; ++l) {
+                    const real_t a_re = li_re[k * B + l], a_im = li_im[k * B + l];
+                    const real_t b_re = lj_re[k * B + l], b_im = lj_im[k * B + l];
+                    s_re[l] -= a_re * b_re + a_im * b_im;
+                    s_im[l] -= a_im * b_re - a_re * b_im;
+                }
+            }
+            for (size_t l = 0; l < B; ++l) {
+                li_re[j * B + l] = s_re[l] * inv[l];
+                li_im[j * B + l] = s_im[l] * inv[l];
+            }
+        }
+    }
+
+    // L z = b, row by row
+    for (size_t i = 0; i < n_; ++i) {
+        const real_t* li_re = &re_[at(i, 0)];
+        const real_t* li_im = &im_[at(i, 0)];
+        real_t s_re[B], s_im[B];
+        for (size_t l = 0; l < B; ++l) {
+            s_re[l] = rhs_re_[i * B + l];
+            s_im[l] = rhs_im_[i * B + l];
+        }
+        for (size_t k = 0; k < i; ++k) {
+            for (size_t l = 0; l < B; ++l) {
+                const real_t a_re = li_re[k * B + l], a_im = li_im[k * B + l];
+                const real_t z_re = rhs_re_[k * B + l], z_im = rhs_im_[k * B + l];
+                s_re[l] -= a_re * z_re - a_im * z_im;
+                s_im[l] -= a_re * z_im + a_im * z_re;
+            }
+        }
+        for (size_t l = 0; l < B; ++l) {
+            rhs_re_[i * B + l] = s_re[l] * inv_diag_[i * B + l];
+            rhs_im_[i * B + l] = s_im[l] * inv_diag_[i * B + l];
+        }
+    }
+
+    // L^H x = z, from the bottom: finish x_i, then remove it from the rows
+    // above using row i of L (contiguous)
+    for (size_t i = n_; i-- > 0;) {
+        const real_t* li_re = &re_[at(i, 0)];
+        const real_t* li_im = &im_[at(i, 0)];
+        real_t x_re[B], x_im[B];
+        for (size_t l = 0; l < B; ++l) {
+            x_re[l] = rhs_re_[i * B + l] * inv_diag_[i * B + l];
+            x_im[l] = rhs_im_[i * B + l] * inv_diag_[i * B + l];
+            rhs_re_[i * B + l] = x_re[l];
+            rhs_im_[i * B + l] = x_im[l];
+        }
+        for (size_t k = 0; k < i; ++k) {
+            for (size_t l = 0; l < B; ++l) {
+                // z_k -= conj(L(i,k)) x_i
+                const real_t a_re = li_re[k * B + l], a_im = li_im[k * B + l];
+                rhs_re_[k * B + l] -= a_re * x_re[l] + a_im * x_im[l];
+                rhs_im_[k * B + l] -= a_re * x_im[l] - a_im * x_re[l];
+            }
+        }
+    }
+    return ok;
+}
+
+Vector BatchedCholesky::solution(size_t lane) const {
+    if (lane >= kBatchLanes) {
+        throw std::out_of_range("Lane out of range");
+    }
+#ifdef USE_EIGEN3
+    Vector x(n_);
+    for (size_t i = 0; i < n_; ++i) {
+        x(i) = complex_t(rhs_re_[i * kBatchLanes + lane], rhs_im_[i * kBatchLanes + lane]);
+    }
+    return x;
+#else
+    return Vector(1);
+#endif
+}
+
+size_t BatchedCholesky::buffer_bytes() const {
+    return (re_.size() + im_.size() + rhs_re_.size() + rhs_im_.size() + inv_diag_.size()) * sizeof(real_t);
+}
+
+} // namespace sheaf
@@ -0,0 +1,437 @@
+/**
+ * @file block_graph_solver.cpp
+ * @brief Aggregation multigrid and PCG over block-sparse patch graphs
+ */
+
+#include "sheaf_solver/block_graph_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace sheaf {
+
+#ifdef USE_EIGEN3
+
+namespace {
+
+/**
+ * @brief Orthonormal basis of the column span of V, rank-revealing
+ *
+ * Gram-Schmidt with column pivoting (and one reorthogonalization), stopped
+ * once every remaining column is below tolerance times the largest: cost
+ * O(rows · cols · rank) rather than a full QR of V.
+ */
+Matrix orthonormal_span(Matrix V, real_t tolerance) {
+    const Eigen::Index rows = V.rows();
+    Matrix Q(rows, 0);
+    RealVector norms = V.colwise().norm().transpose();
+    const real_t scale = norms.size() > 0 ? norms.maxCoeff() : 0.0;
+    while (Q.cols() < rows) {
+        Eigen::Index j = 0;
+        const real_t largest = norms.size() > 0 ? norms.maxCoeff(&j) : 0.0;
+        if (!(largest > tolerance * scale)) break;
+        Vector q = V.col(j);
+        q -= Q * (Q.adjoint() * q);
+        q.normalize();
+        V -= q * (q.adjoint() * V);
+        norms = V.colwise().norm().transpose();
+        Q.conservativeResize(Eigen::NoChange, Q.cols() + 1);
+        Q.rightCols(1) = q;
+    }
+    return Q;
+}
+
+} // namespace
+
+size_t BlockGraphMatrix::add_node(Matrix D) {
+    if (D.rows() != D.cols()) {
+        throw std::invalid_argument("Diagonal block must be square");
+    }
+    offsets.push_back(offsets.back() + D.rows());
+    diagonal.push_back(std::move(D));
+    return diagonal.size() - 1;
+}
+
+void BlockGraphMatrix::add_to_edge(size_t p, size_t q, const Matrix& B) {
+    if (p == q || p >= n_nodes() || q >= n_nodes()) {
+        throw std::invalid_argument("Edge must join two distinct nodes");
+    }
+    const bool swapped = p > q;
+    const auto key = swapped ? std::make_pair(q, p) : std::make_pair(p, q);
+    auto [it, inserted] = edge_index.try_emplace(key, edges.size());
+    if (inserted) {
+        edges.push_back({key.first, key.second,
+                         Matrix::Zero(node_size(key.first), node_size(key.second))});
+    }
+    if (swapped) {
+        edges[it->second].block += B.adjoint();
+    } else {
+        edges[it->second].block += B;
+    }
+}
+
+Vector BlockGraphMatrix::multiply(const Vector& x) const {
+    Vector y(size());
+    for (size_t p = 0; p < n_nodes(); ++p) {
+        y.segment(offsets[p], node_size(p)).noalias() = diagonal[p] * x.segment(offsets[p], node_size(p));
+    }
+    for (const Edge& e : edges) {
+        y.segment(offsets[e.p], node_size(e.p)).noalias() += e.block * x.segment(offsets[e.q], node_size(e.q));
+        y.segment(offsets[e.q], node_size(e.q)).noalias() += e.block.adjoint() * x.segment(offsets[e.p], node_size(e.p));
+    }
+    return y;
+}
+
+Matrix BlockGraphMatrix::to_dense() const {
+    Matrix N = Matrix::Zero(size(), size());
+    for (size_t p = 0; p < n_nodes(); ++p) {
+        N.block(offsets[p], offsets[p], node_size(p), node_size(p)) = diagonal[p];
+    }
+    for (const Edge& e : edges) {
+        N.block(offsets[e.p], offsets[e.q], node_size(e.p), node_size(e.q)) = e.block;
+        N.block(offsets[e.q], offsets[e.p], node_size(e.q), node_size(e.p)) = e.block.adjoint();
+    }
+    return N;
+}
+
+struct BlockGraphMultigrid::Level {
+    BlockGraphMatrix A;
+    std::vector<std::vector<std::pair<size_t, size_t>>> adjacency;  // (neighbour, edge)
+    std::vector<Eigen::LLT<Matrix>> smoother;                        // D_p
+
+    // Prolongation from the next coarser level: coarse node a spans the
+    // nodes aggregates[a] (concatenated) through basis[a]
+    std::vector<std::vector<size_t>> aggregates;
+    std::vector<Matrix> basis;
+
+    std::unique_ptr<Eigen::LLT<Matrix>> direct;                      // Coarsest level only
+
+    explicit Level(BlockGraphMatrix matrix) : A(std::move(matrix)) {
+        adjacency.resize(A.n_nodes());
+        for (size_t e = 0; e < A.edges.size(); ++e) {
+            adjacency[A.edges[e].p].emplace_back(A.edges[e].q, e);
+            adjacency[A.edges[e].q].emplace_back(A.edges[e].p, e);
+        }
+        smoother.reserve(A.n_nodes());
+        for (size_t p = 0; p < A.n_nodes(); ++p) {
+            smoother.emplace_back(A.diagonal[p]);
+            if (smoother.back().info() != Eigen::Success) {
+                throw std::runtime_error("Diagonal block is not positive definite");
+            }
+        }
+    }
+
+    /**
+     * @brief One block Gauss-Seidel sweep on A x = r, forward or backward
+     */
+    void sweep(const Vector& r, Vector& x, bool forward) const {
+        const size_t n = A.n_nodes();
+        for (size_t i = 0; i < n; ++i) {
+            const size_t p = forward ? i : n - 1 - i;
+            Vector rhs = r.segment(A.offsets[p], A.node_size(p));
+            for (const auto& [q, e] : adjacency[p]) {
+                const auto& edge = A.edges[e];
+                const auto x_q = x.segment(A.offsets[q], A.node_size(q));
+                if (edge.p == p) {
+                    rhs.noalias() -= edge.block * x_q;
+                } else {
+                    rhs.noalias() -= edge.block.adjoint() * x_q;
+                }
+            }
+            x.segment(A.offsets[p], A.node_size(p)) = smoother[p].solve(rhs);
+        }
+    }
+
+    Vector restrict_to_coarse(const Vector& r) const {
+        size_t coarse_size = 0;
+        for (const Matrix& B : basis) coarse_size += B.cols();
+        Vector rc(coarse_size);
+        size_t offset = 0;
+        for (size_t a = 0; a < aggregates.size(); ++a) {
+            Vector local(basis[a].rows());
+            size_t row = 0;
+            for (size_t p : aggregates[a]) {
+                local.segment(row, A.node_size(p)) = r.segment(A.offsets[p], A.node_size(p));
+                row += A.node_size(p);
+            }
+            rc.segment(offset, basis[a].cols()).noalias() = basis[a].adjoint() * local;
+            offset += basis[a].cols();
+        }
+        return rc;
+    }
+
+    void prolongate_add(const Vector& xc, Vector& x) const {
+        size_t offset = 0;
+        for (size_t a = 0; a < aggregates.size(); ++a) {
+            Vector local = basis[a] * xc.segment(offset, basis[a].cols());
+            size_t row = 0;
+            for (size_t p : aggregates[a]) {
+                x.segment(A.offsets[p], A.node_size(p)) += local.segment(row, A.node_size(p));
+                row += A.node_size(p);
+            }
+            offset += basis[a].cols();
+        }
+    }
+
+    /**
+     * @brief Aggregate, pick the local low-energy modes and build P^H A P
+     */
+    BlockGraphMatrix coarsen(const MultigridOptions& options) {
+        const size_t n = A.n_nodes();
+        const size_t none = n;
+
+        // Greedy breadth-first aggregates of up to aggregate_size nodes
+        std::vector<size_t> aggregate_of(n, none);
+        aggregates.clear();
+        for (size_t p = 0; p < n; ++p) {
+            if (aggregate_of[p] != none) continue;
+            const size_t a = aggregates.size();
+            std::vector<size_t> members = {p};
+            aggregate_of[p] = a;
+            for (size_t i = 0; i < members.size() && members.size() < options.aggregate_size; ++i) {
+                for (const auto& [q, e] : adjacency[members[i]]) {
+                    if (aggregate_of[q] == none && members.size() < options.aggregate_size) {
+                        aggregate_of[q] = a;
+                        members.push_back(q);
+                    }
+                }
+            }
+            aggregates.push_back(std::move(members));
+        }
+
+        // Row of each node inside its aggregate
+        std::vector<size_t> local_row(n);
+        std::vector<size_t> aggregate_rows(aggregates.size(), 0);
+        for (size_t a = 0; a < aggregates.size(); ++a) {
+            for (size_t p : aggregates[a]) {
+                local_row[p] = aggregate_rows[a];
+                aggregate_rows[a] += A.node_size(p);
+            }
+        }
+
+        // Edges inside each aggregate, listed at both ends
+        std::vector<std::vector<size_t>> internal(n);
+        for (size_t e = 0; e < A.edges.size(); ++e) {
+            const auto& edge = A.edges[e];
+            if (aggregate_of[edge.p] != aggregate_of[edge.q]) continue;
+            internal[edge.p].push_back(e);
+            internal[edge.q].push_back(e);
+        }
+
+        // Low modes of C = L^{-1} N_AA L^{-H} = I + E, D_AA = L L^H block by
+        // block. An eigenvector with λ != 1 lies in range(E), which node p
+        // sees as L_p^{-1} span(B_p·) - a few gluing rows wide, however large
+        // the node. With Q_p an orthonormal basis of it and G_p = L_p^{-H} Q_p,
+        // the eigenproblem shrinks to Q^H C Q = I + [G_p^H B_pq G_q], and a mode
+        // y of it prolongates through G y with coarse block G^H N_AA G y = λ y.
+        // The rank of span(B_p·) is decided before scaling: L_p^{-1}
+        // amplifies rounding noise when the data leave D_p nearly singular
+        basis.assign(aggregates.size(), Matrix());
+        BlockGraphMatrix coarse;
+        std::vector<Matrix> G(n);
+        std::vector<size_t> range_col(n);
+        for (size_t a = 0; a < aggregates.size(); ++a) {
+            const auto& members = aggregates[a];
+            size_t r = 0;
+            for (size_t p : members) {
+                range_col[p] = r;
+                G[p] = Matrix(A.node_size(p), 0);
+                if (internal[p].empty()) continue;
+                Matrix span(A.node_size(p), 0);
+                for (size_t e : internal[p]) {
+                    const auto& edge = A.edges[e];
+                    const Matrix cols = edge.p == p ? edge.block : Matrix(edge.block.adjoint());
+                    span.conservativeResize(Eigen::NoChange, span.cols() + cols.cols());
+                    span.rightCols(cols.cols()) = cols;
+                }
+                Matrix U = orthonormal_span(std::move(span), 1e-12);
+                smoother[p].matrixL().solveInPlace(U);
+                Eigen::HouseholderQR<Matrix> qr(U);
+                G[p] = qr.householderQ() * Matrix::Identity(A.node_size(p), U.cols());
+                smoother[p].matrixU().solveInPlace(G[p]);
+                r += U.cols();
+            }
+
+            Eigen::SelfAdjointEigenSolver<Matrix> eig;
+            Matrix B;                                   // Modes, prolongated: G y
+            if (r > 0 && r < aggregate_rows[a]) {
+                Matrix R = Matrix::Identity(r, r);
+                for (size_t p : members) {
+                    for (size_t e : internal[p]) {
+                        const auto& edge = A.edges[e];
+                        if (edge.p != p) continue;
+                        const Matrix block = G[p].adjoint() * edge.block * G[edge.q];
+                        R.block(range_col[p], range_col[edge.q], block.rows(), block.cols()) = block;
+                        R.block(range_col[edge.q], range_col[p], block.cols(), block.rows()) = block.adjoint();
+                    }
+                }
+                eig.compute(R);
+                if (eig.eigenvalues()(0) < 1.0) {
+                    B = Matrix(aggregate_rows[a], r);
+                    for (size_t p : members) {
+                        B.middleRows(local_row[p], A.node_size(p)) =
+                            G[p] * eig.eigenvectors().middleRows(range_col[p], G[p].cols());
+                    }
+                }
+            }
+            if (B.size() == 0) {
+                // No internal edge, full range, or no mode below the λ = 1
+                // eigenspace outside range(E): C on every aggregate row
+                Matrix C = Matrix::Identity(aggregate_rows[a], aggregate_rows[a]);
+                for (size_t p : members) {
+                    for (size_t e : internal[p]) {
+                        const auto& edge = A.edges[e];
+                        if (edge.p != p) continue;
+                        Matrix S = edge.block;
+                        smoother[p].matrixL().solveInPlace(S);
+                        Matrix St = S.adjoint();
+                        smoother[edge.q].matrixL().solveInPlace(St);
+                        C.block(local_row[edge.q], local_row[p], St.rows(), St.cols()) = St;
+                        C.block(local_row[p], local_row[edge.q], St.cols(), St.rows()) = St.adjoint();
+                    }
+                }
+                eig.compute(C);
+                B = eig.eigenvectors();
+                for (size_t p : members) {
+                    auto rows = B.middleRows(local_row[p], A.node_size(p));
+                    smoother[p].matrixU().solveInPlace(rows);
+                }
+            }
+            const RealVector& lambda = eig.eigenvalues();
+            size_t k = 0;
+            while (k < static_cast<size_t>(lambda.size()) && lambda(k) < options.coarse_threshold) ++k;
+            k = std::clamp<size_t>(k, 1, std::min<size_t>(options.max_coarse_rank, lambda.size()));
+
+            coarse.add_node(Matrix(lambda.head(k).cast<complex_t>().asDiagonal()));
+            basis[a] = B.leftCols(k);
+        }
+        for (const auto& edge : A.edges) {
+            const size_t a = aggregate_of[edge.p];
+            const size_t b = aggregate_of[edge.q];
+            if (a == b) continue;
+            coarse.add_to_edge(a, b,
+                basis[a].middleRows(local_row[edge.p], A.node_size(edge.p)).adjoint()
+                * edge.block
+                * basis[b].middleRows(local_row[edge.q], A.node_size(edge.q)));
+        }
+        return coarse;
+    }
+};
+
+BlockGraphMultigrid::BlockGraphMultigrid(BlockGraphMatrix fine, const MultigridOptions& options) {
+    levels_.push_back(std::make_unique<Level>(std::move(fine)));
+    while (true) {
+        Level& level = *levels_.back();
+        const size_t n = level.A.size();
+        bool coarsest = n <= options.direct_size
+                     || level.A.n_nodes() <= 1
+                     || levels_.size() >= options.max_levels;
+        if (!coarsest) {
+            BlockGraphMatrix coarse = level.coarsen(options);
+            if (coarse.size() < n && coarse.n_nodes() < level.A.n_nodes()) {
+                levels_.push_back(std::make_unique<Level>(std::move(coarse)));
+                continue;
+            }
+            level.aggregates.clear();
+            level.basis.clear();
+        }
+        level.direct = std::make_unique<Eigen::LLT<Matrix>>(level.A.to_dense());
+        break;
+    }
+}
+
+BlockGraphMultigrid::~BlockGraphMultigrid() = default;
+
+const BlockGraphMatrix& BlockGraphMultigrid::matrix() const {
+    return levels_.front()->A;
+}
+
+std::vector<size_t> BlockGraphMultigrid::level_sizes() const {
+    std::vector<size_t> sizes;
+    for (const auto& level : levels_) sizes.push_back(level->A.size());
+    return sizes;
+}
+
+Vector BlockGraphMultigrid::apply(const Vector& r) const {
+    Vector x;
+    cycle(0, r, x);
+    return x;
+}
+
+void BlockGraphMultigrid::cycle(size_t index, const Vector& r, Vector& x) const {
+    const Level& level = *levels_[index];
+    if (level.direct) {
+        x = level.direct->solve(r);
+        return;
+    }
+    x = Vector::Zero(r.size());
+    level.sweep(r, x, true);
+
+    Vector xc;
+    cycle(index + 1, level.restrict_to_coarse(r - level.A.multiply(x)), xc);
+    level.prolongate_add(xc, x);
+
+    level.sweep(r, x, false);
+}
+
+ConjugateGradientResult conjugate_gradient(
+    const BlockGraphMatrix& N,
+    const Vector& b,
+    const std::function<Vector(const Vector&)>& preconditioner,
+    real_t tolerance,
+    size_t max_iterations
+) {
+    ConjugateGradientResult result;
+    result.x = Vector::Zero(b.size());
+    const real_t b_norm = b.norm();
+    if (b_norm == 0.0) {
+        result.converged = true;
+        return result;
+    }
+
+    Vector r = b;
+    Vector z = preconditioner ? preconditioner(r) : r;
+    Vector p = z;
+    real_t rz = std::real(r.dot(z));
+    result.relative_residual = 1.0;
+
+    while (result.iterations < max_iterations) {
+        Vector Np = N.multiply(p);
+        const real_t alpha = rz / std::real(p.dot(Np));
+        result.x += alpha * p;
+        r -= alpha * Np;
+        ++result.iterations;
+
+        result.relative_residual = r.norm() / b_norm;
+        if (result.relative_residual <= tolerance) {
+            result.converged = true;
+            break;
+        }
+
+        z = preconditioner ? preconditioner(r) : r;
+        const real_t rz_next = std::real(r.dot(z));
+        p = z + (rz_next / rz) * p;
+        rz = rz_next;
+    }
+    return result;
+}
+
+std::function<Vector(const Vector&)> block_jacobi(const BlockGraphMatrix& N) {
+    auto factors = std::make_shared<std::vector<Eigen::LLT<Matrix>>>();
+    for (const Matrix& D : N.diagonal) {
+        factors->emplace_back(D);
+    }
+    return [factors, offsets = N.offsets](const Vector& r) {
+        Vector z(r.size());
+        for (size_t p = 0; p < factors->size(); ++p) {
+            const size_t n = offsets[p + 1] - offsets[p];
+            z.segment(offsets[p], n) = (*factors)[p].solve(r.segment(offsets[p], n));
+        }
+        return z;
+    };
+}
+
+#endif // USE_EIGEN3
+
+} // namespace sheaf
@@ -0,0 +1,156 @@
+/**
+ * @file character_theory.cpp
+ * @brief Implementation of the character-theory attention layer
+ */
+
+#include "sheaf_solver/character_theory.hpp"
+#include "sheaf_solver/parallel.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace sheaf {
+
+CharacterAttention::CharacterAttention(size_t seq_len, size_t d_model, size_t n_heads)
+    : seq_len_(seq_len)
+    , d_model_(d_model)
+    , n_heads_(n_heads)
+    , plan_(seq_len)
+    , coefficients_(seq_len, n_heads)
+    , scale_(seq_len, n_heads)
+{
+    if (d_model == 0 || n_heads == 0 || d_model % n_heads != 0) {
+        throw std::invalid_argument("n_heads must be positive and divide d_model");
+    }
+#ifdef USE_EIGEN3
+    coefficients_.setZero();
+    scale_.setZero();
+#endif
+}
+
+void CharacterAttention::set_head_coefficients(size_t head, const Vector& c) {
+    if (head >= n_heads_) {
+        throw std::out_of_range("Head index out of range");
+    }
+    if (static_cast<size_t>(c.size()) > seq_len_) {
+        throw std::invalid_argument("More coefficients than characters");
+    }
+
+#ifdef USE_EIGEN3
+    coefficients_.col(head).setZero();
+    coefficients_.col(head).head(c.size()) = c;
+    scale_.col(head) = coefficients_.col(head) / static_cast<double>(seq_len_);
+#endif
+}
+
+void CharacterAttention::check_shape(const Matrix& V, const char* what) const {
+    if (static_cast<size_t>(V.rows()) != seq_len_ || static_cast<size_t>(V.cols()) != d_model_) {
+        throw std::invalid_argument(std::string(what) + " must be [seq_len, d_model]");
+    }
+}
+
+void CharacterAttention::apply(Matrix& out, complex_t* work) const {
+#ifdef USE_EIGEN3
+    const size_t head_dim = d_model_ / n_heads_;
+    for (size_t c = 0; c < d_model_; ++c) {
+        complex_t* column = out.col(c).data();
+        const complex_t* scale = scale_.col(c / head_dim).data();
+
+        plan_.forward(column, work);
+        for (size_t j = 0; j < seq_len_; ++j) {
+            column[j] *= scale[j];
+        }
+        plan_.inverse(column, work);
+    }
+#else
+    (void)out;
+    (void)work;
+#endif
+}
+
+Matrix CharacterAttention::forward(const Matrix& V) const {
+    check_shape(V, "V");
+    Matrix out = V;
+    std::vector<complex_t> work(plan_.workspace_size());
+    apply(out, work.data());
+    return out;
+}
+
+std::vector<Matrix> CharacterAttention::forward_batch(std::span<const Matrix> batch, size_t n_threads) const {
+    for (const auto& V : batch) {
+        check_shape(V, "Batch element");
+    }
+
+    SHEAF_TRACE_SCOPE("attention_batch", "attention");
+    std::vector<Matrix> outputs(batch.begin(), batch.end());
+    parallel_for(outputs.size(), n_threads, [&](size_t begin, size_t end, size_t) {
+        std::vector<complex_t> work(plan_.workspace_size());
+        for (size_t b = begin; b < end; ++b) {
+            apply(outputs[b], work.data());
+        }
+    });
+    return outputs;
+}
+
+void CharacterAttention::fit(
+    std::span<const Matrix> V_samples,
+    std::span<const Matrix> targets,
+    real_t ridge,
+    size_t n_threads
+) {
+    if (V_samples.empty() || V_samples.size() != targets.size()) {
+        throw std::invalid_argument("Invalid samples or targets");
+    }
+    for (size_t i = 0; i < V_samples.size(); ++i) {
+        check_shape(V_samples[i], "V");
+        check_shape(targets[i], "Target");
+    }
+
+#ifdef USE_EIGEN3
+    SHEAF_TRACE_SCOPE("attention_fit", "attention");
+    const size_t head_dim = d_model_ / n_heads_;
+    const size_t n_workers = resolve_thread_count(n_threads, V_samples.size());
+
+    // Per-worker sums of conj(X_j) Y_j and |X_j|^2, per head
+    std::vector<Matrix> cross(n_workers, Matrix::Zero(seq_len_, n_heads_));
+    std::vector<RealMatrix> energy(n_workers, RealMatrix::Zero(seq_len_, n_heads_));
+
+    parallel_for(V_samples.size(), n_workers, [&](size_t begin, size_t end, size_t worker) {
+        std::vector<complex_t> work(plan_.workspace_size());
+        std::vector<complex_t> X(seq_len_), Y(seq_len_);
+        for (size_t s = begin; s < end; ++s) {
+            for (size_t c = 0; c < d_model_; ++c) {
+                const size_t head = c / head_dim;
+                for (size_t m = 0; m < seq_len_; ++m) {
+                    X[m] = V_samples[s](m, c);
+                    Y[m] = targets[s](m, c);
+                }
+                plan_.forward(X.data(), work.data());
+                plan_.forward(Y.data(), work.data());
+                for (size_t j = 0; j < seq_len_; ++j) {
+                    cross[worker](j, head) += std::conj(X[j]) * Y[j];
+                    energy[worker](j, head) += std::norm(X[j]);
+                }
+            }
+        }
+    });
+
+    for (size_t w = 1; w < n_workers; ++w) {
+        cross[0] += cross[w];
+        energy[0] += energy[w];
+    }
+
+    for (size_t h = 0; h < n_heads_; ++h) {
+        for (size_t j = 0; j < seq_len_; ++j) {
+            const real_t e = energy[0](j, h) + ridge;
+            coefficients_(j, h) = (e > EPSILON) ? cross[0](j, h) / e : complex_t(0.0, 0.0);
+        }
+    }
+    scale_ = coefficients_ / static_cast<double>(seq_len_);
+#else
+    (void)ridge;
+    (void)n_threads;
+#endif
+}
+
+} // namespace sheaf
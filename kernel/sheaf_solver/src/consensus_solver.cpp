@@ -0,0 +1,407 @@
+/**
+ * @file consensus_solver.cpp
+ * @brief ADMM over boundary gluings, and the fork-based launcher
+ */
+
+#include "sheaf_solver/consensus_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace sheaf {
+
+namespace {
+
+constexpr uint64_t kComplexMac = 8;  // Real flops per complex multiply-add
+
+/**
+ * @brief One side of a boundary gluing owned by this worker
+ */
+struct BoundarySide {
+    size_t gluing;
+    size_t side;                     // 0: patch_1, 1: patch_2
+    size_t peer;                     // Rank owning the other side (may be ours)
+    size_t partner = 0;              // Our row of the other side when peer is us
+    size_t slot = 0;                 // Position in the message to / from peer
+};
+
+/**
+ * @brief The patches `rank` owns, with every gluing
+ */
+SheafProblemView worker_view(
+    const SheafProblem& problem,
+    const std::unordered_map<std::string, size_t>& owner,
+    size_t rank
+) {
+    SheafProblemView view;
+    for (const auto& patch : problem.patches) {
+        if (owner.at(patch.name) != rank) continue;
+        PatchView pv;
+        pv.name = patch.name;
+        pv.config = patch.config;
+        for (const auto& V : patch.V_samples) pv.V_samples.push_back(&V);
+        for (const auto& T : patch.targets) pv.targets.push_back(&T);
+        view.patches.push_back(std::move(pv));
+    }
+    view.gluings = problem.gluings;
+    return view;
+}
+
+} // namespace
+
+ConsensusResult consensus_worker(
+    const SheafProblemView& problem,
+    const std::unordered_map<std::string, size_t>& owner,
+    Transport& transport,
+    UnifiedSheafLearner& learner,
+    const ConsensusOptions& options
+) {
+    SHEAF_TRACE_SCOPE("consensus_worker", "solver");
+    ConsensusResult result;
+    FitStats stats;
+    PhaseTimer timer(stats);
+    const size_t rank = transport.rank();
+
+#ifdef USE_EIGEN3
+    // Split the gluings: soft ones inside this worker stay in the local
+    // system, cut or hard ones become boundary sides
+    SheafProblemView local;
+    for (const auto& patch : problem.patches) {
+        if (owner.at(patch.name) == rank) {
+            local.patches.push_back(patch);
+        }
+    }
+    std::vector<BoundarySide> sides;
+    std::vector<real_t> side_weight;
+    for (size_t i = 0; i < problem.gluings.size(); ++i) {
+        const auto& gluing = problem.gluings[i];
+        const size_t owner_1 = owner.at(gluing.patch_1);
+        const size_t owner_2 = owner.at(gluing.patch_2);
+        if (owner_1 != rank && owner_2 != rank) continue;
+        if (owner_1 == owner_2 && gluing.weight != HARD_GLUING) {
+            local.gluings.push_back(gluing);
+            continue;
+        }
+        if (!(gluing.weight > 0.0)) continue;
+        if (owner_1 == rank) {
+            sides.push_back({i, 0, owner_2});
+        }
+        if (owner_2 == rank) {
+            sides.push_back({i, 1, owner_1});
+            if (owner_1 == rank) {
+                sides[sides.size() - 2].partner = sides.size() - 1;
+                sides.back().partner = sides.size() - 2;
+            }
+        }
+    }
+
+    NormalEquations system = learner.normal_equations(local);
+    const size_t n = system.moment.size();
+    std::unordered_map<std::string, size_t> offset_of(system.layout.begin(), system.layout.end());
+    timer.lap(FitPhase::Gram);
+
+    // Boundary rows: u = F w are this worker's predictions at its sides
+    const size_t m = sides.size();
+    Matrix F = Matrix::Zero(m, n);
+    for (size_t j = 0; j < m; ++j) {
+        const auto& gluing = problem.gluings[sides[j].gluing];
+        const std::string& patch = sides[j].side == 0 ? gluing.patch_1 : gluing.patch_2;
+        const Matrix& data = sides[j].side == 0 ? gluing.constraint_data_1 : gluing.constraint_data_2;
+        Vector f = learner.feature_row(patch, data);
+        F.row(j).segment(offset_of.at(patch), f.size()) = f.transpose();
+    }
+    const Matrix FhF = F.adjoint() * F;
+    stats_add(stats.flops, kComplexMac * m * n * n);
+
+    // Message layout per peer: its sides in gluing order, which both ranks share
+    std::vector<size_t> peers;
+    for (const auto& side : sides) {
+        if (side.peer != rank) peers.push_back(side.peer);
+    }
+    std::sort(peers.begin(), peers.end());
+    peers.erase(std::unique(peers.begin(), peers.end()), peers.end());
+    std::vector<size_t> peer_index(transport.size(), 0);
+    for (size_t k = 0; k < peers.size(); ++k) peer_index[peers[k]] = k;
+    std::vector<size_t> message_size(peers.size(), 0);
+    for (auto& side : sides) {
+        if (side.peer != rank) side.slot = message_size[peer_index[side.peer]]++;
+    }
+    for (const auto& side : sides) {
+        side_weight.push_back(problem.gluings[side.gluing].weight);
+    }
+    timer.lap(FitPhase::GluingBuild);
+
+    // Global sizes and the default penalty: ρ |f|^2 ~ a diagonal entry of the Gram
+    std::vector<complex_t> totals = {
+        complex_t(system.gram.diagonal().real().sum()), complex_t(static_cast<real_t>(n)),
+        complex_t(F.squaredNorm()), complex_t(static_cast<real_t>(m))};
+    transport.allreduce_sum(totals);
+    const real_t m_total = totals[3].real();
+    result.boundary_values = static_cast<size_t>(m_total);
+    real_t rho = options.rho;
+    if (rho <= 0.0) {
+        rho = (m_total > 0.0 && totals[2].real() > 0.0)
+            ? (totals[0].real() / totals[1].real()) / (totals[2].real() / m_total)
+            : 1.0;
+    }
+
+    // s → v: prox of d|v_1 - v_2|^2 + ρ/2 (|v_1 - s_1|^2 + |v_2 - s_2|^2). The
+    // mean of the two sides is kept and their gap shrinks by ρ / (ρ + 4d)
+    auto exchange_values = [&](const Vector& values) {
+        std::vector<std::vector<complex_t>> outgoing(peers.size());
+        for (size_t k = 0; k < peers.size(); ++k) outgoing[k].resize(message_size[k]);
+        for (size_t j = 0; j < m; ++j) {
+            if (sides[j].peer != rank) {
+                outgoing[peer_index[sides[j].peer]][sides[j].slot] = values(j);
+            }
+        }
+        std::vector<std::vector<complex_t>> incoming = transport.exchange(peers, outgoing);
+        Vector other(m);
+        for (size_t j = 0; j < m; ++j) {
+            if (sides[j].peer == rank) {
+                other(j) = values(sides[j].partner);
+            } else {
+                const auto& message = incoming[peer_index[sides[j].peer]];
+                if (message.size() != message_size[peer_index[sides[j].peer]]) {
+                    throw std::runtime_error("Boundary message of unexpected length");
+                }
+                other(j) = message[sides[j].slot];
+            }
+        }
+        return other;
+    };
+    auto prox = [&](const Vector& s, const Vector& other, real_t penalty) {
+        Vector v(m);
+        for (size_t j = 0; j < m; ++j) {
+            const real_t d = side_weight[j];
+            const real_t shrink = d == HARD_GLUING ? 0.0 : penalty / (penalty + 4.0 * d);
+            v(j) = 0.5 * (s(j) + other(j)) + 0.5 * shrink * (s(j) - other(j));
+        }
+        return v;
+    };
+
+    // Start from the purely local fit, its boundary values reconciled
+    Eigen::LLT<Matrix> llt(system.gram);
+    if (llt.info() != Eigen::Success) {
+        throw std::runtime_error("Local system is not positive definite");
+    }
+    Vector w = llt.solve(system.moment);
+    stats_add(stats.flops, kComplexMac * (n * n * n / 6 + 2 * n * n));
+    Vector u = F * w;
+    Vector v = prox(u, exchange_values(u), rho);
+    Vector y = Vector::Zero(m);
+    timer.lap(FitPhase::Solve);
+
+    real_t factored_rho = -1.0;
+    while (m_total > 0.0 && result.iterations < options.max_iterations) {
+        if (rho != factored_rho) {
+            llt.compute(system.gram + (0.5 * rho) * FhF);
+            if (llt.info() != Eigen::Success) {
+                throw std::runtime_error("Local system is not positive definite");
+            }
+            factored_rho = rho;
+            ++result.refactorizations;
+            stats_add(stats.flops, kComplexMac * n * n * n / 6);
+            timer.lap(FitPhase::Factorization);
+        }
+
+        w = llt.solve(system.moment + (0.5 * rho) * (F.adjoint() * (v - y)));
+        u = F * w;
+        const Vector s = u + y;
+        const Vector v_previous = v;
+        v = prox(s, exchange_values(s), rho);
+        y += u - v;
+        ++result.iterations;
+        stats_add(stats.flops, kComplexMac * (2 * n * n + 2 * m * n));
+
+        std::vector<complex_t> norms = {
+            complex_t((u - v).squaredNorm()), complex_t((v - v_previous).squaredNorm()),
+            complex_t(u.squaredNorm()), complex_t(v.squaredNorm()), complex_t(y.squaredNorm())};
+        transport.allreduce_sum(norms);
+        const real_t scale = std::sqrt(m_total);
+        result.primal_residual = std::sqrt(norms[0].real())
+            / (scale + std::sqrt(std::max(norms[2].real(), norms[3].real())));
+        result.dual_residual = rho * std::sqrt(norms[1].real())
+            / (scale + rho * std::sqrt(norms[4].real()));
+        timer.lap(FitPhase::Solve);
+
+        if (result.primal_residual <= options.tolerance && result.dual_residual <= options.tolerance) {
+            result.converged = true;
+            break;
+        }
+        // Residual balancing; every rank sees the same sums and agrees on ρ
+        if (options.adaptive_rho) {
+            if (result.primal_residual > 10.0 * result.dual_residual) {
+                rho *= 2.0;
+                y *= 0.5;
+            } else if (result.dual_residual > 10.0 * result.primal_residual) {
+                rho *= 0.5;
+                y *= 2.0;
+            }
+        }
+    }
+    if (m_total == 0.0) {
+        result.converged = true;
+    }
+    result.rho = rho;
+
+    // Global objective: local parts plus each soft boundary gluing, counted
+    // by the owner of its first side
+    const Vector u_other = exchange_values(u);
+    real_t objective = learner.install_weights(w).residual_error;
+    for (size_t j = 0; j < m; ++j) {
+        if (sides[j].side == 0 && side_weight[j] != HARD_GLUING) {
+            objective += side_weight[j] * std::norm(u(j) - u_other(j));
+        }
+    }
+    std::vector<complex_t> total_objective = {complex_t(objective)};
+    transport.allreduce_sum(total_objective);
+
+    result.solution = learner.get_solution();
+    result.solution.residual_error = total_objective[0].real() < EPSILON ? 0.0 : total_objective[0].real();
+    result.solution.converged = result.solution.residual_error < EPSILON;
+    result.bytes_sent = transport.bytes_sent();
+    timer.lap(FitPhase::Unpack);
+    result.solution.stats = stats;
+#else
+    (void)problem;
+    (void)owner;
+    (void)learner;
+    (void)options;
+    (void)timer;
+    (void)rank;
+    result.solution.residual_error = 1.0;
+    result.solution.converged = false;
+#endif
+    return result;
+}
+
+ConsensusResult fit_consensus(const SheafProblem& problem, const ConsensusOptions& options) {
+    const size_t n_workers = options.n_workers;
+    if (n_workers == 0) {
+        throw std::invalid_argument("fit_consensus() needs at least one worker");
+    }
+    const size_t n_patches = problem.patches.size();
+    std::unordered_map<std::string, size_t> owner;
+    for (size_t p = 0; p < n_patches; ++p) {
+        size_t rank = p * n_workers / std::max<size_t>(n_patches, 1);
+        if (!options.assignment.empty()) {
+            if (options.assignment.size() != n_patches || options.assignment[p] >= n_workers) {
+                throw std::invalid_argument("Assignment needs one worker below n_workers per patch");
+            }
+            rank = options.assignment[p];
+        }
+        owner[problem.patches[p].name] = rank;
+    }
+
+    // Channels are set up before fork() so every process inherits them
+    std::shared_ptr<ShmRingTransport::Segment> segment;
+    std::vector<SocketAddress> addresses(n_workers);
+    std::vector<int> listeners;
+    if (options.transport == TransportKind::SharedMemory) {
+        segment = std::make_shared<ShmRingTransport::Segment>(n_workers, options.ring_bytes);
+    } else {
+        for (auto& address : addresses) {
+            listeners.push_back(SocketTransport::listen(address));
+        }
+    }
+    auto make_transport = [&](size_t rank) -> std::unique_ptr<Transport> {
+        if (segment) {
+            return std::make_unique<ShmRingTransport>(segment, rank, options.timeout);
+        }
+        for (size_t r = 0; r < listeners.size(); ++r) {
+            if (r != rank && listeners[r] >= 0) ::close(listeners[r]);
+        }
+        return std::make_unique<SocketTransport>(rank, addresses, listeners[rank], options.timeout);
+    };
+    auto run = [&](Transport& transport) {
+        UnifiedSheafLearner learner;
+        learner.set_ridge(options.ridge);
+        return consensus_worker(worker_view(problem, owner, transport.rank()), owner,
+                                transport, learner, options);
+    };
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::vector<pid_t> children;
+    auto stop_children = [&children] {
+        for (pid_t pid : children) ::kill(pid, SIGKILL);
+        for (pid_t pid : children) ::waitpid(pid, nullptr, 0);
+    };
+
+    for (size_t rank = 1; rank < n_workers; ++rank) {
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            stop_children();
+            throw std::runtime_error("fork() failed");
+        }
+        if (pid == 0) {
+            // Worker: solve, report its weights to rank 0, and leave without
+            // running the parent's destructors or flushing its buffers
+            int status = 0;
+            try {
+                auto transport = make_transport(rank);
+                ConsensusResult local = run(*transport);
+                std::vector<complex_t> message = {complex_t(static_cast<real_t>(transport->bytes_sent()))};
+                for (const auto& patch : problem.patches) {
+                    if (owner.at(patch.name) != rank) continue;
+                    const Matrix& weights = local.solution.weights.at(patch.name);
+                    message.insert(message.end(), weights.data(), weights.data() + weights.size());
+                }
+                transport->send(0, message);
+            } catch (const std::exception& e) {
+                std::cerr << "consensus worker " << rank << ": " << e.what() << std::endl;
+                status = 1;
+            }
+            ::_exit(status);
+        }
+        children.push_back(pid);
+    }
+
+    ConsensusResult result;
+    try {
+        auto transport = make_transport(0);
+        result = run(*transport);
+        result.bytes_sent = transport->bytes_sent();
+        for (size_t rank = 1; rank < n_workers; ++rank) {
+            std::vector<complex_t> message = transport->receive(rank);
+            size_t at = 1;
+            for (const auto& patch : problem.patches) {
+                if (owner.at(patch.name) != rank) continue;
+                Matrix weights(patch.config.n_positions, patch.config.n_characters);
+                if (at + weights.size() > message.size()) {
+                    throw std::runtime_error("Short weight message from a worker");
+                }
+                std::copy(message.begin() + at, message.begin() + at + weights.size(), weights.data());
+                at += weights.size();
+                result.solution.weights[patch.name] = std::move(weights);
+            }
+            result.bytes_sent += static_cast<uint64_t>(message.at(0).real());
+        }
+    } catch (...) {
+        stop_children();
+        throw;
+    }
+
+    bool workers_ok = true;
+    for (pid_t pid : children) {
+        int status = 0;
+        if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            workers_ok = false;
+        }
+    }
+    if (!workers_ok) {
+        throw std::runtime_error("A consensus worker failed");
+    }
+    return result;
+}
+
+} // namespace sheaf
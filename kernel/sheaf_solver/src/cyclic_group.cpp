@@ -4,6 +4,7 @@
  */
 
 #include "sheaf_solver/cyclic_group.hpp"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
@@ -13,6 +14,7 @@ CyclicGroupCharacters::CyclicGroupCharacters(size_t n)
     : n_(n)
     , omega_(std::polar(1.0, 2.0 * PI / static_cast<double>(n)))
     , characters_(n, n)
+    , plan_(n)
 {
     if (n == 0) {
         throw std::invalid_argument("Group order must be positive");
@@ -22,9 +24,11 @@ CyclicGroupCharacters::CyclicGroupCharacters(size_t n)
 
 void CyclicGroupCharacters::compute_character_table() {
 #ifdef USE_EIGEN3
+    // ω^{jk} = ω^{jk mod n}: reduce the exponent so large orders stay exact
     for (size_t j = 0; j < n_; ++j) {
         for (size_t k = 0; k < n_; ++k) {
-            characters_(j, k) = std::pow(omega_, static_cast<double>(j * k));
+            const double phase = 2.0 * PI * static_cast<double>((j * k) % n_) / static_cast<double>(n_);
+            characters_(j, k) = std::polar(1.0, phase);
         }
     }
 #else
@@ -87,6 +91,17 @@ Matrix CyclicGroupCharacters::project_onto_character(const Matrix& V, size_t j)
     const size_t d_model = V.cols();
     const size_t n = std::min(seq_len, n_);
 
+    if (seq_len == n_) {
+        // Proj_j(V)[i] = (1/n) ω^{-ij} X_j with X_j = Σ_m ω^{jm} V[m]
+        Eigen::RowVectorXcd X_j = characters_.row(j) * V;
+        X_j /= static_cast<double>(n_);
+        Matrix proj(seq_len, d_model);
+        for (size_t i = 0; i < seq_len; ++i) {
+            proj.row(i) = std::conj(characters_(j, i)) * X_j;
+        }
+        return proj;
+    }
+
     Matrix proj = Matrix::Zero(seq_len, d_model);
 
     // Sum over group elements: Proj = (1/n) Σ_k χ̄_j(k) · rotate(V, k)
@@ -137,6 +152,19 @@ std::vector<Matrix> CyclicGroupCharacters::decompose_into_characters(const Matri
 
 #ifdef USE_EIGEN3
     const size_t n = std::min(static_cast<size_t>(V.rows()), n_);
+
+    if (static_cast<size_t>(V.rows()) == n_) {
+        Matrix X = transform(V);
+        X /= static_cast<double>(n_);
+        for (size_t j = 0; j < n_; ++j) {
+            Matrix proj(n_, V.cols());
+            for (size_t i = 0; i < n_; ++i) {
+                proj.row(i) = std::conj(characters_(j, i)) * X.row(j);
+            }
+            projections.push_back(std::move(proj));
+        }
+        return projections;
+    }
 #else
     const size_t n = std::min(V.rows(), n_);
 #endif
@@ -148,6 +176,93 @@ std::vector<Matrix> CyclicGroupCharacters::decompose_into_characters(const Matri
     return projections;
 }
 
+Vector CyclicGroupCharacters::selected_projection_features(
+    const Matrix& V, std::span<const size_t> characters) const
+{
+    if (static_cast<size_t>(V.rows()) != n_) {
+        throw std::invalid_argument("Projection features need exactly n rows");
+    }
+    for (size_t c : characters) {
+        if (c >= n_) {
+            throw std::out_of_range("Character index out of range");
+        }
+    }
+
+#ifdef USE_EIGEN3
+    // projs[c](p, 0) = (1/n) χ̄_c(g^p) X_c: one transform, no projections
+    const size_t k = characters.size();
+    Vector features(n_ * k);
+    const Matrix X = transform(V.col(0));
+    const double inv_n = 1.0 / static_cast<double>(n_);
+
+    for (size_t p = 0; p < n_; ++p) {
+        for (size_t i = 0; i < k; ++i) {
+            const size_t c = characters[i];
+            features(p * k + i) = std::conj(characters_(c, p)) * X(c, 0) * inv_n;
+        }
+    }
+    return features;
+#else
+    return Vector(1);
+#endif
+}
+
+Matrix CyclicGroupCharacters::transform(const Matrix& V) const {
+    if (static_cast<size_t>(V.rows()) != n_) {
+        throw std::invalid_argument("transform() needs exactly n rows");
+    }
+
+#ifdef USE_EIGEN3
+    // Column-major storage: each column is a contiguous sequence
+    Matrix X = V;
+    std::vector<complex_t> work(plan_.workspace_size());
+    for (Eigen::Index c = 0; c < X.cols(); ++c) {
+        plan_.forward(X.col(c).data(), work.data());
+    }
+    return X;
+#else
+    Matrix X(n_, V.cols());
+    for (size_t j = 0; j < n_; ++j) {
+        for (size_t c = 0; c < V.cols(); ++c) {
+            complex_t sum(0, 0);
+            for (size_t m = 0; m < n_; ++m) {
+                sum += characters_(j, m) * V(m, c);
+            }
+            X(j, c) = sum;
+        }
+    }
+    return X;
+#endif
+}
+
+Matrix CyclicGroupCharacters::inverse_transform(const Matrix& X) const {
+    if (static_cast<size_t>(X.rows()) != n_) {
+        throw std::invalid_argument("inverse_transform() needs exactly n rows");
+    }
+
+#ifdef USE_EIGEN3
+    Matrix V = X;
+    std::vector<complex_t> work(plan_.workspace_size());
+    for (Eigen::Index c = 0; c < V.cols(); ++c) {
+        plan_.inverse(V.col(c).data(), work.data());
+    }
+    V /= static_cast<double>(n_);
+    return V;
+#else
+    Matrix V(n_, X.cols());
+    for (size_t m = 0; m < n_; ++m) {
+        for (size_t c = 0; c < X.cols(); ++c) {
+            complex_t sum(0, 0);
+            for (size_t j = 0; j < n_; ++j) {
+                sum += std::conj(characters_(j, m)) * X(j, c);
+            }
+            V(m, c) = sum / static_cast<double>(n_);
+        }
+    }
+    return V;
+#endif
+}
+
 Matrix CyclicGroupCharacters::reconstruct_from_characters(
     const Vector& coefficients,
     const std::vector<Matrix>& projections
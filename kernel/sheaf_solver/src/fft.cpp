@@ -0,0 +1,150 @@
+/**
+ * @file fft.cpp
+ * @brief Radix-2 and Bluestein transforms for the characters of C_n
+ */
+
+#include "sheaf_solver/fft.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace sheaf {
+
+namespace {
+
+bool is_pow2(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+size_t next_pow2(size_t n) {
+    size_t m = 1;
+    while (m < n) m <<= 1;
+    return m;
+}
+
+} // namespace
+
+FourierPlan::FourierPlan(size_t n)
+    : n_(n)
+    , pow2_(is_pow2(n))
+{
+    if (n == 0) {
+        throw std::invalid_argument("Transform size must be positive");
+    }
+
+    if (pow2_) {
+        twiddles_.resize(n / 2);
+        for (size_t k = 0; k < n / 2; ++k) {
+            twiddles_[k] = std::polar(1.0, 2.0 * PI * static_cast<double>(k) / static_cast<double>(n));
+        }
+
+        size_t log_n = 0;
+        while ((size_t{1} << log_n) < n) ++log_n;
+        bitrev_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t r = 0;
+            for (size_t b = 0; b < log_n; ++b) {
+                r |= ((i >> b) & 1) << (log_n - 1 - b);
+            }
+            bitrev_[i] = static_cast<uint32_t>(r);
+        }
+        return;
+    }
+
+    // Bluestein: ω^{jm} = a_j a_m conj(a_{j-m}) with a_k = e^{iπ k²/n},
+    // so the transform is a circular convolution of length M >= 2n - 1
+    const size_t M = next_pow2(2 * n - 1);
+    inner_ = std::make_shared<const FourierPlan>(M);
+
+    chirp_.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        const uint64_t k2 = (static_cast<uint64_t>(k) * k) % (2 * n);  // Exact phase
+        chirp_[k] = std::polar(1.0, PI * static_cast<double>(k2) / static_cast<double>(n));
+    }
+
+    chirp_fft_.assign(M, complex_t(0.0, 0.0));
+    chirp_fft_[0] = std::conj(chirp_[0]);
+    for (size_t k = 1; k < n; ++k) {
+        chirp_fft_[k] = std::conj(chirp_[k]);
+        chirp_fft_[M - k] = std::conj(chirp_[k]);
+    }
+    inner_->forward(chirp_fft_.data(), nullptr);
+
+    // Fold the 1/M of the convolution's inverse transform into the kernel
+    const double scale = 1.0 / static_cast<double>(M);
+    for (auto& v : chirp_fft_) {
+        v *= scale;
+    }
+}
+
+void FourierPlan::radix2(complex_t* x) const {
+    const size_t n = n_;
+    for (size_t i = 0; i < n; ++i) {
+        const size_t r = bitrev_[i];
+        if (i < r) std::swap(x[i], x[r]);
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = n / len;
+        for (size_t base = 0; base < n; base += len) {
+            complex_t* lo = x + base;
+            complex_t* hi = lo + half;
+            for (size_t k = 0; k < half; ++k) {
+                const complex_t v = hi[k] * twiddles_[k * step];
+                hi[k] = lo[k] - v;
+                lo[k] += v;
+            }
+        }
+    }
+}
+
+void FourierPlan::bluestein(complex_t* x, complex_t* work) const {
+    const size_t n = n_;
+    const size_t M = chirp_fft_.size();
+
+    for (size_t m = 0; m < n; ++m) {
+        work[m] = x[m] * chirp_[m];
+    }
+    for (size_t m = n; m < M; ++m) {
+        work[m] = complex_t(0.0, 0.0);
+    }
+
+    inner_->radix2(work);
+    for (size_t k = 0; k < M; ++k) {
+        work[k] *= chirp_fft_[k];
+    }
+    inner_->inverse(work, nullptr);
+
+    for (size_t j = 0; j < n; ++j) {
+        x[j] = chirp_[j] * work[j];
+    }
+}
+
+void FourierPlan::forward(complex_t* x, complex_t* work) const {
+    if (pow2_) {
+        radix2(x);
+    } else {
+        bluestein(x, work);
+    }
+}
+
+void FourierPlan::inverse(complex_t* x, complex_t* work) const {
+    // Σ_j ω^{-jm} X_j = conj(Σ_j ω^{jm} conj(X_j))
+    for (size_t i = 0; i < n_; ++i) x[i] = std::conj(x[i]);
+    forward(x, work);
+    for (size_t i = 0; i < n_; ++i) x[i] = std::conj(x[i]);
+}
+
+void FourierPlan::forward(complex_t* x) const {
+    std::vector<complex_t> work(workspace_size());
+    forward(x, work.data());
+}
+
+void FourierPlan::inverse(complex_t* x) const {
+    std::vector<complex_t> work(workspace_size());
+    inverse(x, work.data());
+}
+
+} // namespace sheaf
@@ -0,0 +1,27 @@
+/**
+ * @file fit_stats.cpp
+ * @brief Phase names for FitStats reporting
+ */
+
+#include "sheaf_solver/fit_stats.hpp"
+
+namespace sheaf {
+
+const char* phase_name(FitPhase phase) {
+    switch (phase) {
+        case FitPhase::LocalBuild:       return "local_build";
+        case FitPhase::GluingBuild:      return "gluing_build";
+        case FitPhase::Assembly:         return "assembly";
+        case FitPhase::Gram:             return "gram";
+        case FitPhase::Factorization:    return "factorization";
+        case FitPhase::Solve:            return "solve";
+        case FitPhase::Residual:         return "residual";
+        case FitPhase::Unpack:           return "unpack";
+        case FitPhase::PredictFeaturize: return "predict_featurize";
+        case FitPhase::PredictEvaluate:  return "predict_evaluate";
+        case FitPhase::Count:            break;
+    }
+    return "unknown";
+}
+
+} // namespace sheaf
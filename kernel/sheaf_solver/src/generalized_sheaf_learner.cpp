@@ -0,0 +1,155 @@
+/**
+ * @file generalized_sheaf_learner.cpp
+ * @brief Implementation of the generalized sheaf learner
+ */
+
+#include "sheaf_solver/generalized_sheaf_learner.hpp"
+#include "sheaf_solver/parallel.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace sheaf {
+
+GeneralizedSheafLearner::GeneralizedSheafLearner(bool verbose, size_t n_threads)
+    : verbose_(verbose)
+    , n_threads_(n_threads)
+    , unified_(verbose)
+{}
+
+SheafSolution GeneralizedSheafLearner::fit(
+    std::span<const Matrix> V_samples,
+    std::span<const Matrix> targets,
+    const GeneralizedConfig& config,
+    ConditioningFunction conditioning
+) {
+    if (V_samples.size() != targets.size()) {
+        throw std::invalid_argument("V_samples and targets must have the same length");
+    }
+    if (!conditioning) {
+        throw std::invalid_argument("Conditioning function is empty");
+    }
+
+    SHEAF_TRACE_SCOPE("generalized_fit", "solver");
+    conditioning_ = std::move(conditioning);
+
+    // Step 1: Conditioning - partition the stream into patches
+    partitions_ = partition(V_samples);
+
+    if (verbose_) {
+        std::cout << "Conditioning: " << V_samples.size() << " samples -> "
+                  << partitions_.size() << " patches\n";
+    }
+
+    // Step 2: Sheaf construction - one view per partition, no sample copies
+    SheafProblemView problem;
+    problem.patches.resize(partitions_.size());
+    problem.gluings = config.gluings;
+
+    parallel_for(partitions_.size(), n_threads_, [&](size_t begin, size_t end, size_t) {
+        for (size_t p = begin; p < end; ++p) {
+            const SamplePartition& part = partitions_[p];
+            PatchView& view = problem.patches[p];
+            view.name = part.key;
+            view.config.n_positions = static_cast<size_t>(V_samples[part.indices.front()].rows());
+            view.config.n_characters = config.n_characters;
+            view.config.d_model = config.d_model;
+
+            view.V_samples.reserve(part.indices.size());
+            view.targets.reserve(part.indices.size());
+            for (size_t idx : part.indices) {
+                if (static_cast<size_t>(V_samples[idx].rows()) != view.config.n_positions) {
+                    throw std::invalid_argument(
+                        "Samples in patch '" + part.key + "' have different lengths");
+                }
+                view.V_samples.push_back(&V_samples[idx]);
+                view.targets.push_back(&targets[idx]);
+            }
+        }
+    });
+
+    // Step 3: Solve with the unified learner
+    return unified_.fit(problem);
+}
+
+std::vector<SamplePartition>
+GeneralizedSheafLearner::partition(std::span<const Matrix> V_samples) const {
+    SHEAF_TRACE_SCOPE("partition", "solver");
+    const size_t n = V_samples.size();
+
+    // Pass 1: keys and hashes
+    std::vector<std::string> keys(n);
+    std::vector<size_t> hashes(n);
+    parallel_for(n, n_threads_, [&](size_t begin, size_t end, size_t) {
+        std::hash<std::string> hasher;
+        for (size_t i = begin; i < end; ++i) {
+            keys[i] = conditioning_(V_samples[i]);
+            hashes[i] = hasher(keys[i]);
+        }
+    });
+
+    // Pass 2: worker w groups the samples whose hash maps to it
+    const size_t n_owners = resolve_thread_count(n_threads_, n);
+    std::vector<std::vector<SamplePartition>> owned(n_owners);
+    parallel_for(n_owners, n_owners, [&](size_t begin, size_t end, size_t) {
+        for (size_t owner = begin; owner < end; ++owner) {
+            std::vector<SamplePartition>& parts = owned[owner];
+            std::unordered_map<std::string_view, size_t> slot;
+            for (size_t i = 0; i < n; ++i) {
+                if (hashes[i] % n_owners != owner) {
+                    continue;
+                }
+                auto [it, inserted] = slot.try_emplace(keys[i], parts.size());
+                if (inserted) {
+                    parts.push_back(SamplePartition{keys[i], {}});
+                }
+                parts[it->second].indices.push_back(i);
+            }
+        }
+    });
+
+    // Merge, ordered by first occurrence
+    std::vector<SamplePartition> result;
+    for (auto& parts : owned) {
+        for (auto& part : parts) {
+            result.push_back(std::move(part));
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const SamplePartition& a, const SamplePartition& b) {
+                  return a.indices.front() < b.indices.front();
+              });
+    return result;
+}
+
+Matrix GeneralizedSheafLearner::predict(const Matrix& V) const {
+    if (!is_fitted()) {
+        throw std::runtime_error("Model not fitted");
+    }
+
+    const std::string key = conditioning_(V);
+    if (unified_.get_solution().weights.count(key) == 0) {
+        throw std::out_of_range("No fitted patch for conditioning key '" + key + "'");
+    }
+    return unified_.predict(key, V);
+}
+
+std::vector<Matrix> GeneralizedSheafLearner::predict_batch(std::span<const Matrix> V_samples) const {
+    if (!is_fitted()) {
+        throw std::runtime_error("Model not fitted");
+    }
+
+    SHEAF_TRACE_SCOPE("predict_batch", "solver");
+    std::vector<Matrix> results(V_samples.size());
+    parallel_for(V_samples.size(), n_threads_, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            results[i] = predict(V_samples[i]);
+        }
+    });
+    return results;
+}
+
+} // namespace sheaf
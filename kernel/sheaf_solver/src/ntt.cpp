@@ -0,0 +1,364 @@
+/**
+ * @file ntt.cpp
+ * @brief Montgomery arithmetic and the number-theoretic character transform
+ */
+
+#include "sheaf_solver/ntt.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace sheaf {
+
+namespace {
+
+bool is_pow2(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+size_t next_pow2(size_t n) {
+    size_t m = 1;
+    while (m < n) m <<= 1;
+    return m;
+}
+
+bool is_prime(uint32_t q) {
+    if (q < 2) return false;
+    if (q % 2 == 0) return q == 2;
+    for (uint32_t d = 3; static_cast<uint64_t>(d) * d <= q; d += 2) {
+        if (q % d == 0) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// MontgomeryField
+// ============================================================================
+
+MontgomeryField::MontgomeryField(uint32_t q)
+    : q_(q)
+{
+    if (q < 3 || q >= (uint32_t{1} << 31) || !is_prime(q)) {
+        throw std::invalid_argument("Modulus must be an odd prime below 2^31");
+    }
+
+    // Newton iteration for q^{-1} mod 2^32 (each step doubles the valid bits)
+    uint32_t inv = q;
+    for (int i = 0; i < 5; ++i) {
+        inv *= 2 - q * inv;
+    }
+    q_inv_neg_ = 0u - inv;
+
+    const uint64_t r = (uint64_t{1} << 32) % q;
+    r2_ = static_cast<uint32_t>((r * r) % q);
+}
+
+uint32_t MontgomeryField::pow(uint32_t a, uint64_t e) const {
+    uint32_t result = 1;
+    uint32_t base = to_mont(a);
+    while (e != 0) {
+        if (e & 1) {
+            result = mul_mont(result, base);
+        }
+        base = mul_mont(base, base);   // Stays in Montgomery form
+        e >>= 1;
+    }
+    return result;
+}
+
+uint32_t MontgomeryField::from_int(int64_t v) const {
+    int64_t r = v % static_cast<int64_t>(q_);
+    if (r < 0) r += q_;
+    return static_cast<uint32_t>(r);
+}
+
+uint32_t MontgomeryField::primitive_root() const {
+    std::vector<uint32_t> factors;
+    uint32_t m = q_ - 1;
+    for (uint32_t p = 2; static_cast<uint64_t>(p) * p <= m; ++p) {
+        if (m % p == 0) {
+            factors.push_back(p);
+            while (m % p == 0) m /= p;
+        }
+    }
+    if (m > 1) factors.push_back(m);
+
+    for (uint32_t g = 2; g < q_; ++g) {
+        bool generator = true;
+        for (uint32_t p : factors) {
+            if (pow(g, (q_ - 1) / p) == 1) {
+                generator = false;
+                break;
+            }
+        }
+        if (generator) return g;
+    }
+    throw std::runtime_error("No primitive root found");
+}
+
+// ============================================================================
+// NttCyclicGroupCharacters
+// ============================================================================
+
+NttCyclicGroupCharacters::NttCyclicGroupCharacters(size_t n, uint32_t q)
+    : n_(n)
+    , field_(q)
+    , pow2_(is_pow2(n))
+{
+    if (n == 0 || (q - 1) % n != 0) {
+        throw std::invalid_argument("Group order must divide q - 1");
+    }
+
+    const MontgomeryField& F = field_;
+    const uint32_t g = F.primitive_root();
+    root_ = F.pow(g, (q - 1) / n);
+    n_inv_mont_ = F.to_mont(F.inv(static_cast<uint32_t>(n % q)));
+
+    powers_mont_.resize(n);
+    uint32_t w = 1;
+    for (size_t k = 0; k < n; ++k) {
+        powers_mont_[k] = F.to_mont(w);
+        w = F.mul(w, root_);
+    }
+
+    if (!pow2_) {
+        // Bluestein: ω^{jm} = ψ^{j²} ψ^{m²} ψ^{-(j-m)²} with ψ of order 2n
+        // (ψ² = ω, same generator), so the transform is a cyclic
+        // convolution of length M >= 2n - 1
+        const size_t M = next_pow2(2 * n - 1);
+        if ((q - 1) % (2 * static_cast<uint64_t>(n)) != 0 || (q - 1) % M != 0) {
+            return;
+        }
+        inner_ = std::make_shared<const NttCyclicGroupCharacters>(M, q);
+
+        const uint32_t psi = F.pow(g, (q - 1) / (2 * static_cast<uint64_t>(n)));
+        const uint32_t psi_inv = F.inv(psi);
+        chirp_mont_.resize(n);
+        chirp_inv_mont_.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            const uint64_t k2 = (static_cast<uint64_t>(k) * k) % (2 * n);
+            chirp_mont_[k] = F.to_mont(F.pow(psi, k2));
+            chirp_inv_mont_[k] = F.to_mont(F.pow(psi_inv, k2));
+        }
+
+        // Fold the M^{-1} of the convolution's inverse transform into the kernels
+        const uint32_t m_inv_mont = F.to_mont(F.inv(static_cast<uint32_t>(M % q)));
+        auto make_kernel = [&](const std::vector<uint32_t>& chirp) {
+            std::vector<uint32_t> kernel(M, 0);
+            kernel[0] = F.reduce(chirp[0]);
+            for (size_t k = 1; k < n; ++k) {
+                kernel[k] = kernel[M - k] = F.reduce(chirp[k]);
+            }
+            inner_->radix2(kernel.data(), inner_->stage_tw_.data());
+            for (uint32_t& v : kernel) {
+                v = F.to_mont(F.mul_mont(v, m_inv_mont));
+            }
+            return kernel;
+        };
+        kernel_mont_ = make_kernel(chirp_inv_mont_);
+        kernel_inv_mont_ = make_kernel(chirp_mont_);
+        return;
+    }
+
+    // Stage with half-length h uses ω^{k·n/(2h)}, k < h, stored at offset h - 1
+    stage_tw_.resize(n > 1 ? n - 1 : 0);
+    stage_tw_inv_.resize(stage_tw_.size());
+    for (size_t h = 1; h < n; h <<= 1) {
+        const size_t stride = n / (2 * h);
+        for (size_t k = 0; k < h; ++k) {
+            stage_tw_[h - 1 + k] = powers_mont_[k * stride];
+            stage_tw_inv_[h - 1 + k] = powers_mont_[(n - k * stride) % n];
+        }
+    }
+
+    size_t log_n = 0;
+    while ((size_t{1} << log_n) < n) ++log_n;
+    bitrev_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < log_n; ++b) {
+            r |= ((i >> b) & 1) << (log_n - 1 - b);
+        }
+        bitrev_[i] = static_cast<uint32_t>(r);
+    }
+}
+
+uint32_t NttCyclicGroupCharacters::character(size_t j, size_t k) const {
+    const size_t idx = static_cast<size_t>((static_cast<uint64_t>(j % n_) * (k % n_)) % n_);
+    return field_.reduce(powers_mont_[idx]);
+}
+
+void NttCyclicGroupCharacters::radix2(uint32_t* x, const uint32_t* twiddles) const {
+    for (size_t i = 0; i < n_; ++i) {
+        const size_t r = bitrev_[i];
+        if (i < r) std::swap(x[i], x[r]);
+    }
+
+    // Local copy: the field constants must not alias x for the butterfly
+    // loops to vectorize
+    const MontgomeryField F = field_;
+    for (size_t h = 1; h < n_; h <<= 1) {
+        const uint32_t* __restrict tw = twiddles + (h - 1);
+        for (size_t start = 0; start < n_; start += 2 * h) {
+            uint32_t* __restrict lo = x + start;
+            uint32_t* __restrict hi = lo + h;
+            for (size_t k = 0; k < h; ++k) {
+                const uint32_t u = lo[k];
+                const uint32_t v = F.mul_mont(hi[k], tw[k]);
+                lo[k] = F.add(u, v);
+                hi[k] = F.sub(u, v);
+            }
+        }
+    }
+}
+
+void NttCyclicGroupCharacters::bluestein(uint32_t* x, bool inverse_sign) const {
+    const size_t M = inner_->n_;
+    const uint32_t* chirp = inverse_sign ? chirp_inv_mont_.data() : chirp_mont_.data();
+    const uint32_t* kernel = inverse_sign ? kernel_inv_mont_.data() : kernel_mont_.data();
+    const MontgomeryField F = field_;
+
+    std::vector<uint32_t> work(M, 0);
+    for (size_t m = 0; m < n_; ++m) {
+        work[m] = F.mul_mont(x[m], chirp[m]);
+    }
+    inner_->radix2(work.data(), inner_->stage_tw_.data());
+    for (size_t k = 0; k < M; ++k) {
+        work[k] = F.mul_mont(work[k], kernel[k]);
+    }
+    inner_->radix2(work.data(), inner_->stage_tw_inv_.data());
+
+    for (size_t j = 0; j < n_; ++j) {
+        x[j] = F.mul_mont(work[j], chirp[j]);
+    }
+}
+
+void NttCyclicGroupCharacters::direct(uint32_t* x, bool inverse_sign) const {
+    std::vector<uint32_t> out(n_, 0);
+    for (size_t j = 0; j < n_; ++j) {
+        uint32_t acc = 0;
+        size_t idx = 0;
+        const size_t step = inverse_sign ? (n_ - j) % n_ : j;
+        for (size_t m = 0; m < n_; ++m) {
+            acc = field_.add(acc, field_.mul_mont(x[m], powers_mont_[idx]));
+            idx += step;
+            if (idx >= n_) idx -= n_;
+        }
+        out[j] = acc;
+    }
+    std::copy(out.begin(), out.end(), x);
+}
+
+void NttCyclicGroupCharacters::forward(uint32_t* x) const {
+    if (pow2_) {
+        radix2(x, stage_tw_.data());
+    } else if (inner_) {
+        bluestein(x, false);
+    } else {
+        direct(x, false);
+    }
+}
+
+void NttCyclicGroupCharacters::inverse(uint32_t* x) const {
+    if (pow2_) {
+        radix2(x, stage_tw_inv_.data());
+    } else if (inner_) {
+        bluestein(x, true);
+    } else {
+        direct(x, true);
+    }
+    const MontgomeryField F = field_;
+    for (size_t i = 0; i < n_; ++i) {
+        x[i] = F.mul_mont(x[i], n_inv_mont_);
+    }
+}
+
+std::vector<uint32_t> NttCyclicGroupCharacters::transform(std::span<const uint32_t> V, size_t d_model) const {
+    if (V.size() != n_ * d_model) {
+        throw std::invalid_argument("V must be [n, d_model]");
+    }
+    std::vector<uint32_t> X(V.begin(), V.end());
+    for (size_t c = 0; c < d_model; ++c) {
+        forward(X.data() + c * n_);
+    }
+    return X;
+}
+
+std::vector<uint32_t> NttCyclicGroupCharacters::inverse_transform(std::span<const uint32_t> X, size_t d_model) const {
+    if (X.size() != n_ * d_model) {
+        throw std::invalid_argument("X must be [n, d_model]");
+    }
+    std::vector<uint32_t> V(X.begin(), X.end());
+    for (size_t c = 0; c < d_model; ++c) {
+        inverse(V.data() + c * n_);
+    }
+    return V;
+}
+
+std::vector<std::vector<uint32_t>> NttCyclicGroupCharacters::decompose_into_characters(
+    std::span<const uint32_t> V, size_t d_model) const
+{
+    const std::vector<uint32_t> X = transform(V, d_model);
+
+    std::vector<std::vector<uint32_t>> projections(n_, std::vector<uint32_t>(n_ * d_model));
+    for (size_t j = 0; j < n_; ++j) {
+        auto& proj = projections[j];
+        for (size_t c = 0; c < d_model; ++c) {
+            // Proj_j[i] = n^{-1} ω^{-ij} X_j
+            const uint32_t coef = field_.mul_mont(X[c * n_ + j], n_inv_mont_);
+            size_t idx = 0;
+            const size_t step = (n_ - j) % n_;
+            for (size_t i = 0; i < n_; ++i) {
+                proj[c * n_ + i] = field_.mul_mont(coef, powers_mont_[idx]);
+                idx += step;
+                if (idx >= n_) idx -= n_;
+            }
+        }
+    }
+    return projections;
+}
+
+std::vector<uint32_t> NttCyclicGroupCharacters::reconstruct_from_characters(
+    std::span<const uint32_t> coefficients,
+    const std::vector<std::vector<uint32_t>>& projections) const
+{
+    if (projections.empty() || coefficients.size() != projections.size()) {
+        throw std::invalid_argument("Need one coefficient per projection");
+    }
+
+    const size_t len = projections[0].size();
+    std::vector<uint32_t> result(len, 0);
+    for (size_t j = 0; j < projections.size(); ++j) {
+        if (projections[j].size() != len) {
+            throw std::invalid_argument("Projections must have equal shape");
+        }
+        const uint32_t c = field_.to_mont(coefficients[j] % field_.modulus());
+        for (size_t i = 0; i < len; ++i) {
+            result[i] = field_.add(result[i], field_.mul_mont(projections[j][i], c));
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> NttCyclicGroupCharacters::convolve(
+    std::span<const uint32_t> a, std::span<const uint32_t> b) const
+{
+    if (a.size() != n_ || b.size() != n_) {
+        throw std::invalid_argument("Convolution operands must have length n");
+    }
+
+    std::vector<uint32_t> A(a.begin(), a.end());
+    std::vector<uint32_t> B(b.begin(), b.end());
+    forward(A.data());
+    forward(B.data());
+    for (size_t j = 0; j < n_; ++j) {
+        A[j] = field_.mul(A[j], B[j]);
+    }
+    inverse(A.data());
+    return A;
+}
+
+} // namespace sheaf
@@ -0,0 +1,111 @@
+/**
+ * @file sliding_window.cpp
+ * @brief Implementation of the sliding character transform
+ */
+
+#include "sheaf_solver/sliding_window.hpp"
+
+#include <stdexcept>
+
+namespace sheaf {
+
+SlidingCharacterWindow::SlidingCharacterWindow(size_t n, size_t d_model, size_t resync_interval)
+    : n_(n)
+    , d_model_(d_model)
+    , resync_interval_(resync_interval)
+    , plan_(n)
+    , shift_(n)
+    , ring_(n, d_model)
+    , spectrum_(n, d_model)
+{
+    if (d_model == 0) {
+        throw std::invalid_argument("d_model must be positive");
+    }
+    for (size_t j = 0; j < n; ++j) {
+        shift_[j] = std::polar(1.0, -2.0 * PI * static_cast<double>(j) / static_cast<double>(n));
+    }
+#ifdef USE_EIGEN3
+    ring_.setZero();
+    spectrum_.setZero();
+#endif
+}
+
+void SlidingCharacterWindow::reset(const Matrix& window) {
+    if (static_cast<size_t>(window.rows()) != n_ || static_cast<size_t>(window.cols()) != d_model_) {
+        throw std::invalid_argument("Window must be [n, d_model]");
+    }
+#ifdef USE_EIGEN3
+    ring_ = window;
+#endif
+    oldest_ = 0;
+    count_ = n_;
+    resync();
+}
+
+void SlidingCharacterWindow::push(const complex_t* sample) {
+#ifdef USE_EIGEN3
+    for (size_t c = 0; c < d_model_; ++c) {
+        const complex_t delta = sample[c] - ring_(oldest_, c);
+        complex_t* X = spectrum_.col(c).data();
+        for (size_t j = 0; j < n_; ++j) {
+            X[j] = shift_[j] * (X[j] + delta);
+        }
+        ring_(oldest_, c) = sample[c];
+    }
+#else
+    (void)sample;
+#endif
+    oldest_ = (oldest_ + 1 == n_) ? 0 : oldest_ + 1;
+    ++count_;
+
+    if (resync_interval_ != 0 && ++since_resync_ >= resync_interval_) {
+        resync();
+    }
+}
+
+void SlidingCharacterWindow::push(complex_t sample) {
+    if (d_model_ != 1) {
+        throw std::invalid_argument("Scalar push needs d_model == 1");
+    }
+    push(&sample);
+}
+
+Matrix SlidingCharacterWindow::window() const {
+    Matrix W(n_, d_model_);
+#ifdef USE_EIGEN3
+    const size_t tail = n_ - oldest_;
+    W.topRows(tail) = ring_.bottomRows(tail);
+    W.bottomRows(oldest_) = ring_.topRows(oldest_);
+#endif
+    return W;
+}
+
+void SlidingCharacterWindow::resync() {
+#ifdef USE_EIGEN3
+    spectrum_ = window();
+    std::vector<complex_t> work(plan_.workspace_size());
+    for (size_t c = 0; c < d_model_; ++c) {
+        plan_.forward(spectrum_.col(c).data(), work.data());
+    }
+#endif
+    since_resync_ = 0;
+}
+
+Matrix SlidingCharacterWindow::projection(size_t j) const {
+    if (j >= n_) {
+        throw std::out_of_range("Character index out of range");
+    }
+
+    Matrix proj(n_, d_model_);
+#ifdef USE_EIGEN3
+    // Proj_j[i] = (1/n) ω^{-ij} X_j
+    const double inv_n = 1.0 / static_cast<double>(n_);
+    for (size_t i = 0; i < n_; ++i) {
+        const double phase = -2.0 * PI * static_cast<double>((i * j) % n_) / static_cast<double>(n_);
+        proj.row(i) = std::polar(inv_n, phase) * spectrum_.row(j);
+    }
+#endif
+    return proj;
+}
+
+} // namespace sheaf
@@ -0,0 +1,81 @@
+/**
+ * @file symmetry_group.cpp
+ * @brief Group selection from a patch configuration
+ */
+
+#include "sheaf_solver/symmetry_group.hpp"
+#include "sheaf_solver/abelian_group.hpp"
+#include "sheaf_solver/cyclic_group.hpp"
+#include "sheaf_solver/wreath_product.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace sheaf {
+
+Vector SymmetryGroup::projection_features(const Matrix& V, size_t n_characters) const {
+    std::vector<size_t> characters(std::min(n_characters, n_irreps()));
+    std::iota(characters.begin(), characters.end(), size_t{0});
+    if (characters.size() == n_characters) {
+        return selected_projection_features(V, characters);
+    }
+
+#ifdef USE_EIGEN3
+    // Fewer irreps than requested: the trailing characters stay zero
+    const Vector compact = selected_projection_features(V, characters);
+    const size_t k = characters.size();
+    Vector features = Vector::Zero(order() * n_characters);
+    for (size_t p = 0; p < order(); ++p) {
+        features.segment(p * n_characters, k) = compact.segment(p * k, k);
+    }
+    return features;
+#else
+    return Vector(1);
+#endif
+}
+
+std::vector<size_t> symmetry_group_shape(const PatchConfig& config) {
+    if (config.group_kind == SymmetryKind::Wreath) {
+        if (config.group_shape.size() != 2) {
+            throw std::invalid_argument("Wreath group_shape must be {m, n}");
+        }
+        // Constructing the group would validate too; this stays cheap
+        const size_t m = config.group_shape[0], n = config.group_shape[1];
+        size_t order = n;
+        for (size_t i = 0; i < n && order <= config.n_positions; ++i) {
+            order *= m;
+        }
+        if (m == 0 || n == 0 || order != config.n_positions) {
+            throw std::invalid_argument("Wreath group C_m ≀ C_n needs n_positions = m^n · n");
+        }
+        return config.group_shape;
+    }
+
+    if (config.group_shape.empty()) {
+        return {config.n_positions};
+    }
+
+    size_t order = 1;
+    for (size_t n : config.group_shape) {
+        order *= n;
+    }
+    if (order != config.n_positions) {
+        throw std::invalid_argument("group_shape must multiply out to n_positions");
+    }
+    return config.group_shape;
+}
+
+std::unique_ptr<SymmetryGroup> make_symmetry_group(const PatchConfig& config) {
+    std::vector<size_t> shape = symmetry_group_shape(config);
+    if (config.group_kind == SymmetryKind::Wreath) {
+        return std::make_unique<WreathProductCharacters>(shape[0], shape[1]);
+    }
+    if (shape.size() == 1) {
+        return std::make_unique<CyclicGroupCharacters>(shape[0]);
+    }
+    return std::make_unique<AbelianGroupCharacters>(std::move(shape));
+}
+
+} // namespace sheaf
@@ -0,0 +1,225 @@
+/**
+ * @file trace.cpp
+ * @brief Per-thread span buffers and Chrome Trace Event export
+ */
+
+#include "sheaf_solver/trace.hpp"
+
+#ifdef SHEAF_SOLVER_TRACE
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sheaf {
+namespace trace {
+
+namespace detail {
+std::atomic<bool> g_enabled{false};
+}
+
+namespace {
+
+/**
+ * @brief Span storage owned by one thread (single writer)
+ */
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    std::string name;
+    std::unique_ptr<Event[]> events;
+    std::atomic<std::size_t> count{0};      // Published events (release/acquire)
+    std::atomic<uint64_t> dropped{0};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> free;   // Buffers of threads that have exited
+};
+
+Registry& registry() {
+    // Deliberately leaked so buffers outlive thread_local destructors at exit
+    static Registry* r = new Registry;
+    return *r;
+}
+
+/**
+ * @brief A thread's claim on a buffer, returned to the free list at thread exit
+ *
+ * parallel_for() starts fresh threads on every call, so buffers are recycled:
+ * a new thread keeps appending to a dead thread's buffer (and its track in
+ * the trace) instead of allocating another one.
+ */
+struct BufferLease {
+    ThreadBuffer* buffer = nullptr;
+
+    ~BufferLease() {
+        if (buffer) {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.free.push_back(buffer);
+        }
+    }
+};
+
+ThreadBuffer& local_buffer() {
+    thread_local BufferLease lease;
+    if (!lease.buffer) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.free.empty()) {
+            lease.buffer = r.free.back();
+            r.free.pop_back();
+        } else {
+            auto b = std::make_unique<ThreadBuffer>();
+            b->events = std::make_unique<Event[]>(kEventsPerThread);
+            b->tid = static_cast<uint32_t>(r.buffers.size() + 1);
+            b->name = "thread " + std::to_string(b->tid);
+            lease.buffer = b.get();
+            r.buffers.push_back(std::move(b));
+        }
+    }
+    return *lease.buffer;
+}
+
+void write_escaped(std::ostream& out, const char* s) {
+    for (; *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out << buf;
+        } else {
+            out << c;
+        }
+    }
+}
+
+void write_us(std::ostream& out, uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03llu",
+                  static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    out << buf;
+}
+
+} // namespace
+
+void set_enabled(bool enabled) {
+    detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void set_thread_name(const std::string& name) {
+    ThreadBuffer& b = local_buffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    b.name = name;
+}
+
+void record(const char* name, const char* category,
+            uint64_t begin_ns, uint64_t end_ns, const char* arg) {
+    ThreadBuffer& b = local_buffer();
+    const std::size_t n = b.count.load(std::memory_order_relaxed);
+    if (n >= kEventsPerThread) {
+        b.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& e = b.events[n];
+    e.name = name;
+    e.category = category;
+    e.begin_ns = begin_ns;
+    e.end_ns = end_ns;
+    std::size_t len = 0;
+    if (arg) {
+        for (; len < kMaxArgLength && arg[len]; ++len) {
+            e.arg[len] = arg[len];
+        }
+    }
+    e.arg[len] = '\0';
+
+    b.count.store(n + 1, std::memory_order_release);
+}
+
+void clear() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& b : r.buffers) {
+        b->count.store(0, std::memory_order_relaxed);
+        b->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t dropped() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint64_t total = 0;
+    for (const auto& b : r.buffers) {
+        total += b->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void write_chrome_trace(std::ostream& out) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // Timestamps are written relative to the earliest span
+    uint64_t origin = UINT64_MAX;
+    for (const auto& b : r.buffers) {
+        const std::size_t n = b->count.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i) {
+            origin = std::min(origin, b->events[i].begin_ns);
+        }
+    }
+    if (origin == UINT64_MAX) origin = 0;
+
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    bool first = true;
+    for (const auto& b : r.buffers) {
+        out << (first ? "" : ",\n")
+            << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->tid
+            << ", \"args\": {\"name\": \"";
+        write_escaped(out, b->name.c_str());
+        out << "\"}}";
+        first = false;
+
+        const std::size_t n = b->count.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Event& e = b->events[i];
+            out << ",\n{\"name\": \"";
+            write_escaped(out, e.name);
+            out << "\", \"cat\": \"";
+            write_escaped(out, e.category);
+            out << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << b->tid << ", \"ts\": ";
+            write_us(out, e.begin_ns - origin);
+            out << ", \"dur\": ";
+            write_us(out, e.end_ns - e.begin_ns);
+            if (e.arg[0]) {
+                out << ", \"args\": {\"arg\": \"";
+                write_escaped(out, e.arg);
+                out << "\"}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool write_chrome_trace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    write_chrome_trace(out);
+    return static_cast<bool>(out);
+}
+
+} // namespace trace
+} // namespace sheaf
+
+#endif // SHEAF_SOLVER_TRACE
@@ -0,0 +1,438 @@
+/**
+ * @file transport.cpp
+ * @brief Shared-memory ring and TCP transports
+ */
+
+#include "sheaf_solver/transport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace sheaf {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Spin, then yield, then sleep while a channel makes no progress
+ */
+class Backoff {
+public:
+    explicit Backoff(std::chrono::milliseconds timeout)
+        : deadline_(Clock::now() + timeout) {}
+
+    void wait(const char* what) {
+        ++idle_;
+        if (idle_ < 64) {
+            return;
+        }
+        if (Clock::now() > deadline_) {
+            throw std::runtime_error(std::string("Transport timed out while ") + what);
+        }
+        if (idle_ < 1024) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+
+    void progress(std::chrono::milliseconds timeout) {
+        idle_ = 0;
+        deadline_ = Clock::now() + timeout;
+    }
+
+private:
+    Clock::time_point deadline_;
+    unsigned idle_ = 0;
+};
+
+std::runtime_error system_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+int remaining_ms(Clock::time_point deadline) {
+    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+    return static_cast<int>(std::max<int64_t>(left.count(), 0));
+}
+
+/**
+ * @brief poll() one descriptor for `events` until the deadline
+ */
+void wait_ready(int fd, short events, Clock::time_point deadline, const char* what) {
+    while (true) {
+        pollfd pfd{fd, events, 0};
+        const int ready = ::poll(&pfd, 1, remaining_ms(deadline));
+        if (ready > 0) {
+            return;
+        }
+        if (ready == 0) {
+            throw std::runtime_error(std::string("Transport timed out while ") + what);
+        }
+        if (errno != EINTR) {
+            throw system_error("poll");
+        }
+    }
+}
+
+sockaddr_in make_address(const SocketAddress& address) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(address.port);
+    if (::inet_pton(AF_INET, address.host.c_str(), &addr.sin_addr) != 1) {
+        throw std::invalid_argument("Not an IPv4 address: " + address.host);
+    }
+    return addr;
+}
+
+} // namespace
+
+// ============================================================================
+// Transport
+// ============================================================================
+
+void Transport::check_peer(size_t peer) const {
+    if (peer >= size() || peer == rank()) {
+        throw std::out_of_range("Invalid peer rank");
+    }
+}
+
+std::vector<std::vector<complex_t>> Transport::exchange(
+    std::span<const size_t> peers,
+    const std::vector<std::vector<complex_t>>& outgoing
+) {
+    if (outgoing.size() != peers.size()) {
+        throw std::invalid_argument("Expected one outgoing message per peer");
+    }
+    std::vector<std::vector<complex_t>> incoming(peers.size());
+    for (size_t i = 0; i < peers.size(); ++i) {
+        if (i > 0 && peers[i] <= peers[i - 1]) {
+            throw std::invalid_argument("Peers must be distinct and ascending");
+        }
+        if (peers[i] < rank()) {
+            incoming[i] = receive(peers[i]);
+            send(peers[i], outgoing[i]);
+        } else {
+            send(peers[i], outgoing[i]);
+            incoming[i] = receive(peers[i]);
+        }
+    }
+    return incoming;
+}
+
+void Transport::allreduce_sum(std::span<complex_t> values) {
+    if (size() == 1) {
+        return;
+    }
+    if (rank() == 0) {
+        for (size_t peer = 1; peer < size(); ++peer) {
+            std::vector<complex_t> part = receive(peer);
+            if (part.size() != values.size()) {
+                throw std::runtime_error("allreduce_sum: ranks disagree on the length");
+            }
+            for (size_t i = 0; i < values.size(); ++i) {
+                values[i] += part[i];
+            }
+        }
+        for (size_t peer = 1; peer < size(); ++peer) {
+            send(peer, values);
+        }
+    } else {
+        send(0, values);
+        std::vector<complex_t> total = receive(0);
+        if (total.size() != values.size()) {
+            throw std::runtime_error("allreduce_sum: ranks disagree on the length");
+        }
+        std::copy(total.begin(), total.end(), values.begin());
+    }
+}
+
+// ============================================================================
+// ShmRingTransport
+// ============================================================================
+
+// Producer-owned and consumer-owned counters on separate cache lines; the
+// ring bytes follow the header. head - tail bytes are in flight.
+struct ShmRingTransport::Segment::Ring {
+    alignas(64) std::atomic<uint64_t> head{0};   // Bytes ever written
+    alignas(64) std::atomic<uint64_t> tail{0};   // Bytes ever read
+
+    std::byte* data() { return reinterpret_cast<std::byte*>(this) + sizeof(Ring); }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory rings need lock-free 64-bit atomics");
+
+ShmRingTransport::Segment::Segment(size_t n_ranks, size_t ring_bytes)
+    : n_ranks_(n_ranks), ring_bytes_(ring_bytes) {
+    if (n_ranks == 0 || ring_bytes == 0) {
+        throw std::invalid_argument("Segment needs at least one rank and a non-empty ring");
+    }
+    stride_ = sizeof(Ring) + (ring_bytes + 63) / 64 * 64;
+    mapped_bytes_ = stride_ * n_ranks * n_ranks;
+    base_ = ::mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base_ == MAP_FAILED) {
+        base_ = nullptr;
+        throw system_error("mmap");
+    }
+    for (size_t i = 0; i < n_ranks * n_ranks; ++i) {
+        new (static_cast<std::byte*>(base_) + i * stride_) Ring();
+    }
+}
+
+ShmRingTransport::Segment::~Segment() {
+    if (base_) {
+        ::munmap(base_, mapped_bytes_);
+    }
+}
+
+ShmRingTransport::Segment::Ring& ShmRingTransport::Segment::ring(size_t from, size_t to) const {
+    return *std::launder(reinterpret_cast<Ring*>(
+        static_cast<std::byte*>(base_) + (from * n_ranks_ + to) * stride_));
+}
+
+ShmRingTransport::ShmRingTransport(
+    std::shared_ptr<Segment> segment,
+    size_t rank,
+    std::chrono::milliseconds timeout
+) : segment_(std::move(segment)), rank_(rank), timeout_(timeout) {
+    if (!segment_ || rank_ >= segment_->n_ranks()) {
+        throw std::invalid_argument("Rank outside the shared segment");
+    }
+}
+
+void ShmRingTransport::write(Segment::Ring& ring, const std::byte* data, size_t n) {
+    const size_t capacity = segment_->ring_bytes();
+    Backoff backoff(timeout_);
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    while (n > 0) {
+        const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+        const size_t free = capacity - static_cast<size_t>(head - tail);
+        if (free == 0) {
+            backoff.wait("sending");
+            continue;
+        }
+        const size_t at = static_cast<size_t>(head % capacity);
+        const size_t chunk = std::min({n, free, capacity - at});
+        std::memcpy(ring.data() + at, data, chunk);
+        head += chunk;
+        ring.head.store(head, std::memory_order_release);
+        data += chunk;
+        n -= chunk;
+        backoff.progress(timeout_);
+    }
+}
+
+void ShmRingTransport::read(Segment::Ring& ring, std::byte* data, size_t n) {
+    const size_t capacity = segment_->ring_bytes();
+    Backoff backoff(timeout_);
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    while (n > 0) {
+        const uint64_t head = ring.head.load(std::memory_order_acquire);
+        const size_t available = static_cast<size_t>(head - tail);
+        if (available == 0) {
+            backoff.wait("receiving");
+            continue;
+        }
+        const size_t at = static_cast<size_t>(tail % capacity);
+        const size_t chunk = std::min({n, available, capacity - at});
+        std::memcpy(data, ring.data() + at, chunk);
+        tail += chunk;
+        ring.tail.store(tail, std::memory_order_release);
+        data += chunk;
+        n -= chunk;
+        backoff.progress(timeout_);
+    }
+}
+
+void ShmRingTransport::send(size_t peer, std::span<const complex_t> message) {
+    check_peer(peer);
+    Segment::Ring& ring = segment_->ring(rank_, peer);
+    const uint64_t length = message.size();
+    write(ring, reinterpret_cast<const std::byte*>(&length), sizeof(length));
+    write(ring, reinterpret_cast<const std::byte*>(message.data()), message.size_bytes());
+    bytes_sent_ += message.size_bytes();
+}
+
+std::vector<complex_t> ShmRingTransport::receive(size_t peer) {
+    check_peer(peer);
+    Segment::Ring& ring = segment_->ring(peer, rank_);
+    uint64_t length = 0;
+    read(ring, reinterpret_cast<std::byte*>(&length), sizeof(length));
+    std::vector<complex_t> message(length);
+    read(ring, reinterpret_cast<std::byte*>(message.data()), length * sizeof(complex_t));
+    return message;
+}
+
+// ============================================================================
+// SocketTransport
+// ============================================================================
+
+int SocketTransport::listen(SocketAddress& address) {
+    sockaddr_in addr = make_address(address);
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw system_error("socket");
+    }
+    const int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || ::listen(fd, SOMAXCONN) != 0) {
+        const int saved = errno;
+        ::close(fd);
+        errno = saved;
+        throw system_error("bind/listen " + address.host + ":" + std::to_string(address.port));
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    address.port = ntohs(addr.sin_port);
+    return fd;
+}
+
+SocketTransport::SocketTransport(
+    size_t rank,
+    std::vector<SocketAddress> addresses,
+    int listen_fd,
+    std::chrono::milliseconds timeout
+) : rank_(rank), fds_(addresses.size(), -1), timeout_(timeout) {
+    if (rank_ >= addresses.size()) {
+        throw std::invalid_argument("Rank outside the address list");
+    }
+    if (listen_fd < 0) {
+        listen_fd = listen(addresses[rank_]);
+    }
+    const auto deadline = Clock::now() + timeout_;
+
+    try {
+        // Lower ranks accept us: connect (retrying until they listen) and
+        // introduce ourselves with our rank
+        for (size_t peer = 0; peer < rank_; ++peer) {
+            const sockaddr_in addr = make_address(addresses[peer]);
+            while (true) {
+                const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (fd < 0) {
+                    throw system_error("socket");
+                }
+                if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0) {
+                    fds_[peer] = fd;
+                    break;
+                }
+                ::close(fd);
+                if (Clock::now() > deadline) {
+                    throw std::runtime_error("Transport timed out while connecting to rank "
+                                             + std::to_string(peer));
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            const uint64_t me = rank_;
+            write_all(fds_[peer], &me, sizeof(me));
+        }
+
+        // Higher ranks connect to us, in any order
+        for (size_t accepted = rank_ + 1; accepted < fds_.size(); ++accepted) {
+            wait_ready(listen_fd, POLLIN, deadline, "accepting");
+            const int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                throw system_error("accept");
+            }
+            uint64_t peer = 0;
+            try {
+                read_all(fd, &peer, sizeof(peer));
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+            if (peer <= rank_ || peer >= fds_.size() || fds_[peer] >= 0) {
+                ::close(fd);
+                throw std::runtime_error("Unexpected rank on an incoming connection");
+            }
+            fds_[peer] = fd;
+        }
+    } catch (...) {
+        ::close(listen_fd);
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+        throw;
+    }
+    ::close(listen_fd);
+
+    // Boundary messages are small and latency bound
+    const int on = 1;
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+    }
+}
+
+SocketTransport::~SocketTransport() {
+    for (int fd : fds_) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+void SocketTransport::write_all(int fd, const void* data, size_t n) {
+    const auto* bytes = static_cast<const std::byte*>(data);
+    while (n > 0) {
+        const ssize_t written = ::send(fd, bytes, n, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written > 0) {
+            bytes += written;
+            n -= static_cast<size_t>(written);
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            wait_ready(fd, POLLOUT, Clock::now() + timeout_, "sending");
+        } else if (written < 0 && errno != EINTR) {
+            throw system_error("send");
+        }
+    }
+}
+
+void SocketTransport::read_all(int fd, void* data, size_t n) {
+    auto* bytes = static_cast<std::byte*>(data);
+    while (n > 0) {
+        const ssize_t got = ::recv(fd, bytes, n, MSG_DONTWAIT);
+        if (got > 0) {
+            bytes += got;
+            n -= static_cast<size_t>(got);
+        } else if (got == 0) {
+            throw std::runtime_error("Peer closed the connection");
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            wait_ready(fd, POLLIN, Clock::now() + timeout_, "receiving");
+        } else if (errno != EINTR) {
+            throw system_error("recv");
+        }
+    }
+}
+
+void SocketTransport::send(size_t peer, std::span<const complex_t> message) {
+    check_peer(peer);
+    const uint64_t length = message.size();
+    write_all(fds_[peer], &length, sizeof(length));
+    write_all(fds_[peer], message.data(), message.size_bytes());
+    bytes_sent_ += message.size_bytes();
+}
+
+std::vector<complex_t> SocketTransport::receive(size_t peer) {
+    check_peer(peer);
+    uint64_t length = 0;
+    read_all(fds_[peer], &length, sizeof(length));
+    std::vector<complex_t> message(length);
+    read_all(fds_[peer], message.data(), length * sizeof(complex_t));
+    return message;
+}
+
+} // namespace sheaf
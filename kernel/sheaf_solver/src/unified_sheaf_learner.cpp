@@ -4,11 +4,177 @@
  */
 
 #include "sheaf_solver/unified_sheaf_learner.hpp"
+#include "sheaf_solver/batched_cholesky.hpp"
+#include "sheaf_solver/parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <iostream>
 #include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
 
 namespace sheaf {
 
+// Callers return and store learners by value
+static_assert(std::is_copy_constructible_v<UnifiedSheafLearner>);
+static_assert(std::is_move_constructible_v<UnifiedSheafLearner>);
+
+namespace {
+
+constexpr uint64_t kComplexMac = 8;  // Real flops per complex multiply-add
+
+uint64_t matrix_bytes(size_t rows, size_t cols) {
+    return static_cast<uint64_t>(rows) * cols * sizeof(complex_t);
+}
+
+size_t ceil_log2(size_t n) {
+    size_t log_n = 0;
+    while ((size_t{1} << log_n) < n) ++log_n;
+    return log_n;
+}
+
+/**
+ * @brief Nominal cost of get_feature_row(): one FFT of [n x 1] plus the
+ * n x n_characters feature entries
+ */
+uint64_t featurize_flops(const PatchConfig& config) {
+    const size_t n = config.n_positions;
+    return kComplexMac * (n * ceil_log2(n) + n * config.n_characters);
+}
+
+/**
+ * @brief Storage created by get_feature_row(): the transform plus the row itself
+ */
+uint64_t featurize_bytes(const PatchConfig& config) {
+    return matrix_bytes(config.n_positions, 1)
+         + matrix_bytes(config.n_positions * config.n_characters, 1);
+}
+
+/**
+ * @brief View of an owning problem (samples referenced, gluings copied)
+ */
+SheafProblemView make_view(const SheafProblem& problem) {
+    SheafProblemView view;
+    view.patches.reserve(problem.patches.size());
+    for (const auto& patch : problem.patches) {
+        PatchView pv;
+        pv.name = patch.name;
+        pv.config = patch.config;
+        pv.V_samples.reserve(patch.V_samples.size());
+        pv.targets.reserve(patch.targets.size());
+        for (const auto& V : patch.V_samples) {
+            pv.V_samples.push_back(&V);
+        }
+        for (const auto& t : patch.targets) {
+            pv.targets.push_back(&t);
+        }
+        view.patches.push_back(std::move(pv));
+    }
+    view.gluings = problem.gluings;
+    return view;
+}
+
+#ifdef USE_EIGEN3
+/**
+ * @brief Merges feature rows that hash alike into weighted rows
+ *
+ * Rows are keyed by the bit patterns of their features (quantum = 0) or
+ * by the quantum-wide cell each feature falls in. A group of m rows with
+ * targets t_i becomes one row sqrt(m) · a with target sqrt(m) · t̄, since
+ *
+ *   Σ_i |a w - t_i|^2 = m |a w - t̄|^2 + Σ_i |t_i - t̄|^2
+ *
+ * The second term does not depend on w and is returned by spread(). a is
+ * the first row of the group (exact duplicates) or the group mean.
+ */
+class RowCompressor {
+public:
+    RowCompressor(size_t n_weights, real_t quantum) : n_weights_(n_weights), quantum_(quantum) {}
+
+    void add(const Vector& features, complex_t target) {
+        auto [it, inserted] = groups_.try_emplace(key(features), rows_.size());
+        if (inserted) {
+            rows_.push_back(features);
+            counts_.push_back(1);
+            means_.push_back(target);
+            return;
+        }
+        const size_t g = it->second;
+        const real_t m = static_cast<real_t>(++counts_[g]);
+        const complex_t delta = target - means_[g];
+        means_[g] += delta / m;
+        spread_ += std::real(std::conj(delta) * (target - means_[g]));
+        if (quantum_ > 0.0) {
+            max_deviation_ = std::max(max_deviation_,
+                                      (features - rows_[g] / (m - 1.0)).cwiseAbs().maxCoeff());
+            rows_[g] += features;   // Running sum, divided by the count in emit()
+        }
+    }
+
+    size_t rows() const { return rows_.size(); }
+    real_t spread() const { return spread_; }
+    real_t max_deviation() const { return max_deviation_; }
+
+    void emit(Matrix& A, Vector& b) const {
+        A.resize(rows_.size(), n_weights_);
+        b.resize(rows_.size());
+        for (size_t g = 0; g < rows_.size(); ++g) {
+            const real_t m = static_cast<real_t>(counts_[g]);
+            const real_t scale = std::sqrt(m);
+            A.row(g) = quantum_ > 0.0 ? Vector(rows_[g] * (scale / m)).transpose()
+                                      : Vector(rows_[g] * scale).transpose();
+            b(g) = scale * means_[g];
+        }
+    }
+
+private:
+    struct KeyHash {
+        size_t operator()(const std::vector<int64_t>& cells) const {
+            uint64_t h = 1469598103934665603ull;   // FNV-1a over the cell words
+            for (int64_t c : cells) {
+                h = (h ^ static_cast<uint64_t>(c)) * 1099511628211ull;
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    std::vector<int64_t> key(const Vector& features) const {
+        std::vector<int64_t> cells;
+        cells.reserve(2 * features.size());
+        for (Eigen::Index i = 0; i < features.size(); ++i) {
+            for (real_t x : {features(i).real(), features(i).imag()}) {
+                if (quantum_ > 0.0) {
+                    const real_t cell = std::floor(x / quantum_);
+                    cells.push_back(static_cast<int64_t>(std::clamp(cell, -4.0e18, 4.0e18)));
+                } else {
+                    cells.push_back(std::bit_cast<int64_t>(x + 0.0));   // -0.0 -> +0.0
+                }
+            }
+        }
+        return cells;
+    }
+
+    size_t n_weights_;
+    real_t quantum_;
+    std::unordered_map<std::vector<int64_t>, size_t, KeyHash> groups_;
+    std::vector<Vector> rows_;
+    std::vector<size_t> counts_;
+    std::vector<complex_t> means_;
+    real_t spread_ = 0.0;
+    real_t max_deviation_ = 0.0;
+};
+#endif
+
+void counter_add(std::atomic<uint64_t>& counter, uint64_t n) {
+    if (n != 0) counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+} // namespace
+
 UnifiedSheafLearner::UnifiedSheafLearner(bool verbose)
     : verbose_(verbose)
     , fitted_(false)
@@ -16,6 +182,14 @@ UnifiedSheafLearner::UnifiedSheafLearner(bool verbose)
 {}
 
 SheafSolution UnifiedSheafLearner::fit(const SheafProblem& problem) {
+    return fit(make_view(problem));
+}
+
+SheafSolution UnifiedSheafLearner::fit(const SheafProblemView& problem) {
+    SHEAF_TRACE_SCOPE("fit", "solver");
+    FitStats stats;
+    PhaseTimer timer(stats);
+
     if (verbose_) {
         std::cout << "================================================================================\n";
         std::cout << "Fitting Unified Sheaf Learner\n";
@@ -25,23 +199,552 @@ SheafSolution UnifiedSheafLearner::fit(const SheafProblem& problem) {
     }
 
     // Step 1: Build local systems
-    auto local_result = build_local_systems(problem);
+    auto local_result = build_local_systems(problem, stats);
+    timer.lap(FitPhase::LocalBuild);
 
     // Step 2: Build gluing constraints
-    auto gluing_result = build_gluing_system(problem, local_result);
+    auto gluing_result = build_gluing_system(problem, local_result, stats);
+    timer.lap(FitPhase::GluingBuild);
 
-    // Step 3: Assemble global system
+#ifdef USE_EIGEN3
+    // Step 3: Normal equations patch by patch - A_sheaf is block diagonal
+    // apart from the gluing rows
+    build_normal_equations(problem, local_result, gluing_result, stats);
+    timer.lap(FitPhase::Gram);
+
+    Vector w_solution;
+    real_t residual_error = 0.0;
+    if (!has_hard_gluings()) {
+        // Step 4: Assemble and solve the global least-squares problem
+        // w* = (A^H A)^{-1} A^H b, gluing rows scaled by sqrt(weight)
+        GlobalSystem system = assemble_system(problem, local_result, gluing_result, stats);
+        const Matrix& A_sheaf = system.A;
+        const Vector& b_sheaf = system.b;
+        const size_t total_rows = A_sheaf.rows();
+        const size_t total_cols = A_sheaf.cols();
+        timer.lap(FitPhase::Assembly);
+
+        gram_ = regularized_gram(ridge_, stats);
+        timer.lap(FitPhase::Gram);
+
+        Eigen::LLT<Matrix> llt(gram_);
+        stats_add(stats.flops, kComplexMac * total_cols * total_cols * total_cols / 6);
+        stats_add(stats.bytes_allocated, matrix_bytes(total_cols, total_cols));
+        timer.lap(FitPhase::Factorization);
+
+        w_solution = llt.solve(moment_);
+        stats_add(stats.flops, kComplexMac * 2 * total_cols * total_cols);
+        stats_add(stats.bytes_allocated, matrix_bytes(total_cols, 1));
+        timer.lap(FitPhase::Solve);
+
+        // Compute residual (merged rows leave their target spread behind)
+        Vector residuals = A_sheaf * w_solution - b_sheaf;
+        residual_error = residuals.squaredNorm() + local_result.residual_offset;
+        stats_add(stats.flops, kComplexMac * total_rows * (total_cols + 1));
+        stats_add(stats.bytes_allocated, matrix_bytes(total_rows, 1));
+    } else {
+        // Step 4: Hard gluings - equality-constrained solve through the
+        // Schur complement of the per-patch factorizations
+        w_solution = solve_gluings(stats);
+        timer.lap(FitPhase::Solve);
+        residual_error = gluing_objective(w_solution, stats);
+    }
+    timer.lap(FitPhase::Residual);
+
+    if (residual_error < EPSILON) {
+        residual_error = 0.0;
+    }
+
+    if (verbose_) {
+        std::cout << "\nGlobal System Solved:\n";
+        std::cout << "  - Total weights learned: " << w_solution.size() << "\n";
+        std::cout << "  - Final Residual (Obstruction): " << residual_error << "\n";
+    }
+
+    install_solution(w_solution, residual_error, stats);
+    timer.lap(FitPhase::Unpack);
+    solution_.stats = stats;
+    fitted_ = true;
+
+    return solution_;
+#else
+    // Simplified non-Eigen version - placeholder
+    SheafSolution sol;
+    sol.residual_error = 1.0;
+    sol.converged = false;
+    fitted_ = false;
+    return sol;
+#endif
+}
+
+BatchFit UnifiedSheafLearner::fit_many(
+    std::span<const SheafProblem> problems,
+    const BatchFitOptions& options
+) {
+    SHEAF_TRACE_SCOPE("fit_many", "solver");
+    BatchFit result;
+    result.solutions.resize(problems.size());
+    PhaseTimer timer(result.stats);
+    std::vector<size_t> fallback;
+
+#ifdef USE_EIGEN3
+    // Where each problem's rows come from: samples pooled per (group, width)
+    struct Pool {
+        const SymmetryGroup* group;
+        size_t n_characters;
+        std::vector<const Matrix*> samples;
+        Matrix features;                     // [samples, n · n_characters]
+    };
+    struct Layout {
+        std::vector<size_t> offsets;         // Column offset per patch
+        std::vector<size_t> pool;            // Pool per patch
+        std::vector<size_t> first_sample;    // Row of the patch's first sample in its pool
+        std::vector<std::array<size_t, 2>> gluing_patch;
+        std::vector<std::array<size_t, 2>> gluing_sample;
+        size_t n_weights = 0;
+    };
+    std::vector<Pool> pools;
+    std::map<std::pair<const SymmetryGroup*, size_t>, size_t> pool_index;
+    std::vector<Layout> layouts(problems.size());
+    std::vector<size_t> batched;
+
+    // Group lookups mutate the cache, so eligibility is decided here on the
+    // calling thread; anything unusual is left for fit() to handle (or reject)
+    constexpr size_t kDenseTransformMax = 64;
+    for (size_t i = 0; i < problems.size() && options.batched; ++i) {
+        const SheafProblem& problem = problems[i];
+        Layout& layout = layouts[i];
+        bool eligible = !compression_.enabled && !problem.patches.empty();
+        std::unordered_map<std::string, size_t> patch_index;
+        for (size_t q = 0; q < problem.patches.size() && eligible; ++q) {
+            const Patch& patch = problem.patches[q];
+            const PatchConfig& config = patch.config;
+            const SymmetryGroup* group = nullptr;
+            try {
+                group = &cached_group(config, result.stats);
+            } catch (const std::exception&) {
+                eligible = false;
+                break;
+            }
+            eligible = group->is_abelian() && config.n_positions <= kDenseTransformMax
+                    && patch.V_samples.size() == patch.targets.size()
+                    && patch_index.emplace(patch.name, q).second;
+            for (size_t s = 0; s < patch.V_samples.size() && eligible; ++s) {
+                eligible = static_cast<size_t>(patch.V_samples[s].rows()) == config.n_positions
+                        && patch.V_samples[s].cols() > 0 && patch.targets[s].size() > 0;
+            }
+            if (!eligible) break;
+            auto [it, added] = pool_index.try_emplace({group, config.n_characters}, pools.size());
+            if (added) pools.push_back({group, config.n_characters, {}, {}});
+            layout.offsets.push_back(layout.n_weights);
+            layout.pool.push_back(it->second);
+            layout.n_weights += config.n_positions * config.n_characters;
+        }
+        for (const auto& gluing : problem.gluings) {
+            if (!eligible) break;
+            auto p1 = patch_index.find(gluing.patch_1);
+            auto p2 = patch_index.find(gluing.patch_2);
+            eligible = p1 != patch_index.end() && p2 != patch_index.end()
+                    && gluing.weight >= 0.0 && gluing.weight != HARD_GLUING
+                    && static_cast<size_t>(gluing.constraint_data_1.rows())
+                           == problem.patches[p1->second].config.n_positions
+                    && static_cast<size_t>(gluing.constraint_data_2.rows())
+                           == problem.patches[p2->second].config.n_positions
+                    && gluing.constraint_data_1.cols() > 0 && gluing.constraint_data_2.cols() > 0;
+            if (eligible) {
+                layout.gluing_patch.push_back({p1->second, p2->second});
+            }
+        }
+        if (!eligible) {
+            fallback.push_back(i);
+            continue;
+        }
+        for (size_t q = 0; q < problem.patches.size(); ++q) {
+            Pool& pool = pools[layout.pool[q]];
+            layout.first_sample.push_back(pool.samples.size());
+            for (const Matrix& V : problem.patches[q].V_samples) pool.samples.push_back(&V);
+        }
+        for (size_t g = 0; g < problem.gluings.size(); ++g) {
+            const auto [q1, q2] = layout.gluing_patch[g];
+            layout.gluing_sample.push_back({pools[layout.pool[q1]].samples.size(),
+                                            pools[layout.pool[q2]].samples.size() + (layout.pool[q1] == layout.pool[q2])});
+            pools[layout.pool[q1]].samples.push_back(&problem.gluings[g].constraint_data_1);
+            pools[layout.pool[q2]].samples.push_back(&problem.gluings[g].constraint_data_2);
+        }
+        batched.push_back(i);
+    }
+    if (!options.batched) {
+        fallback.resize(problems.size());
+        std::iota(fallback.begin(), fallback.end(), size_t{0});
+    }
+
+    // Stage 1: features(s, p · k + j) = (1/n) χ̄_j(p) X_j(s) with X = T V,
+    // T the first k rows of the character table
+    for (Pool& pool : pools) {
+        const SymmetryGroup& group = *pool.group;
+        const size_t n = group.order();
+        const size_t k = pool.n_characters;
+        const size_t used = std::min(k, n);
+        Matrix table(used, n);
+        for (size_t j = 0; j < used; ++j) {
+            for (size_t p = 0; p < n; ++p) table(j, p) = group.character(j, p);
+        }
+        const Matrix phases = table.conjugate() / static_cast<real_t>(n);
+        pool.features = Matrix::Zero(pool.samples.size(), n * k);
+        parallel_for((pool.samples.size() + 255) / 256, options.n_threads,
+                     [&](size_t begin, size_t end, size_t) {
+            const size_t first = begin * 256;
+            const size_t last = std::min(end * 256, pool.samples.size());
+            Matrix V(n, last - first);
+            for (size_t s = first; s < last; ++s) V.col(s - first) = pool.samples[s]->col(0);
+            const Matrix X = table * V;
+            for (size_t s = first; s < last; ++s) {
+                for (size_t p = 0; p < n; ++p) {
+                    pool.features.row(s).segment(p * k, used) =
+                        phases.col(p).cwiseProduct(X.col(s - first)).transpose();
+                }
+            }
+        });
+        stats_add(result.stats.character_transforms, pool.samples.size());
+        stats_add(result.stats.flops, kComplexMac * pool.samples.size() * n * (used + used));
+    }
+    timer.lap(FitPhase::LocalBuild);
+
+    // Rows of problem t: feature rows sit contiguously in the pools, so A_q
+    // is a view; gluing row g is sqrt(d_g) (f_1 at patch q1 - f_2 at q2)
+    auto patch_rows = [&](size_t i, size_t q) {
+        const Layout& layout = layouts[i];
+        return pools[layout.pool[q]].features.middleRows(
+            layout.first_sample[q], problems[i].patches[q].V_samples.size());
+    };
+    auto gluing_feature = [&](size_t i, size_t g, size_t side) {
+        const Layout& layout = layouts[i];
+        const size_t q = layout.gluing_patch[g][side];
+        return pools[layout.pool[q]].features.row(layout.gluing_sample[g][side]);
+    };
+    auto width = [&](size_t i, size_t q) {
+        const PatchConfig& config = problems[i].patches[q].config;
+        return config.n_positions * config.n_characters;
+    };
+
+    // Stages 2 and 3: problems of equal size kBatchLanes at a time. Each
+    // Gram G = A^H A + Σ d k^H k + ρI is built in one buffer per block and
+    // copied straight into the lockstep Cholesky, so no problem allocates
+    // its own W x W matrix
+    std::map<size_t, std::vector<size_t>> by_size;
+    for (size_t i : batched) {
+        by_size[layouts[i].n_weights].push_back(i);
+    }
+    std::vector<std::pair<size_t, size_t>> blocks;   // (size, first index into by_size[size])
+    for (const auto& [W, members] : by_size) {
+        for (size_t first = 0; first < members.size(); first += kBatchLanes) {
+            blocks.emplace_back(W, first);
+        }
+    }
+    std::vector<Vector> weights(problems.size());
+    std::vector<uint8_t> failed(problems.size(), 0);
+    std::vector<uint64_t> block_bytes(blocks.size(), 0);
+    parallel_for(blocks.size(), options.n_threads, [&](size_t begin, size_t end, size_t) {
+        for (size_t blk = begin; blk < end; ++blk) {
+            const auto [W, first] = blocks[blk];
+            const std::vector<size_t>& members = by_size.at(W);
+            const size_t lanes = std::min(kBatchLanes, members.size() - first);
+            BatchedCholesky batch(W);
+            Matrix gram(W, W);
+            Vector moment(W);
+            for (size_t l = 0; l < lanes; ++l) {
+                const size_t i = members[first + l];
+                const SheafProblem& problem = problems[i];
+                const Layout& layout = layouts[i];
+                gram.setZero();
+                for (size_t q = 0; q < problem.patches.size(); ++q) {
+                    const auto A = patch_rows(i, q);
+                    Vector b(A.rows());
+                    for (Eigen::Index s = 0; s < A.rows(); ++s) b(s) = problem.patches[q].targets[s](0, 0);
+                    gram.block(layout.offsets[q], layout.offsets[q], width(i, q), width(i, q)).noalias() =
+                        A.adjoint() * A;
+                    moment.segment(layout.offsets[q], width(i, q)).noalias() = A.adjoint() * b;
+                }
+                // k^H k only touches the blocks of the (at most two) glued patches
+                for (size_t g = 0; g < problem.gluings.size(); ++g) {
+                    const real_t weight = problem.gluings[g].weight;
+                    const auto [q1, q2] = layout.gluing_patch[g];
+                    const auto f1 = gluing_feature(i, g, 0);
+                    const auto f2 = gluing_feature(i, g, 1);
+                    if (q1 == q2) {
+                        const Matrix k = f1 - f2;
+                        gram.block(layout.offsets[q1], layout.offsets[q1], k.size(), k.size()).noalias() +=
+                            weight * k.adjoint() * k;
+                        continue;
+                    }
+                    auto block = [&](size_t qa, size_t qc) {
+                        return gram.block(layout.offsets[qa], layout.offsets[qc], width(i, qa), width(i, qc));
+                    };
+                    block(q1, q1).noalias() += weight * f1.adjoint() * f1;
+                    block(q2, q2).noalias() += weight * f2.adjoint() * f2;
+                    block(q1, q2).noalias() -= weight * f1.adjoint() * f2;
+                    block(q2, q1).noalias() -= weight * f2.adjoint() * f1;
+                }
+                gram.diagonal().array() += lambda_ridge_;
+                batch.load(l, gram, moment);
+            }
+            for (size_t l = lanes; l < kBatchLanes; ++l) {
+                batch.load_identity(l);
+            }
+            const auto ok = batch.solve();
+            for (size_t l = 0; l < lanes; ++l) {
+                weights[members[first + l]] = batch.solution(l);
+                failed[members[first + l]] = !ok[l];
+            }
+            // Lane buffers, the shared Gram and moment, one solution per lane
+            block_bytes[blk] = batch.buffer_bytes() + matrix_bytes(W, W + 1) + lanes * matrix_bytes(W, 1);
+        }
+    });
+    for (size_t i : batched) {
+        const size_t W = layouts[i].n_weights;
+        size_t rows = problems[i].gluings.size();
+        for (const auto& patch : problems[i].patches) rows += patch.V_samples.size();
+        stats_add(result.stats.flops, kComplexMac * (rows * W * (W + 1) + W * W * W / 6 + 2 * W * W));
+    }
+    for (uint64_t bytes : block_bytes) {
+        stats_add(result.stats.bytes_allocated, bytes);
+    }
+    timer.lap(FitPhase::Factorization);
+
+    // Residuals and per-patch weights
+    parallel_for(batched.size(), options.n_threads, [&](size_t begin, size_t end, size_t) {
+        for (size_t t = begin; t < end; ++t) {
+            const size_t i = batched[t];
+            if (failed[i]) continue;
+            const SheafProblem& problem = problems[i];
+            const Layout& layout = layouts[i];
+            const Vector& w = weights[i];
+            real_t residual = 0.0;
+            SheafSolution& solution = result.solutions[i];
+            for (size_t q = 0; q < problem.patches.size(); ++q) {
+                const PatchConfig& config = problem.patches[q].config;
+                const auto w_q = w.segment(layout.offsets[q], width(i, q));
+                const Vector fitted = patch_rows(i, q) * w_q;
+                for (Eigen::Index s = 0; s < fitted.size(); ++s) {
+                    residual += std::norm(fitted(s) - problem.patches[q].targets[s](0, 0));
+                }
+                Matrix patch_weights(config.n_positions, config.n_characters);
+                for (size_t p = 0; p < config.n_positions; ++p) {
+                    for (size_t j = 0; j < config.n_characters; ++j) {
+                        patch_weights(p, j) = w_q(p * config.n_characters + j);
+                    }
+                }
+                solution.weights[problem.patches[q].name] = std::move(patch_weights);
+            }
+            for (size_t g = 0; g < problem.gluings.size(); ++g) {
+                const auto [q1, q2] = layout.gluing_patch[g];
+                const complex_t gap =
+                    gluing_feature(i, g, 0).dot(w.segment(layout.offsets[q1], width(i, q1)).conjugate())
+                    - gluing_feature(i, g, 1).dot(w.segment(layout.offsets[q2], width(i, q2)).conjugate());
+                residual += problem.gluings[g].weight * std::norm(gap);
+            }
+            solution.residual_error = residual < EPSILON ? 0.0 : residual;
+            solution.converged = residual < EPSILON;
+        }
+    });
+    for (size_t i : batched) {
+        if (failed[i]) {
+            fallback.push_back(i);
+        } else {
+            ++result.batched;
+        }
+    }
+    timer.lap(FitPhase::Residual);
+#else
+    fallback.resize(problems.size());
+    std::iota(fallback.begin(), fallback.end(), size_t{0});
+#endif
+
+    // Everything else, one learner per problem
+    std::sort(fallback.begin(), fallback.end());
+    parallel_for(fallback.size(), options.n_threads, [&](size_t begin, size_t end, size_t) {
+        for (size_t f = begin; f < end; ++f) {
+            UnifiedSheafLearner learner;
+            learner.set_ridge(lambda_ridge_);
+            learner.set_row_compression(compression_);
+            result.solutions[fallback[f]] = learner.fit(problems[fallback[f]]);
+            result.solutions[fallback[f]].stats = FitStats{};
+        }
+    });
+    result.fallback = fallback.size();
+    timer.lap(FitPhase::Solve);
+    return result;
+}
+
+RidgeSelection UnifiedSheafLearner::select_ridge(
+    const SheafProblem& problem, const RidgeSelectionOptions& options
+) {
+    return select_ridge(make_view(problem), options);
+}
+
+RidgeSelection UnifiedSheafLearner::select_ridge(
+    const SheafProblemView& problem, const RidgeSelectionOptions& options
+) {
+    SHEAF_TRACE_SCOPE("select_ridge", "solver");
+    FitStats stats;
+    PhaseTimer timer(stats);
+    RidgeSelection result;
+
+    auto local_result = build_local_systems(problem, stats);
+    timer.lap(FitPhase::LocalBuild);
+    auto gluing_result = build_gluing_system(problem, local_result, stats);
+    timer.lap(FitPhase::GluingBuild);
+
+#ifdef USE_EIGEN3
+    for (real_t weight : gluing_result.weights) {
+        if (weight == HARD_GLUING) {
+            throw std::invalid_argument("select_ridge() does not support hard gluings");
+        }
+    }
+    build_normal_equations(problem, local_result, gluing_result, stats);
+    timer.lap(FitPhase::Gram);
+
+    GlobalSystem system = assemble_system(problem, local_result, gluing_result, stats);
+    const Matrix& A = system.A;
+    const Vector& b = system.b;
+    const size_t rows = A.rows();
+    const size_t cols = A.cols();
+    const size_t local_rows = system.local_rows;
+    timer.lap(FitPhase::Assembly);
+
+    // One eigendecomposition A^H A = V diag(σ^2) V^H serves the whole grid;
+    // P = A V carries U Σ without forming U
+    Matrix gram = regularized_gram(0.0, stats);
+    timer.lap(FitPhase::Gram);
+
+    Eigen::SelfAdjointEigenSolver<Matrix> eig(gram);
+    const RealVector sigma2 = eig.eigenvalues().cwiseMax(0.0);
+    const Matrix& V = eig.eigenvectors();
+    const Matrix P = A * V;
+    const Vector beta = V.adjoint() * moment_;                        // P^H b
+    const RealMatrix leverage = P.topRows(local_rows).cwiseAbs2();   // σ_k^2 |U_ik|^2
+    stats_add(stats.flops, kComplexMac * (5 * cols * cols * cols + rows * cols * cols + cols * cols));
+    stats_add(stats.bytes_allocated, matrix_bytes(cols, cols) + matrix_bytes(rows, cols) * 3 / 2);
+    timer.lap(FitPhase::Factorization);
+
+    std::vector<real_t> lambdas = options.lambdas;
+    if (lambdas.empty()) {
+        const real_t top = cols > 0 && sigma2.maxCoeff() > 0.0 ? sigma2.maxCoeff() : 1.0;
+        const size_t points = std::max<size_t>(options.grid_points, 1);
+        for (size_t i = 0; i < points; ++i) {
+            const real_t t = points > 1 ? static_cast<real_t>(i) / (points - 1) : 1.0;
+            lambdas.push_back(top * options.min_ratio * std::pow(options.max_ratio / options.min_ratio, t));
+        }
+    }
+
+    const real_t infinity = std::numeric_limits<real_t>::infinity();
+    for (real_t lambda : lambdas) {
+        if (!(lambda > 0.0)) {
+            throw std::invalid_argument("Ridge values must be positive");
+        }
+        RealVector inverse = (sigma2.array() + lambda).inverse();
+        RealVector shrink = sigma2.array() * inverse.array();
+
+        // A w(λ) - b = P diag(1 / (σ^2 + λ)) P^H b - b
+        Vector error = P * (inverse.cast<complex_t>().asDiagonal() * beta) - b;
+        RealVector hat = leverage * inverse;
+
+        RidgePoint point{lambda, error.squaredNorm() + local_result.residual_offset,
+                         0.0, 0.0, shrink.sum()};
+        if (point.residual < EPSILON) {
+            point.residual = 0.0;
+        }
+        point.gluing_obstruction = error.tail(rows - local_rows).squaredNorm();
+        for (size_t i = 0; i < local_rows; ++i) {
+            const real_t slack = 1.0 - hat(i);
+            if (slack <= EPSILON) {
+                point.loo_error = infinity;
+                break;
+            }
+            point.loo_error += std::norm(error(i)) / (slack * slack);
+        }
+        if (local_rows > 0 && point.loo_error < infinity) {
+            point.loo_error /= static_cast<real_t>(local_rows);
+        }
+        stats_add(stats.flops, kComplexMac * 2 * rows * cols);
+
+        if (verbose_) {
+            std::cout << "  ridge " << lambda << ": residual " << point.residual
+                      << ", gluing " << point.gluing_obstruction
+                      << ", LOO " << point.loo_error << "\n";
+        }
+        if (result.path.empty() || point.loo_error < result.path[result.best].loo_error) {
+            result.best = result.path.size();
+        }
+        result.path.push_back(point);
+    }
+    timer.lap(FitPhase::Residual);
+
+    const RidgePoint& best = result.path[result.best];
+    result.best_lambda = best.lambda;
+    RealVector gain = (sigma2.array() + best.lambda).inverse();
+    Vector w_solution = V * (gain.cast<complex_t>().asDiagonal() * beta);
+    stats_add(stats.flops, kComplexMac * cols * cols);
+    timer.lap(FitPhase::Solve);
+
+    // Leave the learner as fit() would at the chosen ridge
+    lambda_ridge_ = best.lambda;
+    gram_ = std::move(gram);
+    gram_.diagonal().array() += best.lambda;
+    ridge_ = best.lambda;
+
+    install_solution(w_solution, best.residual, stats);
+    timer.lap(FitPhase::Unpack);
+    solution_.stats = stats;
+    fitted_ = true;
+    result.solution = solution_;
+#else
+    (void)options;
+    result.solution.residual_error = 1.0;
+    result.solution.converged = false;
+    fitted_ = false;
+#endif
+    return result;
+}
+
+void UnifiedSheafLearner::set_row_compression(const RowCompression& compression) {
+    if (!(compression.quantum >= 0.0)) {
+        throw std::invalid_argument("Compression quantum must be non-negative");
+    }
+    compression_ = compression;
+}
+
+void UnifiedSheafLearner::set_ridge(real_t lambda) {
+    if (!(lambda >= 0.0)) {
+        throw std::invalid_argument("Ridge must be non-negative");
+    }
+    lambda_ridge_ = lambda;
+}
+
+UnifiedSheafLearner::GlobalSystem
+UnifiedSheafLearner::assemble_system(
+    const SheafProblemView& problem,
+    const LocalSystemsResult& local_result,
+    const GluingSystemResult& gluing_result,
+    FitStats& stats
+) {
+    GlobalSystem system;
 #ifdef USE_EIGEN3
     size_t local_rows = 0;
     for (const auto& mat : local_result.matrices) {
         local_rows += mat.rows();
     }
     size_t total_rows = local_rows + gluing_result.A_gluing.rows();
-    size_t total_cols = local_result.matrices.empty() ? 0 : local_result.matrices[0].cols();
+    size_t total_cols = 0;
+    for (const auto& [name, n_weights] : local_result.patch_n_weights) {
+        total_cols += n_weights;
+    }
 
-    // Stack matrices vertically
-    Matrix A_sheaf(total_rows, total_cols);
-    Vector b_sheaf(total_rows);
+    // Stack matrices vertically (local blocks sit on the diagonal)
+    Matrix& A_sheaf = system.A;
+    Vector& b_sheaf = system.b;
+    A_sheaf = Matrix::Zero(total_rows, total_cols);
+    b_sheaf = Vector::Zero(total_rows);
 
     // Copy local systems
     size_t row_offset = 0;
@@ -49,17 +752,25 @@ SheafSolution UnifiedSheafLearner::fit(const SheafProblem& problem) {
         const auto& mat = local_result.matrices[i];
         const auto& vec = local_result.targets[i];
         size_t n_rows = mat.rows();
+        size_t col_offset = local_result.patch_offsets.at(problem.patches[i].name);
 
-        A_sheaf.block(row_offset, 0, n_rows, mat.cols()) = mat;
+        A_sheaf.block(row_offset, col_offset, n_rows, mat.cols()) = mat;
         b_sheaf.segment(row_offset, n_rows) = vec;
         row_offset += n_rows;
     }
 
-    // Copy gluing constraints
+    // Copy gluing constraints, each row scaled by sqrt(weight) (callers
+    // route hard gluings elsewhere)
     if (gluing_result.A_gluing.rows() > 0) {
         A_sheaf.block(row_offset, 0, gluing_result.A_gluing.rows(), gluing_result.A_gluing.cols()) = gluing_result.A_gluing;
         b_sheaf.segment(row_offset, gluing_result.b_gluing.size()) = gluing_result.b_gluing;
+        for (size_t i = 0; i < gluing_result.weights.size(); ++i) {
+            const real_t scale = std::sqrt(gluing_result.weights[i]);
+            A_sheaf.row(row_offset + i) *= scale;
+            b_sheaf(row_offset + i) *= scale;
+        }
     }
+    stats_add(stats.bytes_allocated, matrix_bytes(total_rows, total_cols + 1));
 
     if (verbose_) {
         std::cout << "\nAssembled Global System 'A_sheaf':\n";
@@ -68,72 +779,496 @@ SheafSolution UnifiedSheafLearner::fit(const SheafProblem& problem) {
         std::cout << "  - Gluing rows (consistency): " << gluing_result.A_gluing.rows() << "\n";
     }
 
-    // Step 4: Solve the global least-squares problem
-    // w* = (A^H A)^{-1} A^H b
-    const real_t lambda_ridge = 1e-8;
-    Matrix A_H_A = A_sheaf.adjoint() * A_sheaf;
-    A_H_A.diagonal().array() += lambda_ridge;
-    Vector A_H_b = A_sheaf.adjoint() * b_sheaf;
+    system.local_rows = local_rows;
+#else
+    (void)problem;
+    (void)local_result;
+    (void)gluing_result;
+    (void)stats;
+#endif
+    return system;
+}
+
+void UnifiedSheafLearner::install_solution(
+    const Vector& w_solution,
+    real_t residual_error,
+    FitStats& stats
+) {
+    solution_ = unpack_solution(w_solution, residual_error);
+#ifdef USE_EIGEN3
+    stats_add(stats.bytes_allocated, matrix_bytes(w_solution.size(), 2));
+    dense_weights_ = w_solution;
+#endif
+    sparse_models_.clear();
+
+    update_spectral_weights(stats);
+}
+
+void UnifiedSheafLearner::build_normal_equations(
+    const SheafProblemView& problem,
+    const LocalSystemsResult& local_result,
+    const GluingSystemResult& gluing_result,
+    FitStats& stats
+) {
+    // Offsets are handed out in patch order, so layout_ follows problem.patches
+    layout_.clear();
+    for (const auto& patch : problem.patches) {
+        layout_.emplace_back(patch.name, local_result.patch_offsets.at(patch.name));
+    }
+    ridge_ = lambda_ridge_;
+    gluing_weights_ = gluing_result.weights;
+    std::unordered_map<std::string, size_t> patch_index;
+    for (size_t i = 0; i < layout_.size(); ++i) {
+        patch_index.emplace(layout_[i].first, i);
+    }
+    gluing_patches_.clear();
+    for (const auto& gluing : problem.gluings) {
+        gluing_patches_.emplace_back(patch_index.at(gluing.patch_1), patch_index.at(gluing.patch_2));
+    }
+    gluing_schur_.reset();
+#ifdef USE_EIGEN3
+    gram_ = Matrix();
+    gluing_rows_ = gluing_result.A_gluing;
+
+    size_t total_cols = 0;
+    for (const auto& [name, n_weights] : local_result.patch_n_weights) {
+        total_cols += n_weights;
+    }
+    moment_ = Vector::Zero(total_cols);
+    target_norm2_ = 0.0;
+    patch_grams_.clear();
+    for (size_t i = 0; i < local_result.matrices.size(); ++i) {
+        const Matrix& A_patch = local_result.matrices[i];
+        const Vector& b_patch = local_result.targets[i];
+        patch_grams_.push_back(A_patch.adjoint() * A_patch);
+        moment_.segment(layout_[i].second, A_patch.cols()) = A_patch.adjoint() * b_patch;
+        target_norm2_ += b_patch.squaredNorm();
+        stats_add(stats.flops, kComplexMac * A_patch.rows() * A_patch.cols() * (A_patch.cols() + 1));
+        stats_add(stats.bytes_allocated, matrix_bytes(A_patch.cols(), A_patch.cols() + 1));
+    }
+    target_norm2_ += local_result.residual_offset;
+    // Gluing targets are zero, so gluing rows add nothing to A^H b or ||b||^2
+#else
+    (void)stats;
+#endif
+}
+
+bool UnifiedSheafLearner::has_hard_gluings() const {
+    return std::any_of(gluing_weights_.begin(), gluing_weights_.end(),
+                       [](real_t weight) { return weight == HARD_GLUING; });
+}
+
+BlockGraphMatrix UnifiedSheafLearner::patch_graph(FitStats& stats) const {
+    BlockGraphMatrix N;
+#ifdef USE_EIGEN3
+    for (const Matrix& gram : patch_grams_) {
+        Matrix D = gram;
+        D.diagonal().array() += ridge_;
+        N.add_node(std::move(D));
+    }
+    // weight · k^H k split over the (at most two) patches a gluing touches
+    for (size_t i = 0; i < gluing_weights_.size(); ++i) {
+        const real_t weight = gluing_weights_[i];
+        if (weight == 0.0) continue;
+        const auto [a, b] = gluing_patches_[i];
+        const size_t n_a = N.node_size(a);
+        const size_t n_b = N.node_size(b);
+        const Vector k_a = gluing_rows_.row(i).segment(layout_[a].second, n_a).adjoint();
+        N.diagonal[a].noalias() += weight * k_a * k_a.adjoint();
+        if (a != b) {
+            const Vector k_b = gluing_rows_.row(i).segment(layout_[b].second, n_b).adjoint();
+            N.diagonal[b].noalias() += weight * k_b * k_b.adjoint();
+            N.add_to_edge(a, b, weight * k_a * k_b.adjoint());
+        }
+        stats_add(stats.flops, kComplexMac * (n_a + n_b) * (n_a + n_b));
+    }
+#else
+    (void)stats;
+#endif
+    return N;
+}
+
+IterativeFit UnifiedSheafLearner::fit_iterative(
+    const SheafProblem& problem, const IterativeOptions& options
+) {
+    return fit_iterative(make_view(problem), options);
+}
 
-    Vector w_solution = A_H_A.llt().solve(A_H_b);
+IterativeFit UnifiedSheafLearner::fit_iterative(
+    const SheafProblemView& problem, const IterativeOptions& options
+) {
+    SHEAF_TRACE_SCOPE("fit_iterative", "solver");
+    FitStats stats;
+    PhaseTimer timer(stats);
+    IterativeFit result;
 
-    // Compute residual
-    Vector residuals = A_sheaf * w_solution - b_sheaf;
-    real_t residual_error = residuals.squaredNorm();
+    auto local_result = build_local_systems(problem, stats);
+    timer.lap(FitPhase::LocalBuild);
+    auto gluing_result = build_gluing_system(problem, local_result, stats);
+    timer.lap(FitPhase::GluingBuild);
 
+#ifdef USE_EIGEN3
+    build_normal_equations(problem, local_result, gluing_result, stats);
+    if (has_hard_gluings()) {
+        throw std::invalid_argument("fit_iterative() does not support hard gluings");
+    }
+    BlockGraphMatrix N = patch_graph(stats);
+    timer.lap(FitPhase::Gram);
+
+    std::function<Vector(const Vector&)> preconditioner;
+    std::shared_ptr<BlockGraphMultigrid> multigrid;
+    if (options.multigrid && N.n_nodes() >= options.multigrid_min_patches) {
+        multigrid = std::make_shared<BlockGraphMultigrid>(N, options.multigrid_options);
+        result.level_sizes = multigrid->level_sizes();
+        preconditioner = [multigrid](const Vector& r) { return multigrid->apply(r); };
+    } else {
+        preconditioner = block_jacobi(N);
+        result.level_sizes = {N.size()};
+    }
+    timer.lap(FitPhase::Factorization);
+
+    ConjugateGradientResult cg = conjugate_gradient(
+        N, moment_, preconditioner, options.tolerance, options.max_iterations);
+    result.iterations = cg.iterations;
+    result.relative_residual = cg.relative_residual;
+    result.converged = cg.converged;
+    timer.lap(FitPhase::Solve);
+
+    real_t residual_error = gluing_objective(cg.x, stats);
     if (residual_error < EPSILON) {
         residual_error = 0.0;
     }
+    timer.lap(FitPhase::Residual);
 
     if (verbose_) {
-        std::cout << "\nGlobal System Solved:\n";
-        std::cout << "  - Total weights learned: " << w_solution.size() << "\n";
-        std::cout << "  - Final Residual (Obstruction): " << residual_error << "\n";
+        std::cout << "\nIterative solve: " << cg.iterations << " CG iterations, relative residual "
+                  << cg.relative_residual << ", " << result.level_sizes.size() << " levels\n";
     }
 
-    solution_ = unpack_solution(w_solution, local_result, residual_error);
+    install_solution(cg.x, residual_error, stats);
+    timer.lap(FitPhase::Unpack);
+    solution_.stats = stats;
     fitted_ = true;
+    result.solution = solution_;
+#else
+    (void)options;
+    result.solution.residual_error = 1.0;
+    result.solution.converged = false;
+    fitted_ = false;
+#endif
+    return result;
+}
 
+NormalEquations UnifiedSheafLearner::normal_equations(const SheafProblemView& problem) {
+    SHEAF_TRACE_SCOPE("normal_equations", "solver");
+    FitStats stats;
+    NormalEquations system;
+    auto local_result = build_local_systems(problem, stats);
+    auto gluing_result = build_gluing_system(problem, local_result, stats);
+    fitted_ = false;
+#ifdef USE_EIGEN3
+    build_normal_equations(problem, local_result, gluing_result, stats);
+    if (has_hard_gluings()) {
+        throw std::invalid_argument("normal_equations() does not support hard gluings");
+    }
+    system.layout = layout_;
+    system.gram = regularized_gram(ridge_, stats);
+    system.moment = moment_;
+#endif
+    return system;
+}
+
+Vector UnifiedSheafLearner::feature_row(const std::string& patch_name, const Matrix& V) {
+    auto it = patch_configs_.find(patch_name);
+    if (it == patch_configs_.end()) {
+        throw std::out_of_range("Unknown patch: " + patch_name);
+    }
+    FitStats stats;
+    return get_feature_row(V, it->second, cached_group(it->second, stats));
+}
+
+SheafSolution UnifiedSheafLearner::install_weights(const Vector& w) {
+    FitStats stats;
+#ifdef USE_EIGEN3
+    if (static_cast<size_t>(w.size()) != static_cast<size_t>(moment_.size())) {
+        throw std::invalid_argument("Weight vector does not match the system");
+    }
+#endif
+    real_t residual_error = gluing_objective(w, stats);
+    if (residual_error < EPSILON) {
+        residual_error = 0.0;
+    }
+    install_solution(w, residual_error, stats);
+    solution_.stats = stats;
+    fitted_ = true;
     return solution_;
+}
+
+Matrix UnifiedSheafLearner::regularized_gram(real_t ridge, FitStats& stats) const {
+#ifdef USE_EIGEN3
+    const size_t total_cols = moment_.size();
+    Matrix gram = Matrix::Zero(total_cols, total_cols);
+    for (size_t i = 0; i < patch_grams_.size(); ++i) {
+        const size_t offset = layout_[i].second;
+        const size_t n = patch_grams_[i].rows();
+        gram.block(offset, offset, n, n) = patch_grams_[i];
+    }
+    if (!gluing_weights_.empty()) {
+        Matrix weighted = gluing_rows_;
+        for (size_t i = 0; i < gluing_weights_.size(); ++i) {
+            weighted.row(i) *= std::sqrt(gluing_weights_[i]);
+        }
+        gram.noalias() += weighted.adjoint() * weighted;
+        stats_add(stats.flops, kComplexMac * gluing_weights_.size() * total_cols * total_cols);
+        stats_add(stats.bytes_allocated, matrix_bytes(gluing_weights_.size(), total_cols));
+    }
+    gram.diagonal().array() += ridge;
+    stats_add(stats.bytes_allocated, matrix_bytes(total_cols, total_cols));
+    return gram;
 #else
-    // Simplified non-Eigen version - placeholder
-    SheafSolution sol;
-    sol.residual_error = 1.0;
-    sol.converged = false;
-    fitted_ = false;
-    return sol;
+    (void)ridge;
+    (void)stats;
+    return Matrix(1, 1);
+#endif
+}
+
+const UnifiedSheafLearner::GluingSchur& UnifiedSheafLearner::gluing_schur(FitStats& stats) {
+    if (gluing_schur_) {
+        return *gluing_schur_;
+    }
+    auto schur = std::make_shared<GluingSchur>();
+#ifdef USE_EIGEN3
+    // H = blockdiag(A_p^H A_p + ρ I): one Cholesky per patch, then
+    // H^{-1} c and H^{-1} K^H patch by patch
+    const size_t total_cols = moment_.size();
+    const size_t n_gluings = gluing_weights_.size();
+    const Matrix K_adjoint = n_gluings > 0 ? Matrix(gluing_rows_.adjoint())
+                                           : Matrix(Matrix::Zero(total_cols, 0));
+    schur->h_c = Vector(total_cols);
+    schur->h_k = Matrix(total_cols, n_gluings);
+    for (size_t i = 0; i < patch_grams_.size(); ++i) {
+        const size_t offset = layout_[i].second;
+        const size_t n = patch_grams_[i].rows();
+        Matrix H = patch_grams_[i];
+        H.diagonal().array() += ridge_;
+        Eigen::LLT<Matrix> llt(H);
+        if (llt.info() != Eigen::Success) {
+            throw std::runtime_error("Local system is not positive definite: " + layout_[i].first);
+        }
+        schur->h_c.segment(offset, n) = llt.solve(moment_.segment(offset, n));
+        schur->h_k.middleRows(offset, n) = llt.solve(K_adjoint.middleRows(offset, n));
+        stats_add(stats.flops, kComplexMac * (n * n * n / 6 + 2 * n * n * (n_gluings + 1)));
+    }
+    if (n_gluings > 0) {
+        schur->S = gluing_rows_ * schur->h_k;
+        schur->z = gluing_rows_ * schur->h_c;
+    } else {
+        schur->S = Matrix(0, 0);
+        schur->z = Vector(0);
+    }
+    stats_add(stats.flops, kComplexMac * n_gluings * total_cols * (n_gluings + 1));
+    stats_add(stats.bytes_allocated, matrix_bytes(total_cols, n_gluings + 1)
+                                   + matrix_bytes(n_gluings, n_gluings + 1));
+#else
+    (void)stats;
+#endif
+    gluing_schur_ = std::move(schur);
+    return *gluing_schur_;
+}
+
+Vector UnifiedSheafLearner::solve_gluings(FitStats& stats) {
+    const GluingSchur& schur = gluing_schur(stats);
+#ifdef USE_EIGEN3
+    // w = H^{-1}(c - K^H μ) with, over the gluings of positive weight,
+    //   (S + E) μ = z,  S = K H^{-1} K^H,  z = K H^{-1} c,
+    //   E = diag(1/d) for soft rows and 0 for hard ones (K w = 0 exactly)
+    std::vector<Eigen::Index> active;
+    for (size_t i = 0; i < gluing_weights_.size(); ++i) {
+        if (gluing_weights_[i] > 0.0) {
+            active.push_back(static_cast<Eigen::Index>(i));
+        }
+    }
+    if (active.empty()) {
+        return schur.h_c;
+    }
+    Matrix M = schur.S(active, active);
+    for (size_t i = 0; i < active.size(); ++i) {
+        const real_t weight = gluing_weights_[active[i]];
+        if (weight != HARD_GLUING) {
+            M(i, i) += 1.0 / weight;
+        }
+    }
+    // Complete orthogonal decomposition: redundant hard gluings make M singular
+    Vector mu = M.completeOrthogonalDecomposition().solve(Vector(schur.z(active)));
+    const size_t m = active.size();
+    stats_add(stats.flops, kComplexMac * (2 * m * m * m + schur.h_k.rows() * m));
+    return schur.h_c - schur.h_k(Eigen::all, active) * mu;
+#else
+    (void)schur;
+    return Vector(1);
+#endif
+}
+
+real_t UnifiedSheafLearner::gluing_objective(const Vector& w, FitStats& stats) const {
+#ifdef USE_EIGEN3
+    // Σ_p ||A_p w_p - b_p||^2 + Σ_soft d_i |k_i w|^2 from the retained Grams
+    real_t residual = target_norm2_;
+    for (size_t i = 0; i < patch_grams_.size(); ++i) {
+        const size_t offset = layout_[i].second;
+        const size_t n = patch_grams_[i].rows();
+        auto w_p = w.segment(offset, n);
+        residual += std::real(w_p.dot(patch_grams_[i] * w_p))
+                  - 2.0 * std::real(moment_.segment(offset, n).dot(w_p));
+        stats_add(stats.flops, kComplexMac * n * (n + 2));
+    }
+    if (!gluing_weights_.empty()) {
+        Vector y = gluing_rows_ * w;
+        for (size_t i = 0; i < gluing_weights_.size(); ++i) {
+            if (gluing_weights_[i] > 0.0 && gluing_weights_[i] != HARD_GLUING) {
+                residual += gluing_weights_[i] * std::norm(y(i));
+            }
+        }
+        stats_add(stats.flops, kComplexMac * gluing_rows_.size());
+    }
+    return std::max<real_t>(residual, 0.0);
+#else
+    (void)w;
+    (void)stats;
+    return 0.0;
+#endif
+}
+
+SheafSolution UnifiedSheafLearner::reweight_gluings(const std::vector<real_t>& weights) {
+    if (!fitted_) {
+        throw std::runtime_error("Model not fitted");
+    }
+    if (weights.size() != gluing_weights_.size()) {
+        throw std::invalid_argument("Expected one weight per gluing constraint");
+    }
+    for (real_t weight : weights) {
+        if (!(weight >= 0.0)) {
+            throw std::invalid_argument("Gluing weights must be non-negative");
+        }
+    }
+
+    SHEAF_TRACE_SCOPE("reweight_gluings", "solver");
+    FitStats stats;
+    PhaseTimer timer(stats);
+    gluing_weights_ = weights;
+#ifdef USE_EIGEN3
+    gram_ = Matrix();   // Rebuilt by prune() on demand
+#endif
+
+    Vector w_solution = solve_gluings(stats);
+    timer.lap(FitPhase::Solve);
+    real_t residual_error = gluing_objective(w_solution, stats);
+    if (residual_error < EPSILON) {
+        residual_error = 0.0;
+    }
+    timer.lap(FitPhase::Residual);
+
+    install_solution(w_solution, residual_error, stats);
+    timer.lap(FitPhase::Unpack);
+    solution_.stats = stats;
+    return solution_;
+}
+
+void UnifiedSheafLearner::update_spectral_weights(FitStats& stats) {
+#ifdef USE_EIGEN3
+    // Fold the inverse character sum into the weights for predict_spectrum()
+    spectral_weights_.clear();
+    for (const auto& [name, weights] : solution_.weights) {
+        const PatchConfig& config = patch_configs_.at(name);
+        const SymmetryGroup& group = cached_group(config, stats);
+        if (!group.is_abelian()) {
+            continue;
+        }
+        const size_t n = config.n_positions;
+        const size_t n_chars = std::min(config.n_characters, n);
+
+        Vector g = Vector::Zero(n_chars);
+        for (size_t j = 0; j < n_chars; ++j) {
+            for (size_t p = 0; p < n; ++p) {
+                g(j) += weights(p, j) * std::conj(group.character(j, p));
+            }
+        }
+        spectral_weights_[name] = g / static_cast<double>(n);
+        stats_add(stats.flops, kComplexMac * n * n_chars);
+        stats_add(stats.bytes_allocated, matrix_bytes(n_chars, 1));
+    }
+#else
+    (void)stats;
 #endif
 }
 
+const SymmetryGroup& UnifiedSheafLearner::cached_group(const PatchConfig& config, FitStats& stats) {
+    GroupKey key(config.group_kind, symmetry_group_shape(config));
+    auto it = group_cache_.find(key);
+    if (it != group_cache_.end()) {
+        stats_add(stats.cache_hits, 1);
+        return *it->second;
+    }
+    stats_add(stats.cache_misses, 1);
+    // Cyclic groups keep the full character table; the others O(n) tables
+    const size_t n = config.n_positions;
+    const bool cyclic = key.first == SymmetryKind::Abelian && key.second.size() == 1;
+    stats_add(stats.bytes_allocated, cyclic ? matrix_bytes(n, n) : matrix_bytes(n, 1));
+    std::shared_ptr<const SymmetryGroup> group = make_symmetry_group(config);
+    return *group_cache_.emplace(std::move(key), std::move(group)).first->second;
+}
+
 UnifiedSheafLearner::LocalSystemsResult
-UnifiedSheafLearner::build_local_systems(const SheafProblem& problem) {
+UnifiedSheafLearner::build_local_systems(const SheafProblemView& problem, FitStats& stats) {
     LocalSystemsResult result;
     size_t current_col_offset = 0;
+    compression_report_ = RowCompressionReport{};
 
     if (verbose_) {
         std::cout << "\nBuilding Local Systems (Patches):\n";
     }
 
     for (const auto& patch : problem.patches) {
+        SHEAF_TRACE_SCOPE_ARG("patch", "local_build", patch.name);
         const size_t n_samples = patch.V_samples.size();
         const size_t n_weights = patch.config.n_positions * patch.config.n_characters;
 
         patch_configs_[patch.name] = patch.config;
 
-        CyclicGroupCharacters group(patch.config.n_positions);
+        const SymmetryGroup& group = cached_group(patch.config, stats);
 
 #ifdef USE_EIGEN3
-        Matrix A_patch(n_samples, n_weights);
-        Vector b_patch(n_samples);
+        Matrix A_patch;
+        Vector b_patch;
 
-        for (size_t i = 0; i < n_samples; ++i) {
-            Vector feature_row = get_feature_row(patch.V_samples[i], patch.config, group);
-            A_patch.row(i) = feature_row.transpose();
-            b_patch(i) = patch.targets[i](0, 0);  // Assume d_model = 1 for now
+        if (!compression_.enabled) {
+            A_patch.resize(n_samples, n_weights);
+            b_patch.resize(n_samples);
+            for (size_t i = 0; i < n_samples; ++i) {
+                Vector feature_row = get_feature_row(*patch.V_samples[i], patch.config, group);
+                A_patch.row(i) = feature_row.transpose();
+                b_patch(i) = (*patch.targets[i])(0, 0);  // Assume d_model = 1 for now
+            }
+        } else {
+            RowCompressor compressor(n_weights, compression_.quantum);
+            for (size_t i = 0; i < n_samples; ++i) {
+                compressor.add(get_feature_row(*patch.V_samples[i], patch.config, group),
+                               (*patch.targets[i])(0, 0));
+            }
+            compressor.emit(A_patch, b_patch);
+            result.residual_offset += compressor.spread();
+            compression_report_.max_feature_deviation =
+                std::max(compression_report_.max_feature_deviation, compressor.max_deviation());
         }
+        compression_report_.rows_in += n_samples;
+        compression_report_.rows_out += A_patch.rows();
 
         result.matrices.push_back(A_patch);
         result.targets.push_back(b_patch);
+
+        stats_add(stats.character_transforms, n_samples);
+        stats_add(stats.flops, n_samples * featurize_flops(patch.config));
+        stats_add(stats.bytes_allocated, n_samples * featurize_bytes(patch.config)
+                                       + 2 * matrix_bytes(A_patch.rows(), n_weights + 1));
 #endif
 
         result.patch_offsets[patch.name] = current_col_offset;
@@ -145,14 +1280,21 @@ UnifiedSheafLearner::build_local_systems(const SheafProblem& problem) {
                       << n_weights << " weights\n";
         }
     }
+    compression_report_.within_group_residual = result.residual_offset;
+
+    if (verbose_ && compression_.enabled) {
+        std::cout << "  - Row compression: " << compression_report_.rows_in << " -> "
+                  << compression_report_.rows_out << " rows\n";
+    }
 
     return result;
 }
 
 UnifiedSheafLearner::GluingSystemResult
 UnifiedSheafLearner::build_gluing_system(
-    const SheafProblem& problem,
-    const LocalSystemsResult& local_info
+    const SheafProblemView& problem,
+    const LocalSystemsResult& local_info,
+    FitStats& stats
 ) {
     GluingSystemResult result;
 
@@ -174,20 +1316,27 @@ UnifiedSheafLearner::build_gluing_system(
         total_weights += n_weights;
     }
 
-    result.A_gluing = Matrix(problem.gluings.size(), total_weights);
+    result.A_gluing = Matrix::Zero(problem.gluings.size(), total_weights);
     result.b_gluing = Vector::Zero(problem.gluings.size());
+    stats_add(stats.bytes_allocated, matrix_bytes(problem.gluings.size(), total_weights + 1));
 
     for (size_t i = 0; i < problem.gluings.size(); ++i) {
         const auto& gluing = problem.gluings[i];
+        if (!(gluing.weight >= 0.0)) {
+            throw std::invalid_argument("Gluing weights must be non-negative");
+        }
 
         const auto& config1 = patch_configs_[gluing.patch_1];
         const auto& config2 = patch_configs_[gluing.patch_2];
 
-        CyclicGroupCharacters group1(config1.n_positions);
-        CyclicGroupCharacters group2(config2.n_positions);
+        const SymmetryGroup& group1 = cached_group(config1, stats);
+        const SymmetryGroup& group2 = cached_group(config2, stats);
 
         Vector feature1 = get_feature_row(gluing.constraint_data_1, config1, group1);
         Vector feature2 = get_feature_row(gluing.constraint_data_2, config2, group2);
+        stats_add(stats.character_transforms, 2);
+        stats_add(stats.flops, featurize_flops(config1) + featurize_flops(config2));
+        stats_add(stats.bytes_allocated, featurize_bytes(config1) + featurize_bytes(config2));
 
         // Constraint: prediction_1 - prediction_2 = 0
         size_t offset1 = local_info.patch_offsets.at(gluing.patch_1);
@@ -196,6 +1345,7 @@ UnifiedSheafLearner::build_gluing_system(
         result.A_gluing.row(i).segment(offset1, feature1.size()) = feature1.transpose();
         result.A_gluing.row(i).segment(offset2, feature2.size()) -= feature2.transpose();
         result.b_gluing(i) = 0.0;
+        result.weights.push_back(gluing.weight);
 
         if (verbose_) {
             std::cout << "  - Gluing " << (i+1) << " ('" << gluing.patch_1
@@ -210,12 +1360,15 @@ UnifiedSheafLearner::build_gluing_system(
 Vector UnifiedSheafLearner::get_feature_row(
     const Matrix& V,
     const PatchConfig& config,
-    const CyclicGroupCharacters& group
+    const SymmetryGroup& group
 ) const {
 #ifdef USE_EIGEN3
-    auto projs = group.decompose_into_characters(V);
+    if (static_cast<size_t>(V.rows()) == group.order() && config.n_positions == group.order()) {
+        return group.projection_features(V, config.n_characters);
+    }
 
-    Vector feature_row(config.n_positions * config.n_characters);
+    Vector feature_row = Vector::Zero(config.n_positions * config.n_characters);
+    auto projs = group.decompose_into_characters(V);
 
     for (size_t p = 0; p < config.n_positions; ++p) {
         for (size_t j = 0; j < config.n_characters; ++j) {
@@ -234,7 +1387,6 @@ Vector UnifiedSheafLearner::get_feature_row(
 
 SheafSolution UnifiedSheafLearner::unpack_solution(
     const Vector& w_solution,
-    const LocalSystemsResult& local_info,
     real_t residual_error
 ) {
     SheafSolution sol;
@@ -242,9 +1394,9 @@ SheafSolution UnifiedSheafLearner::unpack_solution(
     sol.converged = (residual_error < EPSILON);
 
 #ifdef USE_EIGEN3
-    for (const auto& [name, offset] : local_info.patch_offsets) {
-        size_t n_weights = local_info.patch_n_weights.at(name);
+    for (const auto& [name, offset] : layout_) {
         const auto& config = patch_configs_[name];
+        size_t n_weights = config.n_positions * config.n_characters;
 
         Vector weights_flat = w_solution.segment(offset, n_weights);
 
@@ -258,6 +1410,8 @@ SheafSolution UnifiedSheafLearner::unpack_solution(
 
         sol.weights[name] = weights;
     }
+#else
+    (void)w_solution;
 #endif
 
     return sol;
@@ -269,11 +1423,58 @@ Matrix UnifiedSheafLearner::predict(const std::string& patch_name, const Matrix&
     }
 
 #ifdef USE_EIGEN3
+    SHEAF_TRACE_SCOPE_ARG("predict", "solver", patch_name);
+    FitStats stats;
+    PhaseTimer timer(stats);
+
     const auto& config = patch_configs_.at(patch_name);
     const auto& weights = solution_.weights.at(patch_name);
 
-    CyclicGroupCharacters group(config.n_positions);
+    // The cache is only read here (fit() populated it), so concurrent
+    // predict() calls stay safe
+    auto cached = group_cache_.find(GroupKey(config.group_kind, symmetry_group_shape(config)));
+    std::unique_ptr<SymmetryGroup> local_group;
+    if (cached != group_cache_.end()) {
+        stats_add(stats.cache_hits, 1);
+    } else {
+        stats_add(stats.cache_misses, 1);
+        local_group = make_symmetry_group(config);
+    }
+    const SymmetryGroup& group = local_group ? *local_group : *cached->second;
+
+    // Pruned patch: project onto the active characters only
+    auto sparse = sparse_models_.find(patch_name);
+    if (sparse != sparse_models_.end()) {
+        const SparsePatchModel& model = sparse->second;
+        const size_t n = config.n_positions;
+        const size_t a = model.characters.size();
+        Vector features = group.selected_projection_features(V, model.characters);
+        stats_add(stats.character_transforms, 1);
+        stats_add(stats.flops, kComplexMac * (n * ceil_log2(n) + n * a));
+        stats_add(stats.bytes_allocated, matrix_bytes(n + n * a, 1));
+        timer.lap(FitPhase::PredictFeaturize);
+
+        complex_t prediction = 0.0;
+        for (size_t p = 0; p < n; ++p) {
+            for (size_t i = 0; i < a; ++i) {
+                prediction += features(p * a + i) * model.weights(p, i);
+            }
+        }
+        Matrix result(1, 1);
+        result(0, 0) = prediction;
+        stats_add(stats.flops, kComplexMac * n * a);
+        stats_add(stats.predictions, 1);
+        timer.lap(FitPhase::PredictEvaluate);
+
+        record_predict_stats(stats);
+        return result;
+    }
+
     Vector feature_row = get_feature_row(V, config, group);
+    stats_add(stats.character_transforms, 1);
+    stats_add(stats.flops, featurize_flops(config));
+    stats_add(stats.bytes_allocated, featurize_bytes(config));
+    timer.lap(FitPhase::PredictFeaturize);
 
     // Prediction = dot(feature_row, weights_flat)
     Vector weights_flat(config.n_positions * config.n_characters);
@@ -283,14 +1484,297 @@ Matrix UnifiedSheafLearner::predict(const std::string& patch_name, const Matrix&
         }
     }
 
-    complex_t prediction = feature_row.dot(weights_flat);
+    // Plain bilinear product: Eigen's dot() would conjugate the features
+    complex_t prediction = feature_row.transpose() * weights_flat;
 
     Matrix result(1, 1);
     result(0, 0) = prediction;
+    stats_add(stats.flops, kComplexMac * weights_flat.size());
+    stats_add(stats.bytes_allocated, matrix_bytes(weights_flat.size() + 1, 1));
+    stats_add(stats.predictions, 1);
+    timer.lap(FitPhase::PredictEvaluate);
+
+    record_predict_stats(stats);
+
+    return result;
+#else
+    return Matrix(1, 1);
+#endif
+}
+
+Matrix UnifiedSheafLearner::predict_spectrum(const std::string& patch_name, const Matrix& spectrum) const {
+    if (!fitted_) {
+        throw std::runtime_error("Model not fitted");
+    }
+
+#ifdef USE_EIGEN3
+    SHEAF_TRACE_SCOPE_ARG("predict_spectrum", "solver", patch_name);
+    FitStats stats;
+    PhaseTimer timer(stats);
+
+    const auto& config = patch_configs_.at(patch_name);
+    auto spectral = spectral_weights_.find(patch_name);
+    if (spectral == spectral_weights_.end()) {
+        throw std::invalid_argument("Patch has no abelian spectrum: " + patch_name);
+    }
+    const Vector& g = spectral->second;
+    if (static_cast<size_t>(spectrum.rows()) != config.n_positions || spectrum.cols() < 1) {
+        throw std::invalid_argument("Spectrum must have n_positions rows");
+    }
+
+    Matrix result(1, 1);
+    result(0, 0) = g.transpose() * spectrum.col(0).head(g.size());
+    stats_add(stats.flops, kComplexMac * g.size());
+    stats_add(stats.predictions, 1);
+    timer.lap(FitPhase::PredictEvaluate);
+
+    record_predict_stats(stats);
     return result;
 #else
+    (void)patch_name;
+    (void)spectrum;
     return Matrix(1, 1);
 #endif
 }
 
+PruningReport UnifiedSheafLearner::prune(const PruningOptions& options) {
+    if (!fitted_) {
+        throw std::runtime_error("Model not fitted");
+    }
+    if (has_hard_gluings()) {
+        throw std::runtime_error("prune() does not support hard gluings");
+    }
+
+    PruningReport report;
+#ifdef USE_EIGEN3
+    SHEAF_TRACE_SCOPE("prune", "solver");
+    if (gram_.size() == 0) {
+        FitStats stats;
+        gram_ = regularized_gram(ridge_, stats);
+    }
+    using Index = Eigen::Index;
+
+    // One group per (patch, character): columns offset + p * k + j
+    struct Group {
+        std::vector<Index> columns;
+        real_t step;            // 1 / largest eigenvalue of the diagonal block
+    };
+    std::vector<Group> groups;
+    for (const auto& [name, offset] : layout_) {
+        const PatchConfig& config = patch_configs_.at(name);
+        const size_t k = config.n_characters;
+        for (size_t j = 0; j < k; ++j) {
+            Group g{{}, 0.0};
+            for (size_t p = 0; p < config.n_positions; ++p) {
+                g.columns.push_back(static_cast<Index>(offset + p * k + j));
+            }
+            Matrix block = gram_(g.columns, g.columns);
+            real_t top = Eigen::SelfAdjointEigenSolver<Matrix>(block, Eigen::EigenvaluesOnly)
+                             .eigenvalues().maxCoeff();
+            g.step = top > 0.0 ? 1.0 / top : 0.0;
+            groups.push_back(std::move(g));
+        }
+        report.total_characters += k;
+        report.total_weights += config.n_positions * k;
+    }
+
+    // ||A w - b||^2 from the normal equations (gram_ carries the ridge)
+    auto residual_of = [&](const Vector& w) {
+        real_t r = std::real(w.dot(gram_ * w)) - ridge_ * w.squaredNorm()
+                 - 2.0 * std::real(moment_.dot(w)) + target_norm2_;
+        return r < EPSILON ? 0.0 : r;
+    };
+    report.dense_residual = residual_of(dense_weights_);
+
+    // At w = 0 the gradient of group g is -2 c_g, so every group stays
+    // zero once λ >= 2 max_g ||c_g||
+    real_t lambda_max = 0.0;
+    for (const auto& g : groups) {
+        lambda_max = std::max(lambda_max, 2.0 * moment_(g.columns).norm());
+    }
+
+    std::vector<real_t> lambdas;
+    if (options.lambda > 0.0) {
+        lambdas.push_back(options.lambda * lambda_max);
+    } else {
+        const size_t points = std::max<size_t>(options.path_points, 1);
+        for (size_t i = 0; i < points; ++i) {
+            lambdas.push_back(lambda_max * std::pow(1e-4, static_cast<real_t>(i + 1) / points));
+        }
+    }
+
+    const real_t scale = std::max(target_norm2_, EPSILON);
+    Vector w = dense_weights_;
+    Vector gradient = gram_ * w - moment_;     // Half the gradient of the smooth part
+    std::vector<Vector> candidates;
+
+    for (real_t lambda : lambdas) {
+        // Block proximal coordinate descent:
+        //   w_g <- S(w_g - t_g (G w - c)_g, t_g λ / 2),  S(z, τ) = max(0, 1 - τ/||z||) z
+        size_t sweeps = 0;
+        while (sweeps < options.max_sweeps) {
+            ++sweeps;
+            real_t max_delta = 0.0;
+            for (const auto& g : groups) {
+                if (g.step == 0.0) {
+                    continue;
+                }
+                Vector current = w(g.columns);
+                Vector z = current - g.step * gradient(g.columns);
+                const real_t norm = z.norm();
+                const real_t threshold = g.step * lambda / 2.0;
+                Vector next = norm > threshold ? Vector((1.0 - threshold / norm) * z)
+                                               : Vector(Vector::Zero(z.size()));
+                Vector delta = next - current;
+                const real_t moved = delta.norm();
+                if (moved == 0.0) {
+                    continue;
+                }
+                w(g.columns) = next;
+                gradient += gram_(Eigen::all, g.columns) * delta;
+                max_delta = std::max(max_delta, moved);
+            }
+            if (max_delta <= options.convergence * std::max<real_t>(w.norm(), 1.0)) {
+                break;
+            }
+        }
+
+        PruningPoint point{lambda, 0, 0, 0.0, 0.0, sweeps};
+        std::vector<Index> active;
+        for (const auto& g : groups) {
+            if (w(g.columns).squaredNorm() > 0.0) {
+                ++point.active_characters;
+                active.insert(active.end(), g.columns.begin(), g.columns.end());
+            }
+        }
+        point.active_weights = active.size();
+
+        Vector candidate = w;
+        if (options.refit && !active.empty()) {
+            Eigen::LLT<Matrix> llt(gram_(active, active));
+            Vector refitted = llt.solve(Vector(moment_(active)));
+            candidate.setZero();
+            candidate(active) = refitted;
+        }
+        point.residual = residual_of(candidate);
+        point.relative_loss = (point.residual - report.dense_residual) / scale;
+
+        if (verbose_) {
+            std::cout << "  prune: lambda " << lambda << ", " << point.active_characters
+                      << "/" << report.total_characters << " characters, relative loss "
+                      << point.relative_loss << "\n";
+        }
+
+        report.path.push_back(point);
+        candidates.push_back(std::move(candidate));
+        if (options.lambda == 0.0 && point.relative_loss <= options.tolerance) {
+            break;
+        }
+    }
+    report.chosen = report.path.size() - 1;
+    const Vector& chosen = candidates[report.chosen];
+
+    // Install the chosen weights: dense-shaped (zero columns) plus compact models
+    sparse_models_.clear();
+    for (const auto& [name, offset] : layout_) {
+        const PatchConfig& config = patch_configs_.at(name);
+        const size_t n = config.n_positions;
+        const size_t k = config.n_characters;
+
+        Matrix dense = Matrix::Zero(n, k);
+        SparsePatchModel model;
+        for (size_t j = 0; j < k; ++j) {
+            bool active = false;
+            for (size_t p = 0; p < n; ++p) {
+                dense(p, j) = chosen(offset + p * k + j);
+                active = active || dense(p, j) != complex_t(0.0);
+            }
+            if (active) {
+                model.characters.push_back(j);
+            }
+        }
+        model.weights = Matrix(n, model.characters.size());
+        for (size_t i = 0; i < model.characters.size(); ++i) {
+            model.weights.col(i) = dense.col(model.characters[i]);
+        }
+
+        const size_t a = model.characters.size();
+        report.dense_predict_flops += featurize_flops(config) + kComplexMac * n * k;
+        report.sparse_predict_flops += kComplexMac * (n * ceil_log2(n) + 2 * n * a);
+
+        solution_.weights[name] = std::move(dense);
+        if (a < k) {
+            sparse_models_[name] = std::move(model);
+        }
+    }
+    solution_.residual_error = report.path[report.chosen].residual;
+    solution_.converged = solution_.residual_error < EPSILON;
+
+    FitStats stats;
+    update_spectral_weights(stats);
+#else
+    (void)options;
+#endif
+    return report;
+}
+
+const SparsePatchModel* UnifiedSheafLearner::get_sparse_model(const std::string& patch_name) const {
+    auto it = sparse_models_.find(patch_name);
+    return it == sparse_models_.end() ? nullptr : &it->second;
+}
+
+void UnifiedSheafLearner::PredictCounters::add(const FitStats& stats) {
+    for (size_t i = 0; i < kNumFitPhases; ++i) {
+        counter_add(phase_ns[i], stats.phase_ns[i]);
+    }
+    counter_add(flops, stats.flops);
+    counter_add(bytes_allocated, stats.bytes_allocated);
+    counter_add(character_transforms, stats.character_transforms);
+    counter_add(cache_hits, stats.cache_hits);
+    counter_add(cache_misses, stats.cache_misses);
+    counter_add(predictions, stats.predictions);
+}
+
+FitStats UnifiedSheafLearner::PredictCounters::load() const {
+    // Counters are read one by one: a snapshot taken during concurrent
+    // predict() calls may split a call between fields
+    FitStats stats;
+    for (size_t i = 0; i < kNumFitPhases; ++i) {
+        stats.phase_ns[i] = phase_ns[i].load(std::memory_order_relaxed);
+    }
+    stats.flops = flops.load(std::memory_order_relaxed);
+    stats.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+    stats.character_transforms = character_transforms.load(std::memory_order_relaxed);
+    stats.cache_hits = cache_hits.load(std::memory_order_relaxed);
+    stats.cache_misses = cache_misses.load(std::memory_order_relaxed);
+    stats.predictions = predictions.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void UnifiedSheafLearner::PredictCounters::store(const FitStats& stats) {
+    for (size_t i = 0; i < kNumFitPhases; ++i) {
+        phase_ns[i].store(stats.phase_ns[i], std::memory_order_relaxed);
+    }
+    flops.store(stats.flops, std::memory_order_relaxed);
+    bytes_allocated.store(stats.bytes_allocated, std::memory_order_relaxed);
+    character_transforms.store(stats.character_transforms, std::memory_order_relaxed);
+    cache_hits.store(stats.cache_hits, std::memory_order_relaxed);
+    cache_misses.store(stats.cache_misses, std::memory_order_relaxed);
+    predictions.store(stats.predictions, std::memory_order_relaxed);
+}
+
+void UnifiedSheafLearner::record_predict_stats([[maybe_unused]] const FitStats& stats) const {
+#ifdef SHEAF_SOLVER_STATS
+    predict_stats_.add(stats);
+#endif
+}
+
+FitStats UnifiedSheafLearner::get_predict_stats() const {
+    return predict_stats_.load();
+}
+
+void UnifiedSheafLearner::reset_predict_stats() {
+    predict_stats_.store(FitStats{});
+}
+
 } // namespace sheaf
@@ -0,0 +1,355 @@
+/**
+ * @file wreath_product.cpp
+ * @brief Clifford-theory irreps and the fast Fourier transform of C_m ≀ C_n
+ */
+
+#include "sheaf_solver/wreath_product.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace sheaf {
+
+namespace {
+
+size_t checked_base_size(size_t m, size_t n) {
+    if (m == 0 || n == 0) {
+        throw std::invalid_argument("Wreath product orders must be positive");
+    }
+    constexpr size_t kMax = std::numeric_limits<size_t>::max();
+    size_t size = 1;
+    for (size_t i = 0; i < n; ++i) {
+        if (size > kMax / m) {
+            throw std::invalid_argument("Wreath product is too large");
+        }
+        size *= m;
+    }
+    if (size > kMax / n) {
+        throw std::invalid_argument("Wreath product is too large");
+    }
+    return size;
+}
+
+} // namespace
+
+WreathProductCharacters::WreathProductCharacters(size_t m, size_t n)
+    : m_(m)
+    , n_(n)
+    , base_size_(checked_base_size(m, n))
+    , order_(base_size_ * n)
+    , base_(std::vector<size_t>(n, m))
+    , roots_m_(m)
+{
+    for (size_t k = 0; k < m; ++k) {
+        roots_m_[k] = std::polar(1.0, 2.0 * PI * static_cast<double>(k) / static_cast<double>(m));
+    }
+
+    // σ rotates the digits of x right by one: the last digit becomes the first
+    const size_t top_digit = base_size_ / m;
+    auto shift = [&](size_t x) { return (x % m) * top_digit + x / m; };
+
+    std::vector<bool> visited(base_size_, false);
+    for (size_t x = 0; x < base_size_; ++x) {
+        if (visited[x]) continue;
+
+        Orbit orbit{0, members_.size(), irreps_.size()};
+        size_t y = x;
+        do {
+            visited[y] = true;
+            members_.push_back(y);
+            y = shift(y);
+        } while (y != x);
+        orbit.period = members_.size() - orbit.first_member;
+
+        const size_t q_len = n / orbit.period;
+        for (size_t r = 0; r < q_len; ++r) {
+            irreps_.push_back({x, orbit.period, r, orbits_.size()});
+        }
+        if (top_plans_.find(q_len) == top_plans_.end()) {
+            top_plans_.emplace(q_len, FourierPlan(q_len));
+        }
+        orbits_.push_back(orbit);
+    }
+}
+
+size_t WreathProductCharacters::element(size_t a, size_t s) const {
+    if (a >= base_size_ || s >= n_) {
+        throw std::out_of_range("Wreath product element out of range");
+    }
+    return s * base_size_ + a;
+}
+
+size_t WreathProductCharacters::multiply(size_t g, size_t h) const {
+    if (g >= order_ || h >= order_) {
+        throw std::out_of_range("Wreath product element out of range");
+    }
+    const size_t a = g % base_size_, s = g / base_size_;
+    const size_t b = h % base_size_, t = h / base_size_;
+
+    // a + σ^s b, digit by digit: (σ^s b)_i = b_{i-s}
+    std::vector<size_t> a_digits(n_), b_digits(n_);
+    for (size_t i = n_, x = a, y = b; i-- > 0; x /= m_, y /= m_) {
+        a_digits[i] = x % m_;
+        b_digits[i] = y % m_;
+    }
+    size_t c = 0;
+    for (size_t i = 0; i < n_; ++i) {
+        c = c * m_ + (a_digits[i] + b_digits[(i + n_ - s) % n_]) % m_;
+    }
+    return ((s + t) % n_) * base_size_ + c;
+}
+
+size_t WreathProductCharacters::base_phase(size_t y, size_t a) const {
+    size_t phase = 0;
+    for (size_t i = 0; i < n_; ++i, y /= m_, a /= m_) {
+        phase += (y % m_) * (a % m_);
+    }
+    return phase % m_;
+}
+
+Matrix WreathProductCharacters::representation(size_t i, size_t g) const {
+    const Irrep& rho = irreps_.at(i);
+    if (g >= order_) {
+        throw std::out_of_range("Wreath product element out of range");
+    }
+
+    const size_t p = rho.period;
+    const size_t q_len = n_ / p;
+    const size_t a = g % base_size_, s = g / base_size_;
+    const Orbit& orbit = orbits_[rho.orbit];
+
+    Matrix R(p, p);
+#ifdef USE_EIGEN3
+    R.setZero();
+    for (size_t t = 0; t < p; ++t) {
+        const size_t w = (s + t) % n_;
+        const size_t tp = w % p;
+        const size_t q = (w - tp) / p;
+        const double top = 2.0 * PI * static_cast<double>((rho.r * q) % q_len) / static_cast<double>(q_len);
+        R(tp, t) = roots_m_[base_phase(members_[orbit.first_member + tp], a)] * std::polar(1.0, top);
+    }
+#endif
+    return R;
+}
+
+complex_t WreathProductCharacters::character(size_t i, size_t g) const {
+    const Irrep& rho = irreps_.at(i);
+    if (g >= order_) {
+        throw std::out_of_range("Wreath product element out of range");
+    }
+
+    // ρ(a, s) is a permutation of the coset basis that fixes nothing unless p | s
+    const size_t p = rho.period;
+    const size_t s = g / base_size_;
+    if (s % p != 0) {
+        return complex_t(0.0, 0.0);
+    }
+
+    const size_t q_len = n_ / p;
+    const size_t a = g % base_size_;
+    const Orbit& orbit = orbits_[rho.orbit];
+    complex_t trace(0.0, 0.0);
+    for (size_t t = 0; t < p; ++t) {
+        const size_t q = ((s + t) % n_ - t) / p;
+        const double top = 2.0 * PI * static_cast<double>((rho.r * q) % q_len) / static_cast<double>(q_len);
+        trace += roots_m_[base_phase(members_[orbit.first_member + t], a)] * std::polar(1.0, top);
+    }
+    return trace;
+}
+
+void WreathProductCharacters::check_rows(const Matrix& V) const {
+    if (static_cast<size_t>(V.rows()) != order_) {
+        throw std::invalid_argument("Wreath product samples need |G| rows");
+    }
+}
+
+std::vector<Matrix> WreathProductCharacters::fourier_transform(const Vector& f) const {
+    if (static_cast<size_t>(f.size()) != order_) {
+        throw std::invalid_argument("Function must have |G| entries");
+    }
+
+    std::vector<Matrix> coefficients;
+#ifdef USE_EIGEN3
+    // Step 1: F(y, s) = Σ_a f(a, s) ψ_y(a), one base transform per s
+    const Matrix blocks = Eigen::Map<const Matrix>(f.data(), base_size_, n_);
+    const Matrix F = base_.transform(blocks);
+
+    coefficients.reserve(irreps_.size());
+    for (const auto& rho : irreps_) {
+        coefficients.push_back(Matrix::Zero(rho.period, rho.period));
+    }
+
+    // Step 2: per orbit and (t', t), one DFT over the stabilizer gives every r
+    std::vector<complex_t> v, work;
+    for (const auto& orbit : orbits_) {
+        const size_t p = orbit.period;
+        const size_t q_len = n_ / p;
+        const FourierPlan& plan = top_plans_.at(q_len);
+        v.resize(q_len);
+        work.resize(plan.workspace_size());
+
+        for (size_t tp = 0; tp < p; ++tp) {
+            const size_t y = members_[orbit.first_member + tp];
+            for (size_t t = 0; t < p; ++t) {
+                for (size_t q = 0; q < q_len; ++q) {
+                    v[q] = F(y, (tp + p * q + n_ - t) % n_);
+                }
+                plan.forward(v.data(), work.data());
+                for (size_t r = 0; r < q_len; ++r) {
+                    coefficients[orbit.first_irrep + r](tp, t) = v[r];
+                }
+            }
+        }
+    }
+#endif
+    return coefficients;
+}
+
+Vector WreathProductCharacters::inverse_fourier_transform(const std::vector<Matrix>& coefficients) const {
+    if (coefficients.size() != irreps_.size()) {
+        throw std::invalid_argument("Need one coefficient matrix per irrep");
+    }
+    for (size_t i = 0; i < irreps_.size(); ++i) {
+        const size_t d = irreps_[i].period;
+        if (static_cast<size_t>(coefficients[i].rows()) != d || static_cast<size_t>(coefficients[i].cols()) != d) {
+            throw std::invalid_argument("Coefficient matrix has the wrong dimension");
+        }
+    }
+
+    Vector f(order_);
+#ifdef USE_EIGEN3
+    // Undo step 2: G(σ^{t'}x, s) = p Σ_r ω_{n/p}^{-rq} \hat f_r(t', t); for a fixed
+    // s each member of the orbit receives exactly one term
+    Matrix G = Matrix::Zero(base_size_, n_);
+    std::vector<complex_t> v, work;
+    for (const auto& orbit : orbits_) {
+        const size_t p = orbit.period;
+        const size_t q_len = n_ / p;
+        const FourierPlan& plan = top_plans_.at(q_len);
+        v.resize(q_len);
+        work.resize(plan.workspace_size());
+
+        for (size_t tp = 0; tp < p; ++tp) {
+            const size_t y = members_[orbit.first_member + tp];
+            for (size_t t = 0; t < p; ++t) {
+                for (size_t r = 0; r < q_len; ++r) {
+                    v[r] = coefficients[orbit.first_irrep + r](tp, t);
+                }
+                plan.inverse(v.data(), work.data());
+                for (size_t q = 0; q < q_len; ++q) {
+                    G(y, (tp + p * q + n_ - t) % n_) += static_cast<double>(p) * v[q];
+                }
+            }
+        }
+    }
+
+    // Undo step 1: (1/|G|) Σ_y ψ̄_y(a) G(y, s) = base inverse (1/m^n) times 1/n
+    const Matrix blocks = base_.inverse_transform(G) / static_cast<double>(n_);
+    f = Eigen::Map<const Vector>(blocks.data(), order_);
+#endif
+    return f;
+}
+
+void WreathProductCharacters::accumulate_projection(size_t i, const Matrix& coef, complex_t* out) const {
+#ifdef USE_EIGEN3
+    const Irrep& rho = irreps_[i];
+    const Orbit& orbit = orbits_[rho.orbit];
+    const size_t p = rho.period;
+    const size_t q_len = n_ / p;
+    const double scale = static_cast<double>(p) / static_cast<double>(order_);
+
+    // ψ̄_{σ^{t'}x}(a) for every coset t' and base element a
+    std::vector<complex_t> psi_bar(p * base_size_);
+    for (size_t tp = 0; tp < p; ++tp) {
+        const size_t y = members_[orbit.first_member + tp];
+        for (size_t a = 0; a < base_size_; ++a) {
+            psi_bar[tp * base_size_ + a] = std::conj(roots_m_[base_phase(y, a)]);
+        }
+    }
+
+    // ρ(a, s) has one entry per column t, at row t': tr(ρ^H coef) has p terms
+    for (size_t s = 0; s < n_; ++s) {
+        complex_t* block = out + s * base_size_;
+        for (size_t t = 0; t < p; ++t) {
+            const size_t w = (s + t) % n_;
+            const size_t tp = w % p;
+            const size_t q = (w - tp) / p;
+            const double top = -2.0 * PI * static_cast<double>((rho.r * q) % q_len) / static_cast<double>(q_len);
+            const complex_t c = scale * std::polar(1.0, top) * coef(tp, t);
+            const complex_t* psi = psi_bar.data() + tp * base_size_;
+            for (size_t a = 0; a < base_size_; ++a) {
+                block[a] += c * psi[a];
+            }
+        }
+    }
+#else
+    (void)i;
+    (void)coef;
+    (void)out;
+#endif
+}
+
+Matrix WreathProductCharacters::project_onto_irrep(const Matrix& V, size_t i) const {
+    if (i >= irreps_.size()) {
+        throw std::out_of_range("Irrep index out of range");
+    }
+    check_rows(V);
+
+    Matrix proj(order_, V.cols());
+#ifdef USE_EIGEN3
+    proj.setZero();
+    for (Eigen::Index c = 0; c < V.cols(); ++c) {
+        const std::vector<Matrix> coefficients = fourier_transform(V.col(c));
+        accumulate_projection(i, coefficients[i], proj.col(c).data());
+    }
+#endif
+    return proj;
+}
+
+std::vector<Matrix> WreathProductCharacters::decompose_into_characters(const Matrix& V) const {
+    check_rows(V);
+
+    std::vector<Matrix> projections;
+#ifdef USE_EIGEN3
+    projections.assign(irreps_.size(), Matrix::Zero(order_, V.cols()));
+    for (Eigen::Index c = 0; c < V.cols(); ++c) {
+        const std::vector<Matrix> coefficients = fourier_transform(V.col(c));
+        for (size_t i = 0; i < irreps_.size(); ++i) {
+            accumulate_projection(i, coefficients[i], projections[i].col(c).data());
+        }
+    }
+#endif
+    return projections;
+}
+
+Vector WreathProductCharacters::selected_projection_features(
+    const Matrix& V, std::span<const size_t> characters) const
+{
+    check_rows(V);
+    for (size_t c : characters) {
+        if (c >= irreps_.size()) {
+            throw std::out_of_range("Irrep index out of range");
+        }
+    }
+
+#ifdef USE_EIGEN3
+    const size_t k = characters.size();
+    Vector features(order_ * k);
+    const std::vector<Matrix> coefficients = fourier_transform(V.col(0));
+
+    std::vector<complex_t> proj(order_);
+    for (size_t i = 0; i < k; ++i) {
+        std::fill(proj.begin(), proj.end(), complex_t(0.0, 0.0));
+        accumulate_projection(characters[i], coefficients[characters[i]], proj.data());
+        for (size_t p = 0; p < order_; ++p) {
+            features(p * k + i) = proj[p];
+        }
+    }
+    return features;
+#else
+    return Vector(1);
+#endif
+}
+
+} // namespace sheaf
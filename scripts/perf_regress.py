@@ -0,0 +1,328 @@
+#!/usr/bin/env python3
+"""
+Performance regression harness for the sheaf solver.
+
+Runs sheaf_bench repeatedly, stores the per-trial results keyed by git
+revision and machine fingerprint, and compares against a recorded baseline
+with Welch confidence intervals. Only slowdowns whose confidence interval
+excludes "no change" and that exceed the threshold are flagged, so noise
+does not fail the gate.
+
+Commands:
+    run      Run the trials and store them under the current revision
+    compare  Compare two stored revisions (default: current vs latest other)
+    gate     run + compare, exit 1 on a significant slowdown
+
+Examples:
+    scripts/perf_regress.py gate --bench _gate_build/userspace/bench/sheaf_bench
+    scripts/perf_regress.py run --bench build-arm/userspace/bench/sheaf_bench \\
+        --runner "qemu-aarch64 -L /usr/aarch64-linux-gnu"
+    scripts/perf_regress.py compare --baseline 1a2b3c4 --revision HEAD
+
+Only the Python standard library is used, so it runs on the target board too.
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import platform
+import shlex
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_STORE = os.path.join(REPO_ROOT, "perf", "baselines")
+
+# Two-sided 95% Student-t critical values by degrees of freedom
+T_CRITICAL_95 = {
+    1: 12.706, 2: 4.303, 3: 3.182, 4: 2.776, 5: 2.571, 6: 2.447, 7: 2.365,
+    8: 2.306, 9: 2.262, 10: 2.228, 12: 2.179, 15: 2.131, 20: 2.086,
+    25: 2.060, 30: 2.042, 40: 2.021, 60: 2.000, 120: 1.980,
+}
+
+
+def t_critical(df):
+    """Conservative 95% critical value: use the nearest tabulated df below."""
+    if df >= 120:
+        return 1.960
+    best = 1
+    for k in sorted(T_CRITICAL_95):
+        if k <= df:
+            best = k
+    return T_CRITICAL_95[best]
+
+
+def git_revision():
+    try:
+        rev = subprocess.check_output(
+            ["git", "rev-parse", "--short=12", "HEAD"], cwd=REPO_ROOT, text=True).strip()
+        dirty = subprocess.call(
+            ["git", "diff", "--quiet", "HEAD", "--", "kernel", "userspace"], cwd=REPO_ROOT) != 0
+        return rev + ("-dirty" if dirty else "")
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+
+def resolve_revision(rev):
+    if rev in (None, "", "HEAD"):
+        return git_revision()
+    try:
+        return subprocess.check_output(
+            ["git", "rev-parse", "--short=12", rev], cwd=REPO_ROOT, text=True,
+            stderr=subprocess.DEVNULL).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return rev
+
+
+def cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                key = line.split(":")[0].strip().lower()
+                if key in ("model name", "cpu part", "hardware"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or "unknown"
+
+
+def machine_fingerprint(runner):
+    """Stable id for 'same hardware, same execution mode'."""
+    parts = {
+        "machine": platform.machine(),
+        "cpu": cpu_model(),
+        "cpus": str(os.cpu_count()),
+        "system": platform.system(),
+        "runner": runner or "native",
+    }
+    digest = hashlib.sha1(json.dumps(parts, sort_keys=True).encode()).hexdigest()[:10]
+    label = "%s-%s" % (platform.machine(), "qemu" if runner else "native")
+    return label + "-" + digest, parts
+
+
+def bench_key(record):
+    params = record.get("params", {})
+    return record["name"] + "".join(
+        "/%s=%g" % (k, params[k]) for k in sorted(params))
+
+
+def run_trials(args):
+    runner = shlex.split(args.runner) if args.runner else []
+    samples = {}
+    context = {}
+
+    for trial in range(args.trials):
+        with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as tmp:
+            out_path = tmp.name
+        cmd = runner + [args.bench, "--out", out_path, "--min-time", str(args.min_time)]
+        if args.quick:
+            cmd.append("--quick")
+        if args.filter:
+            cmd += ["--filter", args.filter]
+
+        sys.stderr.write("trial %d/%d: %s\n" % (trial + 1, args.trials, " ".join(cmd)))
+        try:
+            subprocess.run(cmd, check=True, stderr=subprocess.DEVNULL)
+            with open(out_path) as f:
+                doc = json.load(f)
+        finally:
+            os.unlink(out_path)
+
+        context = doc.get("context", {})
+        for rec in doc.get("benchmarks", []):
+            samples.setdefault(bench_key(rec), []).append(rec["ns_per_op"])
+
+    return context, samples
+
+
+def store_path(store, fingerprint, revision):
+    return os.path.join(store, fingerprint, revision + ".json")
+
+
+def save_results(args, context, samples):
+    fingerprint, parts = machine_fingerprint(args.runner)
+    revision = git_revision()
+    path = store_path(args.store, fingerprint, revision)
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    doc = {
+        "revision": revision,
+        "fingerprint": fingerprint,
+        "machine": parts,
+        "timestamp": int(time.time()),
+        "trials": args.trials,
+        "context": context,
+        "samples_ns": samples,
+    }
+    with open(path, "w") as f:
+        json.dump(doc, f, indent=1, sort_keys=True)
+    sys.stderr.write("stored %d benchmarks -> %s\n" % (len(samples), path))
+    return path
+
+
+def load_results(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def latest_other(store, fingerprint, exclude_revision):
+    directory = os.path.join(store, fingerprint)
+    if not os.path.isdir(directory):
+        return None
+    candidates = []
+    for name in os.listdir(directory):
+        if not name.endswith(".json") or name[:-5] == exclude_revision:
+            continue
+        path = os.path.join(directory, name)
+        candidates.append((load_results(path).get("timestamp", 0), path))
+    return max(candidates)[1] if candidates else None
+
+
+def welch(base, cur):
+    """Relative change of the mean with a 95% confidence interval."""
+    mb, mc = statistics.fmean(base), statistics.fmean(cur)
+    vb = statistics.variance(base) if len(base) > 1 else 0.0
+    vc = statistics.variance(cur) if len(cur) > 1 else 0.0
+    se2 = vb / len(base) + vc / len(cur)
+    if se2 > 0.0:
+        denom = 0.0
+        if len(base) > 1:
+            denom += (vb / len(base)) ** 2 / (len(base) - 1)
+        if len(cur) > 1:
+            denom += (vc / len(cur)) ** 2 / (len(cur) - 1)
+        df = se2 ** 2 / denom if denom > 0.0 else 1.0
+        half = t_critical(int(df)) * math.sqrt(se2)
+    else:
+        half = 0.0
+    diff = mc - mb
+    return diff / mb, (diff - half) / mb, (diff + half) / mb
+
+
+def compare(base_doc, cur_doc, threshold, top):
+    rows = []
+    for key, cur in cur_doc["samples_ns"].items():
+        base = base_doc["samples_ns"].get(key)
+        if not base:
+            continue
+        rel, lo, hi = welch(base, cur)
+        significant = lo > 0.0 or hi < 0.0
+        rows.append({
+            "key": key,
+            "base_ns": statistics.fmean(base),
+            "cur_ns": statistics.fmean(cur),
+            "rel": rel, "lo": lo, "hi": hi,
+            "regression": significant and lo > 0.0 and rel > threshold,
+            "improvement": significant and hi < 0.0 and rel < -threshold,
+        })
+
+    rows.sort(key=lambda r: abs(r["rel"]), reverse=True)
+    regressions = [r for r in rows if r["regression"]]
+    improvements = [r for r in rows if r["improvement"]]
+
+    print("Performance comparison: %s -> %s (%s)" % (
+        base_doc["revision"], cur_doc["revision"], cur_doc["fingerprint"]))
+    print("  %d benchmarks compared, %d regressions, %d improvements (threshold %.1f%%, 95%% CI)"
+          % (len(rows), len(regressions), len(improvements), threshold * 100.0))
+    print()
+    print("Top movers:")
+    for r in rows[:top]:
+        tag = "REGRESSION" if r["regression"] else ("faster" if r["improvement"] else "noise")
+        print("  %+7.1f%%  [%+6.1f%%, %+6.1f%%]  %12.0f -> %12.0f ns  %-10s %s" % (
+            r["rel"] * 100.0, r["lo"] * 100.0, r["hi"] * 100.0,
+            r["base_ns"], r["cur_ns"], tag, r["key"]))
+    return regressions
+
+
+def cmd_run(args):
+    context, samples = run_trials(args)
+    save_results(args, context, samples)
+    return 0
+
+
+def cmd_compare(args):
+    fingerprint, _ = machine_fingerprint(args.runner)
+    cur_rev = resolve_revision(args.revision)
+    cur_path = store_path(args.store, fingerprint, cur_rev)
+    if not os.path.exists(cur_path):
+        sys.stderr.write("no results for %s on %s\n" % (cur_rev, fingerprint))
+        return 2
+
+    if args.baseline:
+        base_path = store_path(args.store, fingerprint, resolve_revision(args.baseline))
+    else:
+        base_path = latest_other(args.store, fingerprint, cur_rev)
+    if not base_path or not os.path.exists(base_path):
+        print("No baseline recorded for %s yet; current results stored as the first one."
+              % fingerprint)
+        return 0
+
+    regressions = compare(load_results(base_path), load_results(cur_path),
+                          args.threshold, args.top)
+    if regressions:
+        print("\nFAIL: %d significant slowdown(s)" % len(regressions))
+        return 1
+    print("\nPASS")
+    return 0
+
+
+def cmd_gate(args):
+    status = cmd_run(args)
+    if status != 0:
+        return status
+    args.revision = None
+    return cmd_compare(args)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    def common(p):
+        p.add_argument("--store", default=DEFAULT_STORE,
+                       help="results directory (default: perf/baselines)")
+        p.add_argument("--runner", default=os.environ.get("SHEAF_BENCH_RUNNER", ""),
+                       help="command prefix, e.g. 'qemu-aarch64 -L /usr/aarch64-linux-gnu'")
+
+    def running(p):
+        p.add_argument("--bench", required=True, help="path to the sheaf_bench binary")
+        p.add_argument("--trials", type=int, default=5)
+        p.add_argument("--min-time", type=float, default=0.05)
+        p.add_argument("--quick", action="store_true")
+        p.add_argument("--filter", default="")
+
+    def comparing(p):
+        p.add_argument("--baseline", default=None, help="baseline revision (default: latest other)")
+        p.add_argument("--threshold", type=float, default=0.05,
+                       help="minimum relative slowdown to flag (default 0.05)")
+        p.add_argument("--top", type=int, default=10)
+
+    p_run = sub.add_parser("run", help="run trials and store results")
+    common(p_run)
+    running(p_run)
+    p_run.set_defaults(func=cmd_run)
+
+    p_cmp = sub.add_parser("compare", help="compare two stored revisions")
+    common(p_cmp)
+    comparing(p_cmp)
+    p_cmp.add_argument("--revision", default=None, help="revision to check (default: HEAD)")
+    p_cmp.set_defaults(func=cmd_compare)
+
+    p_gate = sub.add_parser("gate", help="run, store and compare; exit 1 on regression")
+    common(p_gate)
+    running(p_gate)
+    comparing(p_gate)
+    p_gate.set_defaults(func=cmd_gate)
+
+    args = parser.parse_args()
+    if getattr(args, "trials", 2) < 2:
+        parser.error("--trials must be at least 2 for confidence intervals")
+    return args.func(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
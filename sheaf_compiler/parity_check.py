@@ -0,0 +1,257 @@
+"""
+Differential parity and speed check: C++ sheaf_solver vs. this Python reference.
+
+Generates random sheaf problems, fits each one with the Python
+UnifiedSheafLearner and with the C++ library (through the sheaf_parity
+driver built in userspace/bench), and checks that:
+
+  - predictions on held-out samples agree within a relative tolerance, and
+  - the residuals (cohomological obstructions) agree within tolerance.
+
+Weights are not compared directly. A patch's character-projection features
+span at most n_characters of its n_positions * n_characters columns, so the
+rest of the weight vector is fixed only by the tiny ridge term and two
+correct solvers legitimately disagree there. Predictions and residuals only
+see the determined part.
+
+It also reports the Python/C++ time ratio per phase, so a performance change
+in the C++ port that silently alters the math fails here instead of shipping.
+
+Phases are matched as follows:
+
+    Python                          C++ FitStats phases
+    _build_local_systems            local_build
+    _build_gluing_systems           gluing_build
+    (rest of fit: stack + solve)    assembly + gram + factorization + solve + residual
+    _unpack_solution                unpack
+
+Usage:
+    python parity_check.py --driver ../_gate_build/userspace/bench/sheaf_parity
+    python parity_check.py --driver ... --problems 20 --seed 7 --repeat 3
+
+Exit status is 1 if any problem disagrees.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+import numpy as np
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from unified_sheaf_learner import UnifiedSheafLearner
+
+
+PHASES = ["local_build", "gluing_build", "solve", "unpack"]
+CPP_SOLVE_PHASES = ["assembly", "gram", "factorization", "solve", "residual"]
+
+
+def random_complex(rng, shape):
+    return rng.standard_normal(shape) + 1j * rng.standard_normal(shape)
+
+
+def random_problem(rng, max_patches=4, max_positions=16, n_holdout=8):
+    """
+    A random problem: targets come from hidden weights plus a little noise,
+    and every patch has at least as many samples as weights.
+
+    Returns (problem, holdout), where holdout maps each patch to samples
+    that are not part of the fit.
+    """
+    n_patches = int(rng.integers(1, max_patches + 1))
+    patches = {}
+    holdout = {}
+    for p in range(n_patches):
+        n_positions = int(rng.choice([2, 3, 4, 6, 8, max_positions]))
+        n_characters = int(rng.integers(1, n_positions + 2))  # may exceed n_positions
+        n_weights = n_positions * n_characters
+        n_samples = n_weights + int(rng.integers(1, 8))
+
+        hidden = random_complex(rng, n_weights)
+        V_samples = [random_complex(rng, (n_positions, 1)) for _ in range(n_samples)]
+        config = {'n_positions': n_positions, 'n_characters': n_characters, 'd_model': 1}
+        learner = UnifiedSheafLearner()
+        targets = []
+        for V in V_samples:
+            y = learner._get_feature_row(V, config) @ hidden
+            y += 0.01 * complex(*rng.standard_normal(2))
+            targets.append(np.array([[y]]))
+        patches["patch_%d" % p] = {'data': (V_samples, targets), 'config': config}
+        holdout["patch_%d" % p] = [random_complex(rng, (n_positions, 1)) for _ in range(n_holdout)]
+
+    names = list(patches)
+    gluings = []
+    if len(names) > 1:
+        for _ in range(int(rng.integers(0, 2 * len(names) + 1))):
+            a, b = rng.choice(len(names), size=2, replace=False)
+            n1 = patches[names[a]]['config']['n_positions']
+            n2 = patches[names[b]]['config']['n_positions']
+            gluings.append({
+                'patch_1': names[a],
+                'patch_2': names[b],
+                'constraint_data_1': random_complex(rng, (n1, 1)),
+                'constraint_data_2': random_complex(rng, (n2, 1)),
+            })
+
+    return {'patches': patches, 'gluings': gluings}, holdout
+
+
+def format_values(values):
+    return " ".join("%r %r" % (complex(v).real, complex(v).imag) for v in np.ravel(values))
+
+
+def write_problem(problem, path):
+    """Serialize in the text format read by sheaf_parity."""
+    with open(path, "w") as f:
+        f.write("sheaf-problem 1\n")
+        f.write("patches %d\n" % len(problem['patches']))
+        for name, patch in problem['patches'].items():
+            V_samples, targets = patch['data']
+            config = patch['config']
+            f.write("patch %s %d %d %d\n" % (
+                name, config['n_positions'], config['n_characters'], len(V_samples)))
+            for V, t in zip(V_samples, targets):
+                f.write(format_values(V) + " " + format_values(np.ravel(t)[:1]) + "\n")
+        f.write("gluings %d\n" % len(problem['gluings']))
+        for g in problem['gluings']:
+            f.write("gluing %s %s\n" % (g['patch_1'], g['patch_2']))
+            f.write(format_values(g['constraint_data_1']) + "\n")
+            f.write(format_values(g['constraint_data_2']) + "\n")
+
+
+def timed(phases, key, method):
+    """Wrap a bound method so its run time is charged to phases[key]."""
+    def wrapper(*args, **kwargs):
+        t0 = time.perf_counter_ns()
+        try:
+            return method(*args, **kwargs)
+        finally:
+            phases[key] += time.perf_counter_ns() - t0
+    return wrapper
+
+
+def run_python(problem, repeat):
+    """Fit with the Python learner; phase times are means over the repeats."""
+    phases = dict.fromkeys(PHASES, 0)
+    total = 0
+    solution = residual = None
+    for _ in range(repeat):
+        learner = UnifiedSheafLearner(verbose=False)
+        learner._build_local_systems = timed(phases, "local_build", learner._build_local_systems)
+        learner._build_gluing_systems = timed(phases, "gluing_build", learner._build_gluing_systems)
+        learner._unpack_solution = timed(phases, "unpack", learner._unpack_solution)
+        t0 = time.perf_counter_ns()
+        solution, residual = learner.fit(problem)
+        total += time.perf_counter_ns() - t0
+
+    phases["solve"] = total - phases["local_build"] - phases["gluing_build"] - phases["unpack"]
+    return solution, residual, {k: v / repeat for k, v in phases.items()}, total / repeat
+
+
+def run_cpp(driver, problem, repeat):
+    with tempfile.NamedTemporaryFile("w", suffix=".sheaf", delete=False) as tmp:
+        path = tmp.name
+    try:
+        write_problem(problem, path)
+        out = subprocess.run([driver, path, "--repeat", str(repeat)],
+                             check=True, capture_output=True, text=True).stdout
+    finally:
+        os.unlink(path)
+
+    result = json.loads(out)
+    cpp = result['phases_ns']
+    phases = {
+        "local_build": cpp["local_build"],
+        "gluing_build": cpp["gluing_build"],
+        "solve": sum(cpp[k] for k in CPP_SOLVE_PHASES),
+        "unpack": cpp["unpack"],
+    }
+    weights = {name: np.array([complex(re, im) for re, im in w])
+               for name, w in result['weights'].items()}
+    return weights, result['residual'], phases, result['fit_ns']
+
+
+def compare(problem, holdout, py_solution, py_residual, cpp_weights, cpp_residual, rtol):
+    """Return a list of human-readable mismatches (empty if they agree)."""
+    errors = []
+    featurizer = UnifiedSheafLearner(verbose=False)
+    for name, entry in py_solution.items():
+        w_py = np.ravel(entry['weights'])
+        w_cpp = cpp_weights.get(name)
+        if w_cpp is None or w_cpp.shape != w_py.shape:
+            errors.append("%s: missing or mis-shaped C++ weights" % name)
+            continue
+        config = problem['patches'][name]['config']
+        features = np.array([featurizer._get_feature_row(V, config) for V in holdout[name]])
+        y_py = features @ w_py
+        y_cpp = features @ w_cpp
+        rel = np.linalg.norm(y_cpp - y_py) / max(np.linalg.norm(y_py), 1.0)
+        if rel > rtol:
+            errors.append("%s: held-out predictions differ (relative error %.3e)" % (name, rel))
+
+    scale = max(abs(py_residual), 1.0)
+    if abs(cpp_residual - py_residual) / scale > rtol:
+        errors.append("residual differs: python %.6e, c++ %.6e" % (py_residual, cpp_residual))
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description="C++ vs Python sheaf learner parity check")
+    parser.add_argument("--driver", required=True, help="path to the sheaf_parity binary")
+    parser.add_argument("--problems", type=int, default=10)
+    parser.add_argument("--seed", type=int, default=0)
+    parser.add_argument("--repeat", type=int, default=3, help="fits per problem for timing")
+    parser.add_argument("--rtol", type=float, default=1e-6,
+                        help="relative tolerance on held-out predictions and the residual")
+    parser.add_argument("--holdout", type=int, default=8, help="held-out samples per patch")
+    parser.add_argument("--max-patches", type=int, default=4)
+    parser.add_argument("--max-positions", type=int, default=16)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(args.seed)
+    py_totals = dict.fromkeys(PHASES, 0.0)
+    cpp_totals = dict.fromkeys(PHASES, 0.0)
+    failures = 0
+
+    print("=" * 80)
+    print("Sheaf learner parity: C++ (%s) vs Python" % args.driver)
+    print("=" * 80)
+
+    for k in range(args.problems):
+        problem, holdout = random_problem(rng, args.max_patches, args.max_positions, args.holdout)
+        py_sol, py_res, py_phases, py_ns = run_python(problem, args.repeat)
+        cpp_w, cpp_res, cpp_phases, cpp_ns = run_cpp(args.driver, problem, args.repeat)
+
+        errors = compare(problem, holdout, py_sol, py_res, cpp_w, cpp_res, args.rtol)
+        for p in PHASES:
+            py_totals[p] += py_phases[p]
+            cpp_totals[p] += cpp_phases[p]
+
+        status = "ok" if not errors else "MISMATCH"
+        print("problem %2d: %d patches, %d gluings, residual %.4e  speedup %6.1fx  %s" % (
+            k, len(problem['patches']), len(problem['gluings']), py_res,
+            py_ns / max(cpp_ns, 1.0), status))
+        for e in errors:
+            print("    " + e)
+        failures += bool(errors)
+
+    print()
+    print("%-14s %14s %14s %10s" % ("phase", "python ms", "c++ ms", "speedup"))
+    for p in PHASES:
+        ratio = py_totals[p] / cpp_totals[p] if cpp_totals[p] > 0 else float('inf')
+        print("%-14s %14.3f %14.3f %9.1fx" % (
+            p, py_totals[p] / 1e6, cpp_totals[p] / 1e6, ratio))
+    print()
+    if failures:
+        print("FAIL: %d of %d problems disagree" % (failures, args.problems))
+        return 1
+    print("PASS: all %d problems agree (rtol %g)" % (args.problems, args.rtol))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,145 @@
+/**
+ * @file bench_support.cpp
+ * @brief Counting allocator and JSON writer shared by the benchmarks
+ */
+
+#include "bench_support.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+
+namespace {
+
+std::atomic<uint64_t> g_alloc_bytes{0};
+std::atomic<uint64_t> g_alloc_count{0};
+
+inline void count_alloc(std::size_t size) {
+    g_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// Interpose the C allocator (glibc): Eigen allocates through malloc directly,
+// and operator new ends up here too, so this sees every heap allocation.
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t align, std::size_t size);
+void __libc_free(void* p);
+
+void* malloc(std::size_t size) {
+    count_alloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) {
+    count_alloc(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, std::size_t size) {
+    count_alloc(size);
+    return __libc_realloc(p, size);
+}
+
+void* aligned_alloc(std::size_t align, std::size_t size) {
+    count_alloc(size);
+    return __libc_memalign(align, size);
+}
+
+void* memalign(std::size_t align, std::size_t size) {
+    count_alloc(size);
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void** out, std::size_t align, std::size_t size) {
+    count_alloc(size);
+    void* p = __libc_memalign(align, size);
+    if (!p) {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+
+void free(void* p) {
+    __libc_free(p);
+}
+
+} // extern "C"
+
+namespace bench {
+
+AllocCounters alloc_snapshot() {
+    return AllocCounters{
+        g_alloc_bytes.load(std::memory_order_relaxed),
+        g_alloc_count.load(std::memory_order_relaxed)
+    };
+}
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+namespace {
+
+std::string json_number(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.6g", v);
+    return buf;
+}
+
+} // namespace
+
+void write_json(
+    std::ostream& out,
+    const std::vector<std::pair<std::string, std::string>>& context,
+    const std::vector<Record>& records
+) {
+    out << "{\n  \"context\": {";
+    for (size_t i = 0; i < context.size(); ++i) {
+        out << (i ? ", " : "") << "\"" << json_escape(context[i].first) << "\": \""
+            << json_escape(context[i].second) << "\"";
+    }
+    out << "},\n  \"benchmarks\": [\n";
+
+    for (size_t r = 0; r < records.size(); ++r) {
+        const Record& rec = records[r];
+        out << "    {\"name\": \"" << json_escape(rec.name) << "\", \"params\": {";
+        for (size_t i = 0; i < rec.params.size(); ++i) {
+            out << (i ? ", " : "") << "\"" << json_escape(rec.params[i].first) << "\": "
+                << json_number(rec.params[i].second);
+        }
+        out << "}, \"iterations\": " << rec.measurement.iterations
+            << ", \"ns_per_op\": " << json_number(rec.measurement.ns_per_op)
+            << ", \"bytes_per_op\": " << json_number(rec.measurement.bytes_per_op)
+            << ", \"allocs_per_op\": " << json_number(rec.measurement.allocs_per_op)
+            << ", \"flops_per_op\": " << json_number(rec.flops_per_op)
+            << ", \"gflops\": " << json_number(rec.gflops()) << "}"
+            << (r + 1 < records.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace bench
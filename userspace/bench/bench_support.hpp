@@ -0,0 +1,131 @@
+/**
+ * @file bench_support.hpp
+ * @brief Shared timing, allocation counting and JSON output for benchmarks
+ *
+ * Every benchmark binary links bench_support.cpp, which interposes the C
+ * allocator with counting versions. That lets a benchmark report bytes and
+ * allocations per operation (including Eigen's own buffers) without any
+ * instrumentation inside the sheaf_solver library itself.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief Snapshot of the process-wide allocation counters
+ */
+struct AllocCounters {
+    uint64_t bytes;   // Total bytes requested from the allocator
+    uint64_t count;   // Number of allocation calls
+};
+
+/**
+ * @brief Read the current allocation counters (monotonic, never reset)
+ */
+AllocCounters alloc_snapshot();
+
+/**
+ * @brief Monotonic clock in nanoseconds
+ */
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @brief Keep a value alive so the optimizer cannot drop the benchmarked call
+ */
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Result of timing one operation
+ */
+struct Measurement {
+    uint64_t iterations;
+    double ns_per_op;
+    double bytes_per_op;
+    double allocs_per_op;
+};
+
+/**
+ * @brief Run op() repeatedly until min_time_s has elapsed
+ *
+ * One untimed warm-up call is made first so lazily built state (caches,
+ * first-touch page faults) does not pollute the measurement.
+ */
+template<typename Op>
+Measurement measure(Op&& op, double min_time_s) {
+    op();
+
+    const uint64_t budget_ns = static_cast<uint64_t>(min_time_s * 1e9);
+    uint64_t iterations = 0;
+    uint64_t batch = 1;
+
+    const AllocCounters a0 = alloc_snapshot();
+    const uint64_t t0 = now_ns();
+    uint64_t elapsed = 0;
+
+    while (elapsed < budget_ns) {
+        for (uint64_t i = 0; i < batch; ++i) {
+            op();
+        }
+        iterations += batch;
+        elapsed = now_ns() - t0;
+        if (batch < (1u << 20)) {
+            batch *= 2;
+        }
+    }
+
+    const AllocCounters a1 = alloc_snapshot();
+    const double n = static_cast<double>(iterations);
+
+    Measurement m;
+    m.iterations = iterations;
+    m.ns_per_op = static_cast<double>(elapsed) / n;
+    m.bytes_per_op = static_cast<double>(a1.bytes - a0.bytes) / n;
+    m.allocs_per_op = static_cast<double>(a1.count - a0.count) / n;
+    return m;
+}
+
+/**
+ * @brief One benchmark result, serialized as a JSON object
+ */
+struct Record {
+    std::string name;
+    std::vector<std::pair<std::string, double>> params;
+    Measurement measurement;
+    double flops_per_op;   // Nominal flop count from the benchmark's cost model
+
+    double gflops() const {
+        return measurement.ns_per_op > 0.0 ? flops_per_op / measurement.ns_per_op : 0.0;
+    }
+};
+
+/**
+ * @brief Write a list of records as {"context": {...}, "benchmarks": [...]}
+ */
+void write_json(
+    std::ostream& out,
+    const std::vector<std::pair<std::string, std::string>>& context,
+    const std::vector<Record>& records
+);
+
+/**
+ * @brief Escape a string for inclusion in a JSON document
+ */
+std::string json_escape(const std::string& s);
+
+} // namespace bench
@@ -0,0 +1,440 @@
+/**
+ * @file sched_bench.cpp
+ * @brief Synthetic scheduler-workload macrobenchmark with tail-latency reporting
+ *
+ * Models the roadmap's "sheaf solve in the scheduling loop" on the CPU:
+ *
+ *   - one patch per CPU   (recent run-queue load  -> next-tick load)
+ *   - one patch per thread (recent runtime history -> next-tick demand)
+ *   - gluings: thread <-> the CPU it runs on, and thread <-> thread for
+ *     threads contending on the same shared resource (lock / cache domain)
+ *   - churn every tick: new samples slide into every window, a fraction of
+ *     threads exit and are replaced, and a fraction migrate between CPUs
+ *
+ * Each tick builds the SheafProblem, fits it with UnifiedSheafLearner and
+ * predicts every CPU's next load to place the runnable threads. The time
+ * from tick start to the last placement is the decision latency.
+ *
+ * Usage:
+ *   sched_bench [--cpus N] [--threads N] [--resources N] [--tick-hz HZ]
+ *               [--ticks N] [--churn FRACTION] [--window N]
+ *               [--positions N] [--characters N] [--no-pace] [--out FILE]
+ *               [--trace FILE]
+ *
+ * --trace writes a Chrome Trace Event file of every tick (per-phase and
+ * per-patch spans) when sheaf_solver is built with SHEAF_SOLVER_TRACE=ON.
+ */
+
+#include "bench_support.hpp"
+#include "sheaf_solver/trace.hpp"
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace sheaf;
+
+namespace {
+
+struct Options {
+    size_t cpus = 4;
+    size_t threads = 16;
+    size_t resources = 4;      // Shared resources threads contend on
+    double tick_hz = 250.0;
+    size_t ticks = 1000;
+    double churn = 0.1;        // Fraction of threads replaced/migrated per tick
+    size_t window = 16;        // Samples kept per patch
+    size_t positions = 4;      // History length per sample (group order)
+    size_t characters = 2;
+    bool pace = true;          // Sleep to the next tick boundary between solves
+    std::string out_path;
+    std::string trace_path;
+};
+
+#ifdef USE_EIGEN3
+
+/**
+ * @brief A sliding window of (history -> next value) training samples
+ */
+struct SeriesPatch {
+    std::string name;
+    std::deque<double> history;      // Raw series, newest at back
+    std::deque<Matrix> V_samples;
+    std::deque<Matrix> targets;
+};
+
+struct SimThread {
+    SeriesPatch series;
+    size_t cpu;
+    size_t resource;
+    double phase;       // Periodic demand phase
+    double period;      // Ticks per demand period
+    double amplitude;
+};
+
+class Workload {
+public:
+    Workload(const Options& opts, uint64_t seed)
+        : opts_(opts)
+        , rng_(seed)
+    {
+        for (size_t c = 0; c < opts_.cpus; ++c) {
+            SeriesPatch p;
+            p.name = "cpu_" + std::to_string(c);
+            cpus_.push_back(std::move(p));
+        }
+        for (size_t t = 0; t < opts_.threads; ++t) {
+            threads_.push_back(spawn_thread());
+        }
+        // Warm up every window so the first timed tick is a full-size solve
+        for (size_t i = 0; i < opts_.window + opts_.positions; ++i) {
+            advance(0.0);
+        }
+    }
+
+    /**
+     * @brief Advance one tick: new samples everywhere, plus thread churn
+     */
+    void advance(double churn) {
+        ++tick_;
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+
+        for (auto& th : threads_) {
+            if (u(rng_) < churn * 0.5) {
+                th = spawn_thread();               // Exit + replacement
+            } else if (u(rng_) < churn * 0.5) {
+                th.cpu = rng_() % opts_.cpus;      // Migration
+            }
+        }
+
+        std::vector<double> cpu_load(opts_.cpus, 0.0);
+        std::normal_distribution<double> noise(0.0, 0.05);
+        for (auto& th : threads_) {
+            const double demand = 1.0 + th.amplitude
+                * std::sin(2.0 * PI * (static_cast<double>(tick_) + th.phase) / th.period)
+                + noise(rng_);
+            push(th.series, demand);
+            cpu_load[th.cpu] += demand;
+        }
+        for (size_t c = 0; c < opts_.cpus; ++c) {
+            push(cpus_[c], cpu_load[c]);
+        }
+    }
+
+    /**
+     * @brief Snapshot the current state as a sheaf problem
+     */
+    SheafProblem build_problem() const {
+        SheafProblem problem;
+        problem.patches.reserve(cpus_.size() + threads_.size());
+
+        auto add_patch = [&](const SeriesPatch& s) {
+            Patch p;
+            p.name = s.name;
+            p.config = {opts_.positions, opts_.characters, 1};
+            p.V_samples.assign(s.V_samples.begin(), s.V_samples.end());
+            p.targets.assign(s.targets.begin(), s.targets.end());
+            problem.patches.push_back(std::move(p));
+        };
+        for (const auto& c : cpus_) add_patch(c);
+        for (const auto& t : threads_) add_patch(t.series);
+
+        // Thread <-> CPU: the thread's next demand is consistent with its CPU's view
+        for (const auto& t : threads_) {
+            if (t.series.V_samples.empty()) continue;
+            GluingConstraint g;
+            g.patch_1 = t.series.name;
+            g.patch_2 = cpus_[t.cpu].name;
+            g.constraint_data_1 = t.series.V_samples.back();
+            g.constraint_data_2 = cpus_[t.cpu].V_samples.back();
+            problem.gluings.push_back(std::move(g));
+        }
+
+        // Thread <-> thread: consecutive contenders on the same resource
+        std::vector<const SimThread*> last_on(std::max<size_t>(opts_.resources, 1), nullptr);
+        for (const auto& t : threads_) {
+            const SimThread* prev = last_on[t.resource];
+            if (prev && !prev->series.V_samples.empty() && !t.series.V_samples.empty()) {
+                GluingConstraint g;
+                g.patch_1 = prev->series.name;
+                g.patch_2 = t.series.name;
+                g.constraint_data_1 = prev->series.V_samples.back();
+                g.constraint_data_2 = t.series.V_samples.back();
+                problem.gluings.push_back(std::move(g));
+            }
+            last_on[t.resource] = &t;
+        }
+
+        return problem;
+    }
+
+    /**
+     * @brief Current query sample (most recent history) for a CPU patch
+     */
+    Matrix cpu_query(size_t c) const { return window_matrix(cpus_[c].history); }
+
+    size_t n_cpus() const { return cpus_.size(); }
+    size_t n_threads() const { return threads_.size(); }
+
+private:
+    Options opts_;
+    std::mt19937_64 rng_;
+    uint64_t tick_ = 0;
+    uint64_t next_thread_id_ = 0;
+    std::vector<SeriesPatch> cpus_;
+    std::vector<SimThread> threads_;
+
+    SimThread spawn_thread() {
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        SimThread th;
+        th.series.name = "thr_" + std::to_string(next_thread_id_++);
+        th.cpu = rng_() % opts_.cpus;
+        th.resource = rng_() % std::max<size_t>(opts_.resources, 1);
+        th.phase = u(rng_) * 16.0;
+        th.period = 4.0 + std::floor(u(rng_) * 12.0);
+        th.amplitude = 0.2 + 0.6 * u(rng_);
+        return th;
+    }
+
+    Matrix window_matrix(const std::deque<double>& h) const {
+        Matrix V = Matrix::Zero(opts_.positions, 1);
+        const size_t n = std::min(h.size(), opts_.positions);
+        for (size_t i = 0; i < n; ++i) {
+            V(opts_.positions - n + i, 0) = complex_t(h[h.size() - n + i], 0.0);
+        }
+        return V;
+    }
+
+    void push(SeriesPatch& s, double value) {
+        // The window that ended one step ago predicts the value just observed
+        if (s.history.size() >= opts_.positions) {
+            Matrix T(1, 1);
+            T(0, 0) = complex_t(value, 0.0);
+            s.V_samples.push_back(window_matrix(s.history));
+            s.targets.push_back(T);
+            if (s.V_samples.size() > opts_.window) {
+                s.V_samples.pop_front();
+                s.targets.pop_front();
+            }
+        }
+        s.history.push_back(value);
+        if (s.history.size() > opts_.positions) {
+            s.history.pop_front();
+        }
+    }
+};
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+#endif // USE_EIGEN3
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--cpus N] [--threads N] [--resources N] [--tick-hz HZ] [--ticks N]\n"
+              << "       [--churn FRACTION] [--window N] [--positions N] [--characters N]\n"
+              << "       [--no-pace] [--out FILE] [--trace FILE]\n";
+}
+
+bool parse_args(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(a, "--no-pace") == 0) {
+            opts.pace = false;
+        } else if (std::strcmp(a, "--cpus") == 0 && has_value) {
+            opts.cpus = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--threads") == 0 && has_value) {
+            opts.threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--resources") == 0 && has_value) {
+            opts.resources = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--tick-hz") == 0 && has_value) {
+            opts.tick_hz = std::atof(argv[++i]);
+        } else if (std::strcmp(a, "--ticks") == 0 && has_value) {
+            opts.ticks = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--churn") == 0 && has_value) {
+            opts.churn = std::atof(argv[++i]);
+        } else if (std::strcmp(a, "--window") == 0 && has_value) {
+            opts.window = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--positions") == 0 && has_value) {
+            opts.positions = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--characters") == 0 && has_value) {
+            opts.characters = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--out") == 0 && has_value) {
+            opts.out_path = argv[++i];
+        } else if (std::strcmp(a, "--trace") == 0 && has_value) {
+            opts.trace_path = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return opts.cpus > 0 && opts.positions > 0 && opts.tick_hz > 0.0
+        && opts.characters > 0 && opts.characters <= opts.positions;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+#ifndef SHEAF_SOLVER_TRACE
+    if (!opts.trace_path.empty()) {
+        std::cerr << "ERROR: --trace needs sheaf_solver built with SHEAF_SOLVER_TRACE=ON\n";
+        return 2;
+    }
+#endif
+
+#ifdef USE_EIGEN3
+    const uint64_t period_ns = static_cast<uint64_t>(1e9 / opts.tick_hz);
+
+    std::cerr << "BonsaiOS Sheaf Solver - Scheduler Macrobenchmark\n";
+    std::cerr << "=================================================\n";
+    std::cerr << "  " << opts.cpus << " CPUs, " << opts.threads << " threads, "
+              << opts.resources << " shared resources, " << opts.tick_hz << " Hz, "
+              << opts.ticks << " ticks\n";
+
+    Workload workload(opts, 7);
+    UnifiedSheafLearner learner;
+
+#ifdef SHEAF_SOLVER_TRACE
+    if (!opts.trace_path.empty()) {
+        sheaf::trace::set_thread_name("scheduler tick");
+        sheaf::trace::set_enabled(true);
+    }
+#endif
+
+    std::vector<double> latency_us;
+    latency_us.reserve(opts.ticks);
+    uint64_t alloc_bytes = 0;
+    uint64_t alloc_count = 0;
+    size_t misses = 0;
+    size_t decisions = 0;
+    size_t patches = 0;
+    size_t gluings = 0;
+    volatile double sink = 0.0;
+
+    const uint64_t run_start = bench::now_ns();
+    uint64_t next_tick = run_start;
+
+    for (size_t tick = 0; tick < opts.ticks; ++tick) {
+        if (opts.pace) {
+            while (bench::now_ns() < next_tick) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(next_tick - bench::now_ns()));
+            }
+        }
+        next_tick += period_ns;
+
+        workload.advance(opts.churn);
+
+        const bench::AllocCounters a0 = bench::alloc_snapshot();
+        const uint64_t t0 = bench::now_ns();
+
+        // Decision path: snapshot -> fit -> predict every CPU -> place threads
+        SHEAF_TRACE_SCOPE("tick", "scheduler");
+        SheafProblem problem = workload.build_problem();
+        learner.fit(problem);
+
+        std::vector<double> predicted(workload.n_cpus());
+        for (size_t c = 0; c < workload.n_cpus(); ++c) {
+            predicted[c] = learner.predict("cpu_" + std::to_string(c), workload.cpu_query(c))(0, 0).real();
+        }
+        for (size_t t = 0; t < workload.n_threads(); ++t) {
+            auto best = std::min_element(predicted.begin(), predicted.end());
+            *best += 1.0;
+            ++decisions;
+        }
+        sink = sink + predicted[0];
+
+        const uint64_t dt = bench::now_ns() - t0;
+        const bench::AllocCounters a1 = bench::alloc_snapshot();
+
+        latency_us.push_back(static_cast<double>(dt) / 1e3);
+        alloc_bytes += a1.bytes - a0.bytes;
+        alloc_count += a1.count - a0.count;
+        if (dt > period_ns) ++misses;
+        patches = problem.patches.size();
+        gluings = problem.gluings.size();
+    }
+
+    const double wall_s = static_cast<double>(bench::now_ns() - run_start) / 1e9;
+
+#ifdef SHEAF_SOLVER_TRACE
+    if (!opts.trace_path.empty()) {
+        sheaf::trace::set_enabled(false);
+        if (!sheaf::trace::write_chrome_trace(opts.trace_path)) {
+            std::cerr << "ERROR: cannot write " << opts.trace_path << "\n";
+            return 1;
+        }
+        std::cerr << "  trace written to " << opts.trace_path
+                  << " (" << sheaf::trace::dropped() << " spans dropped)\n";
+    }
+#endif
+
+    std::vector<double> sorted = latency_us;
+    std::sort(sorted.begin(), sorted.end());
+    double mean = 0.0;
+    for (double v : sorted) mean += v;
+    mean /= static_cast<double>(std::max<size_t>(sorted.size(), 1));
+
+    const double ticks_d = static_cast<double>(opts.ticks);
+    const double p50 = percentile(sorted, 0.50);
+    const double p99 = percentile(sorted, 0.99);
+    const double p999 = percentile(sorted, 0.999);
+
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"suite\": \"sched_bench\",\n"
+         << "  \"config\": {\"cpus\": " << opts.cpus << ", \"threads\": " << opts.threads
+         << ", \"resources\": " << opts.resources << ", \"tick_hz\": " << opts.tick_hz
+         << ", \"ticks\": " << opts.ticks << ", \"churn\": " << opts.churn
+         << ", \"window\": " << opts.window << ", \"positions\": " << opts.positions
+         << ", \"characters\": " << opts.characters << ", \"paced\": " << (opts.pace ? "true" : "false")
+         << "},\n"
+         << "  \"problem\": {\"patches\": " << patches << ", \"gluings\": " << gluings
+         << ", \"weights\": " << patches * opts.positions * opts.characters << "},\n"
+         << "  \"latency_us\": {\"p50\": " << p50 << ", \"p99\": " << p99 << ", \"p999\": " << p999
+         << ", \"mean\": " << mean << ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << "},\n"
+         << "  \"deadline\": {\"budget_us\": " << static_cast<double>(period_ns) / 1e3
+         << ", \"misses\": " << misses
+         << ", \"met_fraction\": " << (ticks_d - static_cast<double>(misses)) / ticks_d << "},\n"
+         << "  \"allocations_per_tick\": {\"bytes\": " << static_cast<double>(alloc_bytes) / ticks_d
+         << ", \"count\": " << static_cast<double>(alloc_count) / ticks_d << "},\n"
+         << "  \"throughput\": {\"ticks_per_s\": " << ticks_d / wall_s
+         << ", \"decisions_per_s\": " << static_cast<double>(decisions) / wall_s
+         << ", \"max_sustainable_hz\": " << (mean > 0.0 ? 1e6 / mean : 0.0) << "}\n"
+         << "}\n";
+
+    std::cerr << "  decision latency p50 " << p50 << " us, p99 " << p99
+              << " us, p99.9 " << p999 << " us (budget " << static_cast<double>(period_ns) / 1e3
+              << " us, " << misses << " misses)\n";
+
+    if (opts.out_path.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(opts.out_path);
+        if (!out) {
+            std::cerr << "ERROR: cannot open " << opts.out_path << "\n";
+            return 1;
+        }
+        out << json.str();
+    }
+    return 0;
+#else
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
@@ -0,0 +1,710 @@
+/**
+ * @file sheaf_bench.cpp
+ * @brief Microbenchmarks for the sheaf solver with scaling sweeps
+ *
+ * Measures the character-theory primitives (complex and exact NTT
+ * transforms), the attention layer and the unified learner over group
+ * order, d_model, sample count, patch count and gluing density.
+ * Results are written as JSON (ns/op, bytes and allocations per op, nominal
+ * GFLOP/s) so later runs can be diffed against a stored baseline.
+ *
+ * Usage:
+ *   sheaf_bench [--quick] [--min-time SECONDS] [--filter SUBSTR] [--out FILE]
+ *
+ * Flop counts are nominal cost models (a complex multiply-add counts as 8
+ * real flops) for the algorithm as written, not hardware counter readings.
+ */
+
+#include "bench_support.hpp"
+#include "sheaf_solver/abelian_group.hpp"
+#include "sheaf_solver/character_theory.hpp"
+#include "sheaf_solver/consensus_solver.hpp"
+#include "sheaf_solver/cyclic_group.hpp"
+#include "sheaf_solver/ntt.hpp"
+#include "sheaf_solver/sliding_window.hpp"
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+#include "sheaf_solver/wreath_product.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+
+using namespace sheaf;
+
+namespace {
+
+struct Options {
+    bool quick = false;
+    double min_time_s = 0.2;
+    std::string filter;
+    std::string out_path;
+};
+
+constexpr double kComplexMac = 8.0;  // Real flops per complex multiply-add
+
+#ifdef USE_EIGEN3
+
+Matrix random_matrix(size_t rows, size_t cols, std::mt19937_64& rng) {
+    std::normal_distribution<double> dist(0.0, 1.0);
+    Matrix M(rows, cols);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            M(i, j) = complex_t(dist(rng), 0.0);
+        }
+    }
+    return M;
+}
+
+/**
+ * @brief Shape parameters for a synthetic sheaf problem
+ */
+struct ProblemShape {
+    size_t n_positions;
+    size_t n_characters;
+    size_t n_samples;        // Per patch
+    size_t n_patches;
+    double gluing_density;   // Fraction of patch pairs that carry a gluing
+};
+
+/**
+ * @brief Build a consistent random problem: targets come from hidden weights
+ */
+SheafProblem make_problem(const ProblemShape& shape, std::mt19937_64& rng) {
+    SheafProblem problem;
+    std::normal_distribution<double> dist(0.0, 1.0);
+
+    for (size_t p = 0; p < shape.n_patches; ++p) {
+        Patch patch;
+        patch.name = "patch_" + std::to_string(p);
+        patch.config = {shape.n_positions, shape.n_characters, 1};
+
+        std::vector<double> hidden(shape.n_positions);
+        for (auto& h : hidden) h = dist(rng);
+
+        for (size_t s = 0; s < shape.n_samples; ++s) {
+            Matrix V = random_matrix(shape.n_positions, 1, rng);
+            Matrix T(1, 1);
+            complex_t acc(0.0, 0.0);
+            for (size_t i = 0; i < shape.n_positions; ++i) {
+                acc += hidden[i] * V(i, 0);
+            }
+            T(0, 0) = acc;
+            patch.V_samples.push_back(V);
+            patch.targets.push_back(T);
+        }
+        problem.patches.push_back(std::move(patch));
+    }
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t a = 0; a < shape.n_patches; ++a) {
+        for (size_t b = a + 1; b < shape.n_patches; ++b) {
+            pairs.emplace_back(a, b);
+        }
+    }
+    std::shuffle(pairs.begin(), pairs.end(), rng);
+    const size_t n_gluings = static_cast<size_t>(
+        shape.gluing_density * static_cast<double>(pairs.size()) + 0.5);
+
+    for (size_t g = 0; g < n_gluings && g < pairs.size(); ++g) {
+        GluingConstraint gluing;
+        gluing.patch_1 = problem.patches[pairs[g].first].name;
+        gluing.patch_2 = problem.patches[pairs[g].second].name;
+        gluing.constraint_data_1 = random_matrix(shape.n_positions, 1, rng);
+        gluing.constraint_data_2 = random_matrix(shape.n_positions, 1, rng);
+        problem.gluings.push_back(std::move(gluing));
+    }
+
+    return problem;
+}
+
+/**
+ * @brief Nominal flops of one length-n character transform (radix-2 butterflies)
+ */
+double transform_flops(size_t n) {
+    const double nd = static_cast<double>(n);
+    return kComplexMac * 0.5 * nd * std::ceil(std::log2(std::max(nd, 2.0)));
+}
+
+/**
+ * @brief Nominal flops for get_feature_row: one transform plus n*k feature entries
+ */
+double featurize_flops(size_t n, size_t n_characters) {
+    return transform_flops(n) + kComplexMac * static_cast<double>(n * n_characters);
+}
+
+double fit_flops(const ProblemShape& shape, size_t n_gluings) {
+    const double W = static_cast<double>(shape.n_patches * shape.n_positions * shape.n_characters);
+    const double rows = static_cast<double>(shape.n_patches * shape.n_samples + n_gluings);
+    const double n_featurized = static_cast<double>(shape.n_patches * shape.n_samples + 2 * n_gluings);
+
+    double flops = n_featurized * featurize_flops(shape.n_positions, shape.n_characters);
+    flops += kComplexMac * rows * W * W;       // Gram A^H A
+    flops += kComplexMac * rows * W;           // A^H b
+    flops += kComplexMac * W * W * W / 6.0;    // Cholesky
+    flops += kComplexMac * 2.0 * W * W;        // Triangular solves
+    flops += kComplexMac * rows * W;           // Residual
+    return flops;
+}
+
+#endif // USE_EIGEN3
+
+class Runner {
+public:
+    explicit Runner(const Options& opts) : opts_(opts) {}
+
+    void run(
+        const std::string& name,
+        std::vector<std::pair<std::string, double>> params,
+        double flops_per_op,
+        const std::function<void()>& op
+    ) {
+        std::string label = name;
+        for (const auto& [k, v] : params) {
+            label += "/" + k + "=" + std::to_string(static_cast<long long>(v));
+        }
+        if (!opts_.filter.empty() && label.find(opts_.filter) == std::string::npos) {
+            return;
+        }
+
+        std::cerr << "  " << label << " ... " << std::flush;
+        bench::Record rec;
+        rec.name = name;
+        rec.params = std::move(params);
+        rec.flops_per_op = flops_per_op;
+        rec.measurement = bench::measure(op, opts_.min_time_s);
+        std::cerr << rec.measurement.ns_per_op << " ns/op, "
+                  << rec.gflops() << " GFLOP/s\n";
+        records_.push_back(std::move(rec));
+    }
+
+    bool quick() const { return opts_.quick; }
+    const std::vector<bench::Record>& records() const { return records_; }
+
+private:
+    Options opts_;
+    std::vector<bench::Record> records_;
+};
+
+#ifdef USE_EIGEN3
+
+void bench_character_table(Runner& r) {
+    const std::vector<size_t> orders = r.quick()
+        ? std::vector<size_t>{4, 16}
+        : std::vector<size_t>{4, 8, 16, 32, 64, 128};
+
+    for (size_t n : orders) {
+        const double nd = static_cast<double>(n);
+        r.run("compute_character_table", {{"group_order", nd}}, kComplexMac * nd * nd, [n] {
+            CyclicGroupCharacters group(n);
+            bench::do_not_optimize(group);
+        });
+    }
+}
+
+void bench_project_and_decompose(Runner& r, std::mt19937_64& rng) {
+    const std::vector<size_t> orders = r.quick()
+        ? std::vector<size_t>{8, 32}
+        : std::vector<size_t>{4, 8, 16, 32, 64};
+    const std::vector<size_t> d_models = r.quick()
+        ? std::vector<size_t>{1, 16}
+        : std::vector<size_t>{1, 4, 16, 64};
+
+    for (size_t n : orders) {
+        CyclicGroupCharacters group(n);
+        for (size_t d : d_models) {
+            Matrix V = random_matrix(n, d, rng);
+            const double nd = static_cast<double>(n);
+            const double dd = static_cast<double>(d);
+
+            r.run("project_onto_character", {{"group_order", nd}, {"d_model", dd}},
+                  kComplexMac * 2.0 * nd * dd, [&] {
+                Matrix proj = group.project_onto_character(V, 1 % n);
+                bench::do_not_optimize(proj);
+            });
+
+            r.run("decompose_into_characters", {{"group_order", nd}, {"d_model", dd}},
+                  dd * transform_flops(n) + kComplexMac * nd * nd * dd, [&] {
+                auto projs = group.decompose_into_characters(V);
+                bench::do_not_optimize(projs);
+            });
+        }
+    }
+}
+
+/**
+ * @brief One length-n transform: complex FFT vs the exact NTT over Z_q, plus
+ * the product-group and wreath-product transforms
+ *
+ * NTT "flops" count a butterfly (Montgomery multiply, add, subtract) as 3 ops.
+ */
+void bench_transform(Runner& r, std::mt19937_64& rng) {
+    const std::vector<size_t> orders = r.quick()
+        ? std::vector<size_t>{64, 1024}
+        : std::vector<size_t>{64, 256, 1024, 4096, 65536};
+
+    for (size_t n : orders) {
+        const double nd = static_cast<double>(n);
+        const std::vector<std::pair<std::string, double>> params = {{"group_order", nd}};
+
+        FourierPlan plan(n);
+        std::vector<complex_t> x(n), work(plan.workspace_size());
+        std::normal_distribution<double> dist(0.0, 1.0);
+        for (auto& v : x) v = complex_t(dist(rng), 0.0);
+        r.run("fft_forward", params, transform_flops(n), [&] {
+            plan.forward(x.data(), work.data());
+            bench::do_not_optimize(x);
+        });
+
+        NttCyclicGroupCharacters ntt(n);
+        std::vector<uint32_t> a(n);
+        for (auto& v : a) v = static_cast<uint32_t>(rng() % ntt.field().modulus());
+        r.run("ntt_forward", params, 1.5 * nd * std::log2(std::max(nd, 2.0)), [&] {
+            ntt.forward(a.data());
+            bench::do_not_optimize(a);
+        });
+    }
+
+    // Separable product-group transforms (blocked transposes between axes)
+    const std::vector<std::vector<size_t>> shapes = r.quick()
+        ? std::vector<std::vector<size_t>>{{32, 32}}
+        : std::vector<std::vector<size_t>>{{16, 16}, {64, 64}, {256, 256}, {16, 16, 16}, {8, 32, 64}};
+
+    for (const auto& shape : shapes) {
+        AbelianGroupCharacters group(shape);
+        const size_t N = group.order();
+        std::vector<std::pair<std::string, double>> params = {{"group_order", static_cast<double>(N)}};
+        for (size_t a = 0; a < shape.size(); ++a) {
+            params.emplace_back("n" + std::to_string(a), static_cast<double>(shape[a]));
+        }
+        Matrix V = random_matrix(N, 1, rng);
+        r.run("abelian_transform", params, transform_flops(N), [&] {
+            Matrix X = group.transform(V);
+            bench::do_not_optimize(X);
+        });
+    }
+
+    // Group Fourier transform of C_m ≀ C_n (base FFTs + stabilizer DFTs)
+    const std::vector<std::pair<size_t, size_t>> wreaths = r.quick()
+        ? std::vector<std::pair<size_t, size_t>>{{2, 8}}
+        : std::vector<std::pair<size_t, size_t>>{{2, 4}, {2, 8}, {4, 4}, {2, 10}, {3, 6}};
+
+    for (const auto& [m, n] : wreaths) {
+        WreathProductCharacters group(m, n);
+        const size_t N = group.order();
+        Vector f = random_matrix(N, 1, rng).col(0);
+        r.run("wreath_fourier_transform",
+              {{"group_order", static_cast<double>(N)}, {"m", static_cast<double>(m)},
+               {"n", static_cast<double>(n)}},
+              transform_flops(N), [&] {
+            auto coefficients = group.fourier_transform(f);
+            bench::do_not_optimize(coefficients);
+        });
+    }
+}
+
+void bench_attention(Runner& r, std::mt19937_64& rng) {
+    const std::vector<size_t> seq_lens = r.quick()
+        ? std::vector<size_t>{64, 1000}
+        : std::vector<size_t>{16, 64, 256, 1000, 1024, 4096};
+    const size_t d_model = 64;
+    const size_t n_heads = 8;
+    const size_t batch_size = 16;
+    const std::vector<size_t> thread_counts = {1, 0};
+
+    for (size_t n : seq_lens) {
+        CharacterAttention layer(n, d_model, n_heads);
+        for (size_t h = 0; h < n_heads; ++h) {
+            layer.set_head_coefficients(h, random_matrix(n, 1, rng).col(0));
+        }
+        std::vector<Matrix> batch;
+        for (size_t b = 0; b < batch_size; ++b) {
+            batch.push_back(random_matrix(n, d_model, rng));
+        }
+
+        // Forward + inverse transform and the scale, per column
+        const double flops = static_cast<double>(batch_size * d_model)
+                           * (2.0 * transform_flops(n) + kComplexMac * static_cast<double>(n));
+
+        for (size_t threads : thread_counts) {
+            r.run("attention_forward_batch",
+                  {{"seq_len", static_cast<double>(n)}, {"d_model", static_cast<double>(d_model)},
+                   {"heads", static_cast<double>(n_heads)}, {"batch", static_cast<double>(batch_size)},
+                   {"threads", static_cast<double>(threads)}},
+                  flops, [&] {
+                auto out = layer.forward_batch(batch, threads);
+                bench::do_not_optimize(out);
+            });
+        }
+    }
+}
+
+void bench_learn_character_weights(Runner& r, std::mt19937_64& rng) {
+    const std::vector<size_t> orders = r.quick()
+        ? std::vector<size_t>{8}
+        : std::vector<size_t>{4, 8, 16};
+    const std::vector<size_t> d_models = r.quick()
+        ? std::vector<size_t>{1}
+        : std::vector<size_t>{1, 4};
+    const std::vector<size_t> sample_counts = r.quick()
+        ? std::vector<size_t>{8, 32}
+        : std::vector<size_t>{8, 32, 128};
+
+    for (size_t n : orders) {
+        CyclicGroupCharacters group(n);
+        for (size_t d : d_models) {
+            for (size_t s : sample_counts) {
+                std::vector<Matrix> V_samples;
+                std::vector<Matrix> targets;
+                for (size_t i = 0; i < s; ++i) {
+                    V_samples.push_back(random_matrix(n, d, rng));
+                    targets.push_back(random_matrix(n, d, rng));
+                }
+
+                const double nd = static_cast<double>(n);
+                const double m = static_cast<double>(s * n * d);
+                const double flops = static_cast<double>(s * d) * (transform_flops(n) + kComplexMac * nd * nd)
+                                   + kComplexMac * 2.0 * m * nd * nd;
+
+                r.run("learn_character_weights",
+                      {{"group_order", nd}, {"d_model", static_cast<double>(d)},
+                       {"samples", static_cast<double>(s)}},
+                      flops, [&] {
+                    Vector c = group.learn_character_weights(V_samples, targets);
+                    bench::do_not_optimize(c);
+                });
+            }
+        }
+    }
+}
+
+void bench_fit_case(Runner& r, const ProblemShape& shape, std::mt19937_64& rng) {
+    SheafProblem problem = make_problem(shape, rng);
+    const double flops = fit_flops(shape, problem.gluings.size());
+
+    r.run("fit",
+          {{"group_order", static_cast<double>(shape.n_positions)},
+           {"n_characters", static_cast<double>(shape.n_characters)},
+           {"samples", static_cast<double>(shape.n_samples)},
+           {"patches", static_cast<double>(shape.n_patches)},
+           {"gluing_density_pct", shape.gluing_density * 100.0},
+           {"gluings", static_cast<double>(problem.gluings.size())}},
+          flops, [&] {
+        UnifiedSheafLearner learner;
+        SheafSolution sol = learner.fit(problem);
+        bench::do_not_optimize(sol.residual_error);
+    });
+}
+
+void bench_fit(Runner& r, std::mt19937_64& rng) {
+    const ProblemShape base{8, 4, 32, 4, 0.5};
+
+    // Sweep group order
+    for (size_t n : r.quick() ? std::vector<size_t>{4, 8} : std::vector<size_t>{4, 8, 16}) {
+        ProblemShape s = base;
+        s.n_positions = n;
+        bench_fit_case(r, s, rng);
+    }
+
+    // Sweep sample count
+    for (size_t k : r.quick() ? std::vector<size_t>{8, 128} : std::vector<size_t>{8, 32, 128, 512}) {
+        ProblemShape s = base;
+        s.n_samples = k;
+        bench_fit_case(r, s, rng);
+    }
+
+    // Sweep patch count
+    for (size_t p : r.quick() ? std::vector<size_t>{1, 8} : std::vector<size_t>{1, 2, 4, 8, 16}) {
+        ProblemShape s = base;
+        s.n_patches = p;
+        bench_fit_case(r, s, rng);
+    }
+
+    // Sweep gluing density
+    for (double g : r.quick() ? std::vector<double>{0.0, 1.0} : std::vector<double>{0.0, 0.25, 0.5, 1.0}) {
+        ProblemShape s = base;
+        s.n_patches = 8;
+        s.gluing_density = g;
+        bench_fit_case(r, s, rng);
+    }
+}
+
+/**
+ * @brief Ridge selection over the default 25-point grid (compare with "fit",
+ * which solves a single λ)
+ */
+void bench_select_ridge(Runner& r, std::mt19937_64& rng) {
+    const ProblemShape base{8, 4, 32, 4, 0.5};
+    for (size_t n : r.quick() ? std::vector<size_t>{8} : std::vector<size_t>{4, 8, 16}) {
+        ProblemShape shape = base;
+        shape.n_positions = n;
+        SheafProblem problem = make_problem(shape, rng);
+
+        r.run("select_ridge",
+              {{"group_order", static_cast<double>(n)},
+               {"n_characters", static_cast<double>(shape.n_characters)},
+               {"patches", static_cast<double>(shape.n_patches)},
+               {"grid_points", 25.0}},
+              fit_flops(shape, problem.gluings.size()), [&] {
+            UnifiedSheafLearner learner;
+            RidgeSelection selection = learner.select_ridge(problem);
+            bench::do_not_optimize(selection.best_lambda);
+        });
+    }
+}
+
+/**
+ * @brief Patches glued in a chain, each with too few samples to fit alone:
+ * dense fit against CG with block Jacobi and with the multigrid V-cycle
+ */
+void bench_fit_chain(Runner& r, std::mt19937_64& rng) {
+    for (size_t p : r.quick() ? std::vector<size_t>{16} : std::vector<size_t>{16, 32, 64}) {
+        ProblemShape shape{8, 4, 2, p, 0.0};
+        SheafProblem problem = make_problem(shape, rng);
+        for (size_t a = 0; a + 1 < p; ++a) {
+            for (size_t k = 0; k < 3; ++k) {
+                GluingConstraint gluing;
+                gluing.patch_1 = problem.patches[a].name;
+                gluing.patch_2 = problem.patches[a + 1].name;
+                gluing.constraint_data_1 = random_matrix(shape.n_positions, 1, rng);
+                gluing.constraint_data_2 = gluing.constraint_data_1;
+                problem.gluings.push_back(std::move(gluing));
+            }
+        }
+        const double flops = fit_flops(shape, problem.gluings.size());
+        const std::vector<std::pair<std::string, double>> params = {
+            {"group_order", static_cast<double>(shape.n_positions)},
+            {"n_characters", static_cast<double>(shape.n_characters)},
+            {"patches", static_cast<double>(p)}};
+
+        r.run("fit_chain_dense", params, flops, [&] {
+            UnifiedSheafLearner learner;
+            SheafSolution sol = learner.fit(problem);
+            bench::do_not_optimize(sol.residual_error);
+        });
+        for (bool multigrid : {false, true}) {
+            IterativeOptions options;
+            options.multigrid = multigrid;
+            options.multigrid_min_patches = 0;   // Time the V-cycle at every size
+            r.run(multigrid ? "fit_chain_multigrid" : "fit_chain_jacobi", params, flops, [&] {
+                UnifiedSheafLearner learner;
+                IterativeFit fit = learner.fit_iterative(problem, options);
+                bench::do_not_optimize(fit.iterations);
+            });
+        }
+    }
+}
+
+/**
+ * @brief Many small independent problems: a fit() per problem against one
+ * fit_many() call (pooled featurization, lockstep Cholesky)
+ */
+void bench_fit_many(Runner& r, std::mt19937_64& rng) {
+    const ProblemShape shape{8, 4, 16, 2, 1.0};
+    for (size_t count : r.quick() ? std::vector<size_t>{64} : std::vector<size_t>{64, 512}) {
+        std::vector<SheafProblem> problems;
+        for (size_t i = 0; i < count; ++i) problems.push_back(make_problem(shape, rng));
+        const double flops = count * fit_flops(shape, problems[0].gluings.size());
+        const std::vector<std::pair<std::string, double>> params = {
+            {"group_order", static_cast<double>(shape.n_positions)},
+            {"patches", static_cast<double>(shape.n_patches)},
+            {"problems", static_cast<double>(count)}};
+
+        r.run("fit_loop", params, flops, [&] {
+            for (const SheafProblem& problem : problems) {
+                UnifiedSheafLearner learner;
+                SheafSolution sol = learner.fit(problem);
+                bench::do_not_optimize(sol.residual_error);
+            }
+        });
+        r.run("fit_many", params, flops, [&] {
+            UnifiedSheafLearner learner;
+            BatchFit fit = learner.fit_many(problems);
+            bench::do_not_optimize(fit.batched);
+        });
+    }
+}
+
+/**
+ * @brief Consensus fit over forked workers (includes fork and transport setup)
+ */
+void bench_fit_consensus(Runner& r, std::mt19937_64& rng) {
+    const ProblemShape shape{8, 4, 32, 8, 0.5};
+    SheafProblem problem = make_problem(shape, rng);
+    const double flops = fit_flops(shape, problem.gluings.size());
+    for (TransportKind kind : {TransportKind::SharedMemory, TransportKind::Socket}) {
+        for (size_t workers : r.quick() ? std::vector<size_t>{2} : std::vector<size_t>{2, 4}) {
+            ConsensusOptions options;
+            options.n_workers = workers;
+            options.transport = kind;
+            options.tolerance = 1e-6;
+            r.run(kind == TransportKind::Socket ? "fit_consensus_tcp" : "fit_consensus_shm",
+                  {{"group_order", static_cast<double>(shape.n_positions)},
+                   {"patches", static_cast<double>(shape.n_patches)},
+                   {"workers", static_cast<double>(workers)}},
+                  flops, [&] {
+                ConsensusResult result = fit_consensus(problem, options);
+                bench::do_not_optimize(result.iterations);
+            });
+        }
+    }
+}
+
+void bench_predict(Runner& r, std::mt19937_64& rng) {
+    const std::vector<size_t> orders = r.quick()
+        ? std::vector<size_t>{8, 32}
+        : std::vector<size_t>{4, 8, 16, 32, 64};
+
+    for (size_t n : orders) {
+        const size_t n_chars = std::min<size_t>(n, 4);
+        ProblemShape shape{n, n_chars, 2 * n * n_chars, 1, 0.0};
+        SheafProblem problem = make_problem(shape, rng);
+
+        UnifiedSheafLearner learner;
+        learner.fit(problem);
+        Matrix V = random_matrix(n, 1, rng);
+
+        const double flops = featurize_flops(n, n_chars)
+                           + kComplexMac * static_cast<double>(n * n_chars);
+
+        r.run("predict",
+              {{"group_order", static_cast<double>(n)},
+               {"n_characters", static_cast<double>(n_chars)}},
+              flops, [&] {
+            Matrix y = learner.predict("patch_0", V);
+            bench::do_not_optimize(y);
+        });
+
+        // Same patch after group-LASSO pruning at half of λ_max
+        PruningOptions options;
+        options.lambda = 0.5;
+        PruningReport report = learner.prune(options);
+        const size_t active = report.path[report.chosen].active_characters;
+
+        r.run("predict_pruned",
+              {{"group_order", static_cast<double>(n)},
+               {"n_characters", static_cast<double>(n_chars)},
+               {"active_characters", static_cast<double>(active)}},
+              static_cast<double>(report.sparse_predict_flops), [&] {
+            Matrix y = learner.predict("patch_0", V);
+            bench::do_not_optimize(y);
+        });
+    }
+}
+
+/**
+ * @brief One streaming step: a new sample arrives, predict from the last n
+ *
+ * "rebuild" re-featurizes the whole window per step (predict()); "sliding"
+ * updates the spectrum in O(n) and calls predict_spectrum().
+ */
+void bench_stream(Runner& r, std::mt19937_64& rng) {
+    const std::vector<size_t> orders = r.quick()
+        ? std::vector<size_t>{16, 64}
+        : std::vector<size_t>{8, 16, 32, 64, 128};
+    std::normal_distribution<double> dist(0.0, 1.0);
+
+    for (size_t n : orders) {
+        const size_t n_chars = std::min<size_t>(n, 4);
+        ProblemShape shape{n, n_chars, 2 * n * n_chars, 1, 0.0};
+        SheafProblem problem = make_problem(shape, rng);
+        UnifiedSheafLearner learner;
+        learner.fit(problem);
+
+        const std::vector<std::pair<std::string, double>> params = {
+            {"group_order", static_cast<double>(n)},
+            {"n_characters", static_cast<double>(n_chars)}};
+
+        Matrix window = random_matrix(n, 1, rng);
+        r.run("stream_step_rebuild", params, featurize_flops(n, n_chars), [&] {
+            for (size_t i = 0; i + 1 < n; ++i) window(i, 0) = window(i + 1, 0);
+            window(n - 1, 0) = complex_t(dist(rng), 0.0);
+            Matrix y = learner.predict("patch_0", window);
+            bench::do_not_optimize(y);
+        });
+
+        SlidingCharacterWindow sliding(n);
+        r.run("stream_step_sliding", params,
+              kComplexMac * static_cast<double>(n + n_chars), [&] {
+            sliding.push(complex_t(dist(rng), 0.0));
+            Matrix y = learner.predict_spectrum("patch_0", sliding.spectrum());
+            bench::do_not_optimize(y);
+        });
+    }
+}
+
+#endif // USE_EIGEN3
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--quick] [--min-time SECONDS] [--filter SUBSTR] [--out FILE]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            opts.quick = true;
+            opts.min_time_s = 0.02;
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            opts.min_time_s = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            opts.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            opts.out_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+#ifdef USE_EIGEN3
+    std::cerr << "BonsaiOS Sheaf Solver - Microbenchmarks\n";
+    std::cerr << "=======================================\n";
+
+    Runner runner(opts);
+    std::mt19937_64 rng(42);
+
+    bench_character_table(runner);
+    bench_project_and_decompose(runner, rng);
+    bench_transform(runner, rng);
+    bench_attention(runner, rng);
+    bench_learn_character_weights(runner, rng);
+    bench_fit(runner, rng);
+    bench_select_ridge(runner, rng);
+    bench_fit_chain(runner, rng);
+    bench_fit_many(runner, rng);
+    bench_fit_consensus(runner, rng);
+    bench_predict(runner, rng);
+    bench_stream(runner, rng);
+
+    const std::vector<std::pair<std::string, std::string>> context = {
+        {"suite", "sheaf_bench"},
+        {"compiler", __VERSION__},
+        {"eigen", "yes"},
+        {"mode", opts.quick ? "quick" : "full"},
+        {"min_time_s", std::to_string(opts.min_time_s)},
+    };
+
+    if (opts.out_path.empty()) {
+        bench::write_json(std::cout, context, runner.records());
+    } else {
+        std::ofstream out(opts.out_path);
+        if (!out) {
+            std::cerr << "ERROR: cannot open " << opts.out_path << "\n";
+            return 1;
+        }
+        bench::write_json(out, context, runner.records());
+    }
+    return 0;
+#else
+    (void)opts;
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
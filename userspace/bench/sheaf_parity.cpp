@@ -0,0 +1,220 @@
+/**
+ * @file sheaf_parity.cpp
+ * @brief Fit a problem file and print weights, residual and phase timings
+ *
+ * Driver for sheaf_compiler/parity_check.py, which generates random problems,
+ * fits them with both this library and the Python reference learner, and
+ * compares the answers and per-phase run times.
+ *
+ * Usage:
+ *   sheaf_parity PROBLEM_FILE [--repeat N]
+ *
+ * Problem file format (whitespace separated, complex numbers as "re im"):
+ *   sheaf-problem 1
+ *   patches <P>
+ *   patch <name> <n_positions> <n_characters> <n_samples>
+ *   <V[0..n_positions-1]> <target>        (one line per sample)
+ *   gluings <G>
+ *   gluing <patch_1> <patch_2>
+ *   <constraint_data_1[0..n1-1]>
+ *   <constraint_data_2[0..n2-1]>
+ *
+ * Output is one JSON object on stdout. Phase timings are the mean over the
+ * repeats; weights and residual come from the last fit.
+ */
+
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace sheaf;
+
+namespace {
+
+#ifdef USE_EIGEN3
+
+void expect(std::istream& in, const char* keyword) {
+    std::string token;
+    if (!(in >> token) || token != keyword) {
+        throw std::runtime_error(std::string("expected '") + keyword + "', got '" + token + "'");
+    }
+}
+
+complex_t read_complex(std::istream& in) {
+    real_t re = 0.0, im = 0.0;
+    if (!(in >> re >> im)) {
+        throw std::runtime_error("truncated problem file");
+    }
+    return {re, im};
+}
+
+Matrix read_column(std::istream& in, size_t n) {
+    Matrix V(n, 1);
+    for (size_t i = 0; i < n; ++i) {
+        V(i, 0) = read_complex(in);
+    }
+    return V;
+}
+
+SheafProblem read_problem(std::istream& in) {
+    expect(in, "sheaf-problem");
+    int version = 0;
+    if (!(in >> version) || version != 1) {
+        throw std::runtime_error("unsupported problem file version");
+    }
+
+    SheafProblem problem;
+    std::unordered_map<std::string, size_t> n_positions;
+
+    size_t n_patches = 0;
+    expect(in, "patches");
+    in >> n_patches;
+    for (size_t p = 0; p < n_patches; ++p) {
+        Patch patch;
+        size_t n_samples = 0;
+        expect(in, "patch");
+        in >> patch.name >> patch.config.n_positions >> patch.config.n_characters >> n_samples;
+        patch.config.d_model = 1;
+        for (size_t i = 0; i < n_samples; ++i) {
+            patch.V_samples.push_back(read_column(in, patch.config.n_positions));
+            patch.targets.push_back(read_column(in, 1));
+        }
+        n_positions[patch.name] = patch.config.n_positions;
+        problem.patches.push_back(std::move(patch));
+    }
+
+    size_t n_gluings = 0;
+    expect(in, "gluings");
+    in >> n_gluings;
+    for (size_t g = 0; g < n_gluings; ++g) {
+        GluingConstraint gluing;
+        expect(in, "gluing");
+        in >> gluing.patch_1 >> gluing.patch_2;
+        gluing.constraint_data_1 = read_column(in, n_positions.at(gluing.patch_1));
+        gluing.constraint_data_2 = read_column(in, n_positions.at(gluing.patch_2));
+        problem.gluings.push_back(std::move(gluing));
+    }
+
+    if (!in) {
+        throw std::runtime_error("malformed problem file");
+    }
+    return problem;
+}
+
+void write_number(std::ostream& out, double x) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", x);
+    out << buf;
+}
+
+void write_result(std::ostream& out, const SheafProblem& problem,
+                  const SheafSolution& solution, const double phase_ns[],
+                  double fit_ns, size_t repeats) {
+    out << "{\n  \"repeats\": " << repeats << ",\n  \"fit_ns\": ";
+    write_number(out, fit_ns);
+    out << ",\n  \"residual\": ";
+    write_number(out, solution.residual_error);
+
+    out << ",\n  \"phases_ns\": {";
+    for (size_t i = 0; i < kNumFitPhases; ++i) {
+        out << (i ? ", " : "") << "\"" << phase_name(static_cast<FitPhase>(i)) << "\": ";
+        write_number(out, phase_ns[i]);
+    }
+    out << "}";
+
+    // Weights in patch order, row-major (position, character), as [re, im]
+    out << ",\n  \"weights\": {";
+    for (size_t p = 0; p < problem.patches.size(); ++p) {
+        const std::string& name = problem.patches[p].name;
+        const Matrix& W = solution.weights.at(name);
+        out << (p ? ",\n    " : "\n    ") << "\"" << name << "\": [";
+        for (Eigen::Index r = 0; r < W.rows(); ++r) {
+            for (Eigen::Index c = 0; c < W.cols(); ++c) {
+                out << ((r || c) ? ", " : "") << "[";
+                write_number(out, W(r, c).real());
+                out << ", ";
+                write_number(out, W(r, c).imag());
+                out << "]";
+            }
+        }
+        out << "]";
+    }
+    out << "\n  }\n}\n";
+}
+
+#endif // USE_EIGEN3
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " PROBLEM_FILE [--repeat N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path;
+    size_t repeats = 5;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeats = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (path.empty() && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (path.empty()) {
+        usage(argv[0]);
+        return 2;
+    }
+
+#ifdef USE_EIGEN3
+    try {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "ERROR: cannot open " << path << "\n";
+            return 1;
+        }
+        const SheafProblem problem = read_problem(in);
+
+        double phase_ns[kNumFitPhases] = {};
+        double fit_ns = 0.0;
+        SheafSolution solution;
+
+        // A fresh learner per repeat, as a Python UnifiedSheafLearner would be
+        for (size_t r = 0; r < repeats; ++r) {
+            UnifiedSheafLearner learner(false);
+            const auto t0 = std::chrono::steady_clock::now();
+            solution = learner.fit(problem);
+            const auto t1 = std::chrono::steady_clock::now();
+
+            fit_ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            for (size_t i = 0; i < kNumFitPhases; ++i) {
+                phase_ns[i] += static_cast<double>(solution.stats.phase_ns[i]);
+            }
+        }
+        fit_ns /= static_cast<double>(repeats);
+        for (size_t i = 0; i < kNumFitPhases; ++i) {
+            phase_ns[i] /= static_cast<double>(repeats);
+        }
+
+        write_result(std::cout, problem, solution, phase_ns, fit_ns, repeats);
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+#else
+    (void)repeats;
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
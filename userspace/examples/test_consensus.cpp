@@ -0,0 +1,117 @@
+/**
+ * @file test_consensus.cpp
+ * @brief Check of the ADMM consensus fit against the single-process fit()
+ *
+ * One problem - a chain of patches with soft gluings of mixed weight and
+ * one hard gluing - is solved by fit() and by fit_consensus() with 1, 2
+ * and 4 workers over shared memory and over loopback TCP. Every run must
+ * converge to fit()'s predictions on held-out probes and to its residual.
+ */
+
+#include "sheaf_solver/consensus_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace sheaf;
+
+namespace {
+
+constexpr size_t kPatches = 8;
+constexpr size_t kPositions = 4;
+constexpr size_t kSamples = 6;
+constexpr real_t kTolerance = 1e-8;
+
+Matrix random_matrix(size_t rows, std::mt19937& rng) {
+    std::normal_distribution<real_t> normal;
+    Matrix M(rows, 1);
+    for (size_t i = 0; i < rows; ++i) M(i, 0) = complex_t(normal(rng), normal(rng));
+    return M;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "BonsaiOS Sheaf Solver - Consensus Fit Check\n";
+    std::cout << "===========================================\n\n";
+
+#ifdef USE_EIGEN3
+    std::mt19937 rng(68);
+    SheafProblem problem;
+    for (size_t p = 0; p < kPatches; ++p) {
+        Patch patch;
+        patch.name = "patch_" + std::to_string(p);
+        patch.config = PatchConfig{kPositions, kPositions, 1};
+        for (size_t s = 0; s < kSamples; ++s) {
+            patch.V_samples.push_back(random_matrix(kPositions, rng));
+            patch.targets.push_back(random_matrix(1, rng));
+        }
+        problem.patches.push_back(std::move(patch));
+    }
+    for (size_t p = 0; p + 1 < kPatches; ++p) {
+        GluingConstraint gluing{problem.patches[p].name, problem.patches[p + 1].name,
+                                random_matrix(kPositions, rng), random_matrix(kPositions, rng)};
+        gluing.weight = p == kPatches / 2 ? HARD_GLUING : 0.5 + p;
+        problem.gluings.push_back(std::move(gluing));
+    }
+
+    std::vector<std::pair<std::string, Matrix>> probes;
+    for (const Patch& patch : problem.patches) {
+        for (size_t s = 0; s < 4; ++s) probes.emplace_back(patch.name, random_matrix(kPositions, rng));
+    }
+
+    UnifiedSheafLearner reference;
+    const SheafSolution expected = reference.fit(problem);
+    std::vector<Matrix> expected_predictions;
+    real_t norm = 0.0;
+    for (const auto& [patch, V] : probes) {
+        expected_predictions.push_back(reference.predict(patch, V));
+        norm += expected_predictions.back().squaredNorm();
+    }
+    std::cout << "fit(): residual " << expected.residual_error << "\n\n";
+
+    for (TransportKind transport : {TransportKind::SharedMemory, TransportKind::Socket}) {
+        for (size_t workers : {1, 2, 4}) {
+            ConsensusOptions options;
+            options.n_workers = workers;
+            options.transport = transport;
+            options.ridge = reference.get_ridge();
+            options.tolerance = 1e-11;
+            const ConsensusResult result = fit_consensus(problem, options);
+
+            // Prediction from the consensus weights, flattened as predict() does
+            real_t diff = 0.0;
+            for (size_t i = 0; i < probes.size(); ++i) {
+                const auto& [patch, V] = probes[i];
+                const Matrix& w = result.solution.weights.at(patch);    // [positions, characters]
+                const Vector features = reference.feature_row(patch, V);
+                complex_t predicted = 0.0;
+                for (Eigen::Index r = 0; r < w.rows(); ++r) {
+                    for (Eigen::Index c = 0; c < w.cols(); ++c) predicted += features(r * w.cols() + c) * w(r, c);
+                }
+                diff += std::norm(predicted - expected_predictions[i](0, 0));
+            }
+            const real_t prediction_error = std::sqrt(diff / norm);
+            const real_t residual_error = std::abs(result.solution.residual_error - expected.residual_error) /
+                                          expected.residual_error;
+            std::cout << "  " << (transport == TransportKind::SharedMemory ? "shm" : "tcp") << ", " << workers
+                      << " worker(s): " << result.iterations << " iterations, predictions " << prediction_error
+                      << ", residual " << residual_error << "\n";
+            if (!result.converged || !(prediction_error < kTolerance) || !(residual_error < kTolerance)) {
+                std::cout << "FAIL: consensus fit disagrees with fit()\n";
+                return 1;
+            }
+        }
+    }
+    std::cout << "\n✓ Consensus fits match fit() on every transport\n";
+    return 0;
+#else
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
@@ -0,0 +1,119 @@
+/**
+ * @file test_fit_many.cpp
+ * @brief Check of fit_many() (pooled featurization, BatchedCholesky) against fit()
+ *
+ * A batch of problems of mixed size - one to three patches, several group
+ * orders and character counts, soft gluings of various weights, a few hard
+ * gluings that must take the fallback path - is solved by one fit_many()
+ * call and by a fit() per problem. Every solution must match on held-out
+ * predictions and residual, and the batched path must cover the problems
+ * it claims to.
+ */
+
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sheaf;
+
+namespace {
+
+constexpr size_t kProblems = 100;
+constexpr real_t kTolerance = 1e-10;
+
+Matrix random_matrix(size_t rows, std::mt19937& rng) {
+    std::normal_distribution<real_t> normal;
+    Matrix M(rows, 1);
+    for (size_t i = 0; i < rows; ++i) M(i, 0) = complex_t(normal(rng), normal(rng));
+    return M;
+}
+
+SheafProblem make_problem(size_t index, std::mt19937& rng) {
+    const size_t n_positions = index % 3 == 0 ? 8 : 4;
+    const size_t n_characters = index % 2 == 0 ? n_positions : 2;
+    const size_t n_patches = 1 + index % 3;
+
+    SheafProblem problem;
+    for (size_t p = 0; p < n_patches; ++p) {
+        Patch patch;
+        patch.name = "patch_" + std::to_string(p);
+        patch.config = PatchConfig{n_positions, n_characters, 1};
+        // More samples than characters: predictions do not depend on the ridge
+        const size_t n_samples = n_characters + 1 + rng() % 4;
+        for (size_t s = 0; s < n_samples; ++s) {
+            patch.V_samples.push_back(random_matrix(n_positions, rng));
+            patch.targets.push_back(random_matrix(1, rng));
+        }
+        problem.patches.push_back(std::move(patch));
+    }
+    for (size_t p = 0; p + 1 < n_patches; ++p) {
+        GluingConstraint gluing{problem.patches[p].name, problem.patches[p + 1].name,
+                                random_matrix(n_positions, rng), random_matrix(n_positions, rng)};
+        gluing.weight = index % 17 == 5 ? HARD_GLUING : 0.25 * (1 + rng() % 8);
+        problem.gluings.push_back(std::move(gluing));
+    }
+    return problem;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "BonsaiOS Sheaf Solver - fit_many() Check\n";
+    std::cout << "========================================\n\n";
+
+#ifdef USE_EIGEN3
+    std::mt19937 rng(69);
+    std::vector<SheafProblem> problems;
+    for (size_t i = 0; i < kProblems; ++i) problems.push_back(make_problem(i, rng));
+
+    UnifiedSheafLearner learner;
+    const BatchFit batch = learner.fit_many(problems);
+    std::cout << kProblems << " problems: " << batch.batched << " batched, " << batch.fallback << " through fit(), "
+              << batch.stats.bytes_allocated << " bytes allocated\n";
+    if (batch.solutions.size() != kProblems || batch.batched + batch.fallback != kProblems ||
+        batch.batched == 0 || batch.fallback == 0) {
+        std::cout << "FAIL: problems not split between the batched and fallback paths\n";
+        return 1;
+    }
+
+    real_t worst_prediction = 0.0;
+    real_t worst_residual = 0.0;
+    for (size_t i = 0; i < kProblems; ++i) {
+        UnifiedSheafLearner single;
+        const SheafSolution expected = single.fit(problems[i]);
+        const SheafSolution& got = batch.solutions[i];
+
+        for (const Patch& patch : problems[i].patches) {
+            const Matrix& w = got.weights.at(patch.name);     // [positions, characters]
+            for (size_t s = 0; s < 4; ++s) {
+                const Matrix V = random_matrix(patch.config.n_positions, rng);
+                const Vector features = single.feature_row(patch.name, V);
+                complex_t predicted = 0.0;
+                for (Eigen::Index r = 0; r < w.rows(); ++r) {
+                    for (Eigen::Index c = 0; c < w.cols(); ++c) predicted += features(r * w.cols() + c) * w(r, c);
+                }
+                const complex_t want = single.predict(patch.name, V)(0, 0);
+                worst_prediction = std::max(worst_prediction, std::abs(predicted - want) / std::max(1.0, std::abs(want)));
+            }
+        }
+        worst_residual = std::max(worst_residual, std::abs(got.residual_error - expected.residual_error) /
+                                                      std::max(1.0, expected.residual_error));
+    }
+
+    std::cout << "Largest gap to fit(): predictions " << worst_prediction << ", residual " << worst_residual << "\n\n";
+    if (!(worst_prediction < kTolerance) || !(worst_residual < kTolerance)) {
+        std::cout << "FAIL: fit_many() disagrees with fit()\n";
+        return 1;
+    }
+    std::cout << "✓ fit_many() matches fit()\n";
+    return 0;
+#else
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
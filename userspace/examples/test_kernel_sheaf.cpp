@@ -0,0 +1,154 @@
+/**
+ * @file test_kernel_sheaf.cpp
+ * @brief Host check of the kernel's fixed-capacity sheaf_solve()
+ *
+ * Builds edk2_bootloader/Kernel/sheaf.c for the host and solves 2000
+ * random problems, every tenth one at full capacity, against an Eigen LDLT
+ * of the same ridge-regularized normal equations. Also checks that the
+ * reported work never exceeds SHEAF_SOLVE_MAX_MACS.
+ */
+
+extern "C" {
+#include "sheaf.h"
+}
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+
+constexpr int kProblems = 2000;
+constexpr double kTolerance = 1e-6;     // Relative to max(|w|, 1)
+
+// Real character basis of C_n at offset d: cosines, then sines
+double basis(int j, int d, int n) {
+    return 2 * j <= n ? std::cos(2 * M_PI * j * d / n) : std::sin(2 * M_PI * (n - j) * d / n);
+}
+
+// Feature row of one sample, laid out as w[pos][j]
+Eigen::VectorXd features(const PatchConfig& config, const real_t* v) {
+    const int n = config.n_positions;
+    const int k = config.n_chars;
+    Eigen::VectorXd f(n * k);
+    for (int p = 0; p < n; p++) {
+        for (int j = 0; j < k; j++) {
+            double a = 0.0;
+            for (int q = 0; q < n; q++) a += basis(j, ((p - q) % n + n) % n, n) * v[q];
+            f(p * k + j) = a / n;
+        }
+    }
+    return f;
+}
+
+void random_problem(std::mt19937& rng, bool full, SheafProblem& problem) {
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    problem = SheafProblem{};
+    problem.n_patches = 1 + rng() % MAX_PATCHES;
+    int budget = MAX_WEIGHTS;
+    for (int p = 0; p < problem.n_patches; p++) {
+        int n, k;
+        do {
+            n = 1 + rng() % MAX_POSITIONS;
+            k = 1 + rng() % n;
+        } while (n * k > budget - (problem.n_patches - p - 1));
+        budget -= n * k;
+        Patch& patch = problem.patches[p];
+        patch.config = {n, k};
+        patch.n_samples = full ? MAX_SAMPLES_PER_PATCH : rng() % (MAX_SAMPLES_PER_PATCH + 1);
+        for (int s = 0; s < patch.n_samples; s++) {
+            for (int q = 0; q < n; q++) patch.samples[s][q] = uniform(rng);
+            patch.targets[s] = uniform(rng);
+        }
+    }
+    problem.n_constraints = full ? MAX_CONSTRAINTS : rng() % (MAX_CONSTRAINTS + 1);
+    for (int g = 0; g < problem.n_constraints; g++) {
+        GluingConstraint& c = problem.constraints[g];
+        c.patch_1 = rng() % problem.n_patches;
+        c.patch_2 = g == 0 ? c.patch_1 : rng() % problem.n_patches;   // One self-gluing
+        for (int q = 0; q < MAX_POSITIONS; q++) {
+            c.data_1[q] = uniform(rng);
+            c.data_2[q] = uniform(rng);
+        }
+        c.weight = 1.0 + 0.4 * uniform(rng);
+    }
+}
+
+// Weights from the same normal equations, solved by Eigen
+Eigen::VectorXd reference(const SheafProblem& problem) {
+    const int W = problem.n_weights;
+    Eigen::MatrixXd G = Eigen::MatrixXd::Identity(W, W) * SHEAF_RIDGE;
+    Eigen::VectorXd m = Eigen::VectorXd::Zero(W);
+    for (int p = 0; p < problem.n_patches; p++) {
+        const Patch& patch = problem.patches[p];
+        for (int s = 0; s < patch.n_samples; s++) {
+            const Eigen::VectorXd f = features(patch.config, patch.samples[s]);
+            Eigen::VectorXd row = Eigen::VectorXd::Zero(W);
+            row.segment(problem.offsets[p], f.size()) = f;
+            G += row * row.transpose();
+            m += patch.targets[s] * row;
+        }
+    }
+    for (int g = 0; g < problem.n_constraints; g++) {
+        const GluingConstraint& c = problem.constraints[g];
+        const Eigen::VectorXd f1 = features(problem.patches[c.patch_1].config, c.data_1);
+        const Eigen::VectorXd f2 = features(problem.patches[c.patch_2].config, c.data_2);
+        Eigen::VectorXd row = Eigen::VectorXd::Zero(W);
+        row.segment(problem.offsets[c.patch_1], f1.size()) += f1;
+        row.segment(problem.offsets[c.patch_2], f2.size()) -= f2;
+        G += c.weight * row * row.transpose();
+    }
+    return G.ldlt().solve(m);
+}
+
+} // namespace
+
+int main() {
+    std::printf("BonsaiOS Kernel sheaf_solve - Host Check\n");
+    std::printf("========================================\n\n");
+
+    std::mt19937 rng(7);
+    static SheafProblem problem;
+    double worst = 0.0;
+    unsigned long max_work = 0;
+    int failures = 0;
+    for (int t = 0; t < kProblems; t++) {
+        random_problem(rng, t % 10 == 0, problem);
+        if (sheaf_solve(&problem) != 0) {
+            std::printf("problem %d: sheaf_solve failed\n", t);
+            failures++;
+            continue;
+        }
+        max_work = std::max(max_work, problem.work);
+        if (problem.work > SHEAF_SOLVE_MAX_MACS) {
+            std::printf("problem %d: work %lu exceeds the bound\n", t, problem.work);
+            failures++;
+        }
+        const Eigen::VectorXd expected = reference(problem);
+        const Eigen::Map<const Eigen::VectorXd> got(problem.weights, problem.n_weights);
+        const double rel = (got - expected).norm() / std::max(1.0, expected.norm());
+        worst = std::max(worst, rel);
+        if (rel > kTolerance) {
+            std::printf("problem %d: weights differ from LDLT (relative error %.3g)\n", t, rel);
+            failures++;
+        }
+    }
+
+    static SheafProblem demo;
+    sheaf_demo_register_allocation(&demo);
+    const int rc = sheaf_solve(&demo);
+    std::printf("demo: rc %d, %d weights, work %lu, residual %.4f\n", rc, demo.n_weights, demo.work, demo.residual);
+    failures += rc != 0;
+
+    std::printf("%d problems: worst relative error %.3g, max work %lu of %d\n",
+                kProblems, worst, max_work, SHEAF_SOLVE_MAX_MACS);
+    if (failures) {
+        std::printf("FAIL: %d failures\n", failures);
+        return 1;
+    }
+    std::printf("✓ sheaf_solve matches Eigen LDLT\n");
+    return 0;
+}
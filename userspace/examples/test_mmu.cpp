@@ -0,0 +1,178 @@
+/**
+ * @file test_mmu.cpp
+ * @brief Host check of the kernel's translation tables and stack arena
+ *
+ * Builds edk2_bootloader/Kernel/mmu.c for the host over a synthetic
+ * memory map: write-back RAM, uncached RAM, MMIO and a reserved hole,
+ * with page_alloc.c handing out table pages from an mmap()ed arena
+ * placed below the 39-bit VA limit. Checks:
+ *   - mmu_init() fails cleanly when table pages run out: every page is
+ *     returned and nothing is left half built
+ *   - 1 GiB / 2 MiB / 4 KiB leaf and table page counts
+ *   - each range maps with the right attributes, the hole stays unmapped
+ *   - every stack slot has an invalid guard page below a mapped stack
+ *   - mmu_stack_alloc()/mmu_stack_free() slot accounting, including
+ *     refusal of double and misaligned frees
+ */
+
+extern "C" {
+#include "mmu.h"
+#include "page_alloc.h"
+}
+
+#include <sys/mman.h>
+
+#include <cstdio>
+#include <iterator>
+#include <set>
+#include <vector>
+
+namespace {
+
+constexpr unsigned long kGiB = 1UL << 30;
+constexpr unsigned long kMiB = 1UL << 20;
+constexpr unsigned long kArenaBase = 64 * kGiB;     // Host mapping inside the 39-bit VA
+constexpr unsigned long kArenaBytes = 16 * kMiB;
+constexpr unsigned long kAttrIndex = 7UL << 2;      // Descriptor bits [4:2]: MAIR index
+
+int fail(const char* what, unsigned long addr) {
+    std::printf("FAIL: %s (0x%lx)\n", what, addr);
+    return 1;
+}
+
+unsigned long available_pages() {
+    PageStats stats;
+    page_alloc_stats(&stats);
+    return stats.free_pages + stats.cached_pages;
+}
+
+} // namespace
+
+int main() {
+    std::printf("BonsaiOS Kernel mmu - Host Check\n");
+    std::printf("================================\n\n");
+
+    void* arena = ::mmap((void*)kArenaBase, kArenaBytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (arena == MAP_FAILED || (unsigned long)arena != kArenaBase) {
+        std::perror("mmap");
+        return 1;
+    }
+
+    // Only the conventional range is backed; the rest exist for mmu_init() alone
+    BootMemoryDescriptor map[5] = {};
+    map[0] = {BOOT_MEMORY_LOADER_DATA, 0, 2 * kGiB, 0, (kGiB + 2 * kMiB + 2 * PAGE_SIZE) >> PAGE_SHIFT,
+              BOOT_MEMORY_ATTR_WB};
+    map[1] = {BOOT_MEMORY_MMIO, 0, 4 * kGiB, 0, 16, 0};
+    map[2] = {0, 0, 5 * kGiB, 0, kGiB >> PAGE_SHIFT, BOOT_MEMORY_ATTR_WB};     // Reserved
+    map[3] = {BOOT_MEMORY_LOADER_CODE, 0, 7 * kGiB, 0, (4 * kMiB) >> PAGE_SHIFT, 0};
+    map[4] = {BOOT_MEMORY_CONVENTIONAL, 0, kArenaBase, 0, kArenaBytes >> PAGE_SHIFT, BOOT_MEMORY_ATTR_WB};
+    BootInfo boot{};
+    boot.magic = BOOT_INFO_MAGIC;
+    boot.version = BOOT_INFO_VERSION;
+    boot.descriptor_version = 1;
+    boot.memory_map = (unsigned long)map;
+    boot.memory_map_size = sizeof(map);
+    boot.descriptor_size = sizeof(BootMemoryDescriptor);
+
+    if (page_alloc_init(&boot) != 0) {
+        std::printf("FAIL: page_alloc_init\n");
+        return 1;
+    }
+
+    // Leave three table pages: mmu_init() runs out part way through
+    const unsigned long before = available_pages();
+    std::vector<unsigned long> hog;
+    for (unsigned long page; (page = page_alloc(0)) != 0;) hog.push_back(page);
+    for (int i = 0; i < 3; i++) {
+        page_free(hog.back(), 0);
+        hog.pop_back();
+    }
+    const unsigned long spare = available_pages();
+    MmuStats stats;
+    if (mmu_init(&boot) == 0) return fail("mmu_init() succeeded without table pages", 0);
+    mmu_stats(&stats);
+    if (available_pages() != spare) return fail("failed mmu_init() leaked pages", spare - available_pages());
+    if (stats.el || stats.blocks_1g || stats.blocks_2m || stats.pages_4k || stats.table_pages ||
+        mmu_lookup(2 * kGiB)) {
+        return fail("failed mmu_init() left tables behind", stats.table_pages);
+    }
+    if (mmu_stack_alloc() != 0) return fail("stack handed out without an arena", 0);
+    for (unsigned long page : hog) page_free(page, 0);
+    if (available_pages() != before) return fail("pages lost", before - available_pages());
+
+    if (mmu_init(&boot) != 0) {
+        std::printf("FAIL: mmu_init\n");
+        return 1;
+    }
+    mmu_stats(&stats);
+    std::printf("EL%u: %lu x 1 GiB, %lu x 2 MiB, %lu x 4 KiB, %lu table pages\n",
+                stats.el, stats.blocks_1g, stats.blocks_2m, stats.pages_4k, stats.table_pages);
+    // Device 0-2 GiB: 2 x 1 GiB. Loader data: 1 GiB + 2 MiB + 2 pages. MMIO:
+    // 16 pages. Loader code: 2 x 2 MiB. Conventional: 8 x 2 MiB, one split
+    // into pages for the stack arena less its 32 guards
+    const unsigned long stack_pages = (MMU_STACK_SLOTS * MMU_STACK_SLOT_SIZE) >> PAGE_SHIFT;
+    if (stats.el != 1 || stats.blocks_1g != 3 || stats.blocks_2m != 1 + 2 + 8 - 1 ||
+        stats.pages_4k != 2 + 16 + stack_pages - MMU_STACK_SLOTS || stats.table_pages != 8) {
+        std::printf("FAIL: unexpected leaf or table counts\n");
+        return 1;
+    }
+
+    const unsigned long normal = mmu_lookup(kArenaBase) & kAttrIndex;
+    const unsigned long device = mmu_lookup(0x1000) & kAttrIndex;
+    const struct {
+        unsigned long addr;
+        unsigned long attrs;        // Or ~0 for unmapped
+    } probes[] = {
+        {0, device}, {MMU_DEVICE_LIMIT - PAGE_SIZE, device},
+        {2 * kGiB, normal}, {3 * kGiB + 2 * kMiB + PAGE_SIZE, normal}, {3 * kGiB + 2 * kMiB + 2 * PAGE_SIZE, ~0UL},
+        {4 * kGiB + 15 * PAGE_SIZE, device}, {4 * kGiB + 16 * PAGE_SIZE, ~0UL},
+        {5 * kGiB, ~0UL}, {6 * kGiB - PAGE_SIZE, ~0UL},
+        {7 * kGiB, device}, {7 * kGiB + 4 * kMiB, ~0UL},
+        {kArenaBase + kArenaBytes - PAGE_SIZE, normal}, {kArenaBase + kArenaBytes, ~0UL},
+        {1UL << MMU_VA_BITS, ~0UL},
+    };
+    if (normal == device) return fail("RAM and MMIO share attributes", normal);
+    for (const auto& probe : probes) {
+        const unsigned long e = mmu_lookup(probe.addr);
+        if (probe.attrs == ~0UL ? e != 0 : e == 0 || (e & kAttrIndex) != probe.attrs) {
+            return fail("wrong mapping", probe.addr);
+        }
+    }
+
+    // Every slot: a mapped stack above an invalid guard page
+    std::set<unsigned long> tops;
+    for (int s = 0; s < MMU_STACK_SLOTS; s++) {
+        const unsigned long top = mmu_stack_alloc();
+        if (top == 0 || !tops.insert(top).second) return fail("stack slot not handed out once", top);
+        if (mmu_lookup(top - MMU_STACK_SLOT_SIZE) != 0) return fail("guard page mapped", top - MMU_STACK_SLOT_SIZE);
+        for (unsigned long a = top - MMU_STACK_SIZE; a < top; a += PAGE_SIZE) {
+            const unsigned long e = mmu_lookup(a);
+            if (e == 0 || (e & kAttrIndex) != normal) return fail("stack page unmapped", a);
+        }
+        *(volatile unsigned long*)(top - sizeof(unsigned long)) = top;
+    }
+    mmu_stats(&stats);
+    if (stats.stacks_in_use != MMU_STACK_SLOTS || mmu_stack_alloc() != 0) {
+        return fail("stack slots over-committed", stats.stacks_in_use);
+    }
+
+    const unsigned long victim = *std::next(tops.begin(), MMU_STACK_SLOTS / 2);
+    if (mmu_stack_free(victim) != 0) return fail("free refused", victim);
+    if (mmu_stack_free(victim) == 0) return fail("double free accepted", victim);
+    if (mmu_stack_free(victim - PAGE_SIZE) == 0) return fail("misaligned free accepted", victim - PAGE_SIZE);
+    if (mmu_stack_free(*tops.begin() - MMU_STACK_SLOT_SIZE) == 0) return fail("free below the arena accepted", 0);
+    mmu_stats(&stats);
+    if (stats.stacks_in_use != MMU_STACK_SLOTS - 1) return fail("slot count off after free", stats.stacks_in_use);
+    if (mmu_stack_alloc() != victim) return fail("freed slot not reused", victim);
+    for (unsigned long top : tops) {
+        if (mmu_stack_free(top) != 0) return fail("free refused", top);
+    }
+    mmu_stats(&stats);
+    if (stats.stacks_in_use != 0) return fail("slots still in use", stats.stacks_in_use);
+    if (mmu_init(&boot) == 0) return fail("second mmu_init() accepted", 0);
+
+    std::printf("%d stack slots, guard pages invalid\n\n", MMU_STACK_SLOTS);
+    std::printf("✓ Translation tables and stack arena consistent\n");
+    return 0;
+}
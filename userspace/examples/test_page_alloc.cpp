@@ -0,0 +1,133 @@
+/**
+ * @file test_page_alloc.cpp
+ * @brief Host check of the kernel's buddy page allocator
+ *
+ * Builds edk2_bootloader/Kernel/page_alloc.c for the host over a synthetic
+ * memory map carved out of an mmap()ed arena: a misaligned start, a
+ * loader-data hole, two adjacent conventional ranges and a boot-services
+ * range added afterwards. 200k random mixed-order alloc/free operations
+ * then check that blocks are aligned, stay inside usable ranges, never
+ * overlap, and that double frees and frees into the hole are refused.
+ */
+
+extern "C" {
+#include "page_alloc.h"
+}
+
+#include <sys/mman.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <random>
+
+namespace {
+
+constexpr int kOperations = 200000;
+
+struct Range {
+    unsigned long start;
+    unsigned long end;
+};
+
+int fail(const char* what, unsigned long addr, int order) {
+    std::printf("FAIL: %s (0x%lx, order %d)\n", what, addr, order);
+    return 1;
+}
+
+} // namespace
+
+int main() {
+    std::printf("BonsaiOS Kernel page_alloc - Host Check\n");
+    std::printf("=======================================\n\n");
+
+    const unsigned long arena_bytes = 80UL << 20;
+    void* arena = ::mmap(nullptr, arena_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (arena == MAP_FAILED) {
+        std::perror("mmap");
+        return 1;
+    }
+    const unsigned long max_block = PAGE_SIZE << (PAGE_ORDERS - 1);
+    const unsigned long base = (((unsigned long)arena + max_block - 1) & ~(max_block - 1)) + 3 * PAGE_SIZE;
+    auto page = [&](unsigned long n) { return base + n * PAGE_SIZE; };
+
+    BootMemoryDescriptor map[5] = {};
+    map[0] = {BOOT_MEMORY_CONVENTIONAL, 0, page(0), 0, 1000, 0};
+    map[1] = {BOOT_MEMORY_LOADER_DATA, 0, page(1000), 0, 24, 0};
+    map[2] = {BOOT_MEMORY_CONVENTIONAL, 0, page(1024), 0, 5000, 0};
+    map[3] = {BOOT_MEMORY_CONVENTIONAL, 0, page(6024), 0, 3000, 0};
+    map[4] = {BOOT_MEMORY_BOOT_SERVICES_DATA, 0, page(9024), 0, 2048, 0};
+    BootInfo boot{};
+    boot.magic = BOOT_INFO_MAGIC;
+    boot.version = BOOT_INFO_VERSION;
+    boot.descriptor_version = 1;
+    boot.memory_map = (unsigned long)map;
+    boot.memory_map_size = sizeof(map);
+    boot.descriptor_size = sizeof(BootMemoryDescriptor);
+
+    if (page_alloc_init(&boot) != 0) {
+        std::printf("FAIL: page_alloc_init\n");
+        return 1;
+    }
+    PageStats stats;
+    page_alloc_stats(&stats);
+    const unsigned long conventional = stats.total_pages;
+    const unsigned long added = page_alloc_add_boot_services(&boot);
+    page_alloc_stats(&stats);
+    std::printf("%lu pages (%lu frame table), %lu added from boot services\n",
+                stats.total_pages, stats.frame_table_pages, added);
+    if (added != 2048 || stats.total_pages != conventional + added) {
+        std::printf("FAIL: boot-services range not added whole\n");
+        return 1;
+    }
+    const unsigned long total = stats.total_pages;
+    const Range usable[] = {{page(0), page(1000)}, {page(1024), page(11072)}};
+    const Range hole = {page(1000), page(1024)};
+
+    std::mt19937 rng(1);
+    std::map<unsigned long, int> live;     // Address -> order
+    unsigned long allocs = 0;
+    for (int op = 0; op < kOperations; op++) {
+        if (live.empty() || rng() % 2) {
+            const int order = rng() % 3 == 0 ? rng() % PAGE_ORDERS : 0;
+            const unsigned long addr = page_alloc(order);
+            if (addr == 0) continue;
+            const unsigned long end = addr + (PAGE_SIZE << order);
+            if (addr & ((PAGE_SIZE << order) - 1)) return fail("misaligned block", addr, order);
+            bool inside = false;
+            for (const Range& r : usable) inside |= addr >= r.start && end <= r.end;
+            if (!inside) return fail("block outside usable memory", addr, order);
+            auto next = live.lower_bound(addr);
+            if (next != live.end() && next->first < end) return fail("overlapping blocks", addr, order);
+            if (next != live.begin()) {
+                auto prev = std::prev(next);
+                if (prev->first + (PAGE_SIZE << prev->second) > addr) return fail("overlapping blocks", addr, order);
+            }
+            std::memset((void*)addr, 0xab, PAGE_SIZE << order);
+            live[addr] = order;
+            allocs++;
+        } else {
+            auto victim = live.begin();
+            std::advance(victim, rng() % live.size());
+            if (page_free(victim->first, victim->second) != 0) return fail("free refused", victim->first, victim->second);
+            if (page_free(victim->first, victim->second) == 0) return fail("double free accepted", victim->first, victim->second);
+            live.erase(victim);
+        }
+    }
+    for (const auto& [addr, order] : live) page_free(addr, order);
+    if (page_free(hole.start + PAGE_SIZE, 0) == 0) return fail("free inside the hole accepted", hole.start + PAGE_SIZE, 0);
+
+    page_alloc_stats(&stats);
+    std::printf("%d operations, %lu allocations: %lu pages free, %lu cached of %lu\n",
+                kOperations, allocs, stats.free_pages, stats.cached_pages, total);
+    std::printf("free blocks by order:");
+    for (int o = 0; o < PAGE_ORDERS; o++) std::printf(" %lu", stats.free_blocks[o]);
+    std::printf("\n");
+    if (stats.free_pages + stats.cached_pages != total) {
+        std::printf("FAIL: %lu pages lost\n", total - stats.free_pages - stats.cached_pages);
+        return 1;
+    }
+    std::printf("✓ Buddy allocator consistent\n");
+    return 0;
+}
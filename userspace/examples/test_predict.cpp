@@ -0,0 +1,76 @@
+/**
+ * @file test_predict.cpp
+ * @brief Regression check: predict() on complex-valued data
+ *
+ * Features are linear in the sample, f(V) = M V, so a patch with fewer
+ * samples than positions is interpolated exactly: predict() must return
+ * each complex training target, and must be complex-linear in V. A
+ * prediction that conjugates the feature row (Eigen's dot()) fails both.
+ */
+
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <iostream>
+#include <random>
+
+using namespace sheaf;
+
+int main() {
+    std::cout << "BonsaiOS Sheaf Solver - Complex predict() Check\n";
+    std::cout << "================================================\n\n";
+
+#ifdef USE_EIGEN3
+    constexpr size_t n = 4;
+    constexpr size_t n_samples = 3;      // < n: the fit interpolates
+    constexpr real_t tolerance = 1e-6;
+
+    std::mt19937 rng(57);
+    std::normal_distribution<real_t> normal;
+    auto random_complex = [&] { return complex_t(normal(rng), normal(rng)); };
+
+    Patch patch;
+    patch.name = "complex";
+    patch.config = PatchConfig{n, n, 1};
+    for (size_t s = 0; s < n_samples; ++s) {
+        Matrix V(n, 1);
+        for (size_t i = 0; i < n; ++i) V(i, 0) = random_complex();
+        Matrix t(1, 1);
+        t(0, 0) = random_complex();
+        patch.V_samples.push_back(V);
+        patch.targets.push_back(t);
+    }
+
+    UnifiedSheafLearner learner;
+    learner.fit(SheafProblem{{patch}, {}});
+
+    real_t worst = 0.0;
+    for (size_t s = 0; s < n_samples; ++s) {
+        const complex_t got = learner.predict(patch.name, patch.V_samples[s])(0, 0);
+        const complex_t want = patch.targets[s](0, 0);
+        std::cout << "  sample " << s << ": target " << want << ", predicted " << got << "\n";
+        worst = std::max(worst, std::abs(got - want));
+    }
+
+    // Complex linearity: predict(a V0 + b V1) = a t0 + b t1
+    const complex_t a(0.3, -1.2);
+    const complex_t b(-0.7, 0.4);
+    const Matrix mix = a * patch.V_samples[0] + b * patch.V_samples[1];
+    const complex_t got = learner.predict(patch.name, mix)(0, 0);
+    const complex_t want = a * patch.targets[0](0, 0) + b * patch.targets[1](0, 0);
+    std::cout << "  a V0 + b V1: expected " << want << ", predicted " << got << "\n\n";
+    worst = std::max(worst, std::abs(got - want));
+
+    std::cout << "Largest error: " << worst << "\n";
+    if (!(worst < tolerance)) {
+        std::cout << "FAIL: predictions do not match the complex targets\n";
+        return 1;
+    }
+    std::cout << "✓ predict() matches complex targets\n";
+    return 0;
+#else
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
@@ -0,0 +1,156 @@
+/**
+ * @file oracle_abi.hpp
+ * @brief Shared-memory layout of the sheaf oracle's submission/completion rings
+ *
+ * The oracle daemon (sheaf_oracle) creates one POSIX shared-memory segment:
+ *
+ *   [SegmentHeader][Channel 0]...[Channel C-1][slots of channel 0]...[slots of channel C-1]
+ *
+ * A client claims a free channel and owns it until it detaches. Each
+ * channel is a pair of single-producer/single-consumer rings in the style
+ * of io_uring: the client produces SubmissionEntry records, the daemon
+ * consumes them and produces CompletionEntry records. Request and result
+ * payloads never travel through the rings - an entry names a slot of the
+ * channel's arena, the daemon parses the request in place and writes the
+ * result back into the same slot.
+ *
+ * A channel has as many slots as ring entries, so a client can never have
+ * more requests in flight than its completion ring holds.
+ *
+ * When the daemon finds every ring empty for a while it sets
+ * SegmentHeader::sleeping and waits on the doorbell futex; a client that
+ * sees the flag after submitting bumps the doorbell and wakes it
+ * (IORING_SQ_NEED_WAKEUP, in io_uring terms).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sheaf::oracle {
+
+constexpr uint32_t kMagic = 0x4f524853;    // "SHRO"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kRingEntries = 256;      // Power of two; also slots per channel
+constexpr const char* kDefaultSegment = "/sheaf_oracle";
+
+enum class Opcode : uint32_t {
+    Nop = 0,
+    Fit,         // Slot: encoded problem            -> weights, model handle in the completion
+    Predict,     // Slot: patch index + samples      -> one prediction per sample
+    Reweight,    // Slot: one weight per gluing      -> weights (reuses the model's factorizations)
+    Release      // Drop the handle `model`
+};
+
+enum class Status : int32_t {
+    Ok = 0,
+    BadRequest = -1,     // Malformed payload or unknown opcode
+    UnknownModel = -2,
+    Failed = -3,         // The solver rejected the problem
+    TooLarge = -4        // Result does not fit in a slot
+};
+
+// Completion flags
+constexpr uint32_t kCompletionCached = 1u << 0;   // Fit served from the model cache
+
+struct SubmissionEntry {
+    uint64_t user_data;    // Returned untouched in the completion
+    uint32_t opcode;       // Opcode
+    uint32_t slot;         // Slot of this channel holding the payload
+    uint64_t model;        // Predict, Reweight, Release
+    uint32_t length;       // Payload bytes
+    uint32_t reserved;
+};
+
+struct CompletionEntry {
+    uint64_t user_data;
+    int32_t status;        // Status
+    uint32_t slot;
+    uint64_t model;        // Fit: handle of the (possibly cached) model
+    double residual;       // Fit, Reweight: cohomological obstruction
+    uint32_t length;       // Result bytes written to the slot
+    uint32_t flags;
+};
+
+/**
+ * @brief Single-producer/single-consumer ring of fixed-size entries
+ *
+ * head and tail are free-running counters on separate cache lines; the
+ * producer publishes an entry with a release store of tail, the consumer
+ * retires it with a release store of head.
+ */
+template <typename Entry>
+struct Ring {
+    alignas(64) std::atomic<uint32_t> head;
+    alignas(64) std::atomic<uint32_t> tail;
+    alignas(64) Entry entries[kRingEntries];
+
+    bool push(const Entry& entry) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == kRingEntries) {
+            return false;
+        }
+        entries[t & (kRingEntries - 1)] = entry;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(Entry& entry) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        entry = entries[h & (kRingEntries - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+enum class ChannelState : uint32_t {
+    Free = 0,
+    Claiming,    // Owner is resetting the rings; the daemon keeps away
+    Claimed
+};
+
+struct Channel {
+    alignas(64) std::atomic<uint32_t> state;   // ChannelState
+    int32_t pid;                               // Owner, for reclaiming after a crash
+    uint32_t generation;                       // Bumped on every claim
+    Ring<SubmissionEntry> sq;
+    Ring<CompletionEntry> cq;
+};
+
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t n_channels;
+    uint32_t slot_bytes;                       // Multiple of 64
+    uint64_t total_bytes;
+    alignas(64) std::atomic<uint32_t> running;     // Cleared when the daemon exits
+    std::atomic<uint32_t> sleeping;                // Daemon is (about to be) waiting on the doorbell
+    std::atomic<uint32_t> doorbell;                // Futex word
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Ring counters must be lock free to live in shared memory");
+
+inline size_t channel_offset(uint32_t channel) {
+    return sizeof(SegmentHeader) + static_cast<size_t>(channel) * sizeof(Channel);
+}
+
+inline size_t slot_offset(const SegmentHeader& header, uint32_t channel, uint32_t slot) {
+    return channel_offset(header.n_channels)
+         + (static_cast<size_t>(channel) * kRingEntries + slot) * header.slot_bytes;
+}
+
+inline size_t segment_bytes(uint32_t n_channels, uint32_t slot_bytes) {
+    return channel_offset(n_channels) + static_cast<size_t>(n_channels) * kRingEntries * slot_bytes;
+}
+
+} // namespace sheaf::oracle
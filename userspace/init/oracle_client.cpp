@@ -0,0 +1,234 @@
+/**
+ * @file oracle_client.cpp
+ * @brief Channel claiming, submission and completion for oracle clients
+ */
+
+#include "oracle_client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace sheaf::oracle {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::runtime_error system_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+OracleClient::OracleClient(const std::string& segment, std::chrono::milliseconds timeout)
+    : timeout_(timeout) {
+    const int fd = ::shm_open(segment.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw system_error("shm_open " + segment + " (is sheaf_oracle running?)");
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Oracle segment is too small: " + segment);
+    }
+    void* base = ::mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw system_error("mmap " + segment);
+    }
+    base_ = static_cast<std::byte*>(base);
+    mapped_bytes_ = st.st_size;
+    header_ = reinterpret_cast<SegmentHeader*>(base_);
+
+    if (header_->magic != kMagic || header_->version != kVersion
+        || header_->total_bytes != mapped_bytes_
+        || segment_bytes(header_->n_channels, header_->slot_bytes) != mapped_bytes_
+        || !header_->running.load(std::memory_order_acquire)) {
+        ::munmap(base_, mapped_bytes_);
+        throw std::runtime_error("No compatible oracle serves " + segment);
+    }
+
+    // Free -> Claiming keeps the daemon off the rings while they are reset
+    for (uint32_t c = 0; c < header_->n_channels && !ring_; ++c) {
+        Channel* channel = reinterpret_cast<Channel*>(base_ + channel_offset(c));
+        uint32_t expected = static_cast<uint32_t>(ChannelState::Free);
+        if (channel->state.compare_exchange_strong(expected, static_cast<uint32_t>(ChannelState::Claiming),
+                                                   std::memory_order_acq_rel)) {
+            channel->pid = ::getpid();
+            ++channel->generation;
+            channel->sq.head.store(0, std::memory_order_relaxed);
+            channel->sq.tail.store(0, std::memory_order_relaxed);
+            channel->cq.head.store(0, std::memory_order_relaxed);
+            channel->cq.tail.store(0, std::memory_order_relaxed);
+            channel->state.store(static_cast<uint32_t>(ChannelState::Claimed), std::memory_order_release);
+            ring_ = channel;
+            channel_ = c;
+        }
+    }
+    if (!ring_) {
+        ::munmap(base_, mapped_bytes_);
+        throw std::runtime_error("Every oracle channel is taken");
+    }
+    free_slots_.reserve(kRingEntries);
+    for (uint32_t s = kRingEntries; s-- > 0;) free_slots_.push_back(s);
+}
+
+OracleClient::~OracleClient() {
+    // The daemon may still write results for requests in flight, so drain
+    // them before the channel can pass to another client
+    try {
+        while (in_flight() > 0 && header_->running.load(std::memory_order_acquire)) {
+            release_slot(wait().slot);
+        }
+    } catch (const std::exception&) {
+        // Timed out: the daemon drops completions for a channel it no longer owns
+    }
+    ring_->state.store(static_cast<uint32_t>(ChannelState::Free), std::memory_order_release);
+    ::munmap(base_, mapped_bytes_);
+}
+
+std::optional<uint32_t> OracleClient::acquire_slot() {
+    if (free_slots_.empty()) {
+        return std::nullopt;
+    }
+    const uint32_t slot = free_slots_.back();
+    free_slots_.pop_back();
+    return slot;
+}
+
+void OracleClient::release_slot(uint32_t slot) {
+    if (slot >= kRingEntries) {
+        throw std::out_of_range("Slot out of range");
+    }
+    free_slots_.push_back(slot);
+}
+
+std::span<std::byte> OracleClient::slot(uint32_t slot) {
+    if (slot >= kRingEntries) {
+        throw std::out_of_range("Slot out of range");
+    }
+    return {base_ + slot_offset(*header_, channel_, slot), header_->slot_bytes};
+}
+
+void OracleClient::submit(const SubmissionEntry& entry) {
+    if (!ring_->sq.push(entry)) {
+        throw std::logic_error("Submission ring full: more requests in flight than slots");
+    }
+    // Pairs with the daemon's store of `sleeping` before its last look at
+    // the rings: one of the two sides sees the other
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->sleeping.load(std::memory_order_relaxed)) {
+        header_->doorbell.fetch_add(1, std::memory_order_release);
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header_->doorbell), FUTEX_WAKE, 1,
+                  nullptr, nullptr, 0);
+    }
+}
+
+bool OracleClient::poll(CompletionEntry& entry) {
+    return ring_->cq.pop(entry);
+}
+
+CompletionEntry OracleClient::wait() {
+    CompletionEntry entry;
+    const Clock::time_point deadline = Clock::now() + timeout_;
+    for (unsigned idle = 0;; ++idle) {
+        if (poll(entry)) {
+            return entry;
+        }
+        if (idle < 256) {
+            continue;
+        }
+        if (!header_->running.load(std::memory_order_acquire)) {
+            throw std::runtime_error("Oracle daemon exited");
+        }
+        if (Clock::now() > deadline) {
+            throw std::runtime_error("Timed out waiting for the oracle");
+        }
+        if (idle < 4096) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+}
+
+uint32_t OracleClient::blocking_slot() {
+    const std::optional<uint32_t> s = acquire_slot();
+    if (!s) {
+        throw std::logic_error("Blocking calls need an otherwise idle channel");
+    }
+    return *s;
+}
+
+CompletionEntry OracleClient::call(Opcode opcode, uint32_t slot, uint64_t model, size_t length) {
+    if (in_flight() != 1) {
+        release_slot(slot);
+        throw std::logic_error("Blocking calls need an otherwise idle channel");
+    }
+    submit(SubmissionEntry{0, static_cast<uint32_t>(opcode), slot, model, static_cast<uint32_t>(length), 0});
+    CompletionEntry entry = wait();
+    if (entry.status != static_cast<int32_t>(Status::Ok)) {
+        release_slot(slot);
+        throw std::runtime_error(std::string("Oracle request failed: ") + status_name(entry.status));
+    }
+    return entry;
+}
+
+FitReply OracleClient::fit(const SheafProblem& problem, real_t ridge) {
+    const uint32_t s = blocking_slot();
+    size_t length;
+    try {
+        length = encode_fit(problem, ridge, slot(s));
+    } catch (...) {
+        release_slot(s);
+        throw;
+    }
+    const CompletionEntry entry = call(Opcode::Fit, s, 0, length);
+    FitReply reply{entry.model, entry.residual, (entry.flags & kCompletionCached) != 0,
+                   decode_values(slot(s).first(entry.length))};
+    release_slot(s);
+    return reply;
+}
+
+std::vector<complex_t> OracleClient::predict(uint64_t model, uint32_t patch, std::span<const Matrix> samples) {
+    const uint32_t s = blocking_slot();
+    size_t length;
+    try {
+        length = encode_predict(patch, samples, slot(s));
+    } catch (...) {
+        release_slot(s);
+        throw;
+    }
+    const CompletionEntry entry = call(Opcode::Predict, s, model, length);
+    std::vector<complex_t> values = decode_values(slot(s).first(entry.length));
+    release_slot(s);
+    return values;
+}
+
+void OracleClient::release(uint64_t model) {
+    const uint32_t s = blocking_slot();
+    call(Opcode::Release, s, model, 0);
+    release_slot(s);
+}
+
+const char* status_name(int32_t status) {
+    switch (static_cast<Status>(status)) {
+        case Status::Ok: return "ok";
+        case Status::BadRequest: return "bad request";
+        case Status::UnknownModel: return "unknown model";
+        case Status::Failed: return "solver failed";
+        case Status::TooLarge: return "result too large";
+    }
+    return "unknown status";
+}
+
+} // namespace sheaf::oracle
@@ -0,0 +1,110 @@
+/**
+ * @file oracle_client.hpp
+ * @brief Client side of the sheaf oracle's shared-memory rings
+ *
+ * An OracleClient maps the daemon's segment and claims one channel. The
+ * asynchronous interface mirrors io_uring: take a slot, encode the
+ * request into it (see oracle_protocol.hpp), submit() an entry naming the
+ * slot, and later poll() or wait() for its completion. The result is in
+ * the same slot, which the client hands back with release_slot() once it
+ * has read it.
+ *
+ * Completions may arrive in any order; requests that depend on each other
+ * (a Predict on the model a Fit returns) must wait for the first one.
+ *
+ * fit() and predict() are blocking conveniences for callers with nothing
+ * else in flight.
+ */
+
+#pragma once
+
+#include "oracle_abi.hpp"
+#include "oracle_protocol.hpp"
+
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sheaf::oracle {
+
+struct FitReply {
+    uint64_t model;
+    real_t residual;
+    bool cached;                          // Served from the daemon's model cache
+    std::vector<complex_t> weights;       // Every patch's weights, in request order
+};
+
+class OracleClient {
+public:
+    /**
+     * @brief Map the segment and claim a free channel
+     *
+     * @throws std::runtime_error if no daemon serves `segment` or every
+     *         channel is taken
+     */
+    explicit OracleClient(const std::string& segment = kDefaultSegment,
+                          std::chrono::milliseconds timeout = std::chrono::seconds(30));
+    ~OracleClient();
+
+    OracleClient(const OracleClient&) = delete;
+    OracleClient& operator=(const OracleClient&) = delete;
+
+    uint32_t channel() const { return channel_; }
+    size_t slot_bytes() const { return header_->slot_bytes; }
+    size_t in_flight() const { return kRingEntries - free_slots_.size(); }
+
+    /**
+     * @brief A free slot, or nothing when kRingEntries requests are in flight
+     */
+    std::optional<uint32_t> acquire_slot();
+    void release_slot(uint32_t slot);
+    std::span<std::byte> slot(uint32_t slot);
+
+    /**
+     * @brief Queue one request (its slot must hold the payload)
+     *
+     * Never fails for a client that only submits with slots it holds.
+     */
+    void submit(const SubmissionEntry& entry);
+
+    /**
+     * @brief Next completion, if one has arrived
+     */
+    bool poll(CompletionEntry& entry);
+
+    /**
+     * @brief Next completion, spinning then sleeping while none has arrived
+     *
+     * @throws std::runtime_error if the daemon exits or the timeout passes
+     */
+    CompletionEntry wait();
+
+    /**
+     * @throws std::runtime_error for a non-Ok completion
+     * @throws std::logic_error while asynchronous requests are in flight
+     */
+    FitReply fit(const SheafProblem& problem, real_t ridge = 1e-8);
+    std::vector<complex_t> predict(uint64_t model, uint32_t patch, std::span<const Matrix> samples);
+    void release(uint64_t model);
+
+private:
+    uint32_t blocking_slot();
+    CompletionEntry call(Opcode opcode, uint32_t slot, uint64_t model, size_t length);
+
+    std::byte* base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    SegmentHeader* header_ = nullptr;
+    Channel* ring_ = nullptr;
+    uint32_t channel_ = 0;
+    std::vector<uint32_t> free_slots_;
+    std::chrono::milliseconds timeout_;
+};
+
+/**
+ * @brief Status name for messages
+ */
+const char* status_name(int32_t status);
+
+} // namespace sheaf::oracle
@@ -0,0 +1,355 @@
+/**
+ * @file oracle_loadgen.cpp
+ * @brief Load generator for sheaf_oracle: throughput and latency per request type
+ *
+ * Each client thread claims its own channel, fits one of --models random
+ * problems (clients beyond the first --models share problems and hit the
+ * daemon's model cache) and then keeps --depth requests in flight for
+ * --duration seconds: Predict requests of --samples samples each, with
+ * every --reweight-every'th request a Reweight and every --fit-every'th a
+ * Fit of the client's problem (0 disables either).
+ *
+ * Latency is measured per request from submission to completion. Before
+ * the run, client 0 checks the daemon's weights and predictions against a
+ * local fit of the same problem.
+ *
+ * Usage:
+ *   oracle_loadgen [--segment NAME] [--clients N] [--models N] [--duration S]
+ *                  [--depth N] [--samples N] [--positions N] [--characters N]
+ *                  [--patches N] [--fit-every N] [--reweight-every N] [--out FILE]
+ */
+
+#include "oracle_client.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace sheaf;
+using namespace sheaf::oracle;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string segment = kDefaultSegment;
+    size_t clients = 2;
+    size_t models = 2;           // Distinct problems; client c fits problem c % models
+    double duration_s = 3.0;
+    size_t depth = 16;           // Requests in flight per client
+    size_t samples = 4;          // Per Predict
+    size_t positions = 8;
+    size_t characters = 4;
+    size_t patches = 4;
+    size_t fit_every = 0;        // Every Nth request is a Fit (0 = never)
+    size_t reweight_every = 0;   // Every Nth request is a Reweight (0 = never)
+    std::string out_path;
+};
+
+#ifdef USE_EIGEN3
+
+Matrix random_sample(size_t n, std::mt19937_64& rng) {
+    std::normal_distribution<double> dist(0.0, 1.0);
+    Matrix V(n, 1);
+    for (size_t i = 0; i < n; ++i) V(i, 0) = complex_t(dist(rng), 0.0);
+    return V;
+}
+
+/**
+ * @brief Patches in a chain, targets from hidden weights plus noise
+ */
+SheafProblem make_problem(const Options& opts, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    SheafProblem problem;
+    for (size_t p = 0; p < opts.patches; ++p) {
+        Patch patch;
+        patch.name = "patch_" + std::to_string(p);
+        patch.config = {opts.positions, opts.characters, 1};
+        std::vector<double> hidden(opts.positions);
+        for (auto& h : hidden) h = dist(rng);
+        for (size_t s = 0; s < 4 * opts.positions; ++s) {
+            Matrix V = random_sample(opts.positions, rng);
+            Matrix T(1, 1);
+            T(0, 0) = 0.01 * dist(rng);
+            for (size_t i = 0; i < opts.positions; ++i) T(0, 0) += hidden[i] * V(i, 0);
+            patch.V_samples.push_back(std::move(V));
+            patch.targets.push_back(std::move(T));
+        }
+        problem.patches.push_back(std::move(patch));
+    }
+    for (size_t p = 0; p + 1 < opts.patches; ++p) {
+        GluingConstraint gluing;
+        gluing.patch_1 = problem.patches[p].name;
+        gluing.patch_2 = problem.patches[p + 1].name;
+        gluing.constraint_data_1 = random_sample(opts.positions, rng);
+        gluing.constraint_data_2 = gluing.constraint_data_1;
+        problem.gluings.push_back(std::move(gluing));
+    }
+    return problem;
+}
+
+enum Kind { kPredict, kReweight, kFit, kKinds };
+constexpr const char* kKindNames[kKinds] = {"predict", "reweight", "fit"};
+
+struct ClientResult {
+    std::vector<double> latency_us[kKinds];
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+    uint64_t cache_hits = 0;
+};
+
+/**
+ * @brief Compare the daemon's fit and predictions with a local fit
+ */
+bool verify(OracleClient& client, const SheafProblem& problem, const FitReply& reply, std::mt19937_64& rng) {
+    UnifiedSheafLearner learner;
+    const SheafSolution local = learner.fit(problem);
+    double weight_diff = 0.0;
+    size_t at = 0;
+    for (const Patch& patch : problem.patches) {
+        const Matrix& w = local.weights.at(patch.name);
+        for (Eigen::Index p = 0; p < w.rows(); ++p) {
+            for (Eigen::Index j = 0; j < w.cols(); ++j) {
+                weight_diff = std::max(weight_diff, std::abs(w(p, j) - reply.weights.at(at++)));
+            }
+        }
+    }
+    std::vector<Matrix> samples;
+    for (size_t s = 0; s < 8; ++s) samples.push_back(random_sample(problem.patches[0].config.n_positions, rng));
+    const std::vector<complex_t> remote = client.predict(reply.model, 0, samples);
+    double predict_diff = 0.0;
+    for (size_t s = 0; s < samples.size(); ++s) {
+        predict_diff = std::max(predict_diff, std::abs(remote[s] - learner.predict(problem.patches[0].name, samples[s])(0, 0)));
+    }
+    std::cerr << "  verify: max |Δw| = " << weight_diff << ", max |Δprediction| = " << predict_diff
+              << ", residual " << reply.residual << " (local " << local.residual_error << ")\n";
+    return at == reply.weights.size() && weight_diff < 1e-9 && predict_diff < 1e-9;
+}
+
+void run_client(const Options& opts, size_t id, Clock::time_point end, ClientResult& result,
+                std::mutex& log_mutex, bool& verified) {
+    OracleClient client(opts.segment);
+    std::mt19937_64 rng(1000 + id);
+    const SheafProblem problem = make_problem(opts, 17 + id % opts.models);
+    const FitReply reply = client.fit(problem);
+    result.cache_hits += reply.cached;
+    if (id == 0) {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        verified = verify(client, problem, reply, rng);
+    }
+
+    // A pool of sample batches, so the loop measures the oracle and not the RNG
+    std::vector<std::vector<Matrix>> batches(64);
+    for (auto& batch : batches) {
+        for (size_t s = 0; s < opts.samples; ++s) batch.push_back(random_sample(opts.positions, rng));
+    }
+    std::vector<real_t> gluing_weights(problem.gluings.size());
+    std::uniform_real_distribution<double> weight_dist(0.1, 10.0);
+
+    std::vector<Clock::time_point> submitted(kRingEntries);
+    std::vector<uint64_t> fitted;     // Models from Fit requests, released at the end
+    size_t issued = 0;
+    auto issue = [&] {
+        const uint32_t slot = *client.acquire_slot();
+        const std::span<std::byte> bytes = client.slot(slot);
+        ++issued;
+        Kind kind = kPredict;
+        size_t length;
+        if (opts.fit_every && issued % opts.fit_every == 0) {
+            kind = kFit;
+            length = encode_fit(problem, 1e-8, bytes);
+        } else if (opts.reweight_every && issued % opts.reweight_every == 0 && !gluing_weights.empty()) {
+            kind = kReweight;
+            for (auto& w : gluing_weights) w = weight_dist(rng);
+            length = encode_reweight(gluing_weights, bytes);
+        } else {
+            length = encode_predict(issued % opts.patches, batches[issued % batches.size()], bytes);
+        }
+        const Opcode opcode = kind == kFit ? Opcode::Fit : kind == kReweight ? Opcode::Reweight : Opcode::Predict;
+        submitted[slot] = Clock::now();
+        client.submit(SubmissionEntry{static_cast<uint64_t>(kind), static_cast<uint32_t>(opcode), slot,
+                                      reply.model, static_cast<uint32_t>(length), 0});
+    };
+    auto complete = [&](const CompletionEntry& entry) {
+        const double us = std::chrono::duration<double, std::micro>(Clock::now() - submitted[entry.slot]).count();
+        const Kind kind = static_cast<Kind>(entry.user_data);
+        result.latency_us[kind].push_back(us);
+        if (entry.status != static_cast<int32_t>(Status::Ok)) {
+            ++result.errors;
+        } else if (kind == kPredict) {
+            result.samples += entry.length / (2 * sizeof(double));
+        } else if (kind == kFit) {
+            result.cache_hits += (entry.flags & kCompletionCached) != 0;
+            fitted.push_back(entry.model);
+        }
+        client.release_slot(entry.slot);
+    };
+
+    // Top the queue up, then block (spin, yield, sleep) for the next
+    // completion rather than spinning against the daemon for the CPU
+    CompletionEntry entry;
+    while (Clock::now() < end) {
+        while (client.in_flight() < opts.depth) issue();
+        complete(client.wait());
+        while (client.poll(entry)) complete(entry);
+    }
+    while (client.in_flight() > 0) complete(client.wait());
+    for (uint64_t model : fitted) client.release(model);
+    client.release(reply.model);
+}
+
+double percentile(std::vector<double>& v, double q) {
+    if (v.empty()) return 0.0;
+    const size_t k = std::min(v.size() - 1, static_cast<size_t>(q * static_cast<double>(v.size())));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+#endif // USE_EIGEN3
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--segment NAME] [--clients N] [--models N] [--duration S]\n"
+              << "       [--depth N] [--samples N] [--positions N] [--characters N]\n"
+              << "       [--patches N] [--fit-every N] [--reweight-every N] [--out FILE]\n";
+}
+
+bool parse_args(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(a, "--segment") == 0 && has_value) {
+            opts.segment = argv[++i];
+        } else if (std::strcmp(a, "--clients") == 0 && has_value) {
+            opts.clients = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--models") == 0 && has_value) {
+            opts.models = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--duration") == 0 && has_value) {
+            opts.duration_s = std::atof(argv[++i]);
+        } else if (std::strcmp(a, "--depth") == 0 && has_value) {
+            opts.depth = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--samples") == 0 && has_value) {
+            opts.samples = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--positions") == 0 && has_value) {
+            opts.positions = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--characters") == 0 && has_value) {
+            opts.characters = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--patches") == 0 && has_value) {
+            opts.patches = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--fit-every") == 0 && has_value) {
+            opts.fit_every = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--reweight-every") == 0 && has_value) {
+            opts.reweight_every = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--out") == 0 && has_value) {
+            opts.out_path = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return opts.clients > 0 && opts.models > 0 && opts.patches > 0
+        && opts.depth > 0 && opts.depth <= kRingEntries;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+#ifdef USE_EIGEN3
+    std::cerr << "Sheaf Oracle Load Generator\n";
+    std::cerr << "===========================\n";
+    std::cerr << "  " << opts.clients << " clients, " << opts.models << " models, depth " << opts.depth
+              << ", " << opts.samples << " samples per predict, " << opts.duration_s << " s\n";
+
+    std::vector<ClientResult> results(opts.clients);
+    std::vector<std::string> failures(opts.clients);
+    std::mutex log_mutex;
+    bool verified = false;
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts.duration_s));
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < opts.clients; ++c) {
+        threads.emplace_back([&, c] {
+            try {
+                run_client(opts, c, end, results[c], log_mutex, verified);
+            } catch (const std::exception& e) {
+                failures[c] = e.what();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    for (size_t c = 0; c < opts.clients; ++c) {
+        if (!failures[c].empty()) {
+            std::cerr << "ERROR: client " << c << ": " << failures[c] << "\n";
+            return 1;
+        }
+    }
+
+    ClientResult total;
+    for (ClientResult& r : results) {
+        for (int k = 0; k < kKinds; ++k) {
+            total.latency_us[k].insert(total.latency_us[k].end(), r.latency_us[k].begin(), r.latency_us[k].end());
+        }
+        total.samples += r.samples;
+        total.errors += r.errors;
+        total.cache_hits += r.cache_hits;
+    }
+    size_t requests = 0;
+    for (int k = 0; k < kKinds; ++k) requests += total.latency_us[k].size();
+
+    std::ostringstream json;
+    json << "{\n  \"clients\": " << opts.clients << ", \"depth\": " << opts.depth
+         << ", \"samples_per_predict\": " << opts.samples << ",\n"
+         << "  \"elapsed_s\": " << elapsed << ", \"requests\": " << requests
+         << ", \"requests_per_s\": " << requests / elapsed
+         << ", \"predictions_per_s\": " << total.samples / elapsed
+         << ", \"errors\": " << total.errors << ", \"cache_hits\": " << total.cache_hits
+         << ", \"verified\": " << (verified ? "true" : "false") << ",\n  \"latency_us\": {";
+    std::cerr << "\n  " << requests << " requests in " << elapsed << " s: " << requests / elapsed
+              << " req/s, " << total.samples / elapsed << " predictions/s, " << total.errors
+              << " errors, " << total.cache_hits << " fits served from cache\n";
+    bool first = true;
+    for (int k = 0; k < kKinds; ++k) {
+        std::vector<double>& v = total.latency_us[k];
+        if (v.empty()) continue;
+        const double p50 = percentile(v, 0.50), p90 = percentile(v, 0.90), p99 = percentile(v, 0.99);
+        const double max = *std::max_element(v.begin(), v.end());
+        std::cerr << "  " << kKindNames[k] << ": " << v.size() << " requests, latency p50 " << p50
+                  << " us, p90 " << p90 << " us, p99 " << p99 << " us, max " << max << " us\n";
+        json << (first ? "" : ",") << "\n    \"" << kKindNames[k] << "\": {\"count\": " << v.size()
+             << ", \"p50\": " << p50 << ", \"p90\": " << p90 << ", \"p99\": " << p99
+             << ", \"max\": " << max << "}";
+        first = false;
+    }
+    json << "\n  }\n}\n";
+
+    if (!opts.out_path.empty()) {
+        std::ofstream out(opts.out_path);
+        if (!out) {
+            std::cerr << "ERROR: cannot open " << opts.out_path << "\n";
+            return 1;
+        }
+        out << json.str();
+    } else {
+        std::cout << json.str();
+    }
+    return verified && total.errors == 0 ? 0 : 1;
+#else
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}
@@ -0,0 +1,253 @@
+/**
+ * @file oracle_protocol.cpp
+ * @brief Bounds-checked encoding and decoding of oracle slot payloads
+ */
+
+#include "oracle_protocol.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace sheaf::oracle {
+
+namespace {
+
+class Writer {
+public:
+    explicit Writer(std::span<std::byte> out) : out_(out) {}
+
+    template <typename T>
+    void put(const T& value) {
+        reserve(sizeof(T));
+        std::memcpy(out_.data() + at_, &value, sizeof(T));
+        at_ += sizeof(T);
+    }
+
+    void put_value(complex_t value) {
+        put(value.real());
+        put(value.imag());
+    }
+
+    // Column 0 of V, which must have `rows` rows
+    void put_column(const Matrix& V, size_t rows) {
+        if (static_cast<size_t>(V.rows()) != rows || V.cols() < 1) {
+            throw std::invalid_argument("Sample does not match the patch size");
+        }
+        for (size_t p = 0; p < rows; ++p) put_value(V(p, 0));
+    }
+
+    size_t size() const { return at_; }
+
+private:
+    void reserve(size_t bytes) {
+        if (at_ + bytes > out_.size()) {
+            throw std::length_error("Payload does not fit in the slot");
+        }
+    }
+
+    std::span<std::byte> out_;
+    size_t at_ = 0;
+};
+
+class Reader {
+public:
+    explicit Reader(std::span<const std::byte> in) : in_(in) {}
+
+    template <typename T>
+    T get() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, in_.data() + at_, sizeof(T));
+        at_ += sizeof(T);
+        return value;
+    }
+
+    complex_t get_value() {
+        const double re = get<double>();
+        const double im = get<double>();
+        return {re, im};
+    }
+
+    Matrix get_column(size_t rows) {
+        require(rows * 2 * sizeof(double));
+        Matrix V(rows, 1);
+        for (size_t p = 0; p < rows; ++p) V(p, 0) = get_value();
+        return V;
+    }
+
+    void require(size_t bytes) const {
+        if (bytes > in_.size() - at_) {
+            throw std::invalid_argument("Truncated payload");
+        }
+    }
+
+    void finish() const {
+        if (at_ != in_.size()) {
+            throw std::invalid_argument("Trailing bytes after payload");
+        }
+    }
+
+private:
+    std::span<const std::byte> in_;
+    size_t at_ = 0;
+};
+
+} // namespace
+
+size_t encode_fit(const SheafProblem& problem, real_t ridge, std::span<std::byte> out) {
+    Writer w(out);
+    w.put(FitHeader{static_cast<uint32_t>(problem.patches.size()),
+                    static_cast<uint32_t>(problem.gluings.size()), ridge});
+    std::vector<std::pair<std::string, size_t>> index;
+    for (const Patch& patch : problem.patches) {
+        PatchHeader header{};
+        if (patch.name.size() >= sizeof(header.name)) {
+            throw std::invalid_argument("Patch name too long: " + patch.name);
+        }
+        if (!patch.config.group_shape.empty() || patch.config.group_kind != SymmetryKind::Abelian) {
+            throw std::invalid_argument("Only cyclic patches can be sent to the oracle");
+        }
+        if (patch.V_samples.size() != patch.targets.size()) {
+            throw std::invalid_argument("Sample and target counts differ: " + patch.name);
+        }
+        std::memcpy(header.name, patch.name.c_str(), patch.name.size());
+        header.n_positions = static_cast<uint32_t>(patch.config.n_positions);
+        header.n_characters = static_cast<uint32_t>(patch.config.n_characters);
+        header.n_samples = static_cast<uint32_t>(patch.V_samples.size());
+        w.put(header);
+        for (const Matrix& V : patch.V_samples) w.put_column(V, patch.config.n_positions);
+        for (const Matrix& t : patch.targets) w.put_value(t(0, 0));
+        index.emplace_back(patch.name, patch.config.n_positions);
+    }
+    auto find = [&](const std::string& name) {
+        for (size_t i = 0; i < index.size(); ++i) {
+            if (index[i].first == name) return i;
+        }
+        throw std::invalid_argument("Gluing names an unknown patch: " + name);
+    };
+    for (const GluingConstraint& gluing : problem.gluings) {
+        const size_t p1 = find(gluing.patch_1);
+        const size_t p2 = find(gluing.patch_2);
+        w.put(GluingHeader{static_cast<uint32_t>(p1), static_cast<uint32_t>(p2), gluing.weight});
+        w.put_column(gluing.constraint_data_1, index[p1].second);
+        w.put_column(gluing.constraint_data_2, index[p2].second);
+    }
+    return w.size();
+}
+
+size_t encode_predict(uint32_t patch, std::span<const Matrix> samples, std::span<std::byte> out) {
+    Writer w(out);
+    w.put(PredictHeader{patch, static_cast<uint32_t>(samples.size())});
+    for (const Matrix& V : samples) w.put_column(V, V.rows());
+    return w.size();
+}
+
+size_t encode_reweight(std::span<const real_t> weights, std::span<std::byte> out) {
+    Writer w(out);
+    for (real_t weight : weights) w.put(weight);
+    return w.size();
+}
+
+FitRequest decode_fit(std::span<const std::byte> in) {
+    Reader r(in);
+    FitRequest request;
+    const FitHeader header = r.get<FitHeader>();
+    if (!(header.ridge >= 0.0) || !std::isfinite(header.ridge)) {
+        throw std::invalid_argument("Ridge must be finite and non-negative");
+    }
+    request.ridge = header.ridge;
+    for (uint32_t i = 0; i < header.n_patches; ++i) {
+        const PatchHeader ph = r.get<PatchHeader>();
+        if (std::memchr(ph.name, '\0', sizeof(ph.name)) == nullptr) {
+            throw std::invalid_argument("Patch name is not terminated");
+        }
+        if (ph.n_positions == 0 || ph.n_characters == 0 || ph.n_characters > ph.n_positions) {
+            throw std::invalid_argument("Bad patch dimensions");
+        }
+        // Reject sizes the payload cannot hold before allocating for them
+        r.require(static_cast<size_t>(ph.n_samples) * (ph.n_positions + 1) * 2 * sizeof(double));
+        Patch patch;
+        patch.name = ph.name;
+        patch.config = PatchConfig{ph.n_positions, ph.n_characters, 1};
+        patch.V_samples.reserve(ph.n_samples);
+        for (uint32_t s = 0; s < ph.n_samples; ++s) {
+            patch.V_samples.push_back(r.get_column(ph.n_positions));
+        }
+        for (uint32_t s = 0; s < ph.n_samples; ++s) {
+            Matrix t(1, 1);
+            t(0, 0) = r.get_value();
+            patch.targets.push_back(std::move(t));
+        }
+        request.problem.patches.push_back(std::move(patch));
+    }
+    for (uint32_t g = 0; g < header.n_gluings; ++g) {
+        const GluingHeader gh = r.get<GluingHeader>();
+        if (gh.patch_1 >= header.n_patches || gh.patch_2 >= header.n_patches) {
+            throw std::invalid_argument("Gluing names an unknown patch");
+        }
+        const Patch& p1 = request.problem.patches[gh.patch_1];
+        const Patch& p2 = request.problem.patches[gh.patch_2];
+        GluingConstraint gluing;
+        gluing.patch_1 = p1.name;
+        gluing.patch_2 = p2.name;
+        gluing.weight = gh.weight;
+        gluing.constraint_data_1 = r.get_column(p1.config.n_positions);
+        gluing.constraint_data_2 = r.get_column(p2.config.n_positions);
+        request.problem.gluings.push_back(std::move(gluing));
+    }
+    r.finish();
+    return request;
+}
+
+PredictRequest decode_predict(std::span<const std::byte> in) {
+    Reader r(in);
+    PredictRequest request;
+    const PredictHeader header = r.get<PredictHeader>();
+    request.patch = header.patch;
+    if (header.n_samples == 0) {
+        r.finish();
+        return request;
+    }
+    // Every sample has the same length; the payload fixes it
+    const size_t bytes = in.size() - sizeof(PredictHeader);
+    const size_t per_sample = bytes / header.n_samples;
+    if (per_sample == 0 || per_sample % (2 * sizeof(double)) != 0
+        || per_sample * header.n_samples != bytes) {
+        throw std::invalid_argument("Samples do not divide the payload");
+    }
+    request.samples.reserve(header.n_samples);
+    for (uint32_t s = 0; s < header.n_samples; ++s) {
+        request.samples.push_back(r.get_column(per_sample / (2 * sizeof(double))));
+    }
+    r.finish();
+    return request;
+}
+
+std::vector<real_t> decode_reweight(std::span<const std::byte> in) {
+    if (in.size() % sizeof(double) != 0) {
+        throw std::invalid_argument("Reweight payload is not a list of doubles");
+    }
+    Reader r(in);
+    std::vector<real_t> weights(in.size() / sizeof(double));
+    for (real_t& weight : weights) weight = r.get<double>();
+    return weights;
+}
+
+size_t encode_values(std::span<const complex_t> values, std::span<std::byte> out) {
+    Writer w(out);
+    for (complex_t value : values) w.put_value(value);
+    return w.size();
+}
+
+std::vector<complex_t> decode_values(std::span<const std::byte> in) {
+    if (in.size() % (2 * sizeof(double)) != 0) {
+        throw std::invalid_argument("Value payload is not a list of complex numbers");
+    }
+    Reader r(in);
+    std::vector<complex_t> values(in.size() / (2 * sizeof(double)));
+    for (complex_t& value : values) value = r.get_value();
+    return values;
+}
+
+} // namespace sheaf::oracle
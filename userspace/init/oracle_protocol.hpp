@@ -0,0 +1,91 @@
+/**
+ * @file oracle_protocol.hpp
+ * @brief Slot payload encodings of the sheaf oracle
+ *
+ * All payloads are flat little-endian records followed by complex values
+ * stored as (real, imaginary) doubles. Samples are single-column
+ * (d_model = 1) and patches use the cyclic group C_{n_positions}.
+ *
+ *   Fit       FitHeader, per patch PatchHeader + V (n_samples x n_positions)
+ *             + targets (n_samples), per gluing GluingHeader + data_1 + data_2
+ *   Predict   PredictHeader + samples (n_samples x n_positions)
+ *   Reweight  n_gluings doubles
+ *
+ * Fit and Reweight results are every patch's weights, in request order,
+ * each n_positions x n_characters row-major. Predict results are one
+ * complex value per sample.
+ */
+
+#pragma once
+
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sheaf::oracle {
+
+struct FitHeader {
+    uint32_t n_patches;
+    uint32_t n_gluings;
+    double ridge;
+};
+
+struct PatchHeader {
+    char name[48];         // NUL-terminated
+    uint32_t n_positions;
+    uint32_t n_characters;
+    uint32_t n_samples;
+    uint32_t reserved;
+};
+
+struct GluingHeader {
+    uint32_t patch_1;      // Index into the request's patches
+    uint32_t patch_2;
+    double weight;         // HARD_GLUING = exact
+};
+
+struct PredictHeader {
+    uint32_t patch;        // Index into the Fit request's patches
+    uint32_t n_samples;
+};
+
+struct FitRequest {
+    SheafProblem problem;
+    real_t ridge;
+};
+
+struct PredictRequest {
+    uint32_t patch;
+    std::vector<Matrix> samples;
+};
+
+/**
+ * @return Bytes written
+ * @throws std::length_error if the encoding does not fit in `out`
+ * @throws std::invalid_argument for a problem the wire format cannot carry
+ */
+size_t encode_fit(const SheafProblem& problem, real_t ridge, std::span<std::byte> out);
+size_t encode_predict(uint32_t patch, std::span<const Matrix> samples, std::span<std::byte> out);
+size_t encode_reweight(std::span<const real_t> weights, std::span<std::byte> out);
+
+/**
+ * @throws std::invalid_argument for a truncated or inconsistent payload
+ */
+FitRequest decode_fit(std::span<const std::byte> in);
+PredictRequest decode_predict(std::span<const std::byte> in);
+std::vector<real_t> decode_reweight(std::span<const std::byte> in);
+
+/**
+ * @brief Write `values` as (real, imaginary) pairs
+ *
+ * @return Bytes written
+ * @throws std::length_error if they do not fit in `out`
+ */
+size_t encode_values(std::span<const complex_t> values, std::span<std::byte> out);
+std::vector<complex_t> decode_values(std::span<const std::byte> in);
+
+} // namespace sheaf::oracle
@@ -0,0 +1,620 @@
+/**
+ * @file sheaf_oracle.cpp
+ * @brief The Oracle: a userspace sheaf solver service over shared-memory rings
+ *
+ * Other components query one long-running solver instead of linking their
+ * own. sheaf_oracle creates the segment described in oracle_abi.hpp and
+ * loops:
+ *
+ *   1. drain every claimed channel's submission ring into one batch
+ *   2. Fit: hash the request bytes; a problem already in the model cache
+ *      is answered from it, identical problems in the batch are fitted
+ *      once, and the distinct misses are fitted in parallel. A hash match
+ *      only counts once the bytes compare equal, so a collision costs a
+ *      solve rather than someone else's weights
+ *   3. Reweight: reweight_gluings() on the cached learner, which reuses
+ *      the per-patch factorizations of its fit
+ *   4. Predict: in parallel, straight from the request slots
+ *   5. post one completion per request
+ *
+ * Payloads are parsed where the client wrote them and results are written
+ * back into the same slot; nothing is copied through a socket or pipe.
+ *
+ * Every Fit returns a new model handle, valid until Release or until its
+ * client detaches. Handles from identical requests share one learner; the
+ * first Reweight through a shared handle refits a private copy, so no
+ * other holder sees its weights change. The last --max-models fits stay
+ * cached for new requests, least recently used evicted first.
+ *
+ * When every ring has been empty for --idle-us the daemon sleeps on the
+ * segment's doorbell futex until a client rings it.
+ *
+ * Usage:
+ *   sheaf_oracle [--segment NAME] [--channels N] [--slot-bytes N]
+ *                [--threads N] [--max-models N] [--idle-us N]
+ */
+
+#include "oracle_abi.hpp"
+#include "oracle_protocol.hpp"
+#include "sheaf_solver/parallel.hpp"
+#include "sheaf_solver/unified_sheaf_learner.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace sheaf;
+using namespace sheaf::oracle;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string segment = kDefaultSegment;
+    uint32_t channels = 8;
+    uint32_t slot_bytes = 64 * 1024;
+    size_t threads = 0;            // 0 = hardware concurrency
+    size_t max_models = 64;        // Fits kept for identical requests
+    unsigned idle_us = 200;        // Empty-ring time before sleeping on the doorbell
+};
+
+std::atomic<bool> g_stop{false};
+
+void on_signal(int) {
+    g_stop.store(true);
+}
+
+uint64_t fnv1a(std::span<const std::byte> bytes) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (std::byte b : bytes) {
+        h = (h ^ static_cast<uint8_t>(b)) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+// A fitted learner with the request it came from (to refit a private copy)
+struct Fitted {
+    std::unique_ptr<UnifiedSheafLearner> learner;
+    std::shared_ptr<const FitRequest> request;
+    std::vector<std::byte> request_bytes; // Cache key check; empty for private copies
+    std::vector<std::string> patches;    // Request order
+    std::vector<complex_t> weights;      // Result payload of its fit or last reweight
+    real_t residual = 0.0;
+};
+
+// What a model handle names; handles of identical Fit requests share `fitted`
+struct Model {
+    std::shared_ptr<Fitted> fitted;
+    uint32_t channel;                    // Owner, so handles die with their client
+    uint32_t generation;
+};
+
+bool same_bytes(std::span<const std::byte> a, std::span<const std::byte> b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+struct CacheEntry {
+    std::shared_ptr<Fitted> fitted;
+    uint64_t last_used;
+};
+
+struct Pending {
+    uint32_t channel;
+    uint32_t generation;                 // Of the channel when drained
+    SubmissionEntry request;
+    CompletionEntry reply;
+};
+
+struct Counters {
+    uint64_t batches = 0;
+    uint64_t requests = 0;
+    uint64_t fits = 0;                   // Actually solved
+    uint64_t cache_hits = 0;
+    uint64_t reweights = 0;
+    uint64_t private_copies = 0;         // Shared learners refitted for a Reweight
+    uint64_t predictions = 0;            // Samples
+    uint64_t errors = 0;
+    uint64_t sleeps = 0;
+};
+
+// Fit/Reweight result payload: every patch's weights, row-major, in request order
+std::vector<complex_t> flatten_weights(const SheafSolution& solution, const std::vector<std::string>& patches) {
+    std::vector<complex_t> flat;
+    for (const std::string& name : patches) {
+        const Matrix& w = solution.weights.at(name);
+        for (size_t p = 0; p < static_cast<size_t>(w.rows()); ++p) {
+            for (size_t j = 0; j < static_cast<size_t>(w.cols()); ++j) flat.push_back(w(p, j));
+        }
+    }
+    return flat;
+}
+
+class Oracle {
+public:
+    explicit Oracle(const Options& options) : options_(options) {
+        if (options.channels == 0 || options.slot_bytes < 256 || options.slot_bytes % 64 != 0) {
+            throw std::invalid_argument("Need at least one channel and a slot size that is a multiple of 64 (>= 256)");
+        }
+        bytes_ = segment_bytes(options.channels, options.slot_bytes);
+        ::shm_unlink(options.segment.c_str());   // Left behind by a daemon that crashed
+        const int fd = ::shm_open(options.segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            throw std::runtime_error("shm_open " + options.segment + ": " + std::strerror(errno));
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+            ::close(fd);
+            ::shm_unlink(options.segment.c_str());
+            throw std::runtime_error(std::string("ftruncate: ") + std::strerror(errno));
+        }
+        void* base = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            ::shm_unlink(options.segment.c_str());
+            throw std::runtime_error(std::string("mmap: ") + std::strerror(errno));
+        }
+        base_ = static_cast<std::byte*>(base);
+
+        // The fresh mapping is zero: every channel Free, every ring empty
+        header_ = new (base_) SegmentHeader{};
+        header_->magic = kMagic;
+        header_->version = kVersion;
+        header_->n_channels = options.channels;
+        header_->slot_bytes = options.slot_bytes;
+        header_->total_bytes = bytes_;
+        for (uint32_t c = 0; c < options.channels; ++c) {
+            new (base_ + channel_offset(c)) Channel{};
+        }
+        header_->running.store(1, std::memory_order_release);
+    }
+
+    ~Oracle() {
+        header_->running.store(0, std::memory_order_release);
+        ::munmap(base_, bytes_);
+        ::shm_unlink(options_.segment.c_str());
+    }
+
+    void run() {
+        std::vector<Pending> batch;
+        Clock::time_point last_work = Clock::now();
+        Clock::time_point last_reclaim = last_work;
+        while (!g_stop.load(std::memory_order_relaxed)) {
+            batch.clear();
+            drain(batch);
+            const Clock::time_point now = Clock::now();
+            if (now - last_reclaim > std::chrono::seconds(1)) {
+                reclaim_dead_channels();
+                last_reclaim = now;
+            }
+            if (!batch.empty()) {
+                serve(batch);
+                post(batch);
+                last_work = Clock::now();
+            } else if (now - last_work > std::chrono::microseconds(options_.idle_us)) {
+                sleep_on_doorbell();
+                last_work = Clock::now();
+            } else {
+                // Polling: let clients sharing this core run
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    const Counters& counters() const { return counters_; }
+    size_t cached_models() const { return cache_.size(); }
+
+private:
+    Channel& channel(uint32_t c) { return *reinterpret_cast<Channel*>(base_ + channel_offset(c)); }
+
+    bool claimed(Channel& ch) const {
+        return ch.state.load(std::memory_order_acquire) == static_cast<uint32_t>(ChannelState::Claimed);
+    }
+
+    std::span<std::byte> slot(uint32_t c, uint32_t s) {
+        return {base_ + slot_offset(*header_, c, s), header_->slot_bytes};
+    }
+
+    void drain(std::vector<Pending>& batch) {
+        for (uint32_t c = 0; c < header_->n_channels; ++c) {
+            Channel& ch = channel(c);
+            if (!claimed(ch)) continue;
+            SubmissionEntry request;
+            while (ch.sq.pop(request)) {
+                CompletionEntry reply{};
+                reply.user_data = request.user_data;
+                reply.slot = request.slot;
+                batch.push_back({c, ch.generation, request, reply});
+            }
+        }
+        counters_.batches += !batch.empty();
+        counters_.requests += batch.size();
+    }
+
+    // Payload of a request, or empty with BadRequest set
+    std::span<const std::byte> payload(Pending& p) {
+        if (p.request.slot >= kRingEntries || p.request.length > header_->slot_bytes) {
+            p.reply.status = static_cast<int32_t>(Status::BadRequest);
+            return {};
+        }
+        return slot(p.channel, p.request.slot).first(p.request.length);
+    }
+
+    void reply_values(Pending& p, std::span<const complex_t> values) {
+        if (values.size() * 2 * sizeof(double) > header_->slot_bytes) {
+            p.reply.status = static_cast<int32_t>(Status::TooLarge);
+            return;
+        }
+        p.reply.length = static_cast<uint32_t>(encode_values(values, slot(p.channel, p.request.slot)));
+    }
+
+    void serve(std::vector<Pending>& batch) {
+        std::vector<Pending*> fits, reweights, predicts;
+        for (Pending& p : batch) {
+            switch (static_cast<Opcode>(p.request.opcode)) {
+                case Opcode::Nop:
+                    break;
+                case Opcode::Fit:
+                    fits.push_back(&p);
+                    break;
+                case Opcode::Reweight:
+                    reweights.push_back(&p);
+                    break;
+                case Opcode::Predict:
+                    predicts.push_back(&p);
+                    break;
+                case Opcode::Release:
+                    if (models_.erase(p.request.model) == 0) {
+                        p.reply.status = static_cast<int32_t>(Status::UnknownModel);
+                    }
+                    break;
+                default:
+                    p.reply.status = static_cast<int32_t>(Status::BadRequest);
+            }
+        }
+        serve_fits(fits);
+        serve_reweights(reweights);
+        serve_predicts(predicts);
+        evict();
+        for (const Pending& p : batch) {
+            counters_.errors += p.reply.status != static_cast<int32_t>(Status::Ok);
+        }
+    }
+
+    static std::shared_ptr<Fitted> fit(std::shared_ptr<const FitRequest> request) {
+        auto fitted = std::make_shared<Fitted>();
+        fitted->learner = std::make_unique<UnifiedSheafLearner>();
+        fitted->learner->set_ridge(request->ridge);
+        const SheafSolution solution = fitted->learner->fit(request->problem);
+        for (const Patch& patch : request->problem.patches) {
+            fitted->patches.push_back(patch.name);
+        }
+        fitted->weights = flatten_weights(solution, fitted->patches);
+        fitted->residual = solution.residual_error;
+        fitted->request = std::move(request);
+        return fitted;
+    }
+
+    void serve_fits(const std::vector<Pending*>& fits) {
+        // Requests with the same bytes share one solve. The hash only finds
+        // candidates: a collision with different bytes is a miss
+        struct Job {
+            std::vector<Pending*> waiters;
+            std::span<const std::byte> bytes;
+            uint64_t hash;
+            std::shared_ptr<Fitted> fitted;
+            Status status = Status::Ok;
+        };
+        std::vector<Job> jobs;
+        std::unordered_map<uint64_t, size_t> job_index;
+        for (Pending* p : fits) {
+            const std::span<const std::byte> bytes = payload(*p);
+            if (p->reply.status != 0) continue;
+            const uint64_t hash = fnv1a(bytes);
+            auto cached = cache_.find(hash);
+            if (cached != cache_.end() && same_bytes(cached->second.fitted->request_bytes, bytes)) {
+                cached->second.last_used = ++clock_;
+                attach(*p, cached->second.fitted);
+                p->reply.flags |= kCompletionCached;
+                ++counters_.cache_hits;
+                continue;
+            }
+            auto [it, added] = job_index.try_emplace(hash, jobs.size());
+            if (!added && !same_bytes(jobs[it->second].bytes, bytes)) {
+                // Colliding problem: solved on its own, never merged into
+                jobs.push_back(Job{{p}, bytes, hash, nullptr});
+                continue;
+            }
+            if (added) {
+                jobs.push_back(Job{{}, bytes, hash, nullptr});
+            }
+            jobs[it->second].waiters.push_back(p);
+        }
+
+        // Each job owns its learner, so the solves share nothing
+        parallel_for(jobs.size(), jobs.size() > 1 ? options_.threads : 1, [&](size_t begin, size_t end, size_t) {
+            for (size_t j = begin; j < end; ++j) {
+                Job& job = jobs[j];
+                std::shared_ptr<const FitRequest> request;
+                try {
+                    request = std::make_shared<const FitRequest>(decode_fit(job.bytes));
+                } catch (const std::exception&) {
+                    job.status = Status::BadRequest;
+                    continue;
+                }
+                try {
+                    job.fitted = fit(std::move(request));
+                    job.fitted->request_bytes.assign(job.bytes.begin(), job.bytes.end());
+                } catch (const std::exception&) {
+                    job.status = Status::Failed;
+                }
+            }
+        });
+
+        for (Job& job : jobs) {
+            if (job.status != Status::Ok) {
+                for (Pending* p : job.waiters) p->reply.status = static_cast<int32_t>(job.status);
+                continue;
+            }
+            ++counters_.fits;
+            cache_[job.hash] = CacheEntry{job.fitted, ++clock_};
+            for (Pending* p : job.waiters) attach(*p, job.fitted);
+        }
+    }
+
+    // Answer a Fit request with a new handle on `fitted`
+    void attach(Pending& p, const std::shared_ptr<Fitted>& fitted) {
+        const uint64_t id = next_model_++;
+        models_.emplace(id, Model{fitted, p.channel, p.generation});
+        p.reply.model = id;
+        p.reply.residual = fitted->residual;
+        reply_values(p, fitted->weights);
+    }
+
+    void serve_reweights(const std::vector<Pending*>& reweights) {
+        // reweight_gluings() mutates the learner: one handle, one thread, in
+        // submission order
+        std::vector<std::vector<Pending*>> per_model;
+        std::unordered_map<uint64_t, size_t> index;
+        for (Pending* p : reweights) {
+            if (!models_.count(p->request.model)) {
+                p->reply.status = static_cast<int32_t>(Status::UnknownModel);
+                continue;
+            }
+            auto [at, added] = index.try_emplace(p->request.model, per_model.size());
+            if (added) per_model.emplace_back();
+            per_model[at->second].push_back(p);
+        }
+        // Copy on write: a learner shared with the cache or another handle is
+        // refitted privately first, so nobody else sees the new weights
+        std::vector<std::shared_ptr<Fitted>> shared(per_model.size());
+        for (size_t m = 0; m < per_model.size(); ++m) {
+            Model& model = models_.at(per_model[m].front()->request.model);
+            if (model.fitted.use_count() > 1) {
+                shared[m] = model.fitted;
+            }
+        }
+        std::atomic<uint64_t> copies{0};
+        parallel_for(per_model.size(), per_model.size() > 1 ? options_.threads : 1,
+                     [&](size_t begin, size_t end, size_t) {
+            for (size_t m = begin; m < end; ++m) {
+                Model& model = models_.at(per_model[m].front()->request.model);
+                if (shared[m]) {
+                    try {
+                        model.fitted = fit(shared[m]->request);
+                        copies.fetch_add(1, std::memory_order_relaxed);
+                    } catch (const std::exception&) {
+                        for (Pending* p : per_model[m]) p->reply.status = static_cast<int32_t>(Status::Failed);
+                        continue;
+                    }
+                }
+                Fitted& fitted = *model.fitted;
+                for (Pending* p : per_model[m]) {
+                    const std::span<const std::byte> bytes = payload(*p);
+                    if (p->reply.status != 0) continue;
+                    try {
+                        const SheafSolution solution = fitted.learner->reweight_gluings(decode_reweight(bytes));
+                        fitted.weights = flatten_weights(solution, fitted.patches);
+                        fitted.residual = solution.residual_error;
+                        p->reply.model = p->request.model;
+                        p->reply.residual = fitted.residual;
+                        reply_values(*p, fitted.weights);
+                    } catch (const std::invalid_argument&) {
+                        p->reply.status = static_cast<int32_t>(Status::BadRequest);
+                    } catch (const std::exception&) {
+                        p->reply.status = static_cast<int32_t>(Status::Failed);
+                    }
+                }
+            }
+        });
+        counters_.reweights += reweights.size();
+        counters_.private_copies += copies.load();
+    }
+
+    void serve_predicts(const std::vector<Pending*>& predicts) {
+        for (Pending* p : predicts) {
+            if (!models_.count(p->request.model)) {
+                p->reply.status = static_cast<int32_t>(Status::UnknownModel);
+            }
+        }
+        // predict() is const and safe to call concurrently on one learner;
+        // thread start-up only pays off for a sizeable batch
+        std::atomic<uint64_t> samples{0};
+        parallel_for(predicts.size(), predicts.size() >= 32 ? options_.threads : 1,
+                     [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                Pending& p = *predicts[i];
+                if (p.reply.status != 0) continue;
+                const std::span<const std::byte> bytes = payload(p);
+                if (p.reply.status != 0) continue;
+                const Fitted& fitted = *models_.at(p.request.model).fitted;
+                try {
+                    const PredictRequest request = decode_predict(bytes);
+                    if (request.patch >= fitted.patches.size()) {
+                        throw std::invalid_argument("Unknown patch");
+                    }
+                    const std::string& name = fitted.patches[request.patch];
+                    std::vector<complex_t> values;
+                    values.reserve(request.samples.size());
+                    for (const Matrix& V : request.samples) {
+                        values.push_back(fitted.learner->predict(name, V)(0, 0));
+                    }
+                    // The samples are parsed, so the slot can take the results
+                    reply_values(p, values);
+                    samples.fetch_add(values.size(), std::memory_order_relaxed);
+                } catch (const std::exception&) {
+                    p.reply.status = static_cast<int32_t>(Status::BadRequest);
+                }
+            }
+        });
+        counters_.predictions += samples.load();
+    }
+
+    // Handles keep their learners alive; the cache only decides which fits
+    // a new request can reuse
+    void evict() {
+        while (cache_.size() > options_.max_models) {
+            auto victim = cache_.begin();
+            for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+                if (it->second.last_used < victim->second.last_used) victim = it;
+            }
+            cache_.erase(victim);
+        }
+    }
+
+    void post(std::vector<Pending>& batch) {
+        for (Pending& p : batch) {
+            Channel& ch = channel(p.channel);
+            // The client detached (and maybe someone else claimed the
+            // channel) while this request was being served
+            if (!claimed(ch) || ch.generation != p.generation) continue;
+            if (!ch.cq.push(p.reply)) {
+                // Only a client submitting without a slot can overrun its ring
+                ++counters_.errors;
+            }
+        }
+    }
+
+    void reclaim_dead_channels() {
+        for (uint32_t c = 0; c < header_->n_channels; ++c) {
+            Channel& ch = channel(c);
+            if (claimed(ch) && ::kill(ch.pid, 0) != 0 && errno == ESRCH) {
+                std::cerr << "[oracle] channel " << c << ": client " << ch.pid << " exited without detaching\n";
+                ch.state.store(static_cast<uint32_t>(ChannelState::Free), std::memory_order_release);
+            }
+        }
+        // Handles whose client detached without releasing them
+        for (auto it = models_.begin(); it != models_.end();) {
+            Channel& ch = channel(it->second.channel);
+            if (!claimed(ch) || ch.generation != it->second.generation) {
+                it = models_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void sleep_on_doorbell() {
+        const uint32_t bell = header_->doorbell.load(std::memory_order_acquire);
+        header_->sleeping.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool idle = true;
+        for (uint32_t c = 0; c < header_->n_channels && idle; ++c) {
+            Channel& ch = channel(c);
+            idle = !claimed(ch) || ch.sq.empty();
+        }
+        if (idle && !g_stop.load()) {
+            // Wake up now and then to notice dead clients and signals
+            timespec timeout{0, 100 * 1000 * 1000};
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header_->doorbell), FUTEX_WAIT, bell,
+                      &timeout, nullptr, 0);
+            ++counters_.sleeps;
+        }
+        header_->sleeping.store(0, std::memory_order_relaxed);
+    }
+
+    Options options_;
+    std::byte* base_ = nullptr;
+    size_t bytes_ = 0;
+    SegmentHeader* header_ = nullptr;
+    std::unordered_map<uint64_t, Model> models_;           // By handle
+    std::unordered_map<uint64_t, CacheEntry> cache_;       // By request hash
+    uint64_t next_model_ = 1;
+    uint64_t clock_ = 0;
+    Counters counters_;
+};
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0
+              << " [--segment NAME] [--channels N] [--slot-bytes N]\n"
+              << "       [--threads N] [--max-models N] [--idle-us N]\n";
+}
+
+bool parse_args(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(a, "--segment") == 0 && has_value) {
+            opts.segment = argv[++i];
+        } else if (std::strcmp(a, "--channels") == 0 && has_value) {
+            opts.channels = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--slot-bytes") == 0 && has_value) {
+            opts.slot_bytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--threads") == 0 && has_value) {
+            opts.threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--max-models") == 0 && has_value) {
+            opts.max_models = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(a, "--idle-us") == 0 && has_value) {
+            opts.idle_us = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+#ifdef USE_EIGEN3
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    try {
+        Oracle oracle(opts);
+        std::cerr << "[oracle] serving " << opts.segment << ": " << opts.channels << " channels, "
+                  << kRingEntries << " slots of " << opts.slot_bytes << " bytes each\n";
+        oracle.run();
+        const Counters& c = oracle.counters();
+        std::cerr << "[oracle] " << c.requests << " requests in " << c.batches << " batches: "
+                  << c.fits << " fits, " << c.cache_hits << " cache hits, " << c.reweights
+                  << " reweights (" << c.private_copies << " private copies), " << c.predictions << " predictions, " << c.errors << " errors, "
+                  << c.sleeps << " doorbell sleeps, " << oracle.cached_models() << " models cached\n";
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+#else
+    std::cerr << "ERROR: Eigen3 required\n";
+    return 1;
+#endif
+}